@@ -19,18 +19,23 @@ RT_WEAK void rt_hw_board_init()
     /* Heap initialization */
 #if defined(RT_USING_HEAP)
     rt_system_heap_init((void *) HEAP_BEGIN, (void *) HEAP_END);
+#if defined(RT_USING_MEMHEAP_AS_HEAP) && defined(RT_USING_DMA_BUFFER)
+    /* the heap lies in SRAM1, which is accessible by DMA */
+    rt_memheap_set_attr((struct rt_memheap *)rt_object_find("heap", RT_Object_Class_MemHeap),
+                        RT_MEMHEAP_ATTR_DMA);
+#endif
 #endif
 
     hw_board_init(BSP_CLOCK_SOURCE, BSP_CLOCK_SOURCE_FREQ_MHZ, BSP_CLOCK_SYSTEM_FREQ_MHZ);
 
-    /* Set the shell console output device */
-#if defined(RT_USING_DEVICE) && defined(RT_USING_CONSOLE)
-    rt_console_set_device(RT_CONSOLE_DEVICE_NAME);
-#endif
-
     /* Board underlying hardware initialization */
 #ifdef RT_USING_COMPONENTS_INIT
     rt_components_board_init();
 #endif
 
+    /* Set the shell console output device, the uart device is registered by board init */
+#if defined(RT_USING_DEVICE) && defined(RT_USING_CONSOLE)
+    rt_console_set_device(RT_CONSOLE_DEVICE_NAME);
+#endif
+
 }
@@ -58,11 +58,22 @@ extern "C"
  *                 such as     #define BSP_UART1_TX_PIN       "PA9"
  *                             #define BSP_UART1_RX_PIN       "PA10"
  *
+ * STEP 3, if you want the serial port to move data by DMA, define the DMA macro of serial port,
+ *                 the DMA streams are listed in dma_config.h, otherwise the data is moved by interrupt
+ *                 such as     #define BSP_UART1_RX_USING_DMA
+ *                             #define BSP_UART1_TX_USING_DMA
+ *
+ * STEP 4, the size of rx and tx buffer of each serial device can be changed
+ *                 such as     #define BSP_UART_RX_BUFSIZE    256
+ *                             #define BSP_UART_TX_BUFSIZE    512
+ *
  */
 
 #define BSP_USING_UART1
 #define BSP_UART1_TX_PIN       "PA9"
 #define BSP_UART1_RX_PIN       "PA10"
+#define BSP_UART1_RX_USING_DMA
+#define BSP_UART1_TX_USING_DMA
 
 /*-------------------------- UART CONFIG END --------------------------*/
 
@@ -37,7 +37,42 @@ void rt_hw_systick_init(void)
     _systick_ms = 1000u / RT_TICK_PER_SECOND;
     if(_systick_ms == 0)
         _systick_ms = 1;
+
+#ifdef RT_USING_HW_CYCLE
+    /* enable the cycle counter of DWT */
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+}
+
+#ifdef RT_USING_HW_CYCLE
+/**
+ * This function will get the cpu cycle counter.
+ *
+ * @return the current value of DWT cycle counter
+ */
+rt_uint32_t rt_hw_cycle_get(void)
+{
+    return DWT->CYCCNT;
+}
+#endif
+
+#ifdef RT_USING_IRQ_LATENCY
+/**
+ * This function will get the entry latency of current interrupt. It is known
+ * for SysTick only, which is the cycles since the counter was reloaded.
+ *
+ * @return the cycles of latency, RT_UINT32_MAX if it is unknown
+ */
+rt_uint32_t rt_hw_irq_latency_get(void)
+{
+    if ((SCB->ICSR & SCB_ICSR_VECTACTIVE_Msk) == (SysTick_IRQn + 16))
+        return SysTick->LOAD - SysTick->VAL;
+
+    return RT_UINT32_MAX;
 }
+#endif
 
 /**
  * This is the timer interrupt service routine.
@@ -153,6 +188,101 @@ void rt_hw_us_delay(rt_uint32_t us)
     }
 }
 
+#ifdef RT_USING_TICKLESS
+/**
+ * This function will stop the periodic SysTick, sleep until the tick boundary
+ * of the next timer deadline or until another interrupt wakes up the CPU,
+ * and then restart the periodic SysTick aligned to the original tick phase.
+ *
+ * @param tick the ticks to the next timer deadline, RT_TICK_MAX for no timer
+ *
+ * @return the number of whole ticks passed during the sleep, excluding the
+ *         tick of deadline, which is left pending to SysTick_Handler so that
+ *         the expired timers are checked in interrupt
+ *
+ * @note this function is invoked by the idle thread with interrupt disabled.
+ */
+rt_tick_t rt_hw_tickless_sleep(rt_tick_t tick)
+{
+    rt_uint32_t cycle_per_tick, max_tick;
+    rt_uint32_t ctrl, remain, sleep_cycle, passed_cycle, next_cycle;
+    rt_tick_t passed_tick, pending_tick = 0;
+
+    cycle_per_tick = SysTick->LOAD + 1;
+    max_tick = (SysTick_LOAD_RELOAD_Msk + 1) / cycle_per_tick;
+    if (tick > max_tick)
+        tick = max_tick;
+
+    /* a tick is pending, let SysTick_Handler account it firstly */
+    if (tick == 0 || (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk))
+        return 0;
+
+    /* stop SysTick and keep the cycles left in the current tick period */
+    ctrl = SysTick->CTRL;
+    SysTick->CTRL = ctrl & ~SysTick_CTRL_ENABLE_Msk;
+    remain = SysTick->VAL;
+    if ((ctrl & SysTick_CTRL_COUNTFLAG_Msk) || remain == 0)
+    {
+        /* the tick boundary is just reached, give up this sleep */
+        SysTick->CTRL = ctrl | SysTick_CTRL_ENABLE_Msk;
+        if (ctrl & SysTick_CTRL_COUNTFLAG_Msk)
+            HAL_IncTick();
+        return 0;
+    }
+
+    /* expire at the tick boundary of the next timer deadline */
+    sleep_cycle = remain + (tick - 1) * cycle_per_tick;
+    SysTick->LOAD = sleep_cycle - 1;
+    SysTick->VAL  = 0;
+    SysTick->CTRL = ctrl | SysTick_CTRL_ENABLE_Msk;
+
+    __DSB();
+    __WFI();
+    __ISB();
+
+    ctrl = SysTick->CTRL;
+    SysTick->CTRL = ctrl & ~SysTick_CTRL_ENABLE_Msk;
+
+    if (ctrl & SysTick_CTRL_COUNTFLAG_Msk)
+    {
+        /* woken up by SysTick, the interrupt is left pending to account the tick of deadline */
+        SCB->ICSR = SCB_ICSR_PENDSTSET_Msk;
+        pending_tick = 1;
+        passed_tick = tick;
+        /* the counter is reloaded and keeps counting after the deadline */
+        passed_cycle = sleep_cycle - 1 - SysTick->VAL;
+        next_cycle = passed_cycle < cycle_per_tick ? cycle_per_tick - passed_cycle : cycle_per_tick;
+    }
+    else
+    {
+        /* woken up by other interrupt */
+        passed_cycle = sleep_cycle - 1 - SysTick->VAL;
+        if (passed_cycle < remain)
+        {
+            passed_tick = 0;
+            next_cycle = remain - passed_cycle;
+        }
+        else
+        {
+            passed_cycle -= remain;
+            passed_tick = 1 + passed_cycle / cycle_per_tick;
+            next_cycle = cycle_per_tick - passed_cycle % cycle_per_tick;
+        }
+    }
+
+    /* restart SysTick with the left cycles, then back to the period of one tick */
+    SysTick->LOAD = next_cycle - 1;
+    SysTick->VAL  = 0;
+    SysTick->CTRL = ctrl | SysTick_CTRL_ENABLE_Msk;
+    SysTick->LOAD = cycle_per_tick - 1;
+
+    /* the count flag is cleared, SysTick_Handler doesn't increase the HAL tick */
+    uwTick += passed_tick * _systick_ms;
+
+    return passed_tick - pending_tick;
+}
+#endif
+
 /**
  * This function will initial STM32 board.
  */
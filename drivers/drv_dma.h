@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2021-09-27     RT-Thread    the first version
+ */
+
+#ifndef __DRV_DMA_H__
+#define __DRV_DMA_H__
+
+#include <rtthread.h>
+#include <board.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(SOC_SERIES_STM32F2) || defined(SOC_SERIES_STM32F4) || defined(SOC_SERIES_STM32F7)
+#define DMA_INSTANCE_TYPE              DMA_Stream_TypeDef
+#else
+#define DMA_INSTANCE_TYPE              DMA_Channel_TypeDef
+#endif
+
+struct dma_config
+{
+    DMA_INSTANCE_TYPE *Instance;
+    rt_uint32_t dma_rcc;
+    IRQn_Type dma_irq;
+#if defined(SOC_SERIES_STM32F2) || defined(SOC_SERIES_STM32F4) || defined(SOC_SERIES_STM32F7)
+    rt_uint32_t channel;
+#endif
+};
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DRV_DMA_H__ */
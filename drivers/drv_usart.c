@@ -11,6 +11,8 @@
 
 #include "stdlib.h"
 #include "drv_common.h"
+#include "drv_dma.h"
+#include "dma_config.h"
 #include "uart_config.h"
 
 #define DBG_TAG              "drv.usart"
@@ -25,7 +27,45 @@
 
 #ifdef RT_USING_CONSOLE
 
-static UART_HandleTypeDef handle;
+#ifdef RT_USING_DEVICE
+#ifndef BSP_UART_RX_BUFSIZE
+#define BSP_UART_RX_BUFSIZE    256
+#endif
+#ifndef BSP_UART_TX_BUFSIZE
+#define BSP_UART_TX_BUFSIZE    512
+#endif
+#endif /* RT_USING_DEVICE */
+
+enum
+{
+#ifdef BSP_USING_UART1
+    UART1_INDEX,
+#endif
+#ifdef BSP_USING_UART2
+    UART2_INDEX,
+#endif
+#ifdef BSP_USING_UART3
+    UART3_INDEX,
+#endif
+#ifdef BSP_USING_UART4
+    UART4_INDEX,
+#endif
+#ifdef BSP_USING_UART5
+    UART5_INDEX,
+#endif
+#ifdef BSP_USING_UART6
+    UART6_INDEX,
+#endif
+#ifdef BSP_USING_UART7
+    UART7_INDEX,
+#endif
+#ifdef BSP_USING_UART8
+    UART8_INDEX,
+#endif
+#ifdef BSP_USING_LPUART1
+    LPUART1_INDEX,
+#endif
+};
 
 /* stm32 config class */
 struct stm32_uart_config
@@ -36,9 +76,10 @@ struct stm32_uart_config
 
     const char *tx_pin_name;
     const char *rx_pin_name;
-};
 
-static struct stm32_uart_config *_uart_config = RT_NULL;
+    struct dma_config *dma_rx;
+    struct dma_config *dma_tx;
+};
 
 struct stm32_uart_config uart_config[] =
 {
@@ -71,6 +112,37 @@ struct stm32_uart_config uart_config[] =
 #endif
 };
 
+/* stm32 uart driver class */
+struct stm32_uart
+{
+#ifdef RT_USING_DEVICE
+    struct rt_device parent;
+#endif
+    UART_HandleTypeDef handle;
+    struct stm32_uart_config *config;
+
+#ifdef RT_USING_DEVICE
+    rt_uint16_t uart_dma_flag;
+    DMA_HandleTypeDef dma_rx;
+    DMA_HandleTypeDef dma_tx;
+
+    /* the rx ring buffer, it is filled by the circular DMA or the rx interrupt */
+    rt_uint8_t rx_buf[BSP_UART_RX_BUFSIZE];
+    rt_uint16_t rx_put_index;
+    rt_uint16_t rx_get_index;
+
+    /* the tx ring buffer, it is drained by the DMA or the tx interrupt */
+    rt_uint8_t tx_buf[BSP_UART_TX_BUFSIZE];
+    rt_uint16_t tx_put_index;
+    rt_uint16_t tx_get_index;
+    rt_uint16_t tx_count;                   /* the size of transfer in progress */
+    rt_uint16_t tx_waiting;                 /* the threads waiting for the room */
+    struct rt_semaphore tx_sem;
+#endif
+};
+
+static struct stm32_uart uart_obj[sizeof(uart_config) / sizeof(uart_config[0])] = {0};
+
 static rt_err_t stm32_uart_clk_enable(struct stm32_uart_config *config)
 {
     /* check the parameters */
@@ -291,39 +363,904 @@ static rt_err_t stm32_gpio_configure(struct stm32_uart_config *config)
     return RT_EOK;
 }
 
-static rt_err_t stm32_configure(struct stm32_uart_config *config)
+static rt_err_t stm32_configure(struct stm32_uart *uart)
 {
-    stm32_uart_clk_enable(config);
+    stm32_uart_clk_enable(uart->config);
 
-    handle.Instance          = config->Instance;
-    handle.Init.BaudRate     = 115200;
-    handle.Init.HwFlowCtl    = UART_HWCONTROL_NONE;
-    handle.Init.Mode         = UART_MODE_TX_RX;
-    handle.Init.OverSampling = UART_OVERSAMPLING_16;
-    handle.Init.WordLength   = UART_WORDLENGTH_8B;
-    handle.Init.StopBits     = UART_STOPBITS_1;
-    handle.Init.Parity       = UART_PARITY_NONE;
+    uart->handle.Instance          = uart->config->Instance;
+    uart->handle.Init.BaudRate     = 115200;
+    uart->handle.Init.HwFlowCtl    = UART_HWCONTROL_NONE;
+    uart->handle.Init.Mode         = UART_MODE_TX_RX;
+    uart->handle.Init.OverSampling = UART_OVERSAMPLING_16;
+    uart->handle.Init.WordLength   = UART_WORDLENGTH_8B;
+    uart->handle.Init.StopBits     = UART_STOPBITS_1;
+    uart->handle.Init.Parity       = UART_PARITY_NONE;
 
-    if (HAL_UART_Init(&handle) != HAL_OK)
+    if (HAL_UART_Init(&uart->handle) != HAL_OK)
     {
         return -RT_ERROR;
     }
-    stm32_gpio_configure(_uart_config);
+    stm32_gpio_configure(uart->config);
 
     return RT_EOK;
 }
 
-int rt_hw_usart_init(void)
+static int stm32_uart_get_dr(UART_HandleTypeDef *handle)
+{
+#if defined(SOC_SERIES_STM32L4) || defined(SOC_SERIES_STM32F7) || defined(SOC_SERIES_STM32F0) \
+    || defined(SOC_SERIES_STM32L0) || defined(SOC_SERIES_STM32G0) || defined(SOC_SERIES_STM32H7) \
+    || defined(SOC_SERIES_STM32G4)
+    return handle->Instance->RDR & 0xff;
+#else
+    return handle->Instance->DR & 0xff;
+#endif
+}
+
+#ifdef RT_USING_DEVICE
+static void stm32_dma_config(struct stm32_uart *uart, rt_uint16_t flag)
+{
+    DMA_HandleTypeDef *DMA_Handle;
+    struct dma_config *dma_config;
+    rt_uint32_t tmpreg = 0x00U;
+
+    if (flag == RT_DEVICE_FLAG_DMA_RX)
+    {
+        DMA_Handle = &uart->dma_rx;
+        dma_config = uart->config->dma_rx;
+        __HAL_LINKDMA(&(uart->handle), hdmarx, uart->dma_rx);
+    }
+    else
+    {
+        DMA_Handle = &uart->dma_tx;
+        dma_config = uart->config->dma_tx;
+        __HAL_LINKDMA(&(uart->handle), hdmatx, uart->dma_tx);
+    }
+
+    /* enable DMA clock && delay after an RCC peripheral clock enabling */
+    SET_BIT(RCC->AHB1ENR, dma_config->dma_rcc);
+    tmpreg = READ_BIT(RCC->AHB1ENR, dma_config->dma_rcc);
+    UNUSED(tmpreg);
+
+    DMA_Handle->Instance                 = dma_config->Instance;
+    DMA_Handle->Init.Channel             = dma_config->channel;
+    DMA_Handle->Init.PeriphInc           = DMA_PINC_DISABLE;
+    DMA_Handle->Init.MemInc              = DMA_MINC_ENABLE;
+    DMA_Handle->Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+    DMA_Handle->Init.MemDataAlignment    = DMA_MDATAALIGN_BYTE;
+    DMA_Handle->Init.Priority            = DMA_PRIORITY_MEDIUM;
+    DMA_Handle->Init.FIFOMode            = DMA_FIFOMODE_DISABLE;
+
+    if (flag == RT_DEVICE_FLAG_DMA_RX)
+    {
+        /* the rx buffer is refilled circularly, it never needs to be restarted */
+        DMA_Handle->Init.Direction = DMA_PERIPH_TO_MEMORY;
+        DMA_Handle->Init.Mode      = DMA_CIRCULAR;
+    }
+    else
+    {
+        DMA_Handle->Init.Direction = DMA_MEMORY_TO_PERIPH;
+        DMA_Handle->Init.Mode      = DMA_NORMAL;
+    }
+
+    HAL_DMA_DeInit(DMA_Handle);
+    if (HAL_DMA_Init(DMA_Handle) != HAL_OK)
+    {
+        RT_ASSERT(0);
+    }
+
+    HAL_NVIC_SetPriority(dma_config->dma_irq, 0, 0);
+    HAL_NVIC_EnableIRQ(dma_config->dma_irq);
+}
+
+/* the length of received data in the rx buffer */
+static rt_size_t stm32_uart_rx_length(struct stm32_uart *uart)
+{
+    if (uart->uart_dma_flag & RT_DEVICE_FLAG_DMA_RX)
+    {
+        /* the DMA writes at the position of remaining count in the circular transfer */
+        uart->rx_put_index = (BSP_UART_RX_BUFSIZE - __HAL_DMA_GET_COUNTER(&uart->dma_rx)) % BSP_UART_RX_BUFSIZE;
+    }
+
+    return (uart->rx_put_index + BSP_UART_RX_BUFSIZE - uart->rx_get_index) % BSP_UART_RX_BUFSIZE;
+}
+
+static void stm32_uart_rx_indicate(struct stm32_uart *uart)
+{
+    rt_size_t length;
+
+    length = stm32_uart_rx_length(uart);
+    if (length != 0 && uart->parent.rx_indicate != RT_NULL)
+    {
+        uart->parent.rx_indicate(&uart->parent, length);
+    }
+}
+
+static void stm32_uart_rx_start(struct stm32_uart *uart)
+{
+    if (uart->uart_dma_flag & RT_DEVICE_FLAG_DMA_RX)
+    {
+        uart->rx_put_index = 0;
+        uart->rx_get_index = 0;
+        HAL_UART_Receive_DMA(&uart->handle, uart->rx_buf, BSP_UART_RX_BUFSIZE);
+
+        /* the idle line reports the end of a burst which doesn't reach the half of buffer */
+        __HAL_UART_CLEAR_IDLEFLAG(&uart->handle);
+        __HAL_UART_ENABLE_IT(&uart->handle, UART_IT_IDLE);
+    }
+    else
+    {
+        __HAL_UART_ENABLE_IT(&uart->handle, UART_IT_RXNE);
+    }
+}
+
+/* start the transfer of pending data in the tx buffer, it shall be invoked with interrupt disabled */
+static void stm32_uart_tx_start(struct stm32_uart *uart)
+{
+    HAL_StatusTypeDef status;
+    rt_uint16_t length;
+
+    if (uart->tx_count != 0 || uart->tx_get_index == uart->tx_put_index)
+    {
+        return;
+    }
+
+    /* send the continuous part only, the wrapped part is sent by the next transfer */
+    if (uart->tx_put_index > uart->tx_get_index)
+    {
+        length = uart->tx_put_index - uart->tx_get_index;
+    }
+    else
+    {
+        length = BSP_UART_TX_BUFSIZE - uart->tx_get_index;
+    }
+
+    uart->tx_count = length;
+    if (uart->uart_dma_flag & RT_DEVICE_FLAG_DMA_TX)
+    {
+        status = HAL_UART_Transmit_DMA(&uart->handle, &uart->tx_buf[uart->tx_get_index], length);
+    }
+    else
+    {
+        status = HAL_UART_Transmit_IT(&uart->handle, &uart->tx_buf[uart->tx_get_index], length);
+    }
+
+    if (status != HAL_OK)
+    {
+        /* try again on the next write */
+        uart->tx_count = 0;
+    }
+}
+
+static void stm32_uart_tx_done(struct stm32_uart *uart)
+{
+    rt_base_t level;
+
+    level = rt_hw_interrupt_disable();
+
+    uart->tx_get_index = (uart->tx_get_index + uart->tx_count) % BSP_UART_TX_BUFSIZE;
+    uart->tx_count = 0;
+    stm32_uart_tx_start(uart);
+
+    /* wake up all the writers waiting for the room, one release for each of them */
+    while (uart->tx_waiting > 0)
+    {
+        uart->tx_waiting --;
+        rt_sem_release(&uart->tx_sem);
+    }
+
+    rt_hw_interrupt_enable(level);
+}
+
+/**
+ * Uart common interrupt process. This need add to uart ISR.
+ *
+ * @param uart the uart device
+ */
+static void uart_isr(struct stm32_uart *uart)
+{
+    UART_HandleTypeDef *handle = &uart->handle;
+    rt_uint16_t index;
+    int ch;
+
+    if ((__HAL_UART_GET_FLAG(handle, UART_FLAG_RXNE) != RESET) &&
+        (__HAL_UART_GET_IT_SOURCE(handle, UART_IT_RXNE) != RESET))
+    {
+        ch = stm32_uart_get_dr(handle);
+
+        /* the data is dropped when the rx buffer is full */
+        index = (uart->rx_put_index + 1) % BSP_UART_RX_BUFSIZE;
+        if (index != uart->rx_get_index)
+        {
+            uart->rx_buf[uart->rx_put_index] = ch;
+            uart->rx_put_index = index;
+        }
+        stm32_uart_rx_indicate(uart);
+    }
+    else if ((__HAL_UART_GET_FLAG(handle, UART_FLAG_IDLE) != RESET) &&
+             (__HAL_UART_GET_IT_SOURCE(handle, UART_IT_IDLE) != RESET))
+    {
+        __HAL_UART_CLEAR_IDLEFLAG(handle);
+        stm32_uart_rx_indicate(uart);
+    }
+
+    /* the end of transmission and the errors are processed by HAL */
+    HAL_UART_IRQHandler(handle);
+}
+
+/* drive the transmission by polling when the writer can't be suspended */
+static void stm32_uart_tx_poll(struct stm32_uart *uart)
+{
+    rt_base_t level;
+
+    level = rt_hw_interrupt_disable();
+
+    if (uart->uart_dma_flag & RT_DEVICE_FLAG_DMA_TX)
+    {
+        HAL_DMA_IRQHandler(&uart->dma_tx);
+    }
+    uart_isr(uart);
+
+    rt_hw_interrupt_enable(level);
+}
+
+static rt_err_t stm32_uart_open(rt_device_t dev, rt_uint16_t oflag)
 {
-    _uart_config = &uart_config[0];
-    stm32_configure(_uart_config);
+    struct stm32_uart *uart = (struct stm32_uart *)dev;
+    rt_base_t level;
+
+    RT_ASSERT(uart != RT_NULL);
+
+    level = rt_hw_interrupt_disable();
+
+    /* the device is shared by console and shell, the reception is started by the first open */
+    if (!(dev->open_flag & RT_DEVICE_OFLAG_OPEN))
+    {
+        stm32_uart_rx_start(uart);
+    }
+    dev->open_flag |= oflag & (RT_DEVICE_OFLAG_MASK | RT_DEVICE_FLAG_STREAM);
+
+    rt_hw_interrupt_enable(level);
 
     return RT_EOK;
 }
+
+static rt_err_t stm32_uart_close(rt_device_t dev)
+{
+    struct stm32_uart *uart = (struct stm32_uart *)dev;
+
+    RT_ASSERT(uart != RT_NULL);
+
+    if (uart->uart_dma_flag & RT_DEVICE_FLAG_DMA_RX)
+    {
+        __HAL_UART_DISABLE_IT(&uart->handle, UART_IT_IDLE);
+        HAL_UART_AbortReceive(&uart->handle);
+    }
+    else
+    {
+        __HAL_UART_DISABLE_IT(&uart->handle, UART_IT_RXNE);
+    }
+
+    return RT_EOK;
+}
+
+static rt_size_t stm32_uart_read(rt_device_t dev, rt_off_t pos, void *buffer, rt_size_t size)
+{
+    struct stm32_uart *uart = (struct stm32_uart *)dev;
+    rt_uint8_t *ptr = (rt_uint8_t *)buffer;
+    rt_size_t length;
+    rt_base_t level;
+
+    RT_ASSERT(uart != RT_NULL);
+
+    level = rt_hw_interrupt_disable();
+
+    length = stm32_uart_rx_length(uart);
+    if (length > size)
+    {
+        length = size;
+    }
+
+    for (size = 0; size < length; size ++)
+    {
+        ptr[size] = uart->rx_buf[uart->rx_get_index];
+        uart->rx_get_index = (uart->rx_get_index + 1) % BSP_UART_RX_BUFSIZE;
+    }
+
+    rt_hw_interrupt_enable(level);
+
+    return length;
+}
+
+static rt_size_t stm32_uart_write(rt_device_t dev, rt_off_t pos, const void *buffer, rt_size_t size)
+{
+    struct stm32_uart *uart = (struct stm32_uart *)dev;
+    const rt_uint8_t *ptr = (const rt_uint8_t *)buffer;
+    rt_size_t length = 0;
+    rt_uint16_t room, need;
+    rt_bool_t blocking;
+    rt_base_t level;
+
+    RT_ASSERT(uart != RT_NULL);
+
+    /* only the thread can be suspended to wait for the room, otherwise the transmission is polled */
+    blocking = (rt_interrupt_get_nest() == 0 && rt_thread_self() != RT_NULL &&
+                rt_critical_level() == 0 && __get_PRIMASK() == 0);
+
+    while (length < size)
+    {
+        level = rt_hw_interrupt_disable();
+
+        while (length < size)
+        {
+            room = (uart->tx_get_index + BSP_UART_TX_BUFSIZE - uart->tx_put_index - 1) % BSP_UART_TX_BUFSIZE;
+            need = ((dev->open_flag & RT_DEVICE_FLAG_STREAM) && ptr[length] == '\n') ? 2 : 1;
+            if (room < need)
+            {
+                break;
+            }
+
+            if (need == 2)
+            {
+                uart->tx_buf[uart->tx_put_index] = '\r';
+                uart->tx_put_index = (uart->tx_put_index + 1) % BSP_UART_TX_BUFSIZE;
+            }
+            uart->tx_buf[uart->tx_put_index] = ptr[length ++];
+            uart->tx_put_index = (uart->tx_put_index + 1) % BSP_UART_TX_BUFSIZE;
+        }
+        stm32_uart_tx_start(uart);
+
+        if (length < size && blocking)
+        {
+            uart->tx_waiting ++;
+        }
+
+        rt_hw_interrupt_enable(level);
+
+        if (length < size)
+        {
+            if (blocking)
+            {
+                rt_sem_take(&uart->tx_sem, RT_WAITING_FOREVER);
+            }
+            else
+            {
+                stm32_uart_tx_poll(uart);
+            }
+        }
+    }
+
+    return size;
+}
+
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+    struct stm32_uart *uart = rt_container_of(huart, struct stm32_uart, handle);
+
+    stm32_uart_tx_done(uart);
+}
+
+void HAL_UART_RxHalfCpltCallback(UART_HandleTypeDef *huart)
+{
+    struct stm32_uart *uart = rt_container_of(huart, struct stm32_uart, handle);
+
+    stm32_uart_rx_indicate(uart);
+}
+
+void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart)
+{
+    struct stm32_uart *uart = rt_container_of(huart, struct stm32_uart, handle);
+
+    stm32_uart_rx_indicate(uart);
+}
+
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
+{
+    struct stm32_uart *uart = rt_container_of(huart, struct stm32_uart, handle);
+    rt_base_t level;
+
+    level = rt_hw_interrupt_disable();
+
+    /* the reception is stopped by HAL on the blocking error, restart it */
+    if ((uart->parent.open_flag & RT_DEVICE_OFLAG_OPEN) && huart->RxState == HAL_UART_STATE_READY)
+    {
+        stm32_uart_rx_start(uart);
+    }
+
+    /* the transmission is aborted, drop it and go on with the rest */
+    if (uart->tx_count != 0 && huart->gState == HAL_UART_STATE_READY)
+    {
+        stm32_uart_tx_done(uart);
+    }
+
+    rt_hw_interrupt_enable(level);
+}
+
+#ifdef RT_USING_DEVICE_OPS
+const static struct rt_device_ops stm32_uart_ops =
+{
+    RT_NULL,
+    stm32_uart_open,
+    stm32_uart_close,
+    stm32_uart_read,
+    stm32_uart_write,
+    RT_NULL
+};
+#endif
+
+static rt_err_t stm32_uart_register(struct stm32_uart *uart)
+{
+    struct rt_device *device = &uart->parent;
+
+    rt_sem_init(&uart->tx_sem, uart->config->name, 0, RT_IPC_FLAG_FIFO);
+
+    if (uart->uart_dma_flag & RT_DEVICE_FLAG_DMA_RX)
+    {
+        stm32_dma_config(uart, RT_DEVICE_FLAG_DMA_RX);
+    }
+    if (uart->uart_dma_flag & RT_DEVICE_FLAG_DMA_TX)
+    {
+        stm32_dma_config(uart, RT_DEVICE_FLAG_DMA_TX);
+    }
+
+    HAL_NVIC_SetPriority(uart->config->irq_type, 1, 0);
+    HAL_NVIC_EnableIRQ(uart->config->irq_type);
+
+    device->type        = RT_Device_Class_Char;
+    device->rx_indicate = RT_NULL;
+    device->tx_complete = RT_NULL;
+
+#ifdef RT_USING_DEVICE_OPS
+    device->ops         = &stm32_uart_ops;
+#else
+    device->init        = RT_NULL;
+    device->open        = stm32_uart_open;
+    device->close       = stm32_uart_close;
+    device->read        = stm32_uart_read;
+    device->write       = stm32_uart_write;
+    device->control     = RT_NULL;
+#endif
+    device->user_data   = RT_NULL;
+
+    return rt_device_register(device, uart->config->name,
+                              RT_DEVICE_FLAG_RDWR | RT_DEVICE_FLAG_INT_RX | RT_DEVICE_FLAG_INT_TX | uart->uart_dma_flag);
+}
+
+static void stm32_uart_get_dma_config(void)
+{
+#ifdef BSP_USING_UART1
+    uart_obj[UART1_INDEX].uart_dma_flag = 0;
+#ifdef BSP_UART1_RX_USING_DMA
+    uart_obj[UART1_INDEX].uart_dma_flag |= RT_DEVICE_FLAG_DMA_RX;
+    static struct dma_config uart1_dma_rx = UART1_DMA_RX_CONFIG;
+    uart_config[UART1_INDEX].dma_rx = &uart1_dma_rx;
+#endif
+#ifdef BSP_UART1_TX_USING_DMA
+    uart_obj[UART1_INDEX].uart_dma_flag |= RT_DEVICE_FLAG_DMA_TX;
+    static struct dma_config uart1_dma_tx = UART1_DMA_TX_CONFIG;
+    uart_config[UART1_INDEX].dma_tx = &uart1_dma_tx;
+#endif
+#endif
+#ifdef BSP_USING_UART2
+    uart_obj[UART2_INDEX].uart_dma_flag = 0;
+#ifdef BSP_UART2_RX_USING_DMA
+    uart_obj[UART2_INDEX].uart_dma_flag |= RT_DEVICE_FLAG_DMA_RX;
+    static struct dma_config uart2_dma_rx = UART2_DMA_RX_CONFIG;
+    uart_config[UART2_INDEX].dma_rx = &uart2_dma_rx;
+#endif
+#ifdef BSP_UART2_TX_USING_DMA
+    uart_obj[UART2_INDEX].uart_dma_flag |= RT_DEVICE_FLAG_DMA_TX;
+    static struct dma_config uart2_dma_tx = UART2_DMA_TX_CONFIG;
+    uart_config[UART2_INDEX].dma_tx = &uart2_dma_tx;
+#endif
+#endif
+#ifdef BSP_USING_UART3
+    uart_obj[UART3_INDEX].uart_dma_flag = 0;
+#ifdef BSP_UART3_RX_USING_DMA
+    uart_obj[UART3_INDEX].uart_dma_flag |= RT_DEVICE_FLAG_DMA_RX;
+    static struct dma_config uart3_dma_rx = UART3_DMA_RX_CONFIG;
+    uart_config[UART3_INDEX].dma_rx = &uart3_dma_rx;
+#endif
+#ifdef BSP_UART3_TX_USING_DMA
+    uart_obj[UART3_INDEX].uart_dma_flag |= RT_DEVICE_FLAG_DMA_TX;
+    static struct dma_config uart3_dma_tx = UART3_DMA_TX_CONFIG;
+    uart_config[UART3_INDEX].dma_tx = &uart3_dma_tx;
+#endif
+#endif
+#ifdef BSP_USING_UART4
+    uart_obj[UART4_INDEX].uart_dma_flag = 0;
+#ifdef BSP_UART4_RX_USING_DMA
+    uart_obj[UART4_INDEX].uart_dma_flag |= RT_DEVICE_FLAG_DMA_RX;
+    static struct dma_config uart4_dma_rx = UART4_DMA_RX_CONFIG;
+    uart_config[UART4_INDEX].dma_rx = &uart4_dma_rx;
+#endif
+#ifdef BSP_UART4_TX_USING_DMA
+    uart_obj[UART4_INDEX].uart_dma_flag |= RT_DEVICE_FLAG_DMA_TX;
+    static struct dma_config uart4_dma_tx = UART4_DMA_TX_CONFIG;
+    uart_config[UART4_INDEX].dma_tx = &uart4_dma_tx;
+#endif
+#endif
+#ifdef BSP_USING_UART5
+    uart_obj[UART5_INDEX].uart_dma_flag = 0;
+#ifdef BSP_UART5_RX_USING_DMA
+    uart_obj[UART5_INDEX].uart_dma_flag |= RT_DEVICE_FLAG_DMA_RX;
+    static struct dma_config uart5_dma_rx = UART5_DMA_RX_CONFIG;
+    uart_config[UART5_INDEX].dma_rx = &uart5_dma_rx;
+#endif
+#ifdef BSP_UART5_TX_USING_DMA
+    uart_obj[UART5_INDEX].uart_dma_flag |= RT_DEVICE_FLAG_DMA_TX;
+    static struct dma_config uart5_dma_tx = UART5_DMA_TX_CONFIG;
+    uart_config[UART5_INDEX].dma_tx = &uart5_dma_tx;
+#endif
+#endif
+#ifdef BSP_USING_UART6
+    uart_obj[UART6_INDEX].uart_dma_flag = 0;
+#ifdef BSP_UART6_RX_USING_DMA
+    uart_obj[UART6_INDEX].uart_dma_flag |= RT_DEVICE_FLAG_DMA_RX;
+    static struct dma_config uart6_dma_rx = UART6_DMA_RX_CONFIG;
+    uart_config[UART6_INDEX].dma_rx = &uart6_dma_rx;
+#endif
+#ifdef BSP_UART6_TX_USING_DMA
+    uart_obj[UART6_INDEX].uart_dma_flag |= RT_DEVICE_FLAG_DMA_TX;
+    static struct dma_config uart6_dma_tx = UART6_DMA_TX_CONFIG;
+    uart_config[UART6_INDEX].dma_tx = &uart6_dma_tx;
+#endif
+#endif
+#ifdef BSP_USING_UART7
+    uart_obj[UART7_INDEX].uart_dma_flag = 0;
+#ifdef BSP_UART7_RX_USING_DMA
+    uart_obj[UART7_INDEX].uart_dma_flag |= RT_DEVICE_FLAG_DMA_RX;
+    static struct dma_config uart7_dma_rx = UART7_DMA_RX_CONFIG;
+    uart_config[UART7_INDEX].dma_rx = &uart7_dma_rx;
+#endif
+#ifdef BSP_UART7_TX_USING_DMA
+    uart_obj[UART7_INDEX].uart_dma_flag |= RT_DEVICE_FLAG_DMA_TX;
+    static struct dma_config uart7_dma_tx = UART7_DMA_TX_CONFIG;
+    uart_config[UART7_INDEX].dma_tx = &uart7_dma_tx;
+#endif
+#endif
+#ifdef BSP_USING_UART8
+    uart_obj[UART8_INDEX].uart_dma_flag = 0;
+#ifdef BSP_UART8_RX_USING_DMA
+    uart_obj[UART8_INDEX].uart_dma_flag |= RT_DEVICE_FLAG_DMA_RX;
+    static struct dma_config uart8_dma_rx = UART8_DMA_RX_CONFIG;
+    uart_config[UART8_INDEX].dma_rx = &uart8_dma_rx;
+#endif
+#ifdef BSP_UART8_TX_USING_DMA
+    uart_obj[UART8_INDEX].uart_dma_flag |= RT_DEVICE_FLAG_DMA_TX;
+    static struct dma_config uart8_dma_tx = UART8_DMA_TX_CONFIG;
+    uart_config[UART8_INDEX].dma_tx = &uart8_dma_tx;
+#endif
+#endif
+}
+
+#if defined(BSP_USING_UART1)
+void USART1_IRQHandler(void)
+{
+    /* enter interrupt */
+    rt_interrupt_enter();
+
+    uart_isr(&(uart_obj[UART1_INDEX]));
+
+    /* leave interrupt */
+    rt_interrupt_leave();
+}
+#if defined(BSP_UART1_RX_USING_DMA)
+void UART1_DMA_RX_IRQHandler(void)
+{
+    /* enter interrupt */
+    rt_interrupt_enter();
+
+    HAL_DMA_IRQHandler(&uart_obj[UART1_INDEX].dma_rx);
+
+    /* leave interrupt */
+    rt_interrupt_leave();
+}
+#endif /* defined(BSP_UART1_RX_USING_DMA) */
+#if defined(BSP_UART1_TX_USING_DMA)
+void UART1_DMA_TX_IRQHandler(void)
+{
+    /* enter interrupt */
+    rt_interrupt_enter();
+
+    HAL_DMA_IRQHandler(&uart_obj[UART1_INDEX].dma_tx);
+
+    /* leave interrupt */
+    rt_interrupt_leave();
+}
+#endif /* defined(BSP_UART1_TX_USING_DMA) */
+#endif /* BSP_USING_UART1 */
+
+#if defined(BSP_USING_UART2)
+void USART2_IRQHandler(void)
+{
+    /* enter interrupt */
+    rt_interrupt_enter();
+
+    uart_isr(&(uart_obj[UART2_INDEX]));
+
+    /* leave interrupt */
+    rt_interrupt_leave();
+}
+#if defined(BSP_UART2_RX_USING_DMA)
+void UART2_DMA_RX_IRQHandler(void)
+{
+    /* enter interrupt */
+    rt_interrupt_enter();
+
+    HAL_DMA_IRQHandler(&uart_obj[UART2_INDEX].dma_rx);
+
+    /* leave interrupt */
+    rt_interrupt_leave();
+}
+#endif /* defined(BSP_UART2_RX_USING_DMA) */
+#if defined(BSP_UART2_TX_USING_DMA)
+void UART2_DMA_TX_IRQHandler(void)
+{
+    /* enter interrupt */
+    rt_interrupt_enter();
+
+    HAL_DMA_IRQHandler(&uart_obj[UART2_INDEX].dma_tx);
+
+    /* leave interrupt */
+    rt_interrupt_leave();
+}
+#endif /* defined(BSP_UART2_TX_USING_DMA) */
+#endif /* BSP_USING_UART2 */
+
+#if defined(BSP_USING_UART3)
+void USART3_IRQHandler(void)
+{
+    /* enter interrupt */
+    rt_interrupt_enter();
+
+    uart_isr(&(uart_obj[UART3_INDEX]));
+
+    /* leave interrupt */
+    rt_interrupt_leave();
+}
+#if defined(BSP_UART3_RX_USING_DMA)
+void UART3_DMA_RX_IRQHandler(void)
+{
+    /* enter interrupt */
+    rt_interrupt_enter();
+
+    HAL_DMA_IRQHandler(&uart_obj[UART3_INDEX].dma_rx);
+
+    /* leave interrupt */
+    rt_interrupt_leave();
+}
+#endif /* defined(BSP_UART3_RX_USING_DMA) */
+#if defined(BSP_UART3_TX_USING_DMA)
+void UART3_DMA_TX_IRQHandler(void)
+{
+    /* enter interrupt */
+    rt_interrupt_enter();
+
+    HAL_DMA_IRQHandler(&uart_obj[UART3_INDEX].dma_tx);
+
+    /* leave interrupt */
+    rt_interrupt_leave();
+}
+#endif /* defined(BSP_UART3_TX_USING_DMA) */
+#endif /* BSP_USING_UART3 */
+
+#if defined(BSP_USING_UART4)
+void UART4_IRQHandler(void)
+{
+    /* enter interrupt */
+    rt_interrupt_enter();
+
+    uart_isr(&(uart_obj[UART4_INDEX]));
+
+    /* leave interrupt */
+    rt_interrupt_leave();
+}
+#if defined(BSP_UART4_RX_USING_DMA)
+void UART4_DMA_RX_IRQHandler(void)
+{
+    /* enter interrupt */
+    rt_interrupt_enter();
+
+    HAL_DMA_IRQHandler(&uart_obj[UART4_INDEX].dma_rx);
+
+    /* leave interrupt */
+    rt_interrupt_leave();
+}
+#endif /* defined(BSP_UART4_RX_USING_DMA) */
+#if defined(BSP_UART4_TX_USING_DMA)
+void UART4_DMA_TX_IRQHandler(void)
+{
+    /* enter interrupt */
+    rt_interrupt_enter();
+
+    HAL_DMA_IRQHandler(&uart_obj[UART4_INDEX].dma_tx);
+
+    /* leave interrupt */
+    rt_interrupt_leave();
+}
+#endif /* defined(BSP_UART4_TX_USING_DMA) */
+#endif /* BSP_USING_UART4 */
+
+#if defined(BSP_USING_UART5)
+void UART5_IRQHandler(void)
+{
+    /* enter interrupt */
+    rt_interrupt_enter();
+
+    uart_isr(&(uart_obj[UART5_INDEX]));
+
+    /* leave interrupt */
+    rt_interrupt_leave();
+}
+#if defined(BSP_UART5_RX_USING_DMA)
+void UART5_DMA_RX_IRQHandler(void)
+{
+    /* enter interrupt */
+    rt_interrupt_enter();
+
+    HAL_DMA_IRQHandler(&uart_obj[UART5_INDEX].dma_rx);
+
+    /* leave interrupt */
+    rt_interrupt_leave();
+}
+#endif /* defined(BSP_UART5_RX_USING_DMA) */
+#if defined(BSP_UART5_TX_USING_DMA)
+void UART5_DMA_TX_IRQHandler(void)
+{
+    /* enter interrupt */
+    rt_interrupt_enter();
+
+    HAL_DMA_IRQHandler(&uart_obj[UART5_INDEX].dma_tx);
+
+    /* leave interrupt */
+    rt_interrupt_leave();
+}
+#endif /* defined(BSP_UART5_TX_USING_DMA) */
+#endif /* BSP_USING_UART5 */
+
+#if defined(BSP_USING_UART6)
+void USART6_IRQHandler(void)
+{
+    /* enter interrupt */
+    rt_interrupt_enter();
+
+    uart_isr(&(uart_obj[UART6_INDEX]));
+
+    /* leave interrupt */
+    rt_interrupt_leave();
+}
+#if defined(BSP_UART6_RX_USING_DMA)
+void UART6_DMA_RX_IRQHandler(void)
+{
+    /* enter interrupt */
+    rt_interrupt_enter();
+
+    HAL_DMA_IRQHandler(&uart_obj[UART6_INDEX].dma_rx);
+
+    /* leave interrupt */
+    rt_interrupt_leave();
+}
+#endif /* defined(BSP_UART6_RX_USING_DMA) */
+#if defined(BSP_UART6_TX_USING_DMA)
+void UART6_DMA_TX_IRQHandler(void)
+{
+    /* enter interrupt */
+    rt_interrupt_enter();
+
+    HAL_DMA_IRQHandler(&uart_obj[UART6_INDEX].dma_tx);
+
+    /* leave interrupt */
+    rt_interrupt_leave();
+}
+#endif /* defined(BSP_UART6_TX_USING_DMA) */
+#endif /* BSP_USING_UART6 */
+
+#if defined(BSP_USING_UART7)
+void UART7_IRQHandler(void)
+{
+    /* enter interrupt */
+    rt_interrupt_enter();
+
+    uart_isr(&(uart_obj[UART7_INDEX]));
+
+    /* leave interrupt */
+    rt_interrupt_leave();
+}
+#if defined(BSP_UART7_RX_USING_DMA)
+void UART7_DMA_RX_IRQHandler(void)
+{
+    /* enter interrupt */
+    rt_interrupt_enter();
+
+    HAL_DMA_IRQHandler(&uart_obj[UART7_INDEX].dma_rx);
+
+    /* leave interrupt */
+    rt_interrupt_leave();
+}
+#endif /* defined(BSP_UART7_RX_USING_DMA) */
+#if defined(BSP_UART7_TX_USING_DMA)
+void UART7_DMA_TX_IRQHandler(void)
+{
+    /* enter interrupt */
+    rt_interrupt_enter();
+
+    HAL_DMA_IRQHandler(&uart_obj[UART7_INDEX].dma_tx);
+
+    /* leave interrupt */
+    rt_interrupt_leave();
+}
+#endif /* defined(BSP_UART7_TX_USING_DMA) */
+#endif /* BSP_USING_UART7 */
+
+#if defined(BSP_USING_UART8)
+void UART8_IRQHandler(void)
+{
+    /* enter interrupt */
+    rt_interrupt_enter();
+
+    uart_isr(&(uart_obj[UART8_INDEX]));
+
+    /* leave interrupt */
+    rt_interrupt_leave();
+}
+#if defined(BSP_UART8_RX_USING_DMA)
+void UART8_DMA_RX_IRQHandler(void)
+{
+    /* enter interrupt */
+    rt_interrupt_enter();
+
+    HAL_DMA_IRQHandler(&uart_obj[UART8_INDEX].dma_rx);
+
+    /* leave interrupt */
+    rt_interrupt_leave();
+}
+#endif /* defined(BSP_UART8_RX_USING_DMA) */
+#if defined(BSP_UART8_TX_USING_DMA)
+void UART8_DMA_TX_IRQHandler(void)
+{
+    /* enter interrupt */
+    rt_interrupt_enter();
+
+    HAL_DMA_IRQHandler(&uart_obj[UART8_INDEX].dma_tx);
+
+    /* leave interrupt */
+    rt_interrupt_leave();
+}
+#endif /* defined(BSP_UART8_TX_USING_DMA) */
+#endif /* BSP_USING_UART8 */
+
+#endif /* RT_USING_DEVICE */
+
+int rt_hw_usart_init(void)
+{
+    rt_size_t obj_num = sizeof(uart_obj) / sizeof(struct stm32_uart);
+    rt_err_t result = RT_EOK;
+    rt_size_t i;
+
+#ifdef RT_USING_DEVICE
+    stm32_uart_get_dma_config();
+#endif
+
+    for (i = 0; i < obj_num; i++)
+    {
+        uart_obj[i].config = &uart_config[i];
+        stm32_configure(&uart_obj[i]);
+
+#ifdef RT_USING_DEVICE
+        /* register UART device */
+        result = stm32_uart_register(&uart_obj[i]);
+        RT_ASSERT(result == RT_EOK);
+#endif
+    }
+
+    return result;
+}
 INIT_BOARD_EXPORT(rt_hw_usart_init);
 
+/* the polled output is used before the console device is set */
 void rt_hw_console_output(const char *str)
 {
+    UART_HandleTypeDef *handle = &uart_obj[0].handle;
     rt_size_t i = 0, size = 0;
     char a = '\r';
 
@@ -332,32 +1269,27 @@ void rt_hw_console_output(const char *str)
     {
         if (*(str + i) == '\n')
         {
-            HAL_UART_Transmit(&handle, (uint8_t *)&a, 1, 1);
+            HAL_UART_Transmit(handle, (uint8_t *)&a, 1, 1);
         }
-        HAL_UART_Transmit(&handle, (uint8_t *)(str + i), 1, 1);
+        HAL_UART_Transmit(handle, (uint8_t *)(str + i), 1, 1);
     }
 }
 
 #ifdef RT_USING_FINSH
 char rt_hw_console_getchar(void)
 {
+    UART_HandleTypeDef *handle = &uart_obj[0].handle;
     int ch = -1;
 
-    if (__HAL_UART_GET_FLAG(&handle, UART_FLAG_RXNE) != RESET)
+    if (__HAL_UART_GET_FLAG(handle, UART_FLAG_RXNE) != RESET)
     {
-#if defined(SOC_SERIES_STM32L4) || defined(SOC_SERIES_STM32F7) || defined(SOC_SERIES_STM32F0) \
-    || defined(SOC_SERIES_STM32L0) || defined(SOC_SERIES_STM32G0) || defined(SOC_SERIES_STM32H7) \
-    || defined(SOC_SERIES_STM32G4)
-        ch = handle.Instance->RDR & 0xff;
-#else
-        ch = handle.Instance->DR & 0xff;
-#endif
+        ch = stm32_uart_get_dr(handle);
     }
     else
     {
-        if(__HAL_UART_GET_FLAG(&handle, UART_FLAG_ORE) != RESET)
+        if(__HAL_UART_GET_FLAG(handle, UART_FLAG_ORE) != RESET)
         {
-            __HAL_UART_CLEAR_OREFLAG(&handle);
+            __HAL_UART_CLEAR_OREFLAG(handle);
         }
         rt_thread_mdelay(10);
     }
@@ -365,4 +1297,3 @@ char rt_hw_console_getchar(void)
 }
 #endif /* RT_USING_FINSH */
 #endif /* RT_USING_CONSLONE */
-
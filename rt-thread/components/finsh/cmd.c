@@ -165,12 +165,25 @@ long list_thread(void)
     maxlen = RT_NAME_MAX;
 
 #ifdef RT_USING_SMP
-    rt_kprintf("%-*.s cpu pri  status      sp     stack size max used left tick  error\n", maxlen, item_title); object_split(maxlen);
-    rt_kprintf(     " --- ---  ------- ---------- ----------  ------  ---------- ---\n");
+    rt_kprintf("%-*.s cpu pri  status      sp     stack size max used left tick  error", maxlen, item_title);
 #else
-    rt_kprintf("%-*.s pri  status      sp     stack size max used left tick  error\n", maxlen, item_title); object_split(maxlen);
-    rt_kprintf(     " ---  ------- ---------- ----------  ------  ---------- ---\n");
+    rt_kprintf("%-*.s pri  status      sp     stack size max used left tick  error", maxlen, item_title);
 #endif /*RT_USING_SMP*/
+#ifdef RT_USING_THREAD_RUNTIME
+    rt_kprintf("   cpu%%\n"); object_split(maxlen);
+#else
+    rt_kprintf("\n"); object_split(maxlen);
+#endif
+#ifdef RT_USING_SMP
+    rt_kprintf(     " --- ---  ------- ---------- ----------  ------  ---------- ---");
+#else
+    rt_kprintf(     " ---  ------- ---------- ----------  ------  ---------- ---");
+#endif /*RT_USING_SMP*/
+#ifdef RT_USING_THREAD_RUNTIME
+    rt_kprintf(" ------\n");
+#else
+    rt_kprintf("\n");
+#endif
 
     do
     {
@@ -198,6 +211,9 @@ long list_thread(void)
                 {
                     rt_uint8_t stat;
                     rt_uint8_t *ptr;
+#ifdef RT_USING_THREAD_RUNTIME
+                    rt_uint32_t usage;
+#endif
 
 #ifdef RT_USING_SMP
                     if (thread->oncpu != RT_CPU_DETACHED)
@@ -219,7 +235,7 @@ long list_thread(void)
                     ptr = (rt_uint8_t *)thread->stack_addr + thread->stack_size - 1;
                     while (*ptr == '#')ptr --;
 
-                    rt_kprintf(" 0x%08x 0x%08x    %02d%%   0x%08x %03d\n",
+                    rt_kprintf(" 0x%08x 0x%08x    %02d%%   0x%08x %03d",
                             ((rt_ubase_t)thread->sp - (rt_ubase_t)thread->stack_addr),
                             thread->stack_size,
                             ((rt_ubase_t)ptr - (rt_ubase_t)thread->stack_addr) * 100 / thread->stack_size,
@@ -229,13 +245,19 @@ long list_thread(void)
                     ptr = (rt_uint8_t *)thread->stack_addr;
                     while (*ptr == '#')ptr ++;
 
-                    rt_kprintf(" 0x%08x 0x%08x    %02d%%   0x%08x %03d\n",
+                    rt_kprintf(" 0x%08x 0x%08x    %02d%%   0x%08x %03d",
                             thread->stack_size + ((rt_ubase_t)thread->stack_addr - (rt_ubase_t)thread->sp),
                             thread->stack_size,
                             (thread->stack_size - ((rt_ubase_t) ptr - (rt_ubase_t) thread->stack_addr)) * 100
                             / thread->stack_size,
                             thread->remaining_tick,
                             thread->error);
+#endif
+#ifdef RT_USING_THREAD_RUNTIME
+                    usage = rt_thread_cpu_usage_get(thread);
+                    rt_kprintf(" %3d.%02d\n", usage / 100, usage % 100);
+#else
+                    rt_kprintf("\n");
 #endif
                 }
             }
@@ -591,6 +613,131 @@ FINSH_FUNCTION_EXPORT(list_msgqueue, list message queue in system);
 MSH_CMD_EXPORT(list_msgqueue, list message queue in system);
 #endif
 
+#ifdef RT_USING_RINGQUEUE
+long list_ringqueue(void)
+{
+    rt_ubase_t level;
+    list_get_next_t find_arg;
+    rt_list_t *obj_list[LIST_FIND_OBJ_NR];
+    rt_list_t *next = (rt_list_t*)RT_NULL;
+
+    int maxlen;
+    const char *item_title = "ringqueue";
+
+    list_find_init(&find_arg, RT_Object_Class_RingQueue, obj_list, sizeof(obj_list)/sizeof(obj_list[0]));
+
+    maxlen = RT_NAME_MAX;
+
+    rt_kprintf("%-*.s elem size size     entry    reader\n", maxlen, item_title); object_split(maxlen);
+    rt_kprintf(     " --------- -------- -------- --------\n");
+    do
+    {
+        next = list_get_next(next, &find_arg);
+        {
+            int i;
+            for (i = 0; i < find_arg.nr_out; i++)
+            {
+                struct rt_object *obj;
+                struct rt_ringqueue *rq;
+                struct rt_thread *reader;
+
+                obj = rt_list_entry(obj_list[i], struct rt_object, list);
+                level = rt_hw_interrupt_disable();
+                if ((obj->type & ~RT_Object_Class_Static) != find_arg.type)
+                {
+                    rt_hw_interrupt_enable(level);
+                    continue;
+                }
+
+                rq = (struct rt_ringqueue *)obj;
+                reader = rq->reader;
+                rt_hw_interrupt_enable(level);
+
+                rt_kprintf("%-*.*s %-9d %-8d %-8d %-.*s\n",
+                        maxlen, RT_NAME_MAX,
+                        rq->parent.name,
+                        rq->elem_size,
+                        rq->size,
+                        rq->head - rq->tail,
+                        RT_NAME_MAX,
+                        reader != RT_NULL ? reader->name : "-");
+            }
+        }
+    }
+    while (next != (rt_list_t*)RT_NULL);
+
+    return 0;
+}
+FINSH_FUNCTION_EXPORT(list_ringqueue, list ring queue in system);
+MSH_CMD_EXPORT(list_ringqueue, list ring queue in system);
+#endif
+
+#ifdef RT_USING_ARENA
+long list_arena(void)
+{
+    rt_ubase_t level;
+    list_get_next_t find_arg;
+    rt_list_t *obj_list[LIST_FIND_OBJ_NR];
+    rt_list_t *next = (rt_list_t*)RT_NULL;
+
+    int maxlen;
+    const char *item_title = "arena";
+
+    list_find_init(&find_arg, RT_Object_Class_Arena, obj_list, sizeof(obj_list)/sizeof(obj_list[0]));
+
+    maxlen = RT_NAME_MAX;
+
+    rt_kprintf("%-*.s chunk size chunk spare used     max used source\n", maxlen, item_title); object_split(maxlen);
+    rt_kprintf(     " ---------- ----- ----- -------- -------- --------\n");
+    do
+    {
+        next = list_get_next(next, &find_arg);
+        {
+            int i;
+            for (i = 0; i < find_arg.nr_out; i++)
+            {
+                struct rt_object *obj;
+                struct rt_arena arena;
+                const char *source;
+
+                obj = rt_list_entry(obj_list[i], struct rt_object, list);
+                level = rt_hw_interrupt_disable();
+                if ((obj->type & ~RT_Object_Class_Static) != find_arg.type)
+                {
+                    rt_hw_interrupt_enable(level);
+                    continue;
+                }
+
+                arena = *(struct rt_arena *)obj;
+                rt_hw_interrupt_enable(level);
+
+                source = "heap";
+#ifdef RT_USING_MEMPOOL
+                if (arena.mp != RT_NULL)
+                    source = arena.mp->parent.name;
+#endif
+
+                rt_kprintf("%-*.*s %-10d %-5d %-5d %-8d %-8d %-.*s\n",
+                        maxlen, RT_NAME_MAX,
+                        arena.parent.name,
+                        arena.chunk_size,
+                        arena.chunk_count,
+                        arena.spare_count,
+                        arena.used,
+                        arena.max_used,
+                        RT_NAME_MAX,
+                        source);
+            }
+        }
+    }
+    while (next != (rt_list_t*)RT_NULL);
+
+    return 0;
+}
+FINSH_FUNCTION_EXPORT(list_arena, list arena in system);
+MSH_CMD_EXPORT(list_arena, list arena in system);
+#endif
+
 #ifdef RT_USING_MEMHEAP
 long list_memheap(void)
 {
@@ -606,8 +753,13 @@ long list_memheap(void)
 
     maxlen = RT_NAME_MAX;
 
+#ifdef RT_USING_MEMHEAP_CACHE
+    rt_kprintf("%-*.s  pool size  max used size available size cache hit  cache miss cache free\n", maxlen, item_title); object_split(maxlen);
+    rt_kprintf(      " ---------- ------------- -------------- ---------- ---------- ----------\n");
+#else
     rt_kprintf("%-*.s  pool size  max used size available size\n", maxlen, item_title); object_split(maxlen);
     rt_kprintf(      " ---------- ------------- --------------\n");
+#endif
     do
     {
         next = list_get_next(next, &find_arg);
@@ -630,12 +782,36 @@ long list_memheap(void)
 
                 mh = (struct rt_memheap *)obj;
 
+#ifdef RT_USING_MEMHEAP_CACHE
+                {
+                    int index;
+                    rt_uint32_t hit = 0, miss = 0, free_size = 0;
+
+                    for (index = 0; index < RT_MEMHEAP_CACHE_CLASS_NR; index ++)
+                    {
+                        hit  += mh->cache[index].hit;
+                        miss += mh->cache[index].miss;
+                        free_size += mh->cache[index].free * mh->cache[index].size;
+                    }
+
+                    rt_kprintf("%-*.*s %-010d %-013d %-014d %-010d %-010d %-05d\n",
+                            maxlen, RT_NAME_MAX,
+                            mh->parent.name,
+                            mh->pool_size,
+                            mh->max_used_size,
+                            mh->available_size,
+                            hit,
+                            miss,
+                            free_size);
+                }
+#else
                 rt_kprintf("%-*.*s %-010d %-013d %-05d\n",
                         maxlen, RT_NAME_MAX,
                         mh->parent.name,
                         mh->pool_size,
                         mh->max_used_size,
                         mh->available_size);
+#endif
 
             }
         }
@@ -663,8 +839,8 @@ long list_mempool(void)
 
     maxlen = RT_NAME_MAX;
 
-    rt_kprintf("%-*.s block total free suspend thread\n", maxlen, item_title); object_split(maxlen);
-    rt_kprintf(     " ----  ----  ---- --------------\n");
+    rt_kprintf("%-*.s block total free max used suspend thread\n", maxlen, item_title); object_split(maxlen);
+    rt_kprintf(     " ----  ----  ---- -------- --------------\n");
     do
     {
         next = list_get_next(next, &find_arg);
@@ -697,24 +873,26 @@ long list_mempool(void)
 
                 if (suspend_thread_count > 0)
                 {
-                    rt_kprintf("%-*.*s %04d  %04d  %04d %d:",
+                    rt_kprintf("%-*.*s %04d  %04d  %04d %04d     %d:",
                             maxlen, RT_NAME_MAX,
                             mp->parent.name,
                             mp->block_size,
                             mp->block_total_count,
                             mp->block_free_count,
+                            mp->block_max_used,
                             suspend_thread_count);
                     show_wait_queue(&(mp->suspend_thread));
                     rt_kprintf("\n");
                 }
                 else
                 {
-                    rt_kprintf("%-*.*s %04d  %04d  %04d %d\n",
+                    rt_kprintf("%-*.*s %04d  %04d  %04d %04d     %d\n",
                             maxlen, RT_NAME_MAX,
                             mp->parent.name,
                             mp->block_size,
                             mp->block_total_count,
                             mp->block_free_count,
+                            mp->block_max_used,
                             suspend_thread_count);
                 }
             }
@@ -781,6 +959,15 @@ long list_timer(void)
 
     rt_kprintf("current tick:0x%08x\n", rt_tick_get());
 
+#ifdef RT_TIMER_USING_IRQOFF_STAT
+    {
+        rt_uint32_t last, max;
+
+        rt_timer_irqoff_get(&last, &max);
+        rt_kprintf("timer check irq off cycles: last %d, max %d\n", last, max);
+    }
+#endif
+
     return 0;
 }
 FINSH_FUNCTION_EXPORT(list_timer, list timer in system);
@@ -0,0 +1,219 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2021-09-30     RT-Thread    the first version
+ *
+ * Anotation：邮箱和消息队列的吞吐量测试。当前线程作为生产者发送固定数量的条目，一个
+ * 优先级更高的消费者线程接收，批量为 1 时使用单条的发送和接收接口，否则使用批量接口，
+ * 统计每个条目平均花费的周期数。消费者优先级更高，单条接口每发送一条都会唤醒它一次，
+ * 批量接口每批只唤醒一次。
+ */
+
+#include <rthw.h>
+#include <rtthread.h>
+
+#include "kbench.h"
+
+#if defined(RT_USING_KBENCH) && defined(RT_KBENCH_USING_IPC)
+
+#define IPC_BENCH_ITEM_NR       4096            /* the items sent in each run */
+#define IPC_BENCH_QUEUE_NR      64              /* the capacity of mailbox and message queue */
+#define IPC_BENCH_MSG_SIZE      16              /* the size of message */
+#define IPC_BENCH_BATCH_MAX     64
+#define IPC_BENCH_STACK_SIZE    1024
+
+struct ipc_bench
+{
+    rt_object_t object;
+    rt_size_t batch;
+    rt_sem_t done;
+};
+
+/* the buffer of producer and consumer, the producer is the caller of kbench */
+static rt_uint8_t _send_buffer[IPC_BENCH_BATCH_MAX * IPC_BENCH_MSG_SIZE];
+static rt_uint8_t _recv_buffer[IPC_BENCH_BATCH_MAX * IPC_BENCH_MSG_SIZE];
+
+static const rt_size_t _batches[] = {1, 4, 16, 64};
+
+#ifdef RT_USING_MAILBOX
+static void _ipc_bench_mb_consumer(void *parameter)
+{
+    struct ipc_bench *bench = (struct ipc_bench *)parameter;
+    rt_mailbox_t mb = (rt_mailbox_t)bench->object;
+    rt_ubase_t *values = (rt_ubase_t *)_recv_buffer;
+    rt_size_t received = 0;
+
+    while (received < IPC_BENCH_ITEM_NR)
+    {
+        if (bench->batch == 1)
+        {
+            if (rt_mb_recv(mb, &values[0], RT_WAITING_FOREVER) == RT_EOK)
+                received ++;
+        }
+        else
+        {
+            received += rt_mb_recv_batch(mb, values, bench->batch, RT_WAITING_FOREVER);
+        }
+    }
+
+    rt_sem_release(bench->done);
+}
+
+static void _ipc_bench_mb_producer(struct ipc_bench *bench)
+{
+    rt_mailbox_t mb = (rt_mailbox_t)bench->object;
+    const rt_ubase_t *values = (const rt_ubase_t *)_send_buffer;
+    rt_size_t sent = 0;
+
+    while (sent < IPC_BENCH_ITEM_NR)
+    {
+        if (bench->batch == 1)
+        {
+            if (rt_mb_send_wait(mb, values[0], RT_WAITING_FOREVER) == RT_EOK)
+                sent ++;
+        }
+        else
+        {
+            sent += rt_mb_send_batch(mb, values, bench->batch, RT_WAITING_FOREVER);
+        }
+    }
+}
+#endif
+
+#ifdef RT_USING_MESSAGEQUEUE
+static void _ipc_bench_mq_consumer(void *parameter)
+{
+    struct ipc_bench *bench = (struct ipc_bench *)parameter;
+    rt_mq_t mq = (rt_mq_t)bench->object;
+    rt_size_t received = 0;
+
+    while (received < IPC_BENCH_ITEM_NR)
+    {
+        if (bench->batch == 1)
+        {
+            if (rt_mq_recv(mq, _recv_buffer, IPC_BENCH_MSG_SIZE, RT_WAITING_FOREVER) == RT_EOK)
+                received ++;
+        }
+        else
+        {
+            received += rt_mq_recv_batch(mq, _recv_buffer, IPC_BENCH_MSG_SIZE,
+                                         bench->batch, RT_WAITING_FOREVER);
+        }
+    }
+
+    rt_sem_release(bench->done);
+}
+
+static void _ipc_bench_mq_producer(struct ipc_bench *bench)
+{
+    rt_mq_t mq = (rt_mq_t)bench->object;
+    rt_size_t sent = 0;
+
+    while (sent < IPC_BENCH_ITEM_NR)
+    {
+        if (bench->batch == 1)
+        {
+            if (rt_mq_send_wait(mq, _send_buffer, IPC_BENCH_MSG_SIZE, RT_WAITING_FOREVER) == RT_EOK)
+                sent ++;
+        }
+        else
+        {
+            sent += rt_mq_send_batch(mq, _send_buffer, IPC_BENCH_MSG_SIZE,
+                                     bench->batch, RT_WAITING_FOREVER);
+        }
+    }
+}
+#endif
+
+/*
+ * run the producer in current thread and the consumer in a thread of higher
+ * priority, return the cycles per item, 0 on failure.
+ */
+static rt_uint32_t _ipc_bench_run(struct ipc_bench *bench,
+                                  void (*consumer)(void *parameter),
+                                  void (*producer)(struct ipc_bench *bench))
+{
+    rt_thread_t thread;
+    rt_uint8_t priority;
+    rt_uint32_t cycles;
+
+    priority = rt_thread_self()->current_priority;
+    if (priority > 0)
+        priority --;
+
+    thread = rt_thread_create("kb_recv", consumer, bench, IPC_BENCH_STACK_SIZE, priority, 10);
+    if (thread == RT_NULL)
+        return 0;
+
+    /* the consumer is waiting for the first item */
+    rt_thread_startup(thread);
+
+    cycles = rt_hw_cycle_get();
+    producer(bench);
+    rt_sem_take(bench->done, RT_WAITING_FOREVER);
+    cycles = rt_hw_cycle_get() - cycles;
+
+    return cycles / IPC_BENCH_ITEM_NR;
+}
+
+/**
+ * This function will run the throughput benchmark of mailbox and message
+ * queue, the single item interfaces are compared with the batch interfaces.
+ *
+ * @param argc the number of arguments
+ * @param argv the arguments
+ *
+ * @return the error code, RT_EOK on successful
+ */
+int rt_kbench_ipc(int argc, char **argv)
+{
+    struct ipc_bench bench;
+    rt_uint32_t cycles;
+    rt_size_t index;
+
+    bench.done = rt_sem_create("kbench", 0, RT_IPC_FLAG_FIFO);
+    if (bench.done == RT_NULL)
+        return -RT_ENOMEM;
+
+    rt_kprintf("%d items, capacity %d, cycles per item\n", IPC_BENCH_ITEM_NR, IPC_BENCH_QUEUE_NR);
+    rt_kprintf("object  batch  cycles\n");
+    rt_kprintf("------- ------ ----------\n");
+
+#ifdef RT_USING_MAILBOX
+    bench.object = (rt_object_t)rt_mb_create("kbench", IPC_BENCH_QUEUE_NR, RT_IPC_FLAG_FIFO);
+    if (bench.object != RT_NULL)
+    {
+        for (index = 0; index < sizeof(_batches) / sizeof(_batches[0]); index ++)
+        {
+            bench.batch = _batches[index];
+            cycles = _ipc_bench_run(&bench, _ipc_bench_mb_consumer, _ipc_bench_mb_producer);
+            rt_kprintf("mailbox %-6d %d\n", bench.batch, cycles);
+        }
+        rt_mb_delete((rt_mailbox_t)bench.object);
+    }
+#endif
+
+#ifdef RT_USING_MESSAGEQUEUE
+    bench.object = (rt_object_t)rt_mq_create("kbench", IPC_BENCH_MSG_SIZE, IPC_BENCH_QUEUE_NR, RT_IPC_FLAG_FIFO);
+    if (bench.object != RT_NULL)
+    {
+        for (index = 0; index < sizeof(_batches) / sizeof(_batches[0]); index ++)
+        {
+            bench.batch = _batches[index];
+            cycles = _ipc_bench_run(&bench, _ipc_bench_mq_consumer, _ipc_bench_mq_producer);
+            rt_kprintf("mq      %-6d %d\n", bench.batch, cycles);
+        }
+        rt_mq_delete((rt_mq_t)bench.object);
+    }
+#endif
+
+    rt_sem_delete(bench.done);
+
+    return RT_EOK;
+}
+
+#endif /* RT_USING_KBENCH && RT_KBENCH_USING_IPC */
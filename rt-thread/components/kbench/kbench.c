@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2021-09-30     RT-Thread    the first version
+ *
+ * Anotation：内核服务的基准测试，用 CPU 周期计数器测量，由 kbench 命令运行。各项测试
+ * 在单独的文件中实现，这里是命令入口和公共的统计函数。
+ */
+
+#include <rthw.h>
+#include <rtthread.h>
+
+#include "kbench.h"
+
+#ifdef RT_USING_KBENCH
+
+static rt_uint32_t _seed = 1;
+
+/**
+ * This function will initialize the statistics of samples.
+ *
+ * @param stat the statistics
+ */
+void rt_kbench_stat_init(struct rt_kbench_stat *stat)
+{
+    stat->count = 0;
+    stat->min   = RT_UINT32_MAX;
+    stat->max   = 0;
+    stat->total = 0;
+}
+
+/**
+ * This function will add a sample to the statistics.
+ *
+ * @param stat the statistics
+ * @param cycles the sample in cpu cycles
+ */
+void rt_kbench_stat_add(struct rt_kbench_stat *stat, rt_uint32_t cycles)
+{
+    stat->count ++;
+    stat->total += cycles;
+    if (cycles < stat->min)
+        stat->min = cycles;
+    if (cycles > stat->max)
+        stat->max = cycles;
+}
+
+/**
+ * This function will get the mean of samples.
+ *
+ * @param stat the statistics
+ *
+ * @return the mean in cpu cycles, 0 if there is no sample
+ */
+rt_uint32_t rt_kbench_stat_mean(struct rt_kbench_stat *stat)
+{
+    if (stat->count == 0)
+        return 0;
+
+    return (rt_uint32_t)(stat->total / stat->count);
+}
+
+/**
+ * This function will get a pseudo random number, the sequence is the same
+ * in every run so that the results are comparable.
+ *
+ * @return the pseudo random number
+ */
+rt_uint32_t rt_kbench_rand(void)
+{
+    _seed = _seed * 1103515245 + 12345;
+
+    return _seed >> 8;
+}
+
+#ifdef RT_USING_FINSH
+#include <finsh.h>
+
+static void kbench_usage(void)
+{
+    rt_kprintf("Usage: kbench <benchmark>\n");
+#ifdef RT_KBENCH_USING_TIMER
+    rt_kprintf("  timer  the interrupt disabled time of timers by the number of timers\n");
+#endif
+#ifdef RT_KBENCH_USING_MUTEX
+    rt_kprintf("  mutex  the priority inversion of mutex under stress, [inversion|chain|restore]\n");
+#endif
+#ifdef RT_KBENCH_USING_IPC
+    rt_kprintf("  ipc    the throughput of mailbox and message queue by batch size\n");
+#endif
+}
+
+static int kbench(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        kbench_usage();
+
+        return 0;
+    }
+
+    _seed = 1;
+
+#ifdef RT_KBENCH_USING_TIMER
+    if (rt_strcmp(argv[1], "timer") == 0)
+        return rt_kbench_timer(argc - 1, argv + 1);
+#endif
+#ifdef RT_KBENCH_USING_MUTEX
+    if (rt_strcmp(argv[1], "mutex") == 0)
+        return rt_kbench_mutex(argc - 1, argv + 1);
+#endif
+#ifdef RT_KBENCH_USING_IPC
+    if (rt_strcmp(argv[1], "ipc") == 0)
+        return rt_kbench_ipc(argc - 1, argv + 1);
+#endif
+
+    kbench_usage();
+
+    return -RT_EINVAL;
+}
+MSH_CMD_EXPORT(kbench, kernel benchmark);
+#endif /* RT_USING_FINSH */
+
+#endif /* RT_USING_KBENCH */
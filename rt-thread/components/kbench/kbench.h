@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2021-09-30     RT-Thread    the first version
+ */
+#ifndef KBENCH_H__
+#define KBENCH_H__
+
+#include <rtthread.h>
+
+/*
+ * the statistics of samples in cpu cycles
+ */
+struct rt_kbench_stat
+{
+    rt_uint32_t count;
+    rt_uint32_t min;
+    rt_uint32_t max;
+    rt_uint64_t total;
+};
+
+void rt_kbench_stat_init(struct rt_kbench_stat *stat);
+void rt_kbench_stat_add(struct rt_kbench_stat *stat, rt_uint32_t cycles);
+rt_uint32_t rt_kbench_stat_mean(struct rt_kbench_stat *stat);
+
+rt_uint32_t rt_kbench_rand(void);
+
+#ifdef RT_KBENCH_USING_TIMER
+int rt_kbench_timer(int argc, char **argv);
+#endif
+#ifdef RT_KBENCH_USING_MUTEX
+int rt_kbench_mutex(int argc, char **argv);
+#endif
+#ifdef RT_KBENCH_USING_IPC
+int rt_kbench_ipc(int argc, char **argv);
+#endif
+
+#endif
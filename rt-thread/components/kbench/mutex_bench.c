@@ -0,0 +1,363 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2021-09-30     RT-Thread    the first version
+ *
+ * Anotation：优先级反转的压力测试，分三个场景，每个场景都有一个中优先级线程随机占用 CPU：
+ * inversion：低优先级线程持有互斥量执行随机长度的临界区，高优先级线程测量从请求到获得
+ * 互斥量的周期数，另有一个线程用很短的超时反复请求互斥量，覆盖等待超时后优先级继承的路径；
+ * chain：最低优先级线程持有 A，低优先级线程持有 B 并等待 A，高优先级线程等待 B，覆盖
+ * 沿"等待的互斥量 -> 持有者"链的传递继承；
+ * restore：低优先级线程同时持有 A 和 B，高优先级线程等待 A，次高优先级线程等待 B，低优
+ * 先级线程先释放 A，此时它的优先级应恢复到 B 的等待者的优先级，而不是原始优先级。
+ * 有正确的优先级继承时，各个等待者最坏的等待应该接近临界区的最大长度，而不会随中优先级
+ * 线程的负载增长。
+ */
+
+#include <rthw.h>
+#include <rtthread.h>
+
+#include "kbench.h"
+
+#if defined(RT_USING_KBENCH) && defined(RT_KBENCH_USING_MUTEX)
+
+#define MUTEX_BENCH_ROUND       1000            /* the takes of the highest thread */
+#define MUTEX_BENCH_CRITICAL    20000           /* the maximum cycles of critical section */
+#define MUTEX_BENCH_STACK_SIZE  1024
+#define MUTEX_BENCH_THREAD_NR   4
+#define MUTEX_BENCH_MUTEX_NR    2
+
+struct mutex_bench
+{
+    rt_mutex_t mutex[MUTEX_BENCH_MUTEX_NR];
+    rt_sem_t done;
+    volatile rt_bool_t running;
+    rt_uint8_t high_mutex;                      /* the mutex taken by the highest thread */
+
+    struct rt_kbench_stat wait[MUTEX_BENCH_MUTEX_NR]; /* the wait of the measuring threads */
+    struct rt_kbench_stat critical;             /* the critical sections of the owner thread */
+    rt_uint32_t timeout;                        /* the timeout takes of the timed thread */
+};
+
+struct mutex_bench_thread
+{
+    const char *name;
+    void (*entry)(void *parameter);
+    rt_uint8_t priority;                        /* below RT_KBENCH_MUTEX_PRIORITY */
+};
+
+struct mutex_bench_scenario
+{
+    const char *name;
+    rt_uint8_t high_mutex;
+    const char *wait_name[MUTEX_BENCH_MUTEX_NR]; /* the measuring thread of each wait */
+    struct mutex_bench_thread threads[MUTEX_BENCH_THREAD_NR];
+};
+
+static void _mutex_bench_busy(rt_uint32_t cycles)
+{
+    rt_uint32_t start;
+
+    start = rt_hw_cycle_get();
+    while (rt_hw_cycle_get() - start < cycles);
+}
+
+/*
+ * take and release the mutex, and add the cycles of taking to the statistics
+ */
+static void _mutex_bench_measure(rt_mutex_t mutex, struct rt_kbench_stat *stat)
+{
+    rt_uint32_t cycles;
+
+    cycles = rt_hw_cycle_get();
+    rt_mutex_take(mutex, RT_WAITING_FOREVER);
+    cycles = rt_hw_cycle_get() - cycles;
+    rt_mutex_release(mutex);
+
+    rt_kbench_stat_add(stat, cycles);
+}
+
+static void _mutex_bench_high(void *parameter)
+{
+    struct mutex_bench *bench = (struct mutex_bench *)parameter;
+    int round;
+
+    for (round = 0; round < MUTEX_BENCH_ROUND; round ++)
+    {
+        rt_thread_delay(1 + rt_kbench_rand() % 2);
+        _mutex_bench_measure(bench->mutex[bench->high_mutex], &bench->wait[0]);
+    }
+
+    bench->running = RT_FALSE;
+    rt_sem_release(bench->done);
+}
+
+static void _mutex_bench_timed(void *parameter)
+{
+    struct mutex_bench *bench = (struct mutex_bench *)parameter;
+
+    while (bench->running)
+    {
+        /* the timeout waiter is left in the mutex until it runs again */
+        if (rt_mutex_take(bench->mutex[0], 1) == RT_EOK)
+            rt_mutex_release(bench->mutex[0]);
+        else
+            bench->timeout ++;
+
+        rt_thread_delay(1 + rt_kbench_rand() % 2);
+    }
+
+    rt_sem_release(bench->done);
+}
+
+static void _mutex_bench_medium(void *parameter)
+{
+    struct mutex_bench *bench = (struct mutex_bench *)parameter;
+
+    while (bench->running)
+    {
+        _mutex_bench_busy(rt_kbench_rand() % (MUTEX_BENCH_CRITICAL * 8));
+        rt_thread_delay(1 + rt_kbench_rand() % 2);
+    }
+
+    rt_sem_release(bench->done);
+}
+
+static void _mutex_bench_low(void *parameter)
+{
+    struct mutex_bench *bench = (struct mutex_bench *)parameter;
+    rt_uint32_t cycles;
+
+    while (bench->running)
+    {
+        rt_mutex_take(bench->mutex[0], RT_WAITING_FOREVER);
+        cycles = rt_hw_cycle_get();
+        _mutex_bench_busy(rt_kbench_rand() % MUTEX_BENCH_CRITICAL);
+        cycles = rt_hw_cycle_get() - cycles;
+        rt_mutex_release(bench->mutex[0]);
+
+        rt_kbench_stat_add(&bench->critical, cycles);
+        rt_thread_yield();
+    }
+
+    rt_sem_release(bench->done);
+}
+
+/*
+ * the middle of chain, it holds mutex[1] and waits for mutex[0] held by the
+ * lowest thread, so the wait of the highest thread for mutex[1] depends on
+ * the lowest thread.
+ */
+static void _mutex_bench_chain(void *parameter)
+{
+    struct mutex_bench *bench = (struct mutex_bench *)parameter;
+
+    while (bench->running)
+    {
+        rt_mutex_take(bench->mutex[1], RT_WAITING_FOREVER);
+        rt_mutex_take(bench->mutex[0], RT_WAITING_FOREVER);
+        _mutex_bench_busy(rt_kbench_rand() % (MUTEX_BENCH_CRITICAL / 8));
+        rt_mutex_release(bench->mutex[0]);
+        rt_mutex_release(bench->mutex[1]);
+
+        rt_thread_delay(1);
+    }
+
+    rt_sem_release(bench->done);
+}
+
+/*
+ * the owner of two mutexes, mutex[0] is released first and the priority
+ * inherited from the waiter of mutex[1] shall be kept.
+ */
+static void _mutex_bench_owner(void *parameter)
+{
+    struct mutex_bench *bench = (struct mutex_bench *)parameter;
+    rt_uint32_t cycles;
+
+    while (bench->running)
+    {
+        rt_mutex_take(bench->mutex[0], RT_WAITING_FOREVER);
+        rt_mutex_take(bench->mutex[1], RT_WAITING_FOREVER);
+        cycles = rt_hw_cycle_get();
+        _mutex_bench_busy(rt_kbench_rand() % (MUTEX_BENCH_CRITICAL / 2));
+        rt_mutex_release(bench->mutex[0]);
+        _mutex_bench_busy(rt_kbench_rand() % (MUTEX_BENCH_CRITICAL / 2));
+        cycles = rt_hw_cycle_get() - cycles;
+        rt_mutex_release(bench->mutex[1]);
+
+        rt_kbench_stat_add(&bench->critical, cycles);
+        rt_thread_yield();
+    }
+
+    rt_sem_release(bench->done);
+}
+
+/*
+ * the waiter of mutex[1] in the restore scenario
+ */
+static void _mutex_bench_second(void *parameter)
+{
+    struct mutex_bench *bench = (struct mutex_bench *)parameter;
+
+    while (bench->running)
+    {
+        rt_thread_delay(1 + rt_kbench_rand() % 2);
+        _mutex_bench_measure(bench->mutex[1], &bench->wait[1]);
+    }
+
+    rt_sem_release(bench->done);
+}
+
+static const struct mutex_bench_scenario _scenarios[] =
+{
+    {
+        "inversion", 0, {"highest", RT_NULL},
+        {
+            {"kb_high", _mutex_bench_high,   0},
+            {"kb_time", _mutex_bench_timed,  1},
+            {"kb_med",  _mutex_bench_medium, 2},
+            {"kb_low",  _mutex_bench_low,    3},
+        }
+    },
+    {
+        "chain", 1, {"highest", RT_NULL},
+        {
+            {"kb_high", _mutex_bench_high,   0},
+            {"kb_med",  _mutex_bench_medium, 1},
+            {"kb_chain", _mutex_bench_chain, 2},
+            {"kb_low",  _mutex_bench_low,    3},
+        }
+    },
+    {
+        "restore", 0, {"highest", "second"},
+        {
+            {"kb_high", _mutex_bench_high,   0},
+            {"kb_2nd",  _mutex_bench_second, 1},
+            {"kb_med",  _mutex_bench_medium, 2},
+            {"kb_own",  _mutex_bench_owner,  3},
+        }
+    },
+};
+
+/*
+ * run a scenario, the threads are started from the lowest one so that the
+ * owners hold the mutexes first.
+ */
+static rt_err_t _mutex_bench_run(const struct mutex_bench_scenario *scenario)
+{
+    const struct mutex_bench_thread *info;
+    struct mutex_bench bench;
+    rt_thread_t thread;
+    int index, started = 0;
+
+    rt_memset(&bench, 0, sizeof(bench));
+    for (index = 0; index < MUTEX_BENCH_MUTEX_NR; index ++)
+    {
+        rt_kbench_stat_init(&bench.wait[index]);
+    }
+    rt_kbench_stat_init(&bench.critical);
+    bench.running    = RT_TRUE;
+    bench.high_mutex = scenario->high_mutex;
+
+    bench.mutex[0] = rt_mutex_create("kbench0", RT_IPC_FLAG_PRIO);
+    bench.mutex[1] = rt_mutex_create("kbench1", RT_IPC_FLAG_PRIO);
+    bench.done     = rt_sem_create("kbench", 0, RT_IPC_FLAG_FIFO);
+    if (bench.mutex[0] == RT_NULL || bench.mutex[1] == RT_NULL || bench.done == RT_NULL)
+    {
+        rt_kprintf("no memory for mutex benchmark\n");
+        goto __exit;
+    }
+
+    for (index = MUTEX_BENCH_THREAD_NR - 1; index >= 0; index --)
+    {
+        info = &scenario->threads[index];
+        thread = rt_thread_create(info->name, info->entry, &bench, MUTEX_BENCH_STACK_SIZE,
+                                  RT_KBENCH_MUTEX_PRIORITY + info->priority, 10);
+        if (thread == RT_NULL)
+        {
+            rt_kprintf("no memory for thread %s\n", info->name);
+            bench.running = RT_FALSE;
+            break;
+        }
+
+        rt_thread_startup(thread);
+        started ++;
+    }
+
+    for (index = 0; index < started; index ++)
+    {
+        rt_sem_take(bench.done, RT_WAITING_FOREVER);
+    }
+
+    if (started == MUTEX_BENCH_THREAD_NR)
+    {
+        for (index = 0; index < MUTEX_BENCH_MUTEX_NR; index ++)
+        {
+            if (scenario->wait_name[index] == RT_NULL)
+                continue;
+
+            rt_kprintf("%-9s wait of %-8s %-8d %-10d %d\n", scenario->name,
+                       scenario->wait_name[index], bench.wait[index].count,
+                       rt_kbench_stat_mean(&bench.wait[index]), bench.wait[index].max);
+        }
+        rt_kprintf("%-9s critical section %-8d %-10d %d\n", scenario->name, bench.critical.count,
+                   rt_kbench_stat_mean(&bench.critical), bench.critical.max);
+        if (bench.timeout != 0)
+            rt_kprintf("%-9s timeout takes    %d\n", scenario->name, bench.timeout);
+    }
+
+__exit:
+    for (index = 0; index < MUTEX_BENCH_MUTEX_NR; index ++)
+    {
+        if (bench.mutex[index] != RT_NULL)
+            rt_mutex_delete(bench.mutex[index]);
+    }
+    if (bench.done != RT_NULL)
+        rt_sem_delete(bench.done);
+
+    return started == MUTEX_BENCH_THREAD_NR ? RT_EOK : -RT_ENOMEM;
+}
+
+/**
+ * This function will run the priority inversion stress test, it measures
+ * the worst wait of the threads for the mutexes held by the lower threads
+ * while the middle thread keeps the cpu busy. The scenarios are the single
+ * inversion, the chain of inheritance and the restore of priority after one
+ * of two mutexes is released.
+ *
+ * @param argc the number of arguments
+ * @param argv the arguments, argv[1] is the name of scenario, all if omitted
+ *
+ * @return the error code, RT_EOK on successful
+ */
+int rt_kbench_mutex(int argc, char **argv)
+{
+    rt_err_t result = -RT_EINVAL;
+    rt_size_t index;
+
+    rt_kprintf("priority inversion, cycles\n");
+    rt_kprintf("scenario  sample           count    mean       max\n");
+    rt_kprintf("--------- ---------------- -------- ---------- ----------\n");
+
+    for (index = 0; index < sizeof(_scenarios) / sizeof(_scenarios[0]); index ++)
+    {
+        if (argc > 1 && rt_strcmp(argv[1], _scenarios[index].name) != 0)
+            continue;
+
+        result = _mutex_bench_run(&_scenarios[index]);
+        if (result != RT_EOK)
+            break;
+    }
+
+    if (result == -RT_EINVAL)
+        rt_kprintf("unknown scenario %s\n", argv[1]);
+
+    return result;
+}
+
+#endif /* RT_USING_KBENCH && RT_KBENCH_USING_MUTEX */
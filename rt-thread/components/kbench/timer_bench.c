@@ -0,0 +1,203 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2021-09-30     RT-Thread    the first version
+ *
+ * Anotation：按已启动定时器的数量（16、64、256 ... RT_KBENCH_TIMER_MAX）测量定时器
+ * 操作的关中断时间。每一轮先启动 N 个超时很远的定时器，再反复启动和停止一个随机超时
+ * 的探测定时器，统计两者的周期数；同时让一批定时器在几个 tick 内到期，用
+ * rt_timer_irqoff_get 采样 rt_timer_check 的关中断时间。用来比较跳表和时间轮。
+ */
+
+#include <rthw.h>
+#include <rtthread.h>
+
+#include "kbench.h"
+
+#if defined(RT_USING_KBENCH) && defined(RT_KBENCH_USING_TIMER)
+
+#define TIMER_BENCH_ROUND       256             /* the start and stop of probe timer in each count */
+#define TIMER_BENCH_EXPIRE_TICK 8               /* the ticks to sample the timer check */
+#define TIMER_BENCH_FAR_TICK    0x100000        /* the timeout of armed timers */
+
+#if defined(RT_TIMER_USING_WHEEL)
+#define TIMER_BENCH_BACKEND     "timing wheel"
+#else
+#define TIMER_BENCH_BACKEND     "skip list"
+#endif
+
+static void _timer_bench_timeout(void *parameter)
+{
+    rt_uint32_t *expired = (rt_uint32_t *)parameter;
+
+    if (expired != RT_NULL)
+        (*expired) ++;
+}
+
+/*
+ * arm timers with random timeouts in [base, base + range)
+ */
+static void _timer_bench_arm(struct rt_timer *timers, int count, rt_uint32_t *expired,
+                             rt_tick_t base, rt_tick_t range)
+{
+    rt_tick_t timeout;
+    int index;
+
+    for (index = 0; index < count; index ++)
+    {
+        timeout = base + rt_kbench_rand() % range;
+        rt_timer_init(&timers[index], "kbench", _timer_bench_timeout, expired,
+                      timeout, RT_TIMER_FLAG_ONE_SHOT | RT_TIMER_FLAG_HARD_TIMER);
+        rt_timer_start(&timers[index]);
+    }
+}
+
+static void _timer_bench_disarm(struct rt_timer *timers, int count)
+{
+    int index;
+
+    for (index = 0; index < count; index ++)
+    {
+        rt_timer_detach(&timers[index]);
+    }
+}
+
+/*
+ * measure the start and stop of probe timer with the armed timers
+ */
+static void _timer_bench_probe(struct rt_kbench_stat *start, struct rt_kbench_stat *stop)
+{
+    struct rt_timer probe;
+    register rt_base_t level;
+    rt_uint32_t cycles;
+    rt_tick_t timeout;
+    int round;
+
+    rt_timer_init(&probe, "probe", _timer_bench_timeout, RT_NULL, 1,
+                  RT_TIMER_FLAG_ONE_SHOT | RT_TIMER_FLAG_HARD_TIMER);
+
+    for (round = 0; round < TIMER_BENCH_ROUND; round ++)
+    {
+        /* the probe is inserted anywhere among the armed timers */
+        timeout = 1 + rt_kbench_rand() % (2 * TIMER_BENCH_FAR_TICK);
+        rt_timer_control(&probe, RT_TIMER_CTRL_SET_TIME, &timeout);
+
+        level = rt_hw_interrupt_disable();
+        cycles = rt_hw_cycle_get();
+        rt_timer_start(&probe);
+        cycles = rt_hw_cycle_get() - cycles;
+        rt_hw_interrupt_enable(level);
+        rt_kbench_stat_add(start, cycles);
+
+        level = rt_hw_interrupt_disable();
+        cycles = rt_hw_cycle_get();
+        rt_timer_stop(&probe);
+        cycles = rt_hw_cycle_get() - cycles;
+        rt_hw_interrupt_enable(level);
+        rt_kbench_stat_add(stop, cycles);
+    }
+
+    rt_timer_detach(&probe);
+}
+
+#ifdef RT_TIMER_USING_IRQOFF_STAT
+/*
+ * expire timers in a few ticks and sample the timer check of each tick
+ */
+static void _timer_bench_check(struct rt_timer *timers, int count, struct rt_kbench_stat *check)
+{
+    rt_uint32_t expired = 0, last;
+    rt_tick_t tick;
+
+    _timer_bench_arm(timers, count, &expired, 1, TIMER_BENCH_EXPIRE_TICK);
+
+    tick = rt_tick_get();
+    while (expired < (rt_uint32_t)count && rt_tick_get() - tick < TIMER_BENCH_EXPIRE_TICK * 2)
+    {
+        rt_thread_delay(1);
+
+        rt_timer_irqoff_get(&last, RT_NULL);
+        rt_kbench_stat_add(check, last);
+    }
+
+    _timer_bench_disarm(timers, count);
+}
+#endif
+
+/**
+ * This function will run the timer benchmark, it measures the interrupt
+ * disabled time of timer start, stop and check by the number of armed timers.
+ *
+ * @param argc the number of arguments
+ * @param argv the arguments, argv[1] is the maximum number of timers
+ *
+ * @return the error code, RT_EOK on successful
+ */
+int rt_kbench_timer(int argc, char **argv)
+{
+    struct rt_kbench_stat start, stop, check;
+    struct rt_timer *timers;
+    int max_count = RT_KBENCH_TIMER_MAX;
+    const char *ptr;
+    int count, next;
+
+    if (argc > 1)
+    {
+        max_count = 0;
+        for (ptr = argv[1]; *ptr >= '0' && *ptr <= '9'; ptr ++)
+            max_count = max_count * 10 + (*ptr - '0');
+    }
+
+    if (max_count < 16)
+        max_count = 16;
+
+    /* the armed timers, and the batch of expiring timers */
+    timers = (struct rt_timer *)rt_malloc(sizeof(struct rt_timer) * (max_count + max_count / 4));
+    if (timers == RT_NULL)
+    {
+        rt_kprintf("no memory for %d timers\n", max_count);
+
+        return -RT_ENOMEM;
+    }
+
+    rt_kprintf("%s, cycles with interrupt disabled\n", TIMER_BENCH_BACKEND);
+    rt_kprintf("timers start mean  max    stop mean  max    check mean max\n");
+    rt_kprintf("------ ---------- ------ ---------- ------ ---------- ------\n");
+
+    for (count = 16; count <= max_count; count = next)
+    {
+        /* the last round with the maximum number */
+        next = count * 4;
+        if (count < max_count && next > max_count)
+            next = max_count;
+
+        rt_kbench_stat_init(&start);
+        rt_kbench_stat_init(&stop);
+        rt_kbench_stat_init(&check);
+
+        _timer_bench_arm(timers, count, RT_NULL, TIMER_BENCH_FAR_TICK, TIMER_BENCH_FAR_TICK);
+        _timer_bench_probe(&start, &stop);
+#ifdef RT_TIMER_USING_IRQOFF_STAT
+        _timer_bench_check(timers + max_count, count / 4, &check);
+#endif
+        _timer_bench_disarm(timers, count);
+
+        rt_kprintf("%-6d %-10d %-6d %-10d %-6d ", count,
+                   rt_kbench_stat_mean(&start), start.max,
+                   rt_kbench_stat_mean(&stop), stop.max);
+        if (check.count != 0)
+            rt_kprintf("%-10d %-6d\n", rt_kbench_stat_mean(&check), check.max);
+        else
+            rt_kprintf("-          -\n");
+    }
+
+    rt_free(timers);
+
+    return RT_EOK;
+}
+
+#endif /* RT_USING_KBENCH && RT_KBENCH_USING_TIMER */
@@ -0,0 +1,875 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2021-09-26     RT-Thread    the first version
+ *
+ * Anotation：通过 rt_malloc_sethook/rt_free_sethook 记录实际负载的分配序列，然后在
+ * 系统堆（mem/slab/tlsf/memheap，取决于配置）、独立的 memheap 对象和按大小分级的
+ * mempool 上重放，统计每次分配和释放所用的周期数（最小、平均、p99、最大）、峰值占用
+ * 和碎片率。记录时保存并串联之前安装的钩子（例如 RT_USING_MEMSTAT 的），停止时恢复。
+ * 记录的序列可以用 membench dump 导出，再用 rt_membench_load 载入后重放；sim 目录是主机上的
+ * 模拟器，把内核的堆算法编译到主机，并覆盖弱函数 rt_membench_cycle_get。
+ */
+
+#include <rthw.h>
+#include <rtthread.h>
+
+#include "membench.h"
+
+#ifdef RT_USING_MEMBENCH
+
+/* size classes of memory pool: 16, 32, ... 1024 */
+#define MEMBENCH_POOL_NR        7
+#define MEMBENCH_POOL_SHIFT     4
+
+struct membench_backend
+{
+    const char *name;
+
+    rt_err_t (*setup)(void);
+    void *(*alloc)(rt_size_t size);
+    void (*free)(void *ptr);
+    rt_size_t (*used)(void);                /* bytes held by the allocator */
+    int (*frag)(rt_size_t live);            /* fragmentation in per mille, -1 if unknown */
+    void (*cleanup)(void);
+};
+
+struct membench_stat
+{
+    rt_uint32_t count;
+    rt_uint32_t min;
+    rt_uint32_t mean;
+    rt_uint32_t p99;
+    rt_uint32_t max;
+};
+
+static struct rt_membench_event _trace[RT_MEMBENCH_EVENT_NR];
+static rt_size_t _trace_count;
+static rt_uint32_t _trace_dropped;
+
+/* the blocks of trace when capturing, and the replayed blocks when replaying */
+static void *_slot[RT_MEMBENCH_SLOT_NR];
+static rt_uint32_t _slot_size[RT_MEMBENCH_SLOT_NR];
+
+/* cycles of allocations from the head, and of releases from the tail */
+static rt_uint32_t _samples[RT_MEMBENCH_EVENT_NR];
+
+static rt_bool_t _capturing;
+static rt_bool_t _running;
+
+#ifdef RT_USING_HOOK
+/* the hooks installed before capturing, they are chained and restored */
+static rt_bool_t _hooked;
+static void (*_membench_prev_malloc_hook)(void *ptr, rt_size_t size);
+static void (*_membench_prev_free_hook)(void *ptr);
+#endif
+
+/**
+ * This function will get the cycle counter for benchmark. The cpu cycle
+ * counter is used when RT_MEMBENCH_USING_HW_CYCLE is enabled, otherwise the
+ * OS tick. It can be overridden, for example by a host-side simulator.
+ *
+ * @return the current value of counter
+ */
+RT_WEAK rt_uint32_t rt_membench_cycle_get(void)
+{
+#ifdef RT_MEMBENCH_USING_HW_CYCLE
+    return rt_hw_cycle_get();
+#else
+    return rt_tick_get();
+#endif
+}
+
+#ifdef RT_USING_HOOK
+static void _membench_malloc_hook(void *ptr, rt_size_t size)
+{
+    register rt_base_t level;
+    rt_uint32_t index;
+
+    level = rt_hw_interrupt_disable();
+
+    if (_capturing)
+    {
+        if (_trace_count >= RT_MEMBENCH_EVENT_NR)
+        {
+            /* the trace is full, stop capturing */
+            _capturing = RT_FALSE;
+            _trace_dropped ++;
+            rt_hw_interrupt_enable(level);
+
+            goto __exit;
+        }
+
+        for (index = 0; index < RT_MEMBENCH_SLOT_NR; index ++)
+        {
+            if (_slot[index] == RT_NULL)
+                break;
+        }
+
+        if (index < RT_MEMBENCH_SLOT_NR)
+        {
+            _slot[index] = ptr;
+            _trace[_trace_count].size = size ? size : 1;
+            _trace[_trace_count].slot = index;
+            _trace_count ++;
+        }
+        else
+        {
+            /* too many live blocks */
+            _trace_dropped ++;
+        }
+    }
+
+    rt_hw_interrupt_enable(level);
+
+__exit:
+    if (_membench_prev_malloc_hook != RT_NULL)
+        _membench_prev_malloc_hook(ptr, size);
+}
+
+static void _membench_free_hook(void *ptr)
+{
+    register rt_base_t level;
+    rt_uint32_t index;
+
+    level = rt_hw_interrupt_disable();
+
+    if (_capturing && _trace_count < RT_MEMBENCH_EVENT_NR)
+    {
+        /* the blocks allocated before capturing are not found */
+        for (index = 0; index < RT_MEMBENCH_SLOT_NR; index ++)
+        {
+            if (_slot[index] == ptr)
+            {
+                _slot[index] = RT_NULL;
+                _trace[_trace_count].size = 0;
+                _trace[_trace_count].slot = index;
+                _trace_count ++;
+                break;
+            }
+        }
+    }
+
+    rt_hw_interrupt_enable(level);
+
+    if (_membench_prev_free_hook != RT_NULL)
+        _membench_prev_free_hook(ptr);
+}
+
+/**
+ * This function will start to capture the allocation trace of heap. The
+ * malloc and free hooks of heap are replaced, and the hooks installed before,
+ * such as the ones of RT_USING_MEMSTAT, are still called.
+ *
+ * @return RT_EOK on success, -RT_EBUSY if the benchmark is running
+ */
+rt_err_t rt_membench_start(void)
+{
+    register rt_base_t level;
+
+    level = rt_hw_interrupt_disable();
+    if (_running)
+    {
+        rt_hw_interrupt_enable(level);
+
+        return -RT_EBUSY;
+    }
+
+    rt_memset(_slot, 0, sizeof(_slot));
+    _trace_count   = 0;
+    _trace_dropped = 0;
+    _capturing     = RT_TRUE;
+
+    /* the hooks are installed once even if capturing is restarted */
+    if (!_hooked)
+    {
+        _membench_prev_malloc_hook = rt_malloc_gethook();
+        _membench_prev_free_hook   = rt_free_gethook();
+        rt_malloc_sethook(_membench_malloc_hook);
+        rt_free_sethook(_membench_free_hook);
+        _hooked = RT_TRUE;
+    }
+    rt_hw_interrupt_enable(level);
+
+    return RT_EOK;
+}
+
+/**
+ * This function will stop capturing the allocation trace, and restore the
+ * malloc and free hooks installed before capturing.
+ *
+ * @return the number of events in trace
+ */
+rt_size_t rt_membench_stop(void)
+{
+    register rt_base_t level;
+
+    level = rt_hw_interrupt_disable();
+    _capturing = RT_FALSE;
+
+    /* the hooks installed after capturing are kept, they chain to ours */
+    if (_hooked && rt_malloc_gethook() == _membench_malloc_hook &&
+        rt_free_gethook() == _membench_free_hook)
+    {
+        rt_malloc_sethook(_membench_prev_malloc_hook);
+        rt_free_sethook(_membench_prev_free_hook);
+        _membench_prev_malloc_hook = RT_NULL;
+        _membench_prev_free_hook   = RT_NULL;
+        _hooked = RT_FALSE;
+    }
+    rt_hw_interrupt_enable(level);
+
+    return _trace_count;
+}
+#endif /* RT_USING_HOOK */
+
+/**
+ * This function will load an allocation trace, for example the trace dumped
+ * from target in a host-side simulator.
+ *
+ * @param events the events of trace
+ * @param count the number of events
+ *
+ * @return RT_EOK on success, -RT_EFULL if the trace is too long, -RT_EINVAL
+ *         if the slot of an event is out of range, -RT_EBUSY if capturing or
+ *         running
+ */
+rt_err_t rt_membench_load(const struct rt_membench_event *events, rt_size_t count)
+{
+    rt_size_t index;
+
+    if (_capturing || _running)
+        return -RT_EBUSY;
+
+    if (count > RT_MEMBENCH_EVENT_NR)
+        return -RT_EFULL;
+
+    for (index = 0; index < count; index ++)
+    {
+        if (events[index].slot >= RT_MEMBENCH_SLOT_NR)
+            return -RT_EINVAL;
+    }
+
+    rt_memcpy(_trace, events, count * sizeof(struct rt_membench_event));
+    _trace_count   = count;
+    _trace_dropped = 0;
+
+    return RT_EOK;
+}
+
+/**
+ * This function will generate a fragmenting allocation trace. The blocks of
+ * small and large sizes are allocated and released in random order with the
+ * live blocks kept around 3/4 of the slots, so the free space is broken into
+ * holes of mixed sizes, which is the worst case of the first-fit allocators.
+ * The trace is the same in every run, so the allocators of different builds
+ * are compared with the same workload.
+ *
+ * @param count the number of events, RT_MEMBENCH_EVENT_NR at most
+ *
+ * @return RT_EOK on success, -RT_EBUSY if capturing or running
+ */
+rt_err_t rt_membench_generate(rt_size_t count)
+{
+    rt_uint32_t seed = 1, random, slot;
+    rt_size_t index, live = 0;
+
+    if (_capturing || _running)
+        return -RT_EBUSY;
+
+    if (count > RT_MEMBENCH_EVENT_NR)
+        count = RT_MEMBENCH_EVENT_NR;
+
+    /* the sizes of live slots, 0 for free */
+    rt_memset(_slot_size, 0, sizeof(_slot_size));
+
+    for (index = 0; index < count; index ++)
+    {
+        seed = seed * 1103515245 + 12345;
+        random = seed >> 8;
+
+        if (live == 0 || (live < RT_MEMBENCH_SLOT_NR * 3 / 4 && random % 3 != 0))
+        {
+            /* one quarter is large */
+            slot = random % RT_MEMBENCH_SLOT_NR;
+            while (_slot_size[slot] != 0)
+                slot = (slot + 1) % RT_MEMBENCH_SLOT_NR;
+
+            if ((random >> 8) % 4 == 0)
+                _slot_size[slot] = 128 + (random >> 10) % 384;
+            else
+                _slot_size[slot] = 8 + (random >> 10) % 120;
+
+            _trace[index].size = _slot_size[slot];
+            live ++;
+        }
+        else
+        {
+            slot = random % RT_MEMBENCH_SLOT_NR;
+            while (_slot_size[slot] == 0)
+                slot = (slot + 1) % RT_MEMBENCH_SLOT_NR;
+
+            _slot_size[slot] = 0;
+            _trace[index].size = 0;
+            live --;
+        }
+        _trace[index].slot = slot;
+    }
+
+    _trace_count   = count;
+    _trace_dropped = 0;
+
+    return RT_EOK;
+}
+
+#ifdef RT_USING_MEMFRAG
+static rt_size_t _walk_total, _walk_largest;
+
+static void _membench_free_block(struct rt_mem_walk *walk, void *addr, rt_size_t size)
+{
+    _walk_total += size;
+    if (size > _walk_largest)
+        _walk_largest = size;
+}
+
+static int _membench_walk_frag(struct rt_memheap *heap)
+{
+    struct rt_mem_walk walk;
+    rt_err_t result;
+
+    rt_memset(&walk, 0, sizeof(walk));
+    walk.free_block = _membench_free_block;
+
+    do
+    {
+        if (walk.cursor == 0)
+        {
+            _walk_total   = 0;
+            _walk_largest = 0;
+        }
+
+#ifdef RT_USING_MEMHEAP
+        if (heap != RT_NULL)
+            result = rt_memheap_walk(heap, &walk, ~(rt_size_t)0);
+        else
+#endif
+            result = rt_memory_walk(&walk, ~(rt_size_t)0);
+
+        /* the heap is locked by others */
+        if (result == -RT_EBUSY)
+            rt_thread_delay(1);
+    }
+    while (result != RT_EOK);
+
+    if (_walk_total == 0)
+        return 0;
+
+    return 1000 - (int)((rt_uint64_t)_walk_largest * 1000 / _walk_total);
+}
+#endif
+
+/*
+ * the system heap, which is mem, slab, tlsf or memheap by configuration
+ */
+static rt_err_t _heap_setup(void)
+{
+    return RT_EOK;
+}
+
+static rt_size_t _heap_used(void)
+{
+    rt_uint32_t used;
+
+    rt_memory_info(RT_NULL, &used, RT_NULL);
+
+    return used;
+}
+
+static int _heap_frag(rt_size_t live)
+{
+#ifdef RT_USING_MEMFRAG
+    return _membench_walk_frag(RT_NULL);
+#else
+    return -1;
+#endif
+}
+
+static void _heap_cleanup(void)
+{
+}
+
+#ifdef RT_USING_MEMHEAP
+/*
+ * a memory heap object in a buffer allocated from system heap
+ */
+static struct rt_memheap _bench_heap;
+static void *_bench_heap_buf;
+
+static rt_err_t _memheap_setup(void)
+{
+    _bench_heap_buf = rt_malloc(RT_MEMBENCH_MEMHEAP_SIZE);
+    if (_bench_heap_buf == RT_NULL)
+        return -RT_ENOMEM;
+
+    return rt_memheap_init(&_bench_heap, "mbench", _bench_heap_buf, RT_MEMBENCH_MEMHEAP_SIZE);
+}
+
+static void *_memheap_alloc(rt_size_t size)
+{
+    return rt_memheap_alloc(&_bench_heap, size);
+}
+
+static rt_size_t _memheap_used(void)
+{
+    return _bench_heap.pool_size - _bench_heap.available_size;
+}
+
+static int _memheap_frag(rt_size_t live)
+{
+#ifdef RT_USING_MEMFRAG
+    return _membench_walk_frag(&_bench_heap);
+#else
+    return -1;
+#endif
+}
+
+static void _memheap_cleanup(void)
+{
+    rt_memheap_detach(&_bench_heap);
+    rt_free(_bench_heap_buf);
+}
+#endif /* RT_USING_MEMHEAP */
+
+#ifdef RT_USING_MEMPOOL
+/*
+ * memory pools of size classes, the number of blocks in each pool is the
+ * maximum of live blocks of the class in trace
+ */
+static rt_mp_t _bench_pool[MEMBENCH_POOL_NR];
+
+static int _mempool_class(rt_size_t size)
+{
+    int index;
+
+    for (index = 0; index < MEMBENCH_POOL_NR; index ++)
+    {
+        if (size <= (1u << (MEMBENCH_POOL_SHIFT + index)))
+            return index;
+    }
+
+    return -1;
+}
+
+static rt_err_t _mempool_setup(void)
+{
+    rt_uint32_t live[MEMBENCH_POOL_NR], peak[MEMBENCH_POOL_NR];
+    char name[RT_NAME_MAX];
+    rt_size_t index;
+    int pool;
+
+    rt_memset(live, 0, sizeof(live));
+    rt_memset(peak, 0, sizeof(peak));
+    rt_memset(_slot_size, 0, sizeof(_slot_size));
+
+    /* count the live blocks of each class */
+    for (index = 0; index < _trace_count; index ++)
+    {
+        if (_trace[index].size != 0)
+        {
+            _slot_size[_trace[index].slot] = _trace[index].size;
+            pool = _mempool_class(_trace[index].size);
+            if (pool >= 0 && ++ live[pool] > peak[pool])
+                peak[pool] = live[pool];
+        }
+        else
+        {
+            pool = _mempool_class(_slot_size[_trace[index].slot]);
+            if (pool >= 0 && live[pool] > 0)
+                live[pool] --;
+        }
+    }
+
+    for (pool = 0; pool < MEMBENCH_POOL_NR; pool ++)
+    {
+        _bench_pool[pool] = RT_NULL;
+        if (peak[pool] == 0)
+            continue;
+
+        rt_snprintf(name, sizeof(name), "mbench%d", pool);
+        _bench_pool[pool] = rt_mp_create(name, peak[pool], 1u << (MEMBENCH_POOL_SHIFT + pool));
+        if (_bench_pool[pool] == RT_NULL)
+            return -RT_ENOMEM;
+    }
+
+    return RT_EOK;
+}
+
+static void *_mempool_alloc(rt_size_t size)
+{
+    int pool;
+
+    /* the larger blocks fail */
+    pool = _mempool_class(size);
+    if (pool < 0 || _bench_pool[pool] == RT_NULL)
+        return RT_NULL;
+
+    return rt_mp_alloc(_bench_pool[pool], RT_WAITING_NO);
+}
+
+static rt_size_t _mempool_used(void)
+{
+    rt_size_t used = 0;
+    int pool;
+
+    for (pool = 0; pool < MEMBENCH_POOL_NR; pool ++)
+    {
+        if (_bench_pool[pool] == RT_NULL)
+            continue;
+
+        used += (_bench_pool[pool]->block_total_count - _bench_pool[pool]->block_free_count) *
+                (_bench_pool[pool]->block_size + sizeof(rt_uint8_t *));
+    }
+
+    return used;
+}
+
+static int _mempool_frag(rt_size_t live)
+{
+    rt_size_t used;
+
+    /* the internal waste of blocks */
+    used = _mempool_used();
+    if (used == 0)
+        return 0;
+
+    return 1000 - (int)((rt_uint64_t)live * 1000 / used);
+}
+
+static void _mempool_cleanup(void)
+{
+    int pool;
+
+    for (pool = 0; pool < MEMBENCH_POOL_NR; pool ++)
+    {
+        if (_bench_pool[pool] != RT_NULL)
+            rt_mp_delete(_bench_pool[pool]);
+        _bench_pool[pool] = RT_NULL;
+    }
+}
+#endif /* RT_USING_MEMPOOL */
+
+static const struct membench_backend _backend[] =
+{
+#if defined(RT_USING_MEMHEAP_AS_HEAP)
+    {"heap(memheap)", _heap_setup, rt_malloc, rt_free, _heap_used, _heap_frag, _heap_cleanup},
+#elif defined(RT_USING_SLAB)
+    {"heap(slab)", _heap_setup, rt_malloc, rt_free, _heap_used, _heap_frag, _heap_cleanup},
+#elif defined(RT_USING_TLSF)
+    {"heap(tlsf)", _heap_setup, rt_malloc, rt_free, _heap_used, _heap_frag, _heap_cleanup},
+#else
+    {"heap(mem)", _heap_setup, rt_malloc, rt_free, _heap_used, _heap_frag, _heap_cleanup},
+#endif
+#ifdef RT_USING_MEMHEAP
+    {"memheap", _memheap_setup, _memheap_alloc, rt_memheap_free, _memheap_used, _memheap_frag, _memheap_cleanup},
+#endif
+#ifdef RT_USING_MEMPOOL
+    {"mempool", _mempool_setup, _mempool_alloc, rt_mp_free, _mempool_used, _mempool_frag, _mempool_cleanup},
+#endif
+};
+
+static void _membench_sort(rt_uint32_t *data, rt_size_t count)
+{
+    rt_size_t gap, i, j;
+    rt_uint32_t value;
+
+    /* shell sort, no recursion and no extra memory */
+    for (gap = count / 2; gap > 0; gap /= 2)
+    {
+        for (i = gap; i < count; i ++)
+        {
+            value = data[i];
+            for (j = i; j >= gap && data[j - gap] > value; j -= gap)
+                data[j] = data[j - gap];
+            data[j] = value;
+        }
+    }
+}
+
+static void _membench_stat(struct membench_stat *stat, rt_uint32_t *data, rt_size_t count)
+{
+    rt_uint64_t sum = 0;
+    rt_size_t index;
+
+    rt_memset(stat, 0, sizeof(*stat));
+    if (count == 0)
+        return;
+
+    _membench_sort(data, count);
+    for (index = 0; index < count; index ++)
+        sum += data[index];
+
+    stat->count = count;
+    stat->min   = data[0];
+    stat->max   = data[count - 1];
+    stat->mean  = (rt_uint32_t)(sum / count);
+    stat->p99   = data[(count * 99 + 99) / 100 - 1];
+}
+
+/*
+ * the cost of reading the counter, which is taken off from the samples
+ */
+static rt_uint32_t _membench_overhead(void)
+{
+    rt_uint32_t start, cycles, overhead;
+    int index;
+
+    overhead = ~0u;
+    for (index = 0; index < 16; index ++)
+    {
+        start  = rt_membench_cycle_get();
+        cycles = rt_membench_cycle_get() - start;
+        if (cycles < overhead)
+            overhead = cycles;
+    }
+
+    return overhead;
+}
+
+static void _membench_replay(const struct membench_backend *backend, rt_uint32_t overhead)
+{
+    struct membench_stat alloc_stat, free_stat;
+    rt_size_t index, alloc_count, free_count;
+    rt_size_t base, used, peak, live;
+    rt_uint32_t start, cycles, fail;
+    struct rt_membench_event *event;
+    void *ptr;
+    int frag;
+
+    if (backend->setup() != RT_EOK)
+    {
+        rt_kprintf("%-13s setup failed\n", backend->name);
+        backend->cleanup();
+
+        return;
+    }
+
+    rt_memset(_slot, 0, sizeof(_slot));
+    rt_memset(_slot_size, 0, sizeof(_slot_size));
+    alloc_count = free_count = 0;
+    peak = live = 0;
+    fail = 0;
+    base = backend->used();
+
+    for (index = 0; index < _trace_count; index ++)
+    {
+        event = &_trace[index];
+        if (event->size != 0)
+        {
+            start  = rt_membench_cycle_get();
+            ptr    = backend->alloc(event->size);
+            cycles = rt_membench_cycle_get() - start;
+            _samples[alloc_count ++] = cycles > overhead ? cycles - overhead : 0;
+
+            if (ptr == RT_NULL || _slot[event->slot] != RT_NULL)
+            {
+                if (ptr != RT_NULL)
+                    backend->free(ptr);
+                fail ++;
+                continue;
+            }
+
+            _slot[event->slot] = ptr;
+            _slot_size[event->slot] = event->size;
+            live += event->size;
+
+            used = backend->used() - base;
+            if (used > peak)
+                peak = used;
+        }
+        else
+        {
+            ptr = _slot[event->slot];
+            if (ptr == RT_NULL)
+                continue;
+
+            start  = rt_membench_cycle_get();
+            backend->free(ptr);
+            cycles = rt_membench_cycle_get() - start;
+            free_count ++;
+            _samples[RT_MEMBENCH_EVENT_NR - free_count] = cycles > overhead ? cycles - overhead : 0;
+
+            _slot[event->slot] = RT_NULL;
+            live -= _slot_size[event->slot];
+        }
+    }
+
+    /* the fragmentation with the blocks left at the end of trace */
+    frag = backend->frag(live);
+
+    for (index = 0; index < RT_MEMBENCH_SLOT_NR; index ++)
+    {
+        if (_slot[index] != RT_NULL)
+            backend->free(_slot[index]);
+        _slot[index] = RT_NULL;
+    }
+    backend->cleanup();
+
+    _membench_stat(&alloc_stat, _samples, alloc_count);
+    _membench_stat(&free_stat, &_samples[RT_MEMBENCH_EVENT_NR - free_count], free_count);
+
+    rt_kprintf("%-13s alloc %-6d %-6d %-6d %-6d %-8d %-8d ",
+               backend->name, alloc_stat.count, alloc_stat.min, alloc_stat.mean,
+               alloc_stat.p99, alloc_stat.max, peak);
+    if (frag >= 0)
+        rt_kprintf("%2d.%d%% ", frag / 10, frag % 10);
+    else
+        rt_kprintf("-     ");
+    rt_kprintf("%d\n", fail);
+    rt_kprintf("%-13s free  %-6d %-6d %-6d %-6d %-8d\n",
+               "", free_stat.count, free_stat.min, free_stat.mean,
+               free_stat.p99, free_stat.max);
+}
+
+/**
+ * This function will replay the allocation trace on each allocator, and show
+ * the cycles of allocations and releases, the peak footprint, the
+ * fragmentation and the number of failed allocations.
+ *
+ * @return RT_EOK on success, -RT_EEMPTY if there is no trace, -RT_EBUSY if
+ *         capturing or running
+ */
+rt_err_t rt_membench_run(void)
+{
+    register rt_base_t level;
+    rt_uint32_t overhead;
+    rt_size_t index;
+
+    level = rt_hw_interrupt_disable();
+    if (_capturing || _running)
+    {
+        rt_hw_interrupt_enable(level);
+
+        return -RT_EBUSY;
+    }
+    _running = RT_TRUE;
+    rt_hw_interrupt_enable(level);
+
+    if (_trace_count == 0)
+    {
+        _running = RT_FALSE;
+
+        return -RT_EEMPTY;
+    }
+
+    overhead = _membench_overhead();
+
+    rt_kprintf("%d events, counter overhead %d\n", _trace_count, overhead);
+    rt_kprintf("allocator     op    count  min    mean   p99    max      peak     frag  fail\n");
+    rt_kprintf("------------- ----- ------ ------ ------ ------ -------- -------- ----- ----\n");
+    for (index = 0; index < sizeof(_backend) / sizeof(_backend[0]); index ++)
+        _membench_replay(&_backend[index], overhead);
+
+    _running = RT_FALSE;
+
+    return RT_EOK;
+}
+
+#ifdef RT_USING_FINSH
+#include <finsh.h>
+
+static void membench_usage(void)
+{
+    rt_kprintf("Usage: membench <command>\n");
+#ifdef RT_USING_HOOK
+    rt_kprintf("  start  start to capture the allocation trace\n");
+    rt_kprintf("  stop   stop capturing\n");
+#endif
+    rt_kprintf("  frag   generate a fragmenting trace of [events]\n");
+    rt_kprintf("  run    replay the trace on each allocator\n");
+    rt_kprintf("  dump   dump the trace as C array\n");
+}
+
+static int membench(int argc, char **argv)
+{
+    rt_size_t index, count;
+    rt_err_t result;
+    const char *ptr;
+
+    if (argc < 2)
+    {
+        membench_usage();
+        rt_kprintf("trace: %d/%d events, %d dropped%s\n", _trace_count, RT_MEMBENCH_EVENT_NR,
+                   _trace_dropped, _capturing ? ", capturing" : "");
+
+        return 0;
+    }
+
+#ifdef RT_USING_HOOK
+    if (rt_strcmp(argv[1], "start") == 0)
+    {
+        result = rt_membench_start();
+        if (result != RT_EOK)
+            rt_kprintf("membench is running\n");
+
+        return result;
+    }
+
+    if (rt_strcmp(argv[1], "stop") == 0)
+    {
+        rt_kprintf("%d events captured, %d dropped\n", rt_membench_stop(), _trace_dropped);
+
+        return 0;
+    }
+#endif
+
+    if (rt_strcmp(argv[1], "frag") == 0)
+    {
+        count = RT_MEMBENCH_EVENT_NR;
+        if (argc > 2)
+        {
+            count = 0;
+            for (ptr = argv[2]; *ptr >= '0' && *ptr <= '9'; ptr ++)
+                count = count * 10 + (*ptr - '0');
+        }
+
+        result = rt_membench_generate(count);
+        if (result == -RT_EBUSY)
+            rt_kprintf("stop capturing first\n");
+        else
+            rt_kprintf("%d events generated\n", _trace_count);
+
+        return result;
+    }
+
+    if (rt_strcmp(argv[1], "run") == 0)
+    {
+        result = rt_membench_run();
+        if (result == -RT_EEMPTY)
+            rt_kprintf("no trace\n");
+        else if (result == -RT_EBUSY)
+            rt_kprintf("stop capturing first\n");
+
+        return result;
+    }
+
+    if (rt_strcmp(argv[1], "dump") == 0)
+    {
+        /* {size, slot}, size 0 for release */
+        for (index = 0; index < _trace_count; index ++)
+            rt_kprintf("{%d, %d},\n", _trace[index].size, _trace[index].slot);
+
+        return 0;
+    }
+
+    membench_usage();
+
+    return -RT_EINVAL;
+}
+MSH_CMD_EXPORT(membench, heap allocation benchmark);
+#endif /* RT_USING_FINSH */
+
+#endif /* RT_USING_MEMBENCH */
@@ -0,0 +1,35 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2021-09-26     RT-Thread    the first version
+ */
+#ifndef MEMBENCH_H__
+#define MEMBENCH_H__
+
+#include <rtthread.h>
+
+/*
+ * an event of allocation trace, the blocks are identified by slot, so the
+ * trace can be replayed on any allocator or in a host-side simulator.
+ */
+struct rt_membench_event
+{
+    rt_uint32_t size;                       /* size of allocation, 0 for release */
+    rt_uint32_t slot;                       /* the slot of block */
+};
+
+#ifdef RT_USING_HOOK
+rt_err_t rt_membench_start(void);
+rt_size_t rt_membench_stop(void);
+#endif
+rt_err_t rt_membench_load(const struct rt_membench_event *events, rt_size_t count);
+rt_err_t rt_membench_generate(rt_size_t count);
+rt_err_t rt_membench_run(void);
+
+rt_uint32_t rt_membench_cycle_get(void);
+
+#endif
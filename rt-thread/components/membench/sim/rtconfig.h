@@ -0,0 +1,35 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2021-09-30     RT-Thread    the first version
+ *
+ * Anotation：主机模拟器的配置，只打开堆和 membench。堆的算法（RT_USING_SMALL_MEM、
+ * RT_USING_TLSF 或 RT_USING_SLAB）由 Makefile 的 HEAP 变量给出。
+ */
+#ifndef RT_CONFIG_H__
+#define RT_CONFIG_H__
+
+#define RT_NAME_MAX 8
+#define RT_ALIGN_SIZE 8
+#define RT_THREAD_PRIORITY_32
+#define RT_THREAD_PRIORITY_MAX 32
+#define RT_TICK_PER_SECOND 1000
+
+#define RT_USING_SEMAPHORE
+#define RT_USING_HEAP
+#define RT_USING_CONSOLE
+#define RT_CONSOLEBUF_SIZE 256
+
+#define RT_USING_MEMBENCH
+#define RT_MEMBENCH_EVENT_NR 4096
+#define RT_MEMBENCH_SLOT_NR 256
+
+#if defined(__LP64__) || defined(_WIN64)
+#define ARCH_CPU_64BIT
+#endif
+
+#endif
@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2021-09-30     RT-Thread    the first version
+ *
+ * Anotation：membench 的主机模拟器。内核的堆算法（mem.c、tlsf.c 或 slab.c）直接在主机上
+ * 编译，信号量、中断开关等只做空实现，rt_membench_cycle_get 用主机的单调时钟（纳秒）
+ * 覆盖。不带参数时重放生成的碎片化序列；带参数时读取目标板上 membench dump 导出的
+ * 序列文件（每行一个 {size, slot}）再重放，这样不同堆算法的碎片率可以在主机上比较。
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <time.h>
+
+#include <rthw.h>
+#include <rtthread.h>
+
+#include "membench.h"
+
+#define SIM_HEAP_SIZE   (4 * 1024 * 1024)
+
+ALIGN(RT_ALIGN_SIZE)
+static rt_uint8_t _sim_heap[SIM_HEAP_SIZE];
+static struct rt_membench_event _sim_trace[RT_MEMBENCH_EVENT_NR];
+
+/*
+ * the nanoseconds of host monotonic clock
+ */
+rt_uint32_t rt_membench_cycle_get(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (rt_uint32_t)((rt_uint64_t)ts.tv_sec * 1000000000ul + ts.tv_nsec);
+}
+
+/*
+ * the kernel services used by the heap and membench, there is only one
+ * thread and no interrupt in simulator
+ */
+rt_base_t rt_hw_interrupt_disable(void)
+{
+    return 0;
+}
+
+void rt_hw_interrupt_enable(rt_base_t level)
+{
+}
+
+rt_uint8_t rt_interrupt_get_nest(void)
+{
+    return 0;
+}
+
+rt_thread_t rt_thread_self(void)
+{
+    return RT_NULL;
+}
+
+rt_tick_t rt_tick_get(void)
+{
+    return 0;
+}
+
+rt_err_t rt_thread_delay(rt_tick_t tick)
+{
+    return RT_EOK;
+}
+
+rt_err_t rt_sem_init(rt_sem_t sem, const char *name, rt_uint32_t value, rt_uint8_t flag)
+{
+    return RT_EOK;
+}
+
+rt_err_t rt_sem_take(rt_sem_t sem, rt_int32_t time)
+{
+    return RT_EOK;
+}
+
+rt_err_t rt_sem_trytake(rt_sem_t sem)
+{
+    return RT_EOK;
+}
+
+rt_err_t rt_sem_release(rt_sem_t sem)
+{
+    return RT_EOK;
+}
+
+void rt_assert_handler(const char *ex, const char *func, rt_size_t line)
+{
+    fprintf(stderr, "(%s) assertion failed at function:%s, line number:%d\n", ex, func, (int)line);
+    abort();
+}
+
+void rt_kprintf(const char *fmt, ...)
+{
+    va_list args;
+
+    va_start(args, fmt);
+    vprintf(fmt, args);
+    va_end(args);
+}
+
+rt_int32_t rt_snprintf(char *buf, rt_size_t size, const char *format, ...)
+{
+    va_list args;
+    rt_int32_t n;
+
+    va_start(args, format);
+    n = vsnprintf(buf, size, format, args);
+    va_end(args);
+
+    return n;
+}
+
+void *rt_memset(void *src, int c, rt_ubase_t n)
+{
+    return memset(src, c, n);
+}
+
+void *rt_memcpy(void *dest, const void *src, rt_ubase_t n)
+{
+    return memcpy(dest, src, n);
+}
+
+rt_int32_t rt_strcmp(const char *cs, const char *ct)
+{
+    return strcmp(cs, ct);
+}
+
+char *rt_strncpy(char *dst, const char *src, rt_ubase_t n)
+{
+    return strncpy(dst, src, n);
+}
+
+int __rt_ffs(int value)
+{
+    return __builtin_ffs(value);
+}
+
+/*
+ * load the trace dumped by "membench dump", one {size, slot} in each line
+ */
+static int _sim_load(const char *path)
+{
+    unsigned int size, slot;
+    rt_size_t count = 0;
+    char line[64];
+    rt_err_t result;
+    FILE *fp;
+
+    fp = fopen(path, "r");
+    if (fp == NULL)
+    {
+        perror(path);
+
+        return -1;
+    }
+
+    while (fgets(line, sizeof(line), fp) != NULL)
+    {
+        if (sscanf(line, " {%u , %u}", &size, &slot) != 2)
+            continue;
+
+        if (count >= RT_MEMBENCH_EVENT_NR)
+        {
+            fprintf(stderr, "%s: more than %d events\n", path, RT_MEMBENCH_EVENT_NR);
+            break;
+        }
+        _sim_trace[count].size = size;
+        _sim_trace[count].slot = slot;
+        count ++;
+    }
+    fclose(fp);
+
+    result = rt_membench_load(_sim_trace, count);
+    if (result != RT_EOK)
+    {
+        fprintf(stderr, "%s: bad trace (%d)\n", path, (int)result);
+
+        return -1;
+    }
+
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    rt_system_heap_init(_sim_heap, _sim_heap + SIM_HEAP_SIZE);
+
+    if (argc > 1)
+    {
+        if (_sim_load(argv[1]) != 0)
+            return 1;
+    }
+    else
+    {
+        rt_membench_generate(RT_MEMBENCH_EVENT_NR);
+    }
+
+    return rt_membench_run() == RT_EOK ? 0 : 1;
+}
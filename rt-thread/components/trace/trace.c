@@ -0,0 +1,635 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2021-09-30     RT-Thread    the first version
+ *
+ * Anotation：内核事件跟踪记录器。通过内核已有的钩子（调度器、中断进出、IPC 对象获取/
+ * 释放、线程挂起/恢复、定时器超时、内存分配/释放）把事件连同时间戳写入内存中的环形
+ * 缓冲区，满时覆盖最早的事件；同时记录内核对象的名字。缓冲区可以用 trace dump 命令
+ * 以十六进制从控制台输出，或以二进制写到另一个设备（如 uart2），也可以用调试器导出，
+ * 由主机上的 tools/trace2json.py 转换成 Perfetto/Chrome trace 的 JSON 时间线。
+ * 开始记录时保存之前安装的钩子并在记录后调用它们，停止时恢复。多核时每个 CPU 用原子
+ * 加法预留事件的位置，不使用全局的锁。
+ */
+
+#include <rthw.h>
+#include <rtthread.h>
+
+#include "trace.h"
+
+#ifdef RT_USING_TRACE
+
+#if defined(RT_USING_SMP) && !defined(__GNUC__)
+#error "RT_USING_TRACE requires the atomic builtins of GNU C on SMP"
+#endif
+
+/*
+ * install the hook of trace and save the previous one, which is called by
+ * the hook of trace. It is installed once even if recording is restarted.
+ */
+#define TRACE_HOOK_SET(name, hook)                          \
+    do                                                      \
+    {                                                       \
+        if (!_trace_installed.name)                         \
+        {                                                   \
+            _trace_prev.name = rt_##name##_gethook();       \
+            rt_##name##_sethook(hook);                      \
+            _trace_installed.name = 1;                      \
+        }                                                   \
+    } while (0)
+
+/*
+ * restore the previous hook. The hook installed after trace calls the hook
+ * of trace, so the hook of trace is kept in the chain and stays installed.
+ */
+#define TRACE_HOOK_RESTORE(name, hook)                      \
+    do                                                      \
+    {                                                       \
+        if (_trace_installed.name &&                        \
+            rt_##name##_gethook() == (hook))                \
+        {                                                   \
+            rt_##name##_sethook(_trace_prev.name);          \
+            _trace_prev.name = RT_NULL;                     \
+            _trace_installed.name = 0;                      \
+        }                                                   \
+    } while (0)
+
+struct rt_trace_buffer rt_trace;
+
+static rt_uint32_t _name_dropped;
+
+/* the hooks installed before recording */
+static struct
+{
+    void (*scheduler)(struct rt_thread *from, struct rt_thread *to);
+    void (*object_attach)(struct rt_object *object);
+    void (*interrupt_enter)(void);
+    void (*interrupt_leave)(void);
+    void (*object_trytake)(struct rt_object *object);
+    void (*object_take)(struct rt_object *object);
+    void (*object_put)(struct rt_object *object);
+    void (*thread_suspend)(rt_thread_t thread);
+    void (*thread_resume)(rt_thread_t thread);
+    void (*timer_enter)(struct rt_timer *timer);
+    void (*timer_exit)(struct rt_timer *timer);
+    void (*malloc)(void *ptr, rt_size_t size);
+    void (*free)(void *ptr);
+} _trace_prev;
+
+/* the hooks of trace in the chain of kernel hooks */
+static struct
+{
+    rt_uint8_t scheduler;
+    rt_uint8_t object_attach;
+    rt_uint8_t interrupt_enter;
+    rt_uint8_t interrupt_leave;
+    rt_uint8_t object_trytake;
+    rt_uint8_t object_take;
+    rt_uint8_t object_put;
+    rt_uint8_t thread_suspend;
+    rt_uint8_t thread_resume;
+    rt_uint8_t timer_enter;
+    rt_uint8_t timer_exit;
+    rt_uint8_t malloc;
+    rt_uint8_t free;
+} _trace_installed;
+
+rt_inline rt_uint32_t _trace_stamp(void)
+{
+#ifdef RT_TRACE_USING_HW_CYCLE
+    return rt_hw_cycle_get();
+#else
+    return rt_tick_get();
+#endif
+}
+
+static void _trace_record(rt_uint8_t type, rt_uint16_t value, void *object, rt_uint32_t arg)
+{
+    register rt_base_t level;
+    struct rt_trace_event *event;
+    rt_uint32_t index;
+
+#ifdef RT_USING_SMP
+    /* the slot is reserved atomically, the other cpus are not locked */
+    level = rt_hw_local_irq_disable();
+#else
+    level = rt_hw_interrupt_disable();
+#endif
+
+    if (rt_trace.flag & RT_TRACE_FLAG_RUNNING)
+    {
+#ifdef RT_USING_SMP
+        index = __atomic_fetch_add(&rt_trace.tail, 1, __ATOMIC_RELAXED);
+#else
+        index = rt_trace.tail ++;
+#endif
+        /* the oldest event is overwritten */
+        event = &rt_trace.events[index % RT_TRACE_EVENT_NR];
+        event->stamp  = _trace_stamp();
+        event->type   = type;
+#ifdef RT_USING_SMP
+        event->cpu    = rt_hw_cpu_id();
+#else
+        event->cpu    = 0;
+#endif
+        event->value  = value;
+        event->object = (rt_uint32_t)(rt_ubase_t)object;
+        event->arg    = arg;
+    }
+
+#ifdef RT_USING_SMP
+    rt_hw_local_irq_enable(level);
+#else
+    rt_hw_interrupt_enable(level);
+#endif
+}
+
+/*
+ * add the name of object, the entry of the same address is replaced, because
+ * the address may be reused by a new object.
+ */
+static void _trace_name_add(struct rt_object *object)
+{
+    register rt_base_t level;
+    struct rt_trace_name *entry = RT_NULL;
+    rt_uint32_t index;
+
+    level = rt_hw_interrupt_disable();
+
+    for (index = 0; index < RT_TRACE_NAME_NR; index ++)
+    {
+        if (rt_trace.names[index].object == (rt_uint32_t)(rt_ubase_t)object)
+        {
+            entry = &rt_trace.names[index];
+            break;
+        }
+
+        if (entry == RT_NULL && rt_trace.names[index].object == 0)
+            entry = &rt_trace.names[index];
+    }
+
+    if (entry != RT_NULL)
+    {
+        entry->object = (rt_uint32_t)(rt_ubase_t)object;
+        entry->type   = object->type & ~RT_Object_Class_Static;
+        rt_strncpy(entry->name, object->name, RT_NAME_MAX);
+    }
+    else
+    {
+        _name_dropped ++;
+    }
+
+    rt_hw_interrupt_enable(level);
+}
+
+/*
+ * add the names of the existing objects.
+ */
+static void _trace_name_scan(void)
+{
+    register rt_base_t level;
+    struct rt_object_information *information;
+    struct rt_list_node *node;
+    int type;
+
+    for (type = RT_Object_Class_Thread; type < RT_Object_Class_Unknown; type ++)
+    {
+        information = rt_object_get_information((enum rt_object_class_type)type);
+        if (information == RT_NULL)
+            continue;
+
+        level = rt_hw_interrupt_disable();
+        rt_list_for_each(node, &(information->object_list))
+        {
+            _trace_name_add(rt_list_entry(node, struct rt_object, list));
+        }
+        rt_hw_interrupt_enable(level);
+    }
+}
+
+/**
+ * This function will get the number of current interrupt, which is recorded
+ * in the interrupt events. It is the exception number on Cortex-M, and it can
+ * be overridden by BSP.
+ *
+ * @return the number of current interrupt, -1 if unknown
+ */
+RT_WEAK int rt_trace_irq_get(void)
+{
+#if defined(ARCH_ARM_CORTEX_M) && defined(__GNUC__)
+    rt_uint32_t ipsr;
+
+    __asm volatile ("mrs %0, ipsr" : "=r" (ipsr));
+
+    return ipsr & 0x1ff;
+#else
+    return -1;
+#endif
+}
+
+static void _trace_switch_hook(rt_thread_t from, rt_thread_t to)
+{
+    _trace_record(RT_TRACE_SWITCH, to->current_priority, from, (rt_uint32_t)(rt_ubase_t)to);
+
+    if (_trace_prev.scheduler != RT_NULL)
+        _trace_prev.scheduler(from, to);
+}
+
+static void _trace_attach_hook(struct rt_object *object)
+{
+    _trace_name_add(object);
+
+    if (_trace_prev.object_attach != RT_NULL)
+        _trace_prev.object_attach(object);
+}
+
+#ifdef RT_TRACE_USING_IRQ
+static void _trace_irq_enter_hook(void)
+{
+    _trace_record(RT_TRACE_IRQ_ENTER, (rt_uint16_t)rt_trace_irq_get(), RT_NULL, 0);
+
+    if (_trace_prev.interrupt_enter != RT_NULL)
+        _trace_prev.interrupt_enter();
+}
+
+static void _trace_irq_leave_hook(void)
+{
+    _trace_record(RT_TRACE_IRQ_LEAVE, (rt_uint16_t)rt_trace_irq_get(), RT_NULL, 0);
+
+    if (_trace_prev.interrupt_leave != RT_NULL)
+        _trace_prev.interrupt_leave();
+}
+#endif /* RT_TRACE_USING_IRQ */
+
+#ifdef RT_TRACE_USING_IPC
+static void _trace_trytake_hook(struct rt_object *object)
+{
+    _trace_record(RT_TRACE_OBJ_TRYTAKE, rt_object_get_type(object), object,
+                  (rt_uint32_t)(rt_ubase_t)rt_thread_self());
+
+    if (_trace_prev.object_trytake != RT_NULL)
+        _trace_prev.object_trytake(object);
+}
+
+static void _trace_take_hook(struct rt_object *object)
+{
+    _trace_record(RT_TRACE_OBJ_TAKE, rt_object_get_type(object), object,
+                  (rt_uint32_t)(rt_ubase_t)rt_thread_self());
+
+    if (_trace_prev.object_take != RT_NULL)
+        _trace_prev.object_take(object);
+}
+
+static void _trace_put_hook(struct rt_object *object)
+{
+    _trace_record(RT_TRACE_OBJ_PUT, rt_object_get_type(object), object,
+                  (rt_uint32_t)(rt_ubase_t)rt_thread_self());
+
+    if (_trace_prev.object_put != RT_NULL)
+        _trace_prev.object_put(object);
+}
+
+static void _trace_suspend_hook(rt_thread_t thread)
+{
+    _trace_record(RT_TRACE_THREAD_SUSPEND, 0, thread, (rt_uint32_t)(rt_ubase_t)rt_thread_self());
+
+    if (_trace_prev.thread_suspend != RT_NULL)
+        _trace_prev.thread_suspend(thread);
+}
+
+static void _trace_resume_hook(rt_thread_t thread)
+{
+    _trace_record(RT_TRACE_THREAD_RESUME, 0, thread, (rt_uint32_t)(rt_ubase_t)rt_thread_self());
+
+    if (_trace_prev.thread_resume != RT_NULL)
+        _trace_prev.thread_resume(thread);
+}
+#endif /* RT_TRACE_USING_IPC */
+
+#ifdef RT_TRACE_USING_TIMER
+static void _trace_timer_enter_hook(struct rt_timer *timer)
+{
+    _trace_record(RT_TRACE_TIMER_ENTER, 0, timer, (rt_uint32_t)(rt_ubase_t)timer->timeout_func);
+
+    if (_trace_prev.timer_enter != RT_NULL)
+        _trace_prev.timer_enter(timer);
+}
+
+static void _trace_timer_exit_hook(struct rt_timer *timer)
+{
+    _trace_record(RT_TRACE_TIMER_EXIT, 0, timer, (rt_uint32_t)(rt_ubase_t)timer->timeout_func);
+
+    if (_trace_prev.timer_exit != RT_NULL)
+        _trace_prev.timer_exit(timer);
+}
+#endif /* RT_TRACE_USING_TIMER */
+
+#ifdef RT_TRACE_USING_HEAP
+static void _trace_malloc_hook(void *ptr, rt_size_t size)
+{
+    _trace_record(RT_TRACE_MALLOC, 0, ptr, size);
+
+    if (_trace_prev.malloc != RT_NULL)
+        _trace_prev.malloc(ptr, size);
+}
+
+static void _trace_free_hook(void *ptr)
+{
+    _trace_record(RT_TRACE_FREE, 0, ptr, (rt_uint32_t)(rt_ubase_t)rt_thread_self());
+
+    if (_trace_prev.free != RT_NULL)
+        _trace_prev.free(ptr);
+}
+#endif /* RT_TRACE_USING_HEAP */
+
+/*
+ * install the hooks of trace, or restore the hooks installed before.
+ */
+static void _trace_sethook(rt_bool_t enable)
+{
+    if (enable)
+    {
+        TRACE_HOOK_SET(scheduler, _trace_switch_hook);
+        TRACE_HOOK_SET(object_attach, _trace_attach_hook);
+#ifdef RT_TRACE_USING_IRQ
+        TRACE_HOOK_SET(interrupt_enter, _trace_irq_enter_hook);
+        TRACE_HOOK_SET(interrupt_leave, _trace_irq_leave_hook);
+#endif
+#ifdef RT_TRACE_USING_IPC
+        TRACE_HOOK_SET(object_trytake, _trace_trytake_hook);
+        TRACE_HOOK_SET(object_take, _trace_take_hook);
+        TRACE_HOOK_SET(object_put, _trace_put_hook);
+        TRACE_HOOK_SET(thread_suspend, _trace_suspend_hook);
+        TRACE_HOOK_SET(thread_resume, _trace_resume_hook);
+#endif
+#ifdef RT_TRACE_USING_TIMER
+        TRACE_HOOK_SET(timer_enter, _trace_timer_enter_hook);
+        TRACE_HOOK_SET(timer_exit, _trace_timer_exit_hook);
+#endif
+#ifdef RT_TRACE_USING_HEAP
+        TRACE_HOOK_SET(malloc, _trace_malloc_hook);
+        TRACE_HOOK_SET(free, _trace_free_hook);
+#endif
+    }
+    else
+    {
+        TRACE_HOOK_RESTORE(scheduler, _trace_switch_hook);
+        TRACE_HOOK_RESTORE(object_attach, _trace_attach_hook);
+#ifdef RT_TRACE_USING_IRQ
+        TRACE_HOOK_RESTORE(interrupt_enter, _trace_irq_enter_hook);
+        TRACE_HOOK_RESTORE(interrupt_leave, _trace_irq_leave_hook);
+#endif
+#ifdef RT_TRACE_USING_IPC
+        TRACE_HOOK_RESTORE(object_trytake, _trace_trytake_hook);
+        TRACE_HOOK_RESTORE(object_take, _trace_take_hook);
+        TRACE_HOOK_RESTORE(object_put, _trace_put_hook);
+        TRACE_HOOK_RESTORE(thread_suspend, _trace_suspend_hook);
+        TRACE_HOOK_RESTORE(thread_resume, _trace_resume_hook);
+#endif
+#ifdef RT_TRACE_USING_TIMER
+        TRACE_HOOK_RESTORE(timer_enter, _trace_timer_enter_hook);
+        TRACE_HOOK_RESTORE(timer_exit, _trace_timer_exit_hook);
+#endif
+#ifdef RT_TRACE_USING_HEAP
+        TRACE_HOOK_RESTORE(malloc, _trace_malloc_hook);
+        TRACE_HOOK_RESTORE(free, _trace_free_hook);
+#endif
+    }
+}
+
+/**
+ * This function will start to record the kernel events. The hooks of kernel
+ * are replaced, the hooks installed before are still called, and the names
+ * of the existing objects are recorded.
+ *
+ * @return RT_EOK on success, -RT_EBUSY if it is recording
+ */
+rt_err_t rt_trace_start(void)
+{
+    if (rt_trace.flag & RT_TRACE_FLAG_RUNNING)
+        return -RT_EBUSY;
+
+    rt_trace.magic      = RT_TRACE_MAGIC;
+    rt_trace.version    = RT_TRACE_VERSION;
+    rt_trace.event_size = sizeof(struct rt_trace_event);
+    rt_trace.name_size  = sizeof(struct rt_trace_name);
+    rt_trace.name_nr    = RT_TRACE_NAME_NR;
+    rt_trace.event_nr   = RT_TRACE_EVENT_NR;
+#ifdef RT_TRACE_USING_HW_CYCLE
+    rt_trace.flag       = RT_TRACE_FLAG_CYCLE;
+    rt_trace.rate       = 0;
+#else
+    rt_trace.flag       = 0;
+    rt_trace.rate       = RT_TICK_PER_SECOND;
+#endif
+
+    rt_memset(rt_trace.names, 0, sizeof(rt_trace.names));
+    _name_dropped = 0;
+    _trace_name_scan();
+
+    rt_trace.flag |= RT_TRACE_FLAG_RUNNING;
+    _trace_sethook(RT_TRUE);
+
+    return RT_EOK;
+}
+
+/**
+ * This function will stop recording the kernel events, and restore the hooks
+ * of kernel installed before recording.
+ */
+void rt_trace_stop(void)
+{
+    _trace_sethook(RT_FALSE);
+    rt_trace.flag &= ~RT_TRACE_FLAG_RUNNING;
+}
+
+/**
+ * This function will clear the recorded events.
+ */
+void rt_trace_clear(void)
+{
+    register rt_base_t level;
+
+    level = rt_hw_interrupt_disable();
+
+    rt_memset(rt_trace.events, 0, sizeof(rt_trace.events));
+    rt_trace.tail = 0;
+
+    rt_hw_interrupt_enable(level);
+}
+
+#ifdef RT_USING_DEVICE
+/**
+ * This function will write the trace buffer to a device in binary. Recording
+ * is paused during writing. The device shall be opened without stream mode.
+ *
+ * @param device the opened device
+ *
+ * @return RT_EOK on success, -RT_EIO if the device fails to write
+ */
+rt_err_t rt_trace_dump(rt_device_t device)
+{
+    rt_uint8_t *ptr = (rt_uint8_t *)&rt_trace;
+    rt_size_t size = sizeof(rt_trace);
+    rt_size_t length;
+    rt_uint32_t running;
+    rt_err_t result = RT_EOK;
+
+    RT_ASSERT(device != RT_NULL);
+
+    running = rt_trace.flag & RT_TRACE_FLAG_RUNNING;
+    rt_trace.flag &= ~RT_TRACE_FLAG_RUNNING;
+
+    while (size > 0)
+    {
+        length = rt_device_write(device, 0, ptr, size);
+        if (length == 0)
+        {
+            result = -RT_EIO;
+            break;
+        }
+
+        ptr  += length;
+        size -= length;
+    }
+
+    rt_trace.flag |= running;
+
+    return result;
+}
+#endif /* RT_USING_DEVICE */
+
+#ifdef RT_USING_FINSH
+#include <finsh.h>
+
+/*
+ * print the trace buffer in hex words, which is converted by
+ * tools/trace2json.py from the captured console output.
+ */
+static void _trace_dump_hex(void)
+{
+    rt_uint32_t *word = (rt_uint32_t *)&rt_trace;
+    rt_size_t index, total;
+    rt_uint32_t running;
+
+    /* pause recording, the output of console is not recorded */
+    running = rt_trace.flag & RT_TRACE_FLAG_RUNNING;
+    rt_trace.flag &= ~RT_TRACE_FLAG_RUNNING;
+
+    total = sizeof(rt_trace) / sizeof(rt_uint32_t);
+    rt_kprintf("trace begin %d\n", total);
+    for (index = 0; index < total; index ++)
+    {
+        rt_kprintf("%08x%c", word[index], (index % 8 == 7 || index == total - 1) ? '\n' : ' ');
+    }
+    rt_kprintf("trace end\n");
+
+    rt_trace.flag |= running;
+}
+
+static void trace_usage(void)
+{
+    rt_kprintf("Usage: trace <command>\n");
+    rt_kprintf("  start           start to record the kernel events\n");
+    rt_kprintf("  stop            stop recording\n");
+    rt_kprintf("  clear           clear the events\n");
+    rt_kprintf("  dump            print the trace buffer in hex\n");
+#ifdef RT_USING_DEVICE
+    rt_kprintf("  dump <device>   write the trace buffer to device in binary\n");
+#endif
+}
+
+static int trace(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        trace_usage();
+        rt_kprintf("events: %d/%d, names: %d dropped%s\n",
+                   rt_trace.tail < RT_TRACE_EVENT_NR ? rt_trace.tail : RT_TRACE_EVENT_NR,
+                   RT_TRACE_EVENT_NR, _name_dropped,
+                   (rt_trace.flag & RT_TRACE_FLAG_RUNNING) ? ", recording" : "");
+
+        return 0;
+    }
+
+    if (rt_strcmp(argv[1], "start") == 0)
+    {
+        if (rt_trace_start() != RT_EOK)
+            rt_kprintf("trace is recording\n");
+
+        return 0;
+    }
+
+    if (rt_strcmp(argv[1], "stop") == 0)
+    {
+        rt_trace_stop();
+        rt_kprintf("%d events recorded\n", rt_trace.tail);
+
+        return 0;
+    }
+
+    if (rt_strcmp(argv[1], "clear") == 0)
+    {
+        rt_trace_clear();
+
+        return 0;
+    }
+
+    if (rt_strcmp(argv[1], "dump") == 0 && argc == 2)
+    {
+        _trace_dump_hex();
+
+        return 0;
+    }
+
+#ifdef RT_USING_DEVICE
+    if (rt_strcmp(argv[1], "dump") == 0)
+    {
+        rt_device_t device;
+        rt_err_t result;
+
+        device = rt_device_find(argv[2]);
+        if (device == RT_NULL)
+        {
+            rt_kprintf("device %s is not found\n", argv[2]);
+
+            return -RT_ERROR;
+        }
+
+        /* the stream mode of console changes the binary */
+        if (device == rt_console_get_device())
+        {
+            rt_kprintf("use \"trace dump\" for console\n");
+
+            return -RT_EINVAL;
+        }
+
+        result = rt_device_open(device, RT_DEVICE_OFLAG_RDWR);
+        if (result != RT_EOK)
+        {
+            rt_kprintf("open device %s failed\n", argv[2]);
+
+            return result;
+        }
+
+        result = rt_trace_dump(device);
+        rt_device_close(device);
+        if (result != RT_EOK)
+            rt_kprintf("write device %s failed\n", argv[2]);
+
+        return result;
+    }
+#endif /* RT_USING_DEVICE */
+
+    trace_usage();
+
+    return -RT_EINVAL;
+}
+MSH_CMD_EXPORT(trace, kernel event trace recorder);
+#endif /* RT_USING_FINSH */
+
+#endif /* RT_USING_TRACE */
@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2021-09-30     RT-Thread    the first version
+ */
+#ifndef TRACE_H__
+#define TRACE_H__
+
+#include <rtthread.h>
+
+/*
+ * The trace buffer is the variable rt_trace, it is dumped as it is in the
+ * memory, by "trace dump" command or by the debugger, and converted by
+ * tools/trace2json.py. All fields are in the byte order of target.
+ *
+ *  - the header, see struct rt_trace_buffer
+ *  - name_nr names of kernel objects, each one is name_size bytes
+ *  - event_nr events, each one is event_size bytes, the oldest events are
+ *    overwritten, the newest one is at (tail - 1) % event_nr
+ */
+#define RT_TRACE_MAGIC          0x45435254      /* "TRCE" */
+#define RT_TRACE_VERSION        1
+
+#define RT_TRACE_FLAG_CYCLE     0x01            /* the timestamp is cpu cycle, otherwise tick */
+#define RT_TRACE_FLAG_RUNNING   0x02            /* the events are being recorded */
+
+/* the type of event, and the meaning of value, object and arg */
+enum rt_trace_event_type
+{
+    RT_TRACE_SWITCH = 1,                        /* priority of to, from thread, to thread */
+    RT_TRACE_IRQ_ENTER,                         /* interrupt number, -, - */
+    RT_TRACE_IRQ_LEAVE,                         /* interrupt number, -, - */
+    RT_TRACE_OBJ_TRYTAKE,                       /* object class, object, current thread */
+    RT_TRACE_OBJ_TAKE,                          /* object class, object, current thread */
+    RT_TRACE_OBJ_PUT,                           /* object class, object, current thread */
+    RT_TRACE_THREAD_SUSPEND,                    /* -, thread, current thread */
+    RT_TRACE_THREAD_RESUME,                     /* -, thread, current thread */
+    RT_TRACE_TIMER_ENTER,                       /* -, timer, timeout function */
+    RT_TRACE_TIMER_EXIT,                        /* -, timer, timeout function */
+    RT_TRACE_MALLOC,                            /* -, block, size */
+    RT_TRACE_FREE,                              /* -, block, current thread */
+};
+
+struct rt_trace_event
+{
+    rt_uint32_t stamp;
+    rt_uint8_t  type;
+    rt_uint8_t  cpu;
+    rt_uint16_t value;
+    rt_uint32_t object;
+    rt_uint32_t arg;
+};
+
+/* the name of kernel object, the object is identified by address */
+struct rt_trace_name
+{
+    rt_uint32_t object;
+    rt_uint8_t  type;                           /* object class */
+    rt_uint8_t  reserved[3];
+    char        name[RT_NAME_MAX];
+};
+
+struct rt_trace_buffer
+{
+    rt_uint32_t magic;
+    rt_uint16_t version;
+    rt_uint16_t event_size;
+    rt_uint16_t name_size;
+    rt_uint16_t name_nr;
+    rt_uint32_t flag;
+    rt_uint32_t event_nr;
+    rt_uint32_t tail;                           /* the free-running count of events */
+    rt_uint32_t rate;                           /* the frequency of timestamp, 0 if unknown */
+
+    struct rt_trace_name  names[RT_TRACE_NAME_NR];
+    struct rt_trace_event events[RT_TRACE_EVENT_NR];
+};
+
+extern struct rt_trace_buffer rt_trace;
+
+rt_err_t rt_trace_start(void);
+void rt_trace_stop(void);
+void rt_trace_clear(void);
+#ifdef RT_USING_DEVICE
+rt_err_t rt_trace_dump(rt_device_t device);
+#endif
+
+int rt_trace_irq_get(void);
+
+#endif
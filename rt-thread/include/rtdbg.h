@@ -132,6 +132,33 @@ extern "C" {
             __FUNCTION__, __LINE__);                        \
     }
 
+#define _DBG_LOG_LEVEL(lvl_name)                            \
+    ((lvl_name)[0] == 'E' ? DBG_ERROR :                     \
+     (lvl_name)[0] == 'W' ? DBG_WARNING :                   \
+     (lvl_name)[0] == 'I' ? DBG_INFO : DBG_LOG)
+
+#ifdef RT_USING_TLOG
+/* the line is decoded on host by tools/tlog_decode.py, fmt shall be a string literal */
+#define dbg_log_line(lvl, color_n, fmt, ...)                \
+    rt_tlog_write(_DBG_LOG_LEVEL(lvl),                      \
+        "[" lvl "/" DBG_SECTION_NAME "] " fmt, ##__VA_ARGS__)
+#elif defined(RT_USING_ASYNC_LOG)
+#ifdef DBG_COLOR
+#define _DBG_LOG_HDR_STR(lvl_name, color_n)                \
+    "\033["#color_n"m[" lvl_name "/" DBG_SECTION_NAME "] "
+#define _DBG_LOG_END_STR    "\033[0m\n"
+#else
+#define _DBG_LOG_HDR_STR(lvl_name, color_n)                \
+    "[" lvl_name "/" DBG_SECTION_NAME "] "
+#define _DBG_LOG_END_STR    "\n"
+#endif /* DBG_COLOR */
+
+/* the whole line is made into one record, and output by the log thread */
+#define dbg_log_line(lvl, color_n, fmt, ...)                \
+    rt_async_log_line(_DBG_LOG_LEVEL(lvl),                  \
+        _DBG_LOG_HDR_STR(lvl, color_n), _DBG_LOG_END_STR,   \
+        fmt, ##__VA_ARGS__)
+#else
 #define dbg_log_line(lvl, color_n, fmt, ...)                \
     do                                                      \
     {                                                       \
@@ -140,6 +167,7 @@ extern "C" {
         _DBG_LOG_X_END;                                     \
     }                                                       \
     while (0)
+#endif /* RT_USING_TLOG */
 
 #define dbg_raw(...)         rt_kprintf(__VA_ARGS__);
 
@@ -360,6 +360,8 @@ typedef struct rt_object *rt_object_t;                  /**< Type for kernel obj
  *  - MemPool
  *  - Device
  *  - Timer
+ *  - RingQueue
+ *  - Arena
  *  - Unknown
  *  - Static
  */
@@ -376,7 +378,9 @@ enum rt_object_class_type
     RT_Object_Class_MemPool       = 0x08,      /**< The object is a memory pool. */
     RT_Object_Class_Device        = 0x09,      /**< The object is a device. */
     RT_Object_Class_Timer         = 0x0a,      /**< The object is a timer. */
-    RT_Object_Class_Unknown       = 0x0c,      /**< The object is unknown. */
+    RT_Object_Class_RingQueue     = 0x0b,      /**< The object is a ring queue. */
+    RT_Object_Class_Arena         = 0x0c,      /**< The object is an arena. */
+    RT_Object_Class_Unknown       = 0x0d,      /**< The object is unknown. */
     RT_Object_Class_Static        = 0x80       /**< The object is a static object. */
 };
 
@@ -420,11 +424,15 @@ struct rt_object_information
 #define RT_TIMER_FLAG_HARD_TIMER        0x0             /**< hard timer,the timer's callback function will be called in tick isr. */
 #define RT_TIMER_FLAG_SOFT_TIMER        0x4             /**< soft timer,the timer's callback function will be called in timer thread. */
 
+#define RT_TIMER_FLAG_ANCHORED          0x8             /**< periodic timer re-armed from the previous timeout tick, no phase drift. */
+#define RT_TIMER_FLAG_CATCH_UP          0x10            /**< anchored timer calls back the missed periods one by one, otherwise skips them. */
+
 #define RT_TIMER_CTRL_SET_TIME          0x0             /**< set timer control command */
 #define RT_TIMER_CTRL_GET_TIME          0x1             /**< get timer control command */
 #define RT_TIMER_CTRL_SET_ONESHOT       0x2             /**< change timer to one shot */
 #define RT_TIMER_CTRL_SET_PERIODIC      0x3             /**< change timer to periodic */
 #define RT_TIMER_CTRL_GET_STATE         0x4             /**< get timer run state active or deactive*/
+#define RT_TIMER_CTRL_GET_OVERRUN       0x5             /**< get the missed periods of anchored timer */
 
 #ifndef RT_TIMER_SKIP_LIST_LEVEL
 #define RT_TIMER_SKIP_LIST_LEVEL          1
@@ -449,6 +457,7 @@ struct rt_timer
 
     rt_tick_t        init_tick;                         /**< timer timeout tick */
     rt_tick_t        timeout_tick;                      /**< timeout tick */
+    rt_uint32_t      overrun;                           /**< missed periods of anchored timer */
 };
 typedef struct rt_timer *rt_timer_t;
 
@@ -473,7 +482,10 @@ typedef struct rt_timer *rt_timer_t;
 #define RT_THREAD_RUNNING               0x03                /**< Running status */
 #define RT_THREAD_BLOCK                 RT_THREAD_SUSPEND   /**< Blocked status */
 #define RT_THREAD_CLOSE                 0x04                /**< Closed status */
-#define RT_THREAD_STAT_MASK             0x0f
+#define RT_THREAD_STAT_MASK             0x07
+
+#define RT_THREAD_STAT_YIELD            0x08                /**< indicate whether remaining_tick has been reloaded since last schedule */
+#define RT_THREAD_STAT_YIELD_MASK       RT_THREAD_STAT_YIELD
 
 /**
  * thread control command definitions
@@ -482,6 +494,60 @@ typedef struct rt_timer *rt_timer_t;
 #define RT_THREAD_CTRL_CLOSE            0x01                /**< Close thread. */
 #define RT_THREAD_CTRL_CHANGE_PRIORITY  0x02                /**< Change thread priority. */
 #define RT_THREAD_CTRL_INFO             0x03                /**< Get thread information. */
+#define RT_THREAD_CTRL_BIND_CPU         0x04                /**< Set thread bind cpu. */
+
+#ifdef RT_USING_SMP
+
+#define RT_CPU_DETACHED                 RT_CPUS_NR          /**< The thread not running on cpu. */
+#define RT_CPU_MASK                     ((1 << RT_CPUS_NR) - 1) /**< All CPUs mask bit. */
+
+#ifndef RT_SCHEDULE_IPI
+#define RT_SCHEDULE_IPI                 0
+#endif
+
+/**
+ * hardware spinlock, the ticket lock of libcpu
+ */
+typedef union {
+    unsigned long slock;
+    struct __arch_tickets {
+        unsigned short owner;
+        unsigned short next;
+    } tickets;
+} rt_hw_spinlock_t;
+
+/**
+ * spinlock
+ */
+struct rt_spinlock
+{
+    rt_hw_spinlock_t lock;
+};
+
+/**
+ * CPUs definitions
+ *
+ * The threads bound to a cpu are in the ready queue of this cpu, the other
+ * threads are in the global ready queue and may run on any cpu.
+ */
+struct rt_cpu
+{
+    struct rt_thread *current_thread;
+
+    rt_uint16_t irq_nest;
+    rt_uint8_t  irq_switch_flag;
+
+    rt_uint8_t current_priority;
+    rt_list_t priority_table[RT_THREAD_PRIORITY_MAX];
+#if RT_THREAD_PRIORITY_MAX > 32
+    rt_uint32_t priority_group;
+    rt_uint8_t ready_table[32];
+#else
+    rt_uint32_t priority_group;
+#endif
+};
+
+#endif /*RT_USING_SMP*/
 
 /**
  * Thread structure
@@ -528,6 +594,33 @@ struct rt_thread
 
     struct rt_timer thread_timer;                       /**< built-in thread timer */
 
+#ifdef RT_USING_MUTEX
+    rt_list_t   taken_mutex_list;                       /**< the mutexes taken by thread */
+    struct rt_mutex *pending_mutex;                     /**< the mutex thread is waiting for */
+#endif
+
+#ifdef RT_USING_SMP
+    rt_uint8_t  bind_cpu;                               /**< thread is bind to cpu */
+    rt_uint8_t  oncpu;                                  /**< process on cpu */
+
+    rt_uint16_t scheduler_lock_nest;                    /**< scheduler lock count */
+    rt_uint16_t cpus_lock_nest;                         /**< cpus lock count */
+    rt_uint16_t critical_lock_nest;                     /**< critical lock count */
+#endif /*RT_USING_SMP*/
+
+#ifdef RT_USING_THREAD_RUNTIME
+    rt_uint64_t runtime;                                /**< total cpu cycles used by thread */
+    rt_uint32_t runtime_start;                          /**< cpu cycle of the last charge */
+    rt_tick_t   runtime_tick;                           /**< tick of the last charge */
+    rt_tick_t   runtime_index;                          /**< the window the cycles are charged in */
+    rt_uint64_t runtime_window;                         /**< cpu cycles used in current window */
+    rt_uint64_t runtime_last;                           /**< cpu cycles used in last window */
+#endif
+
+#ifdef RT_USING_ARENA
+    struct rt_arena *arena;                             /**< default arena of thread */
+#endif
+
     void (*cleanup)(struct rt_thread *tid);             /**< cleanup function when thread exit */
 
     rt_uint32_t user_data;                              /**< private user data beyond this thread */
@@ -547,6 +640,7 @@ typedef struct rt_thread *rt_thread_t;
  */
 #define RT_IPC_FLAG_FIFO                0x00            /**< FIFOed IPC. @ref IPC. */
 #define RT_IPC_FLAG_PRIO                0x01            /**< PRIOed IPC. @ref IPC. */
+#define RT_IPC_FLAG_CEILING             0x02            /**< priority ceiling mutex. @ref IPC. */
 
 #define RT_IPC_CMD_UNKNOWN              0x00            /**< unknown IPC command */
 #define RT_IPC_CMD_RESET                0x01            /**< reset IPC object */
@@ -590,8 +684,10 @@ struct rt_mutex
 
     rt_uint8_t           original_priority;             /**< priority of last thread hold the mutex */
     rt_uint8_t           hold;                          /**< numbers of thread hold the mutex */
+    rt_uint8_t           ceiling_priority;              /**< ceiling priority of RT_IPC_FLAG_CEILING mutex */
 
     struct rt_thread    *owner;                         /**< current owner of mutex */
+    rt_list_t            taken_list;                    /**< node in the taken mutex list of owner */
 };
 typedef struct rt_mutex *rt_mutex_t;
 #endif
@@ -661,6 +757,33 @@ struct rt_messagequeue
 typedef struct rt_messagequeue *rt_mq_t;
 #endif
 
+#ifdef RT_USING_RINGQUEUE
+#ifndef RT_CPU_CACHE_LINE_SZ
+#define RT_CPU_CACHE_LINE_SZ            32
+#endif
+
+/**
+ * ring queue structure, the lock-free queue of one producer and one consumer
+ */
+struct rt_ringqueue
+{
+    struct rt_object     parent;                        /**< inherit from rt_object */
+
+    rt_uint8_t          *pool;                          /**< start address of elements */
+    rt_uint32_t          elem_size;                     /**< size of each element */
+    rt_uint32_t          size;                          /**< number of elements, power of 2 */
+
+    struct rt_thread * volatile reader;                 /**< consumer thread waiting for elements */
+
+    /* the index of producer and consumer are placed in different cache lines */
+    rt_uint8_t           head_pad[RT_CPU_CACHE_LINE_SZ];
+    volatile rt_uint32_t head;                          /**< put index, written by producer only */
+    rt_uint8_t           tail_pad[RT_CPU_CACHE_LINE_SZ - sizeof(rt_uint32_t)];
+    volatile rt_uint32_t tail;                          /**< get index, written by consumer only */
+};
+typedef struct rt_ringqueue *rt_ringqueue_t;
+#endif
+
 /**@}*/
 
 /**
@@ -690,6 +813,33 @@ struct rt_memheap_item
     struct rt_memheap_item *prev_free;                  /**< prev free memheap item */
 };
 
+/*
+ * memory heap attributes, which are also the flags of rt_malloc_ex
+ */
+#define RT_MEMHEAP_ATTR_FAST            0x01            /**< fast memory, such as CCM RAM */
+#define RT_MEMHEAP_ATTR_DMA             0x02            /**< memory accessible by DMA */
+#define RT_MEMHEAP_ATTR_LARGE           0x04            /**< large memory, such as external SDRAM */
+
+#ifdef RT_USING_MEMHEAP_CACHE
+#define RT_MEMHEAP_CACHE_CLASS_NR       6               /**< number of size classes */
+
+/**
+ * size class cache of small objects on the heap
+ */
+struct rt_memheap_cache
+{
+    struct rt_memheap      *heap;                       /**< the heap which cache belongs to */
+    void                   *free_list;                  /**< free objects list */
+
+    rt_uint32_t             size;                       /**< object size of the class */
+    rt_uint32_t             total;                      /**< number of objects carved */
+    rt_uint32_t             free;                       /**< number of free objects */
+
+    rt_uint32_t             hit;                        /**< allocations from free list */
+    rt_uint32_t             miss;                       /**< allocations carving a new page */
+};
+#endif
+
 /**
  * Base structure of memory heap object
  */
@@ -702,6 +852,9 @@ struct rt_memheap
     rt_uint32_t             pool_size;                  /**< pool size */
     rt_uint32_t             available_size;             /**< available size */
     rt_uint32_t             max_used_size;              /**< maximum allocated size */
+    rt_uint32_t             max_free_size;              /**< upper bound of the largest free block */
+
+    rt_uint32_t             attr;                       /**< attributes of memory */
 
     struct rt_memheap_item *block_list;                 /**< used block list */
 
@@ -709,6 +862,51 @@ struct rt_memheap
     struct rt_memheap_item  free_header;                /**< free block list header */
 
     struct rt_semaphore     lock;                       /**< semaphore lock */
+
+#ifdef RT_USING_MEMHEAP_CACHE
+    struct rt_memheap_cache cache[RT_MEMHEAP_CACHE_CLASS_NR]; /**< small object caches */
+#endif
+#ifdef RT_USING_MEMFRAG
+    rt_uint32_t             generation;                 /**< changed on each update of blocks */
+#endif
+};
+#endif
+
+#ifdef RT_USING_MEMFRAG
+#define RT_MEMFRAG_HIST_NR              12              /**< buckets of free block histogram */
+#define RT_MEMFRAG_MAP_WIDTH            64              /**< slices in the map of region */
+
+/**
+ * walk of the blocks of heap, it is done step by step
+ */
+struct rt_mem_walk
+{
+    rt_ubase_t  start;                                  /**< start address of region */
+    rt_size_t   size;                                   /**< size of region */
+    rt_ubase_t  cursor;                                 /**< where the next step begins, 0 at beginning */
+    rt_uint32_t generation;                             /**< generation of heap when the walk begins */
+
+    void (*free_block)(struct rt_mem_walk *walk, void *addr, rt_size_t size);
+};
+
+/**
+ * fragmentation report of a heap region
+ */
+struct rt_memfrag_info
+{
+    rt_ubase_t  start;                                  /**< start address of region */
+    rt_size_t   size;                                   /**< size of region */
+
+    rt_size_t   total_free;                             /**< total size of free blocks */
+    rt_size_t   largest_free;                           /**< size of the largest free block */
+    rt_size_t   largest_free_min;                       /**< minimum of the largest free block */
+    rt_uint32_t free_blocks;                            /**< number of free blocks */
+    rt_uint16_t fragmentation;                          /**< external fragmentation in per mille */
+
+    rt_uint32_t histogram[RT_MEMFRAG_HIST_NR];          /**< free blocks of [2^(i+4), 2^(i+5)) bytes */
+    rt_uint8_t  map[RT_MEMFRAG_MAP_WIDTH];              /**< percent of free memory in each slice */
+
+    rt_tick_t   tick;                                   /**< the tick when the walk is finished */
 };
 #endif
 
@@ -724,16 +922,76 @@ struct rt_mempool
     rt_size_t        size;                              /**< size of memory pool */
 
     rt_size_t        block_size;                        /**< size of memory blocks */
+#ifdef RT_USING_MEMPOOL_LOCKFREE
+    rt_ubase_t       block_head;                        /**< tagged index of the first free block */
+#else
     rt_uint8_t      *block_list;                        /**< memory blocks list */
+#endif
 
     rt_size_t        block_total_count;                 /**< numbers of memory block */
     rt_size_t        block_free_count;                  /**< numbers of free memory block */
+    rt_size_t        block_max_used;                    /**< maximum numbers of used memory block */
 
     rt_list_t        suspend_thread;                    /**< threads pended on this resource */
 };
 typedef struct rt_mempool *rt_mp_t;
 #endif
 
+#ifdef RT_USING_ARENA
+/**
+ * the chunk of arena, the allocations follow the header
+ */
+struct rt_arena_chunk
+{
+    struct rt_arena_chunk *next;                        /**< next chunk */
+    rt_size_t              size;                        /**< size of chunk, header included */
+};
+
+/**
+ * Base structure of Arena object, the memory allocated from an arena is
+ * released all together by reset or delete
+ */
+struct rt_arena
+{
+    struct rt_object parent;                            /**< inherit from rt_object */
+
+#ifdef RT_USING_MEMPOOL
+    rt_mp_t          mp;                                /**< the chunks source, RT_NULL for heap */
+#endif
+    rt_size_t        chunk_size;                        /**< size of chunk */
+
+    rt_uint8_t      *ptr;                               /**< next free byte of current chunk */
+    rt_uint8_t      *end;                               /**< end of current chunk */
+
+    struct rt_arena_chunk *chunk_list;                  /**< chunks in use, current chunk first */
+    struct rt_arena_chunk *chunk_tail;                  /**< last chunk in use */
+    struct rt_arena_chunk *spare_list;                  /**< chunks kept for reuse */
+    struct rt_arena_chunk *large_list;                  /**< allocations larger than chunk */
+
+    rt_uint16_t      chunk_count;                       /**< numbers of chunk in use */
+    rt_uint16_t      spare_count;                       /**< numbers of spare chunk */
+
+    rt_size_t        used;                              /**< bytes allocated since last reset */
+    rt_size_t        max_used;                          /**< maximum of used bytes */
+};
+typedef struct rt_arena *rt_arena_t;
+#endif
+
+#ifdef RT_USING_DMA_BUFFER
+/**
+ * pool of DMA buffers, which are aligned and padded to the cache line
+ */
+struct rt_dma_pool
+{
+    rt_uint8_t      *start;                             /**< address of the first buffer */
+    rt_size_t        buf_size;                          /**< size of buffer, padded to cache line */
+    rt_size_t        total;                             /**< numbers of buffer */
+    rt_size_t        free_count;                        /**< numbers of free buffer */
+    void            *free_list;                         /**< free buffers list */
+};
+typedef struct rt_dma_pool *rt_dma_pool_t;
+#endif
+
 /**@}*/
 
 #ifdef RT_USING_DEVICE
@@ -40,6 +40,20 @@ extern "C" {
 #define RT_CPU_CACHE_LINE_SZ    32
 #endif
 
+/*
+ * memory barrier between the lock-free producer and consumer, the BSP may
+ * define it for the weakly ordered or multi-core cpu
+ */
+#ifndef rt_hw_dmb
+#if defined(__GNUC__)
+#define rt_hw_dmb()             __sync_synchronize()
+#elif defined(__CC_ARM)
+#define rt_hw_dmb()             __schedule_barrier()
+#else
+#define rt_hw_dmb()
+#endif
+#endif
+
 enum RT_HW_CACHE_OPS
 {
     RT_HW_CACHE_FLUSH      = 0x01,
@@ -94,15 +108,45 @@ rt_isr_handler_t rt_hw_interrupt_install(int              vector,
                                          void            *param,
                                          const char      *name);
 
+#ifdef RT_USING_SMP
+rt_base_t rt_hw_local_irq_disable(void);
+void rt_hw_local_irq_enable(rt_base_t level);
+
+/* disable interrupt means locking all cpus on SMP */
+#define rt_hw_interrupt_disable rt_cpus_lock
+#define rt_hw_interrupt_enable  rt_cpus_unlock
+#else
 rt_base_t rt_hw_interrupt_disable(void);
 void rt_hw_interrupt_enable(rt_base_t level);
 
+#ifdef RT_USING_IRQ_LATENCY
+/*
+ * measure the interrupt disabled sections by call site, the real functions
+ * are invoked as (rt_hw_interrupt_disable)() in irqlat.c
+ */
+rt_base_t rt_irqlat_disable(const char *func, int line);
+void rt_irqlat_enable(rt_base_t level);
+
+#define rt_hw_interrupt_disable()       rt_irqlat_disable(__FUNCTION__, __LINE__)
+#define rt_hw_interrupt_enable(level)   rt_irqlat_enable(level)
+#endif
+#endif /*RT_USING_SMP*/
+
 /*
  * Context interfaces
  */
+#ifdef RT_USING_SMP
+void rt_hw_context_switch(rt_ubase_t from, rt_ubase_t to, struct rt_thread *to_thread);
+void rt_hw_context_switch_to(rt_ubase_t to, struct rt_thread *to_thread);
+void rt_hw_context_switch_interrupt(void *context,
+                                    rt_ubase_t from,
+                                    rt_ubase_t to,
+                                    struct rt_thread *to_thread);
+#else
 void rt_hw_context_switch(rt_ubase_t from, rt_ubase_t to);
 void rt_hw_context_switch_to(rt_ubase_t to);
 void rt_hw_context_switch_interrupt(rt_ubase_t from, rt_ubase_t to);
+#endif /*RT_USING_SMP*/
 
 void rt_hw_console_output(const char *str);
 
@@ -119,12 +163,72 @@ void rt_hw_exception_install(rt_err_t (*exception_handle)(void *context));
  */
 void rt_hw_us_delay(rt_uint32_t us);
 
+#ifdef RT_USING_TICKLESS
+/*
+ * tickless interfaces
+ */
+rt_tick_t rt_hw_tickless_sleep(rt_tick_t tick);
+#endif
+
+#ifdef RT_USING_HW_CYCLE
+/*
+ * cpu cycle counter interfaces
+ */
+rt_uint32_t rt_hw_cycle_get(void);
+#endif
+
+#ifdef RT_USING_IRQ_LATENCY
+/*
+ * the cycles from the request of current interrupt to the entry of its
+ * service routine, RT_UINT32_MAX if it is unknown
+ */
+rt_uint32_t rt_hw_irq_latency_get(void);
+#endif
+
+#ifdef RT_USING_SMP
+/*
+ * spinlock interfaces
+ */
+void rt_hw_spin_lock(rt_hw_spinlock_t *lock);
+void rt_hw_spin_unlock(rt_hw_spinlock_t *lock);
+
+int rt_hw_cpu_id(void);
+
+extern rt_hw_spinlock_t _cpus_lock;
+
+#define __RT_HW_SPIN_LOCK_INITIALIZER(lockname) {0}
+
+#define __RT_HW_SPIN_LOCK_UNLOCKED(lockname)    \
+    (rt_hw_spinlock_t) __RT_HW_SPIN_LOCK_INITIALIZER(lockname)
+
+#define RT_DEFINE_SPINLOCK(x)  rt_hw_spinlock_t x = __RT_HW_SPIN_LOCK_UNLOCKED(x)
+#define RT_DECLARE_SPINLOCK(x)
+
+/*
+ * ipi interfaces
+ */
+void rt_hw_ipi_send(int ipi_vector, unsigned int cpu_mask);
+void rt_hw_ipi_handler_install(int ipi_vector, rt_isr_handler_t ipi_isr_handler);
+
+/*
+ * boot the secondary cpus
+ */
+void rt_hw_secondary_cpu_up(void);
+
+/*
+ * idle function of the secondary cpus
+ */
+void rt_hw_secondary_cpu_idle_exec(void);
+#else
+
 #define RT_DEFINE_SPINLOCK(x)
 #define RT_DECLARE_SPINLOCK(x)    rt_ubase_t x
 
 #define rt_hw_spin_lock(lock)     *(lock) = rt_hw_interrupt_disable()
 #define rt_hw_spin_unlock(lock)   rt_hw_interrupt_enable(*(lock))
 
+#endif /*RT_USING_SMP*/
+
 #ifdef __cplusplus
 }
 #endif
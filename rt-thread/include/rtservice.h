@@ -140,6 +140,26 @@ rt_inline unsigned int rt_list_len(const rt_list_t *l)
     return len;
 }
 
+/**
+ * @brief move all nodes of a list to the tail of another list
+ *
+ * @param l the list to receive the nodes
+ * @param n the list to be moved, it's empty after this operation
+ */
+rt_inline void rt_list_splice(rt_list_t *l, rt_list_t *n)
+{
+    if (n->next == n)
+        return;
+
+    n->next->prev = l->prev;
+    l->prev->next = n->next;
+
+    n->prev->next = l;
+    l->prev = n->prev;
+
+    n->next = n->prev = n;
+}
+
 /**
  * @brief get the struct for this entry
  * @param node the entry point
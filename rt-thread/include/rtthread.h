@@ -58,6 +58,10 @@ void rt_object_detach_sethook(void (*hook)(struct rt_object *object));
 void rt_object_trytake_sethook(void (*hook)(struct rt_object *object));
 void rt_object_take_sethook(void (*hook)(struct rt_object *object));
 void rt_object_put_sethook(void (*hook)(struct rt_object *object));
+void (*rt_object_attach_gethook(void))(struct rt_object *object);
+void (*rt_object_trytake_gethook(void))(struct rt_object *object);
+void (*rt_object_take_gethook(void))(struct rt_object *object);
+void (*rt_object_put_gethook(void))(struct rt_object *object);
 #endif
 
 /**@}*/
@@ -99,10 +103,15 @@ rt_err_t rt_timer_control(rt_timer_t timer, int cmd, void *arg);
 
 rt_tick_t rt_timer_next_timeout_tick(void);
 void rt_timer_check(void);
+#ifdef RT_TIMER_USING_IRQOFF_STAT
+void rt_timer_irqoff_get(rt_uint32_t *last, rt_uint32_t *max);
+#endif
 
 #ifdef RT_USING_HOOK
 void rt_timer_enter_sethook(void (*hook)(struct rt_timer *timer));
 void rt_timer_exit_sethook(void (*hook)(struct rt_timer *timer));
+void (*rt_timer_enter_gethook(void))(struct rt_timer *timer);
+void (*rt_timer_exit_gethook(void))(struct rt_timer *timer);
 #endif
 
 /**@}*/
@@ -145,10 +154,17 @@ rt_err_t rt_thread_suspend(rt_thread_t thread);
 rt_err_t rt_thread_resume(rt_thread_t thread);
 void rt_thread_timeout(void *parameter);
 
+#ifdef RT_USING_THREAD_RUNTIME
+rt_uint64_t rt_thread_runtime_get(rt_thread_t thread);
+rt_uint32_t rt_thread_cpu_usage_get(rt_thread_t thread);
+#endif
+
 #ifdef RT_USING_HOOK
 void rt_thread_suspend_sethook(void (*hook)(rt_thread_t thread));
 void rt_thread_resume_sethook (void (*hook)(rt_thread_t thread));
 void rt_thread_inited_sethook (void (*hook)(rt_thread_t thread));
+void (*rt_thread_suspend_gethook(void))(rt_thread_t thread);
+void (*rt_thread_resume_gethook(void))(rt_thread_t thread);
 #endif
 
 /*
@@ -170,6 +186,10 @@ void rt_system_scheduler_start(void);
 
 void rt_schedule(void);
 void rt_schedule_insert_thread(struct rt_thread *thread);
+#ifdef RT_USING_THREAD_RUNTIME
+rt_uint32_t rt_scheduler_runtime_update(struct rt_thread *thread);
+void rt_scheduler_runtime_tick(void);
+#endif
 void rt_schedule_remove_thread(struct rt_thread *thread);
 
 void rt_enter_critical(void);
@@ -178,8 +198,39 @@ rt_uint16_t rt_critical_level(void);
 
 #ifdef RT_USING_HOOK
 void rt_scheduler_sethook(void (*hook)(rt_thread_t from, rt_thread_t to));
+void (*rt_scheduler_gethook(void))(rt_thread_t from, rt_thread_t to);
 #endif
 
+#ifdef RT_USING_SMP
+void rt_scheduler_ipi_handler(int vector, void *param);
+void rt_scheduler_do_irq_switch(void *context);
+
+/*
+ * cpu service
+ */
+struct rt_cpu *rt_cpu_self(void);
+struct rt_cpu *rt_cpu_index(int index);
+
+rt_base_t rt_cpus_lock(void);
+void rt_cpus_unlock(rt_base_t level);
+void rt_cpus_lock_status_restore(struct rt_thread *thread);
+
+/*
+ * spinlock service
+ */
+void rt_spin_lock_init(struct rt_spinlock *lock);
+void rt_spin_lock(struct rt_spinlock *lock);
+void rt_spin_unlock(struct rt_spinlock *lock);
+rt_base_t rt_spin_lock_irqsave(struct rt_spinlock *lock);
+void rt_spin_unlock_irqrestore(struct rt_spinlock *lock, rt_base_t level);
+#else
+#define rt_spin_lock_init(lock)                 /* nothing */
+#define rt_spin_lock(lock)                      rt_enter_critical()
+#define rt_spin_unlock(lock)                    rt_exit_critical()
+#define rt_spin_lock_irqsave(lock)              rt_hw_interrupt_disable()
+#define rt_spin_unlock_irqrestore(lock, level)  rt_hw_interrupt_enable(level)
+#endif /*RT_USING_SMP*/
+
 /**@}*/
 
 /**
@@ -208,6 +259,8 @@ rt_err_t rt_mp_delete(rt_mp_t mp);
 
 void *rt_mp_alloc(rt_mp_t mp, rt_int32_t time);
 void rt_mp_free(void *block);
+rt_size_t rt_mp_alloc_batch(rt_mp_t mp, void **blocks, rt_size_t count, rt_int32_t time);
+void rt_mp_free_batch(void **blocks, rt_size_t count);
 
 #ifdef RT_USING_HOOK
 void rt_mp_alloc_sethook(void (*hook)(struct rt_mempool *mp, void *block));
@@ -216,6 +269,44 @@ void rt_mp_free_sethook(void (*hook)(struct rt_mempool *mp, void *block));
 
 #endif
 
+#ifdef RT_USING_ARENA
+/*
+ * arena interface
+ */
+#ifdef RT_USING_HEAP
+rt_err_t rt_arena_init(rt_arena_t arena, const char *name, rt_size_t chunk_size);
+rt_arena_t rt_arena_create(const char *name, rt_size_t chunk_size);
+rt_err_t rt_arena_delete(rt_arena_t arena);
+#endif
+#ifdef RT_USING_MEMPOOL
+rt_err_t rt_arena_init_mp(rt_arena_t arena, const char *name, rt_mp_t mp);
+#endif
+rt_err_t rt_arena_detach(rt_arena_t arena);
+
+void *rt_arena_alloc(rt_arena_t arena, rt_size_t size);
+void *rt_arena_calloc(rt_arena_t arena, rt_size_t count, rt_size_t size);
+void rt_arena_reset(rt_arena_t arena);
+void rt_arena_trim(rt_arena_t arena);
+
+rt_arena_t rt_arena_set_default(rt_arena_t arena);
+rt_arena_t rt_arena_get_default(void);
+#endif
+
+#ifdef RT_USING_DMA_BUFFER
+/*
+ * DMA buffer interface
+ */
+#ifdef RT_USING_HEAP
+void *rt_dma_malloc(rt_size_t size);
+void rt_dma_free(void *ptr);
+#endif
+rt_err_t rt_dma_pool_init(rt_dma_pool_t pool, void *start, rt_size_t size, rt_size_t buf_size);
+void *rt_dma_pool_alloc(rt_dma_pool_t pool);
+void rt_dma_pool_free(rt_dma_pool_t pool, void *buf);
+void rt_dma_cache_flush(void *buf, rt_size_t size);
+void rt_dma_cache_invalidate(void *buf, rt_size_t size);
+#endif
+
 #ifdef RT_USING_HEAP
 /*
  * heap memory interface
@@ -236,11 +327,30 @@ void rt_memory_info(rt_uint32_t *total,
 #ifdef RT_USING_SLAB
 void *rt_page_alloc(rt_size_t npages);
 void rt_page_free(void *addr, rt_size_t npages);
+rt_size_t rt_slab_reclaim(rt_tick_t age);
+#ifdef RT_USING_SLAB_RECLAIM
+void rt_slab_reclaim_idle(void);
+#endif
 #endif
 
 #ifdef RT_USING_HOOK
 void rt_malloc_sethook(void (*hook)(void *ptr, rt_size_t size));
 void rt_free_sethook(void (*hook)(void *ptr));
+void (*rt_malloc_gethook(void))(void *ptr, rt_size_t size);
+void (*rt_free_gethook(void))(void *ptr);
+#endif
+
+#ifdef RT_USING_MEMSTAT
+int rt_memstat_init(void);
+void rt_memstat_thread_drop(rt_thread_t thread);
+rt_err_t rt_memstat_get(rt_thread_t thread,
+                        rt_uint32_t *live,
+                        rt_uint32_t *peak,
+                        rt_uint32_t *count);
+#endif
+
+#ifdef RT_USING_MEMFRAG
+rt_err_t rt_memory_walk(struct rt_mem_walk *walk, rt_size_t count);
 #endif
 
 #endif
@@ -254,9 +364,27 @@ rt_err_t rt_memheap_init(struct rt_memheap *memheap,
                          void              *start_addr,
                          rt_size_t         size);
 rt_err_t rt_memheap_detach(struct rt_memheap *heap);
+rt_err_t rt_memheap_set_attr(struct rt_memheap *heap, rt_uint32_t attr);
 void *rt_memheap_alloc(struct rt_memheap *heap, rt_size_t size);
+void *rt_memheap_alloc_align(struct rt_memheap *heap, rt_size_t size, rt_size_t align);
 void *rt_memheap_realloc(struct rt_memheap *heap, void *ptr, rt_size_t newsize);
 void rt_memheap_free(void *ptr);
+
+#ifdef RT_USING_MEMHEAP_AS_HEAP
+void *rt_malloc_ex(rt_size_t size, rt_uint32_t flags);
+#endif
+
+#ifdef RT_USING_MEMFRAG
+rt_err_t rt_memheap_walk(struct rt_memheap *heap, struct rt_mem_walk *walk, rt_size_t count);
+#endif
+#endif
+
+#ifdef RT_USING_MEMFRAG
+/*
+ * heap fragmentation analyzer interface
+ */
+void rt_memfrag_step(void);
+rt_err_t rt_memfrag_get(const char *name, struct rt_memfrag_info *info);
 #endif
 
 /**@}*/
@@ -293,6 +421,11 @@ rt_err_t rt_mutex_init(rt_mutex_t mutex, const char *name, rt_uint8_t flag);
 rt_err_t rt_mutex_detach(rt_mutex_t mutex);
 rt_mutex_t rt_mutex_create(const char *name, rt_uint8_t flag);
 rt_err_t rt_mutex_delete(rt_mutex_t mutex);
+rt_err_t rt_mutex_init_ceiling(rt_mutex_t   mutex,
+                               const char  *name,
+                               rt_uint8_t   flag,
+                               rt_uint8_t   ceiling);
+rt_mutex_t rt_mutex_create_ceiling(const char *name, rt_uint8_t flag, rt_uint8_t ceiling);
 
 rt_err_t rt_mutex_take(rt_mutex_t mutex, rt_int32_t time);
 rt_err_t rt_mutex_release(rt_mutex_t mutex);
@@ -335,6 +468,14 @@ rt_err_t rt_mb_send_wait(rt_mailbox_t mb,
                          rt_ubase_t  value,
                          rt_int32_t   timeout);
 rt_err_t rt_mb_recv(rt_mailbox_t mb, rt_ubase_t *value, rt_int32_t timeout);
+rt_size_t rt_mb_send_batch(rt_mailbox_t      mb,
+                           const rt_ubase_t *values,
+                           rt_size_t         count,
+                           rt_int32_t        timeout);
+rt_size_t rt_mb_recv_batch(rt_mailbox_t mb,
+                           rt_ubase_t  *values,
+                           rt_size_t    count,
+                           rt_int32_t   timeout);
 rt_err_t rt_mb_control(rt_mailbox_t mb, int cmd, void *arg);
 #endif
 
@@ -365,9 +506,46 @@ rt_err_t rt_mq_recv(rt_mq_t    mq,
                     void      *buffer,
                     rt_size_t  size,
                     rt_int32_t timeout);
+rt_size_t rt_mq_send_batch(rt_mq_t     mq,
+                           const void *buffer,
+                           rt_size_t   size,
+                           rt_size_t   count,
+                           rt_int32_t  timeout);
+rt_size_t rt_mq_recv_batch(rt_mq_t    mq,
+                           void      *buffer,
+                           rt_size_t  size,
+                           rt_size_t  count,
+                           rt_int32_t timeout);
 rt_err_t rt_mq_control(rt_mq_t mq, int cmd, void *arg);
 #endif
 
+#ifdef RT_USING_RINGQUEUE
+/*
+ * ring queue interface
+ */
+rt_err_t rt_ringqueue_init(rt_ringqueue_t rq,
+                           const char    *name,
+                           void          *pool,
+                           rt_size_t      elem_size,
+                           rt_size_t      size);
+rt_err_t rt_ringqueue_detach(rt_ringqueue_t rq);
+rt_ringqueue_t rt_ringqueue_create(const char *name,
+                                   rt_size_t   elem_size,
+                                   rt_size_t   size);
+rt_err_t rt_ringqueue_delete(rt_ringqueue_t rq);
+
+rt_size_t rt_ringqueue_put(rt_ringqueue_t rq, const void *buffer, rt_size_t count);
+rt_size_t rt_ringqueue_get(rt_ringqueue_t rq,
+                           void          *buffer,
+                           rt_size_t      count,
+                           rt_int32_t     timeout);
+rt_size_t rt_ringqueue_reserve(rt_ringqueue_t rq, void **ptr);
+void rt_ringqueue_commit(rt_ringqueue_t rq, rt_size_t count);
+rt_size_t rt_ringqueue_peek(rt_ringqueue_t rq, void **ptr, rt_int32_t timeout);
+void rt_ringqueue_consume(rt_ringqueue_t rq, rt_size_t count);
+rt_size_t rt_ringqueue_count(rt_ringqueue_t rq);
+#endif
+
 /**@}*/
 
 #ifdef RT_USING_DEVICE
@@ -433,6 +611,18 @@ rt_uint8_t rt_interrupt_get_nest(void);
 #ifdef RT_USING_HOOK
 void rt_interrupt_enter_sethook(void (*hook)(void));
 void rt_interrupt_leave_sethook(void (*hook)(void));
+void (*rt_interrupt_enter_gethook(void))(void);
+void (*rt_interrupt_leave_gethook(void))(void);
+#endif
+
+#ifdef RT_USING_IRQ_LATENCY
+/*
+ * the measurement of interrupt latency and interrupt disabled sections
+ */
+void rt_irqlat_isr_enter(void);
+void rt_irqlat_sleep_enter(void);
+void rt_irqlat_sleep_exit(void);
+void rt_irqlat_reset(void);
 #endif
 
 #ifdef RT_USING_COMPONENTS_INIT
@@ -455,6 +645,20 @@ void rt_components_board_init(void);
 #else
 void rt_kprintf(const char *fmt, ...);
 void rt_kputs(const char *str);
+
+#ifdef RT_USING_ASYNC_LOG
+int rt_async_log_init(void);
+void rt_async_log_line(rt_uint8_t level, const char *hdr, const char *end, const char *fmt, ...);
+rt_err_t rt_async_log_vprintf(const char *fmt, va_list args);
+void rt_async_log_sync(void);
+rt_uint32_t rt_async_log_dropped(void);
+#endif
+#endif
+
+#ifdef RT_USING_TLOG
+int rt_tlog_init(void);
+void rt_tlog_write(rt_uint8_t level, const char *fmt, ...);
+void rt_tlog_clear(void);
 #endif
 rt_int32_t rt_vsprintf(char *dest, const char *format, va_list arg_ptr);
 rt_int32_t rt_vsnprintf(char *buf, rt_size_t size, const char *fmt, va_list args);
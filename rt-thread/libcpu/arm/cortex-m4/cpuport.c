@@ -382,6 +382,11 @@ void rt_hw_hard_fault_exception(struct exception_info *exception_info)
         if (result == RT_EOK) return;
     }
 
+#ifdef RT_USING_ASYNC_LOG
+    /* output the pending logs, and the following ones synchronously */
+    rt_async_log_sync();
+#endif
+
     rt_kprintf("psr: 0x%08x\n", context->exception_stack_frame.psr);
 
     rt_kprintf("r00: 0x%08x\n", context->exception_stack_frame.r0);
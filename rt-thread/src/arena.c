@@ -0,0 +1,492 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2021-09-24     RT-Thread    the first version
+ *
+ * Anotation：arena（内存区域）用于一次请求中分配的大量小对象。分配只需移动当前块中的
+ * 指针，不需要堆的信号量；这些内存不单独释放，而是通过 rt_arena_reset 一次性回收。
+ * 块来自堆或内存池，复位时使用中的块整体挂到备用链表，时间为 O(1)，备用块留给下次分配。
+ * arena 不加锁，同一时刻只能由一个线程使用。
+ */
+
+#include <rthw.h>
+#include <rtthread.h>
+
+#ifdef RT_USING_ARENA
+
+/* the allocations of chunk start after the aligned header */
+#define ARENA_CHUNK_HEAD    RT_ALIGN(sizeof(struct rt_arena_chunk), RT_ALIGN_SIZE)
+#define ARENA_CHUNK_MIN     (ARENA_CHUNK_HEAD + 16 * RT_ALIGN_SIZE)
+
+static void _rt_arena_setup(rt_arena_t arena, rt_size_t chunk_size)
+{
+    arena->chunk_size  = chunk_size;
+    arena->ptr         = RT_NULL;
+    arena->end         = RT_NULL;
+    arena->chunk_list  = RT_NULL;
+    arena->chunk_tail  = RT_NULL;
+    arena->spare_list  = RT_NULL;
+    arena->large_list  = RT_NULL;
+    arena->chunk_count = 0;
+    arena->spare_count = 0;
+    arena->used        = 0;
+    arena->max_used    = 0;
+}
+
+static struct rt_arena_chunk *_rt_arena_chunk_alloc(rt_arena_t arena)
+{
+    struct rt_arena_chunk *chunk;
+
+    /* reuse the spare chunk first */
+    chunk = arena->spare_list;
+    if (chunk != RT_NULL)
+    {
+        arena->spare_list = chunk->next;
+        arena->spare_count --;
+
+        return chunk;
+    }
+
+#ifdef RT_USING_MEMPOOL
+    if (arena->mp != RT_NULL)
+    {
+        /* never wait for the pool, just like the heap */
+        chunk = (struct rt_arena_chunk *)rt_mp_alloc(arena->mp, RT_WAITING_NO);
+    }
+    else
+#endif
+    {
+#ifdef RT_USING_HEAP
+        chunk = (struct rt_arena_chunk *)rt_malloc(arena->chunk_size);
+#endif
+    }
+
+    if (chunk != RT_NULL)
+    {
+        RT_ASSERT(((rt_ubase_t)chunk & (RT_ALIGN_SIZE - 1)) == 0);
+        chunk->size = arena->chunk_size;
+    }
+
+    return chunk;
+}
+
+static void _rt_arena_chunk_free(rt_arena_t arena, struct rt_arena_chunk *chunk)
+{
+#ifdef RT_USING_MEMPOOL
+    if (arena->mp != RT_NULL)
+    {
+        rt_mp_free(chunk);
+
+        return;
+    }
+#endif
+#ifdef RT_USING_HEAP
+    rt_free(chunk);
+#endif
+}
+
+rt_inline void _rt_arena_used(rt_arena_t arena, rt_size_t size)
+{
+    arena->used += size;
+    if (arena->used > arena->max_used)
+        arena->max_used = arena->used;
+}
+
+/*
+ * the current chunk is full, allocate from a new chunk or from heap when the
+ * size is larger than chunk.
+ */
+static void *_rt_arena_alloc_slow(rt_arena_t arena, rt_size_t size)
+{
+    struct rt_arena_chunk *chunk;
+
+    if (size > arena->chunk_size - ARENA_CHUNK_HEAD)
+    {
+#ifdef RT_USING_HEAP
+        /* the large block is released by reset one by one */
+        chunk = (struct rt_arena_chunk *)rt_malloc(ARENA_CHUNK_HEAD + size);
+        if (chunk == RT_NULL)
+            return RT_NULL;
+
+        chunk->size = ARENA_CHUNK_HEAD + size;
+        chunk->next = arena->large_list;
+        arena->large_list = chunk;
+        _rt_arena_used(arena, size);
+
+        return (rt_uint8_t *)chunk + ARENA_CHUNK_HEAD;
+#else
+        return RT_NULL;
+#endif
+    }
+
+    chunk = _rt_arena_chunk_alloc(arena);
+    if (chunk == RT_NULL)
+        return RT_NULL;
+
+    /* the new chunk becomes the current chunk, the rest of old one is dropped */
+    chunk->next = arena->chunk_list;
+    if (arena->chunk_list == RT_NULL)
+        arena->chunk_tail = chunk;
+    arena->chunk_list = chunk;
+    arena->chunk_count ++;
+
+    arena->ptr = (rt_uint8_t *)chunk + ARENA_CHUNK_HEAD + size;
+    arena->end = (rt_uint8_t *)chunk + chunk->size;
+    _rt_arena_used(arena, size);
+
+    return (rt_uint8_t *)chunk + ARENA_CHUNK_HEAD;
+}
+
+/*
+ * the arena is going away, it must not be left as the default arena of any
+ * thread, not only the current one.
+ */
+static void _rt_arena_unset_default(rt_arena_t arena)
+{
+    register rt_base_t level;
+    struct rt_object_information *information;
+    struct rt_list_node *node;
+    struct rt_thread *thread;
+
+    information = rt_object_get_information(RT_Object_Class_Thread);
+    RT_ASSERT(information != RT_NULL);
+
+    level = rt_hw_interrupt_disable();
+    for (node = information->object_list.next; node != &(information->object_list); node = node->next)
+    {
+        thread = rt_list_entry(node, struct rt_thread, list);
+        if (thread->arena == arena)
+            thread->arena = RT_NULL;
+    }
+    rt_hw_interrupt_enable(level);
+}
+
+/**
+ * @addtogroup MM
+ */
+
+/**@{*/
+
+#ifdef RT_USING_HEAP
+/**
+ * This function will initialize an arena object, the chunks of arena are
+ * allocated from heap.
+ *
+ * @param arena the arena object
+ * @param name the name of arena
+ * @param chunk_size the size of each chunk
+ *
+ * @return RT_EOK
+ */
+rt_err_t rt_arena_init(rt_arena_t arena, const char *name, rt_size_t chunk_size)
+{
+    /* parameter check */
+    RT_ASSERT(arena != RT_NULL);
+    RT_ASSERT(chunk_size >= ARENA_CHUNK_MIN);
+
+    /* initialize object */
+    rt_object_init(&(arena->parent), RT_Object_Class_Arena, name);
+
+#ifdef RT_USING_MEMPOOL
+    arena->mp = RT_NULL;
+#endif
+    _rt_arena_setup(arena, RT_ALIGN_DOWN(chunk_size, RT_ALIGN_SIZE));
+
+    return RT_EOK;
+}
+
+/**
+ * This function will create an arena object, the chunks of arena are
+ * allocated from heap.
+ *
+ * @param name the name of arena
+ * @param chunk_size the size of each chunk
+ *
+ * @return the created arena, RT_NULL on error happen
+ */
+rt_arena_t rt_arena_create(const char *name, rt_size_t chunk_size)
+{
+    struct rt_arena *arena;
+
+    RT_DEBUG_NOT_IN_INTERRUPT;
+
+    /* parameter check */
+    RT_ASSERT(chunk_size >= ARENA_CHUNK_MIN);
+
+    /* allocate object */
+    arena = (rt_arena_t)rt_object_allocate(RT_Object_Class_Arena, name);
+    if (arena == RT_NULL)
+        return arena;
+
+#ifdef RT_USING_MEMPOOL
+    arena->mp = RT_NULL;
+#endif
+    _rt_arena_setup(arena, RT_ALIGN_DOWN(chunk_size, RT_ALIGN_SIZE));
+
+    return arena;
+}
+
+/**
+ * This function will delete an arena object and release all of its memory.
+ *
+ * @param arena the arena object
+ *
+ * @return RT_EOK
+ */
+rt_err_t rt_arena_delete(rt_arena_t arena)
+{
+    RT_DEBUG_NOT_IN_INTERRUPT;
+
+    /* parameter check */
+    RT_ASSERT(arena != RT_NULL);
+    RT_ASSERT(rt_object_get_type(&arena->parent) == RT_Object_Class_Arena);
+    RT_ASSERT(rt_object_is_systemobject(&arena->parent) == RT_FALSE);
+
+    rt_arena_reset(arena);
+    rt_arena_trim(arena);
+
+    _rt_arena_unset_default(arena);
+
+    /* delete arena object */
+    rt_object_delete(&(arena->parent));
+
+    return RT_EOK;
+}
+#endif
+
+#ifdef RT_USING_MEMPOOL
+/**
+ * This function will initialize an arena object, the chunks of arena are
+ * the blocks of a memory pool.
+ *
+ * @param arena the arena object
+ * @param name the name of arena
+ * @param mp the memory pool which the chunks are allocated from
+ *
+ * @return RT_EOK
+ */
+rt_err_t rt_arena_init_mp(rt_arena_t arena, const char *name, rt_mp_t mp)
+{
+    /* parameter check */
+    RT_ASSERT(arena != RT_NULL);
+    RT_ASSERT(mp != RT_NULL);
+    RT_ASSERT(mp->block_size >= ARENA_CHUNK_MIN);
+
+    /* initialize object */
+    rt_object_init(&(arena->parent), RT_Object_Class_Arena, name);
+
+    arena->mp = mp;
+    _rt_arena_setup(arena, RT_ALIGN_DOWN(mp->block_size, RT_ALIGN_SIZE));
+
+    return RT_EOK;
+}
+#endif
+
+/**
+ * This function will detach an arena object from resource management and
+ * release all of its memory.
+ *
+ * @param arena the arena object
+ *
+ * @return RT_EOK
+ */
+rt_err_t rt_arena_detach(rt_arena_t arena)
+{
+    /* parameter check */
+    RT_ASSERT(arena != RT_NULL);
+    RT_ASSERT(rt_object_get_type(&arena->parent) == RT_Object_Class_Arena);
+    RT_ASSERT(rt_object_is_systemobject(&arena->parent));
+
+    rt_arena_reset(arena);
+    rt_arena_trim(arena);
+
+    _rt_arena_unset_default(arena);
+
+    /* detach arena object */
+    rt_object_detach(&(arena->parent));
+
+    return RT_EOK;
+}
+
+/**
+ * This function will allocate memory from an arena. The memory can not be
+ * released alone, it is released by rt_arena_reset.
+ *
+ * @param arena the arena object, RT_NULL for the default arena of current thread
+ * @param size the size of memory
+ *
+ * @return the allocated memory, RT_NULL on failure
+ */
+void *rt_arena_alloc(rt_arena_t arena, rt_size_t size)
+{
+    rt_uint8_t *ptr;
+
+    if (arena == RT_NULL)
+    {
+        RT_DEBUG_NOT_IN_INTERRUPT;
+
+        arena = rt_thread_self()->arena;
+        if (arena == RT_NULL)
+            return RT_NULL;
+    }
+
+    /* the aligned size or the size with chunk header would wrap around */
+    if (size == 0 || size > ~(rt_size_t)0 - ARENA_CHUNK_HEAD - RT_ALIGN_SIZE)
+        return RT_NULL;
+
+    size = RT_ALIGN(size, RT_ALIGN_SIZE);
+
+    /* allocate from current chunk by moving the pointer */
+    ptr = arena->ptr;
+    if (size <= (rt_size_t)(arena->end - ptr))
+    {
+        arena->ptr = ptr + size;
+        _rt_arena_used(arena, size);
+
+        return ptr;
+    }
+
+    return _rt_arena_alloc_slow(arena, size);
+}
+
+/**
+ * This function will allocate memory for an array from an arena, and the
+ * memory is set to zero.
+ *
+ * @param arena the arena object, RT_NULL for the default arena of current thread
+ * @param count the number of objects
+ * @param size the size of one object
+ *
+ * @return the allocated memory, RT_NULL on failure
+ */
+void *rt_arena_calloc(rt_arena_t arena, rt_size_t count, rt_size_t size)
+{
+    void *ptr;
+
+    if (size != 0 && count > ~(rt_size_t)0 / size)
+        return RT_NULL;
+
+    ptr = rt_arena_alloc(arena, count * size);
+    if (ptr != RT_NULL)
+        rt_memset(ptr, 0, count * size);
+
+    return ptr;
+}
+
+/**
+ * This function will release all of the memory allocated from an arena. The
+ * chunks are kept for the following allocations, only the blocks larger than
+ * chunk are freed one by one.
+ *
+ * @param arena the arena object, RT_NULL for the default arena of current thread
+ */
+void rt_arena_reset(rt_arena_t arena)
+{
+    struct rt_arena_chunk *chunk;
+
+    if (arena == RT_NULL)
+    {
+        arena = rt_thread_self()->arena;
+        if (arena == RT_NULL)
+            return;
+    }
+
+    /* move the whole list of chunks in use to the spare list */
+    if (arena->chunk_list != RT_NULL)
+    {
+        arena->chunk_tail->next = arena->spare_list;
+        arena->spare_list  = arena->chunk_list;
+        arena->spare_count += arena->chunk_count;
+
+        arena->chunk_list  = RT_NULL;
+        arena->chunk_tail  = RT_NULL;
+        arena->chunk_count = 0;
+    }
+
+    while (arena->large_list != RT_NULL)
+    {
+        chunk = arena->large_list;
+        arena->large_list = chunk->next;
+#ifdef RT_USING_HEAP
+        rt_free(chunk);
+#endif
+    }
+
+    arena->ptr  = RT_NULL;
+    arena->end  = RT_NULL;
+    arena->used = 0;
+}
+
+/**
+ * This function will release the spare chunks of an arena to heap or memory
+ * pool.
+ *
+ * @param arena the arena object, RT_NULL for the default arena of current thread
+ */
+void rt_arena_trim(rt_arena_t arena)
+{
+    struct rt_arena_chunk *chunk;
+
+    if (arena == RT_NULL)
+    {
+        arena = rt_thread_self()->arena;
+        if (arena == RT_NULL)
+            return;
+    }
+
+    while (arena->spare_list != RT_NULL)
+    {
+        chunk = arena->spare_list;
+        arena->spare_list = chunk->next;
+        _rt_arena_chunk_free(arena, chunk);
+    }
+    arena->spare_count = 0;
+}
+
+/**
+ * This function will set the default arena of current thread, which is used
+ * when RT_NULL is passed to rt_arena_alloc.
+ *
+ * @param arena the arena object, RT_NULL to clear the default arena
+ *
+ * @return the previous default arena
+ */
+rt_arena_t rt_arena_set_default(rt_arena_t arena)
+{
+    rt_thread_t thread;
+    rt_arena_t old;
+
+    RT_DEBUG_NOT_IN_INTERRUPT;
+
+    thread = rt_thread_self();
+    RT_ASSERT(thread != RT_NULL);
+
+    old = thread->arena;
+    thread->arena = arena;
+
+    return old;
+}
+
+/**
+ * This function will get the default arena of current thread.
+ *
+ * @return the default arena, RT_NULL if it is not set
+ */
+rt_arena_t rt_arena_get_default(void)
+{
+    rt_thread_t thread;
+
+    thread = rt_thread_self();
+    if (thread == RT_NULL)
+        return RT_NULL;
+
+    return thread->arena;
+}
+
+/**@}*/
+
+#endif /* RT_USING_ARENA */
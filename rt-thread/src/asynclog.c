@@ -0,0 +1,537 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2021-09-28     RT-Thread    the first version
+ *
+ * Anotation：异步日志。每一行日志在调用者的上下文中格式化为一条带时间戳和等级的记录，
+ * 放入多生产者单消费者的无锁环形缓冲区，由低优先级的日志线程写到控制台。生产者用原子
+ * 比较交换预留空间，不需要关中断，可以在中断中使用。缓冲区满时，线程中的日志等待日志
+ * 线程释放空间；不能等待的线程（调度器上锁、空闲线程、日志线程）取得消费者锁，先输出
+ * 缓冲区中已提交的记录，再同步输出自己的日志，所以日志的顺序不变。中断中的日志、调试
+ * 等级的日志以及消费者锁被占用时的日志被丢弃并计数。
+ */
+
+#include <rthw.h>
+#include <rtthread.h>
+#include <rtdbg.h>
+
+#ifdef RT_USING_ASYNC_LOG
+
+#if !defined(__GNUC__)
+#error "RT_USING_ASYNC_LOG requires the atomic builtins of GNU C"
+#endif
+
+#if (RT_ASYNC_LOG_BUF_SIZE & (RT_ASYNC_LOG_BUF_SIZE - 1)) != 0
+#error "RT_ASYNC_LOG_BUF_SIZE shall be a power of 2"
+#endif
+
+#if RT_ASYNC_LOG_BUF_SIZE < 4 * RT_CONSOLEBUF_SIZE
+#error "RT_ASYNC_LOG_BUF_SIZE shall be 4 times of RT_CONSOLEBUF_SIZE at least"
+#endif
+
+#ifndef RT_ASYNC_LOG_THREAD_PRIORITY
+#define RT_ASYNC_LOG_THREAD_PRIORITY    (RT_THREAD_PRIORITY_MAX - 2)
+#endif
+
+#define LOG_ALIGN_SIZE          8
+#define LOG_LEVEL_RAW           0xff
+
+#define LOG_FLAG_COMMIT         0x01            /* the record is ready to output */
+#define LOG_FLAG_PAD            0x02            /* the room is skipped at the end of buffer */
+
+/*
+ * the record in log buffer, it's followed by the text ended with null.
+ */
+struct log_record
+{
+    rt_uint16_t size;                           /* the size of record with header and padding */
+    rt_uint8_t  flag;
+    rt_uint8_t  level;
+    rt_tick_t   tick;
+};
+
+#define LOG_RECORD_MAX          RT_ALIGN(sizeof(struct log_record) + RT_CONSOLEBUF_SIZE, LOG_ALIGN_SIZE)
+#define LOG_RECORD(pos)         ((struct log_record *)((rt_uint8_t *)_log_buf + ((pos) & (RT_ASYNC_LOG_BUF_SIZE - 1))))
+#define LOG_RECORD_TEXT(record) ((char *)((struct log_record *)(record) + 1))
+
+/*
+ * The positions are free-running, the producers reserve the room by moving
+ * tail and the log thread releases it by moving head. The released room is
+ * cleared, so that a reserved record is seen as uncommitted until its owner
+ * sets the flag.
+ */
+static rt_uint32_t _log_buf[RT_ASYNC_LOG_BUF_SIZE / sizeof(rt_uint32_t)];
+static rt_uint32_t _log_head;
+static rt_uint32_t _log_tail;
+static rt_uint32_t _log_drop;
+static rt_uint32_t _log_drop_reported;
+static rt_uint8_t _log_waiting;
+static rt_uint8_t _log_running;
+
+/* the log thread, or the caller which outputs synchronously, holds the consumer lock */
+static rt_uint8_t _log_consuming;
+/* the number of threads waiting for the room of log buffer */
+static rt_uint32_t _log_space_waiting;
+
+static struct rt_semaphore _log_sem;
+static struct rt_semaphore _log_space_sem;
+static struct rt_thread _log_thread;
+ALIGN(RT_ALIGN_SIZE)
+static rt_uint8_t _log_thread_stack[RT_ASYNC_LOG_THREAD_STACK_SIZE];
+
+/* the buffer of synchronous output, it's used under the consumer lock */
+static char _log_line_buf[RT_CONSOLEBUF_SIZE];
+
+/*
+ * format the header, the text and the end of line into buffer.
+ *
+ * @return the length of line
+ */
+static rt_size_t _log_format(char *buf, rt_size_t size, const char *hdr,
+                             const char *end, const char *fmt, va_list args)
+{
+    rt_size_t avail, length, end_length, body;
+
+    /* the room of terminating null */
+    avail = size - 1;
+
+    length = 0;
+    if (hdr != RT_NULL)
+    {
+        length = rt_strlen(hdr);
+        if (length > avail)
+            length = avail;
+        rt_memcpy(buf, hdr, length);
+    }
+
+    end_length = 0;
+    if (end != RT_NULL)
+    {
+        end_length = rt_strlen(end);
+        if (end_length > avail - length)
+            end_length = avail - length;
+    }
+
+    /* the text is truncated to keep the end of line */
+    body = rt_vsnprintf(buf + length, avail - length - end_length + 1, fmt, args);
+    if (body > avail - length - end_length)
+        body = avail - length - end_length;
+    length += body;
+
+    rt_memcpy(buf + length, end, end_length);
+    length += end_length;
+    buf[length] = '\0';
+
+    return length;
+}
+
+/*
+ * reserve the room of a record in the log buffer.
+ *
+ * @param level the level of record
+ * @param pos the position of reserved record
+ *
+ * @return the reserved record, RT_NULL if the log buffer is full
+ */
+static struct log_record *_log_reserve(rt_uint8_t level, rt_uint32_t *pos)
+{
+    rt_uint32_t tail, head, pad, limit;
+    struct log_record *record;
+
+    /* the debug records leave a quarter of buffer to the others */
+    if (level != LOG_LEVEL_RAW && level >= DBG_LOG)
+        limit = RT_ASYNC_LOG_BUF_SIZE / 4 * 3;
+    else
+        limit = RT_ASYNC_LOG_BUF_SIZE;
+
+    tail = __atomic_load_n(&_log_tail, __ATOMIC_RELAXED);
+    do
+    {
+        /* the record never wraps, the rest of buffer is skipped by a padding record */
+        pad = RT_ASYNC_LOG_BUF_SIZE - (tail & (RT_ASYNC_LOG_BUF_SIZE - 1));
+        if (pad >= LOG_RECORD_MAX)
+            pad = 0;
+
+        head = __atomic_load_n(&_log_head, __ATOMIC_ACQUIRE);
+        if (tail + pad + LOG_RECORD_MAX - head > limit)
+            return RT_NULL;
+    } while (!__atomic_compare_exchange_n(&_log_tail, &tail, tail + pad + LOG_RECORD_MAX, 1,
+                                          __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+
+    if (pad != 0)
+    {
+        record = LOG_RECORD(tail);
+        record->size = pad;
+        __atomic_store_n(&record->flag, LOG_FLAG_COMMIT | LOG_FLAG_PAD, __ATOMIC_RELEASE);
+
+        tail += pad;
+    }
+
+    record = LOG_RECORD(tail);
+    record->level = level;
+    record->tick  = rt_tick_get();
+    *pos = tail;
+
+    return record;
+}
+
+/*
+ * commit the record to the log thread, the unused room is given back if no
+ * record is reserved after it.
+ */
+static void _log_commit(struct log_record *record, rt_uint32_t pos, rt_size_t length)
+{
+    rt_uint32_t end, size;
+
+    size = RT_ALIGN(sizeof(struct log_record) + length + 1, LOG_ALIGN_SIZE);
+    end  = pos + LOG_RECORD_MAX;
+    if (__atomic_compare_exchange_n(&_log_tail, &end, pos + size, 0,
+                                    __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+        record->size = size;
+    else
+        record->size = LOG_RECORD_MAX;
+
+    /* the record is written before the flag, and the flag before checking the waiting log thread */
+    __atomic_store_n(&record->flag, LOG_FLAG_COMMIT, __ATOMIC_SEQ_CST);
+
+    if (__atomic_exchange_n(&_log_waiting, 0, __ATOMIC_SEQ_CST))
+        rt_sem_release(&_log_sem);
+}
+
+rt_inline rt_bool_t _log_consumer_trylock(void)
+{
+    return !__atomic_exchange_n(&_log_consuming, 1, __ATOMIC_ACQUIRE);
+}
+
+rt_inline void _log_consumer_unlock(void)
+{
+    __atomic_store_n(&_log_consuming, 0, __ATOMIC_RELEASE);
+}
+
+/*
+ * wake up the threads waiting for the room of log buffer, they try to
+ * reserve again.
+ */
+static void _log_space_wakeup(void)
+{
+    rt_uint32_t count;
+
+    count = __atomic_exchange_n(&_log_space_waiting, 0, __ATOMIC_SEQ_CST);
+    while (count --)
+        rt_sem_release(&_log_space_sem);
+}
+
+/*
+ * check whether the caller can wait for the log thread. The log thread runs
+ * at a low priority, so the caller in critical section, the idle thread and
+ * the log thread itself can't wait for it.
+ */
+static rt_bool_t _log_can_wait(void)
+{
+    rt_thread_t thread;
+
+    if (rt_interrupt_get_nest() != 0 || rt_critical_level() != 0)
+        return RT_FALSE;
+
+    thread = rt_thread_self();
+
+    return thread != RT_NULL && thread != &_log_thread && thread != rt_thread_idle_gethandler();
+}
+
+/*
+ * reserve the room of a record, the thread waits for the log thread to
+ * release the room when the log buffer is full, so the order of records is
+ * kept. The debug records are not waited for.
+ *
+ * @return the reserved record, RT_NULL if the log buffer is full and the
+ *         caller can't wait
+ */
+static struct log_record *_log_reserve_wait(rt_uint8_t level, rt_uint32_t *pos)
+{
+    struct log_record *record;
+
+    record = _log_reserve(level, pos);
+    while (record == RT_NULL && (level == LOG_LEVEL_RAW || level < DBG_LOG) && _log_can_wait())
+    {
+        __atomic_add_fetch(&_log_space_waiting, 1, __ATOMIC_SEQ_CST);
+
+        /* reserve again after counted, so that no release of room is missed */
+        record = _log_reserve(level, pos);
+        if (record != RT_NULL)
+            break;
+
+        rt_sem_take(&_log_space_sem, RT_WAITING_FOREVER);
+        record = _log_reserve(level, pos);
+    }
+
+    return record;
+}
+
+static void _log_output(struct log_record *record)
+{
+    char stamp[16];
+
+    if (record->level != LOG_LEVEL_RAW)
+    {
+        rt_snprintf(stamp, sizeof(stamp), "[%u] ", record->tick);
+        rt_kputs(stamp);
+    }
+    rt_kputs(LOG_RECORD_TEXT(record));
+}
+
+/*
+ * check whether the record at head of log buffer is committed.
+ */
+static rt_bool_t _log_pending(void)
+{
+    rt_uint32_t head;
+
+    head = __atomic_load_n(&_log_head, __ATOMIC_RELAXED);
+    if (head == __atomic_load_n(&_log_tail, __ATOMIC_ACQUIRE))
+        return RT_FALSE;
+
+    return (__atomic_load_n(&LOG_RECORD(head)->flag, __ATOMIC_ACQUIRE) & LOG_FLAG_COMMIT) != 0;
+}
+
+/*
+ * output the record at head of log buffer, the caller holds the consumer lock.
+ *
+ * @return RT_TRUE if a record is released, RT_FALSE if there is no committed record
+ */
+static rt_bool_t _log_drain(void)
+{
+    struct log_record *record;
+    rt_uint32_t head;
+    rt_uint8_t flag;
+    rt_uint16_t size;
+
+    if (!_log_pending())
+        return RT_FALSE;
+
+    head   = _log_head;
+    record = LOG_RECORD(head);
+    flag   = record->flag;
+    size   = record->size;
+    if ((flag & LOG_FLAG_PAD) == 0)
+        _log_output(record);
+
+    /* the released room is cleared for the next reservation */
+    rt_memset(record, 0, size);
+    __atomic_store_n(&_log_head, head + size, __ATOMIC_SEQ_CST);
+
+    return RT_TRUE;
+}
+
+static void _log_report_drop(void)
+{
+    rt_uint32_t drop;
+    char notice[48];
+
+    drop = __atomic_load_n(&_log_drop, __ATOMIC_RELAXED);
+    if (drop != _log_drop_reported)
+    {
+        rt_snprintf(notice, sizeof(notice), "[async log] %u records dropped\n",
+                    drop - _log_drop_reported);
+        rt_kputs(notice);
+        _log_drop_reported = drop;
+    }
+}
+
+/*
+ * output a line synchronously in the context of caller. The committed records
+ * are output before it under the consumer lock, so the order is kept.
+ *
+ * @return RT_TRUE if the line is output, RT_FALSE if the consumer lock is held
+ *         by others
+ */
+static rt_bool_t _log_write_sync(const char *hdr, const char *end, const char *fmt, va_list args)
+{
+    if (!_log_consumer_trylock())
+        return RT_FALSE;
+
+    while (_log_drain());
+    _log_format(_log_line_buf, sizeof(_log_line_buf), hdr, end, fmt, args);
+    rt_kputs(_log_line_buf);
+
+    _log_consumer_unlock();
+    _log_space_wakeup();
+
+    return RT_TRUE;
+}
+
+/*
+ * output a line when the log buffer is full and the caller can't wait. The
+ * line in interrupt or at the debug level is dropped and counted, so is the
+ * line when the log thread is preempted in the middle of output.
+ *
+ * @return RT_EOK if the line is output, -RT_EFULL if it is dropped
+ */
+static rt_err_t _log_write_full(rt_uint8_t level, const char *hdr, const char *end,
+                                const char *fmt, va_list args)
+{
+    if (rt_interrupt_get_nest() == 0 && (level == LOG_LEVEL_RAW || level < DBG_LOG) &&
+        _log_write_sync(hdr, end, fmt, args))
+        return RT_EOK;
+
+    __atomic_add_fetch(&_log_drop, 1, __ATOMIC_RELAXED);
+
+    return -RT_EFULL;
+}
+
+static void _log_thread_entry(void *parameter)
+{
+    while (1)
+    {
+        if (!_log_consumer_trylock())
+        {
+            /* a thread which can't wait is writing synchronously */
+            rt_thread_delay(1);
+            continue;
+        }
+
+        while (_log_drain());
+        _log_report_drop();
+        _log_consumer_unlock();
+        _log_space_wakeup();
+
+        /* check the buffer again after the flag is set, so that no commit is missed */
+        __atomic_store_n(&_log_waiting, 1, __ATOMIC_SEQ_CST);
+        if (_log_pending())
+            continue;
+
+        rt_sem_take(&_log_sem, RT_WAITING_FOREVER);
+    }
+}
+
+/**
+ * This function will initialize the asynchronous log and start the log
+ * thread, the log is output synchronously before it.
+ *
+ * @return RT_EOK
+ */
+int rt_async_log_init(void)
+{
+    if (_log_running)
+        return RT_EOK;
+
+    rt_sem_init(&_log_sem, "alog", 0, RT_IPC_FLAG_FIFO);
+    rt_sem_init(&_log_space_sem, "alogspc", 0, RT_IPC_FLAG_PRIO);
+    rt_thread_init(&_log_thread,
+                   "alog",
+                   _log_thread_entry,
+                   RT_NULL,
+                   &_log_thread_stack[0],
+                   sizeof(_log_thread_stack),
+                   RT_ASYNC_LOG_THREAD_PRIORITY,
+                   10);
+    rt_thread_startup(&_log_thread);
+
+    _log_running = 1;
+
+    return RT_EOK;
+}
+INIT_PREV_EXPORT(rt_async_log_init);
+
+/**
+ * This function will put a log line into the log buffer, the header, the
+ * formatted text and the end of line are made into one record. It can be
+ * invoked in interrupt. If the log buffer is full, the thread waits for the
+ * room, or outputs the line synchronously after the pending records if it
+ * can't wait. The line is dropped in interrupt or at the debug level.
+ *
+ * @param level the level of log, the debug logs are dropped first
+ * @param hdr the header of line, such as level and tag
+ * @param end the end of line
+ * @param fmt the format
+ */
+void rt_async_log_line(rt_uint8_t level, const char *hdr, const char *end, const char *fmt, ...)
+{
+    struct log_record *record;
+    rt_uint32_t pos;
+    rt_size_t length;
+    va_list args;
+
+    va_start(args, fmt);
+
+    if (_log_running)
+    {
+        record = _log_reserve_wait(level, &pos);
+        if (record != RT_NULL)
+        {
+            length = _log_format(LOG_RECORD_TEXT(record), RT_CONSOLEBUF_SIZE, hdr, end, fmt, args);
+            _log_commit(record, pos, length);
+        }
+        else
+        {
+            _log_write_full(level, hdr, end, fmt, args);
+        }
+    }
+    else if (!_log_write_sync(hdr, end, fmt, args))
+    {
+        __atomic_add_fetch(&_log_drop, 1, __ATOMIC_RELAXED);
+    }
+
+    va_end(args);
+}
+
+/**
+ * This function will put the output of rt_kprintf into the log buffer.
+ *
+ * @param fmt the format
+ * @param args the arguments
+ *
+ * @return RT_EOK on success, -RT_EFULL if the log buffer is full and the
+ *         output is dropped, -RT_ENOSYS if the log thread doesn't run, the
+ *         output shall be written synchronously by caller and the arguments
+ *         are not used
+ */
+rt_err_t rt_async_log_vprintf(const char *fmt, va_list args)
+{
+    struct log_record *record;
+    rt_uint32_t pos;
+    rt_size_t length;
+
+    if (!_log_running)
+        return -RT_ENOSYS;
+
+    record = _log_reserve_wait(LOG_LEVEL_RAW, &pos);
+    if (record == RT_NULL)
+        return _log_write_full(LOG_LEVEL_RAW, RT_NULL, RT_NULL, fmt, args);
+
+    length = _log_format(LOG_RECORD_TEXT(record), RT_CONSOLEBUF_SIZE, RT_NULL, RT_NULL, fmt, args);
+    _log_commit(record, pos, length);
+
+    return RT_EOK;
+}
+
+/**
+ * This function will output the pending logs in the context of caller, and
+ * switch the log to synchronous output. It shall be invoked on the fatal
+ * error, such as assertion and exception, when the log thread can't run.
+ */
+void rt_async_log_sync(void)
+{
+    _log_running = 0;
+
+    /* the log thread never runs again, the consumer lock is taken over */
+    __atomic_store_n(&_log_consuming, 1, __ATOMIC_SEQ_CST);
+    while (_log_drain());
+    _log_report_drop();
+    _log_consumer_unlock();
+}
+
+/**
+ * This function will get the number of dropped records since startup.
+ *
+ * @return the number of dropped records
+ */
+rt_uint32_t rt_async_log_dropped(void)
+{
+    return __atomic_load_n(&_log_drop, __ATOMIC_RELAXED);
+}
+
+#endif /* RT_USING_ASYNC_LOG */
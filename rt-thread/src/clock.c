@@ -78,8 +78,19 @@ void rt_tick_increase(void)
 {
     struct rt_thread *thread;
 
-    /* increase the global tick */
-    ++ rt_tick;
+#ifdef RT_USING_THREAD_RUNTIME
+    /* the cycles of the passed tick are charged to its window */
+    rt_scheduler_runtime_tick();
+#endif
+
+#ifdef RT_USING_SMP
+    /* the global tick and timers are handled by the first cpu */
+    if (rt_hw_cpu_id() == 0)
+#endif /*RT_USING_SMP*/
+    {
+        /* increase the global tick */
+        ++ rt_tick;
+    }
 
     /* check time slice
      *
@@ -102,6 +113,11 @@ void rt_tick_increase(void)
         rt_thread_yield();
     }
 
+#ifdef RT_USING_SMP
+    if (rt_hw_cpu_id() != 0)
+        return;
+#endif /*RT_USING_SMP*/
+
     /* check timer */
     rt_timer_check();
 }
@@ -195,6 +195,10 @@ void main_thread_entry(void *parameter)
     /* RT-Thread components initialization */
     rt_components_init();
 #endif
+
+#ifdef RT_USING_SMP
+    rt_hw_secondary_cpu_up();
+#endif /*RT_USING_SMP*/
     /* invoke system main function */
 #if defined(__CC_ARM) || defined(__CLANG_ARM)
     $Super$$main(); /* for ARMCC. */
@@ -261,6 +265,11 @@ int rtthread_startup(void)
     /* idle thread initialization */
     rt_thread_idle_init();
 
+#ifdef RT_USING_SMP
+    /* the cpus lock is released when switching to the first thread */
+    rt_hw_spin_lock(&_cpus_lock);
+#endif /*RT_USING_SMP*/
+
     /* start scheduler */
     rt_system_scheduler_start();
 
@@ -0,0 +1,238 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2021-09-25     RT-Thread    the first version
+ *
+ * Anotation：DMA 缓冲区的起始地址和大小都按 cache line 对齐，这样对缓冲区做 cache
+ * 清除或无效化时不会影响相邻的数据。rt_dma_malloc 从堆中分配：使用内存堆作为系统堆时，
+ * 只从带 RT_MEMHEAP_ATTR_DMA 属性的内存堆分配，没有时返回 RT_NULL，不会退回到 DMA
+ * 不可访问的内存；其他的堆只有一块系统堆，认为它是 DMA 可访问的。rt_dma_pool 在一块
+ * 指定的内存（例如不带 cache 或者 DMA 可访问的 SRAM）上管理固定大小的缓冲区，可以在
+ * 中断中使用。
+ */
+
+#include <rthw.h>
+#include <rtthread.h>
+
+#ifdef RT_USING_DMA_BUFFER
+
+#define DMA_LINE_SIZE       RT_CPU_CACHE_LINE_SZ
+
+#if defined(ARCH_ARM_CORTEX_M7) || defined(ARCH_ARM_CORTEX_A)
+#define DMA_USING_DCACHE
+#endif
+
+#ifdef RT_USING_HEAP
+/**
+ * This function will allocate a buffer for DMA. The address and the size of
+ * buffer are aligned to the cache line, so that no other data shares the
+ * cache lines of buffer.
+ *
+ * With RT_USING_MEMHEAP_AS_HEAP, the buffer is only allocated from the memory
+ * heaps of RT_MEMHEAP_ATTR_DMA. With the other heaps, the system heap is
+ * assumed to be accessible by DMA.
+ *
+ * @param size the size of buffer
+ *
+ * @return the allocated buffer, RT_NULL on failure or if there is no memory
+ *         heap accessible by DMA
+ */
+void *rt_dma_malloc(rt_size_t size)
+{
+    void *ptr;
+
+    if (size == 0)
+        return RT_NULL;
+
+    /* the tail of buffer is padded to the cache line */
+    size = RT_ALIGN(size, DMA_LINE_SIZE);
+
+#ifdef RT_USING_MEMHEAP_AS_HEAP
+    {
+        struct rt_object *object;
+        struct rt_list_node *node;
+        struct rt_memheap *heap;
+        struct rt_object_information *information;
+
+        /* only the memory heaps accessible by DMA */
+        information = rt_object_get_information(RT_Object_Class_MemHeap);
+        RT_ASSERT(information != RT_NULL);
+        for (node  = information->object_list.next;
+             node != &(information->object_list);
+             node  = node->next)
+        {
+            object = rt_list_entry(node, struct rt_object, list);
+            heap   = (struct rt_memheap *)object;
+
+            if ((heap->attr & RT_MEMHEAP_ATTR_DMA) == 0)
+                continue;
+
+            ptr = rt_memheap_alloc_align(heap, size, DMA_LINE_SIZE);
+            if (ptr != RT_NULL)
+            {
+#ifdef RT_USING_HOOK
+                /* rt_free_align of rt_dma_free calls the free hook */
+                void (*hook)(void *ptr, rt_size_t size) = rt_malloc_gethook();
+
+                if (hook != RT_NULL)
+                    hook(ptr, size);
+#endif
+                return ptr;
+            }
+        }
+
+        return RT_NULL;
+    }
+#else
+    ptr = rt_malloc_align(size, DMA_LINE_SIZE);
+
+    return ptr;
+#endif
+}
+
+/**
+ * This function will release the buffer allocated by rt_dma_malloc.
+ *
+ * @param ptr the buffer
+ */
+void rt_dma_free(void *ptr)
+{
+    if (ptr == RT_NULL)
+        return;
+
+    rt_free_align(ptr);
+}
+#endif
+
+/**
+ * This function will initialize a pool of DMA buffers of fixed size in the
+ * specified memory. The buffers are aligned and padded to the cache line.
+ *
+ * @param pool the DMA buffer pool
+ * @param start the start address of memory
+ * @param size the size of memory
+ * @param buf_size the size of each buffer
+ *
+ * @return RT_EOK on success, -RT_EINVAL if there is no room for one buffer
+ */
+rt_err_t rt_dma_pool_init(rt_dma_pool_t pool, void *start, rt_size_t size, rt_size_t buf_size)
+{
+    rt_ubase_t begin, end;
+    rt_uint8_t *buf;
+
+    RT_ASSERT(pool != RT_NULL);
+    RT_ASSERT(start != RT_NULL);
+    RT_ASSERT(buf_size > 0);
+
+    begin    = RT_ALIGN((rt_ubase_t)start, DMA_LINE_SIZE);
+    end      = RT_ALIGN_DOWN((rt_ubase_t)start + size, DMA_LINE_SIZE);
+    buf_size = RT_ALIGN(buf_size, DMA_LINE_SIZE);
+    if (end <= begin || end - begin < buf_size)
+        return -RT_EINVAL;
+
+    pool->start      = (rt_uint8_t *)begin;
+    pool->buf_size   = buf_size;
+    pool->total      = (end - begin) / buf_size;
+    pool->free_count = pool->total;
+
+    /* link the free buffers, the link lies in the buffer itself */
+    pool->free_list = RT_NULL;
+    for (buf = pool->start + (pool->total - 1) * buf_size; ; buf -= buf_size)
+    {
+        *(void **)buf = pool->free_list;
+        pool->free_list = buf;
+
+        if (buf == pool->start)
+            break;
+    }
+
+    return RT_EOK;
+}
+
+/**
+ * This function will allocate a buffer from the DMA buffer pool, it can be
+ * invoked in interrupt.
+ *
+ * @param pool the DMA buffer pool
+ *
+ * @return the allocated buffer, RT_NULL if the pool is empty
+ */
+void *rt_dma_pool_alloc(rt_dma_pool_t pool)
+{
+    register rt_base_t level;
+    void *buf;
+
+    RT_ASSERT(pool != RT_NULL);
+
+    level = rt_hw_interrupt_disable();
+
+    buf = pool->free_list;
+    if (buf != RT_NULL)
+    {
+        pool->free_list = *(void **)buf;
+        pool->free_count --;
+    }
+
+    rt_hw_interrupt_enable(level);
+
+    return buf;
+}
+
+/**
+ * This function will release a buffer to the DMA buffer pool, it can be
+ * invoked in interrupt.
+ *
+ * @param pool the DMA buffer pool
+ * @param buf the buffer
+ */
+void rt_dma_pool_free(rt_dma_pool_t pool, void *buf)
+{
+    register rt_base_t level;
+
+    RT_ASSERT(pool != RT_NULL);
+    RT_ASSERT((rt_uint8_t *)buf >= pool->start &&
+              (rt_uint8_t *)buf < pool->start + pool->total * pool->buf_size);
+    RT_ASSERT(((rt_uint8_t *)buf - pool->start) % pool->buf_size == 0);
+
+    level = rt_hw_interrupt_disable();
+
+    *(void **)buf = pool->free_list;
+    pool->free_list = buf;
+    pool->free_count ++;
+
+    rt_hw_interrupt_enable(level);
+}
+
+/**
+ * This function will write the data in cache back to the memory, it shall be
+ * invoked before DMA reads the buffer.
+ *
+ * @param buf the buffer
+ * @param size the size of data
+ */
+void rt_dma_cache_flush(void *buf, rt_size_t size)
+{
+#ifdef DMA_USING_DCACHE
+    rt_hw_cpu_dcache_ops(RT_HW_CACHE_FLUSH, buf, RT_ALIGN(size, DMA_LINE_SIZE));
+#endif
+}
+
+/**
+ * This function will discard the data in cache, it shall be invoked after DMA
+ * writes the buffer and before cpu reads it.
+ *
+ * @param buf the buffer
+ * @param size the size of data
+ */
+void rt_dma_cache_invalidate(void *buf, rt_size_t size)
+{
+#ifdef DMA_USING_DCACHE
+    rt_hw_cpu_dcache_ops(RT_HW_CACHE_INVALIDATE, buf, RT_ALIGN(size, DMA_LINE_SIZE));
+#endif
+}
+
+#endif /* RT_USING_DMA_BUFFER */
@@ -37,16 +37,28 @@
 #endif
 #endif
 
+#ifdef RT_USING_TICKLESS
+#ifndef RT_TICKLESS_THRESHOLD
+#define RT_TICKLESS_THRESHOLD   2
+#endif
+#endif
+
+#ifdef RT_USING_SMP
+#define _CPUS_NR                RT_CPUS_NR
+#else
+#define _CPUS_NR                1
+#endif /*RT_USING_SMP*/
+
 extern rt_list_t rt_thread_defunct;
 
 /*
  * Anotation：
- * <1> idle 作用于本文件的全局的空闲线程
+ * <1> idle 作用于本文件的全局的空闲线程，每个CPU一个
  * <2> rt_thread_stack 空闲线程的栈空间
  * */
-static struct rt_thread idle;
+static struct rt_thread idle[_CPUS_NR];
 ALIGN(RT_ALIGN_SIZE)
-static rt_uint8_t rt_thread_stack[IDLE_THREAD_STACK_SIZE];
+static rt_uint8_t rt_thread_stack[_CPUS_NR][IDLE_THREAD_STACK_SIZE];
 
 #ifdef RT_USING_IDLE_HOOK
 #ifndef RT_IDLE_HOOK_LIST_SIZE
@@ -195,12 +207,87 @@ void rt_thread_idle_excute(void)
 #endif
 }
 
+#ifdef RT_USING_TICKLESS
+/*
+ * This function will stop the periodic tick when there is no other ready
+ * thread, sleep until the next timer deadline and catch up the system tick
+ * in one batch after wakeup. No timer expires in the ticks caught up, the
+ * tick of deadline is accounted by the tick interrupt, so that the timers are
+ * checked in interrupt as usual.
+ *
+ * Anotation：无节拍空闲模式。就绪队列中只剩空闲线程时，按下一个定时器的超时时刻重新设置节拍源并睡眠，
+ * 唤醒后一次性补偿 rt_tick。到期的那个节拍由节拍中断处理，定时器仍然在中断中检查。
+ */
+static void rt_thread_idle_tickless(void)
+{
+    rt_base_t level;
+    rt_tick_t timeout_tick, sleep_tick, passed_tick;
+
+    level = rt_hw_interrupt_disable();
+
+    /* the time slice of the threads with idle priority needs the tick */
+    if (idle[0].tlist.next != idle[0].tlist.prev || rt_critical_level() != 0)
+    {
+        rt_hw_interrupt_enable(level);
+        return;
+    }
+
+    /*
+     * The thread timers are hard timers, and the soft timer thread waits for
+     * the first soft timer with its thread timer, so the hard timer list holds
+     * the next deadline of the whole system.
+     */
+    timeout_tick = rt_timer_next_timeout_tick();
+    if (timeout_tick == RT_TICK_MAX)
+    {
+        sleep_tick = RT_TICK_MAX;
+    }
+    else
+    {
+        sleep_tick = timeout_tick - rt_tick_get();
+
+        /* the timer is timeout or too close to stop the tick */
+        if (sleep_tick >= RT_TICK_MAX / 2 || sleep_tick < RT_TICKLESS_THRESHOLD)
+        {
+            rt_hw_interrupt_enable(level);
+            return;
+        }
+    }
+
+    /* the ticks before the deadline, the tick interrupt of deadline is pending */
+#ifdef RT_USING_IRQ_LATENCY
+    rt_irqlat_sleep_enter();
+#endif
+    passed_tick = rt_hw_tickless_sleep(sleep_tick);
+#ifdef RT_USING_IRQ_LATENCY
+    rt_irqlat_sleep_exit();
+#endif
+    if (passed_tick > 0)
+    {
+        rt_tick_set(rt_tick_get() + passed_tick);
+    }
+
+    rt_hw_interrupt_enable(level);
+}
+#endif
+
 /*
  * Anotation：钩子线程的服务函数。
  * */
 extern void rt_system_power_manager(void);
 static void rt_thread_idle_entry(void *parameter)
 {
+#ifdef RT_USING_SMP
+    /* the idle hooks and defunct threads are handled by the first cpu */
+    if (rt_hw_cpu_id() != 0)
+    {
+        while (1)
+        {
+            rt_hw_secondary_cpu_idle_exec();
+        }
+    }
+#endif /*RT_USING_SMP*/
+
     while (1)
     {
 
@@ -217,8 +304,17 @@ static void rt_thread_idle_entry(void *parameter)
 #endif
 
         rt_thread_idle_excute();
+#if defined(RT_USING_SLAB) && defined(RT_USING_SLAB_RECLAIM)
+        rt_slab_reclaim_idle();
+#endif
+#ifdef RT_USING_MEMFRAG
+        rt_memfrag_step();
+#endif
 #ifdef RT_USING_PM
         rt_system_power_manager();
+#endif
+#ifdef RT_USING_TICKLESS
+        rt_thread_idle_tickless();
 #endif
     }
 }
@@ -234,18 +330,34 @@ static void rt_thread_idle_entry(void *parameter)
  */
 void rt_thread_idle_init(void)
 {
-    /* initialize thread */
-    rt_thread_init(&idle,
-                   "tidle",
-                   rt_thread_idle_entry,
-                   RT_NULL,
-                   &rt_thread_stack[0],
-                   sizeof(rt_thread_stack),
-                   RT_THREAD_PRIORITY_MAX - 1,
-                   32);
-
-    /* startup */
-    rt_thread_startup(&idle);
+    rt_ubase_t i;
+    char tidle_name[RT_NAME_MAX];
+
+    for (i = 0; i < _CPUS_NR; i++)
+    {
+#ifdef RT_USING_SMP
+        rt_sprintf(tidle_name, "tidle%d", i);
+#else
+        rt_strncpy(tidle_name, "tidle", RT_NAME_MAX);
+#endif /*RT_USING_SMP*/
+
+        /* initialize thread */
+        rt_thread_init(&idle[i],
+                       tidle_name,
+                       rt_thread_idle_entry,
+                       RT_NULL,
+                       &rt_thread_stack[i][0],
+                       sizeof(rt_thread_stack[i]),
+                       RT_THREAD_PRIORITY_MAX - 1,
+                       32);
+#ifdef RT_USING_SMP
+        /* each cpu always has its own idle thread to run */
+        rt_thread_control(&idle[i], RT_THREAD_CTRL_BIND_CPU, (void*)i);
+#endif /*RT_USING_SMP*/
+
+        /* startup */
+        rt_thread_startup(&idle[i]);
+    }
 }
 
 /**
@@ -257,5 +369,11 @@ void rt_thread_idle_init(void)
  */
 rt_thread_t rt_thread_idle_gethandler(void)
 {
-    return (rt_thread_t)(&idle);
+#ifdef RT_USING_SMP
+    register int id = rt_hw_cpu_id();
+#else
+    register int id = 0;
+#endif /*RT_USING_SMP*/
+
+    return (rt_thread_t)(&idle[id]);
 }
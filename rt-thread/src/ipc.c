@@ -74,25 +74,19 @@ rt_inline rt_err_t rt_ipc_object_init(struct rt_ipc_object *ipc)
     return RT_EOK;
 }
 
-/**
- * This function will suspend a thread to a specified list.
- * IPC object or some double-queue object (mailbox etc.) contains this kind of list.
+/*
+ * This function will insert a suspended thread to the suspended list of IPC
+ * object by the flag of IPC object.
  *
  * @param list the IPC suspended thread list
- * @param thread the thread object to be suspended
+ * @param thread the thread object to be inserted
  * @param flag the IPC object flag,
  *        which shall be RT_IPC_FLAG_FIFO/RT_IPC_FLAG_PRIO.
- *
- * @return the operation status, RT_EOK on successful
- *
  */
-rt_inline rt_err_t rt_ipc_list_suspend(rt_list_t        *list,
-                                       struct rt_thread *thread,
-                                       rt_uint8_t        flag)
+rt_inline void rt_ipc_list_insert(rt_list_t        *list,
+                                  struct rt_thread *thread,
+                                  rt_uint8_t        flag)
 {
-    /* suspend thread */
-    rt_thread_suspend(thread);
-
     switch (flag)
     {
     case RT_IPC_FLAG_FIFO:
@@ -130,6 +124,28 @@ rt_inline rt_err_t rt_ipc_list_suspend(rt_list_t        *list,
     default:
         break;
     }
+}
+
+/**
+ * This function will suspend a thread to a specified list.
+ * IPC object or some double-queue object (mailbox etc.) contains this kind of list.
+ *
+ * @param list the IPC suspended thread list
+ * @param thread the thread object to be suspended
+ * @param flag the IPC object flag,
+ *        which shall be RT_IPC_FLAG_FIFO/RT_IPC_FLAG_PRIO.
+ *
+ * @return the operation status, RT_EOK on successful
+ *
+ */
+rt_inline rt_err_t rt_ipc_list_suspend(rt_list_t        *list,
+                                       struct rt_thread *thread,
+                                       rt_uint8_t        flag)
+{
+    /* suspend thread */
+    rt_thread_suspend(thread);
+
+    rt_ipc_list_insert(list, thread, flag);
 
     return RT_EOK;
 }
@@ -531,6 +547,174 @@ rt_err_t rt_sem_control(rt_sem_t sem, int cmd, void *arg)
 #endif /* end of RT_USING_SEMAPHORE */
 
 #ifdef RT_USING_MUTEX
+/*
+ * get the highest priority of the threads waiting for the mutex, 0xff for no
+ * waiting thread.
+ */
+static rt_uint8_t _rt_mutex_waiter_priority(struct rt_mutex *mutex)
+{
+    struct rt_list_node *node;
+    struct rt_thread *thread;
+    rt_uint8_t priority = 0xff;
+
+    rt_list_for_each(node, &(mutex->parent.suspend_thread))
+    {
+        thread = rt_list_entry(node, struct rt_thread, tlist);
+        if (thread->current_priority < priority)
+            priority = thread->current_priority;
+    }
+
+    return priority;
+}
+
+/*
+ * get the priority of thread inherited from the threads waiting for the
+ * mutexes it has taken, or from the ceiling of the RT_IPC_FLAG_CEILING
+ * mutexes it has taken, which is not lower than the priority passed in.
+ */
+static rt_uint8_t _rt_mutex_inherit_priority(struct rt_thread *thread, rt_uint8_t priority)
+{
+    struct rt_list_node *node;
+    struct rt_mutex *mutex;
+    rt_uint8_t waiter_priority;
+
+    rt_list_for_each(node, &(thread->taken_mutex_list))
+    {
+        mutex = rt_list_entry(node, struct rt_mutex, taken_list);
+
+        /* the ceiling mutex does not inherit from waiting threads */
+        if (mutex->parent.parent.flag & RT_IPC_FLAG_CEILING)
+            waiter_priority = mutex->ceiling_priority;
+        else
+            waiter_priority = _rt_mutex_waiter_priority(mutex);
+        if (waiter_priority < priority)
+            priority = waiter_priority;
+    }
+
+    return priority;
+}
+
+/*
+ * get the priority of thread before it inherits any priority. All the
+ * mutexes taken by a thread record the same original priority.
+ */
+static rt_uint8_t _rt_mutex_original_priority(struct rt_thread *thread)
+{
+    if (rt_list_isempty(&(thread->taken_mutex_list)))
+        return thread->current_priority;
+
+    return rt_list_entry(thread->taken_mutex_list.next,
+                         struct rt_mutex, taken_list)->original_priority;
+}
+
+/*
+ * get the mutex the thread is waiting for. The pending mutex of a thread
+ * which is timeout or resumed is kept until the thread runs again, but the
+ * thread is not in the suspended list of the mutex anymore.
+ */
+rt_inline struct rt_mutex *_rt_mutex_pending(struct rt_thread *thread)
+{
+    if ((thread->stat & RT_THREAD_STAT_MASK) != RT_THREAD_SUSPEND)
+        return RT_NULL;
+
+    return thread->pending_mutex;
+}
+
+/*
+ * change the priority of thread, the thread waiting for a mutex is moved to
+ * the new position of the suspended list by its new priority.
+ */
+static void _rt_mutex_set_priority(struct rt_thread *thread, rt_uint8_t priority)
+{
+    struct rt_mutex *mutex;
+
+    rt_thread_control(thread, RT_THREAD_CTRL_CHANGE_PRIORITY, &priority);
+
+    mutex = _rt_mutex_pending(thread);
+    if (mutex != RT_NULL && (mutex->parent.parent.flag & RT_IPC_FLAG_PRIO))
+    {
+        rt_list_remove(&(thread->tlist));
+        rt_ipc_list_insert(&(mutex->parent.suspend_thread), thread, RT_IPC_FLAG_PRIO);
+    }
+}
+
+/*
+ * update the priority of mutex owner by the threads waiting for its mutexes,
+ * and then walk along the chain of owners which are waiting for other mutexes,
+ * so the priority is inherited transitively. It must be invoked with
+ * interrupt disabled.
+ *
+ * Anotation：优先级继承沿着"等待的互斥量 -> 持有者"链传递，直到优先级不再变化
+ */
+static void _rt_mutex_update_owner(struct rt_thread *owner)
+{
+    rt_uint8_t priority;
+
+    while (owner != RT_NULL && !rt_list_isempty(&(owner->taken_mutex_list)))
+    {
+        priority = _rt_mutex_inherit_priority(owner, _rt_mutex_original_priority(owner));
+        if (priority == owner->current_priority)
+            break;
+
+        _rt_mutex_set_priority(owner, priority);
+
+        if (_rt_mutex_pending(owner) == RT_NULL)
+            break;
+        owner = owner->pending_mutex->owner;
+    }
+}
+
+/*
+ * take the mutex off from its owner and the waiting threads, and restore the
+ * priority of owner. It must be invoked with interrupt disabled.
+ */
+static void _rt_mutex_drop_owner(struct rt_mutex *mutex)
+{
+    struct rt_thread *owner;
+    rt_uint8_t priority;
+
+    owner = mutex->owner;
+    rt_list_remove(&(mutex->taken_list));
+
+    /* restore the priority of owner by its remaining mutexes */
+    priority = _rt_mutex_inherit_priority(owner, mutex->original_priority);
+    if (priority != owner->current_priority)
+    {
+        _rt_mutex_set_priority(owner, priority);
+
+        /* the owner may be waiting for another mutex */
+        if (_rt_mutex_pending(owner) != RT_NULL)
+            _rt_mutex_update_owner(owner->pending_mutex->owner);
+    }
+}
+
+/*
+ * clear the owner and waiting threads of the mutex before it is detached or
+ * deleted.
+ */
+static void _rt_mutex_clear(struct rt_mutex *mutex)
+{
+    register rt_base_t temp;
+    struct rt_list_node *node;
+    struct rt_thread *thread;
+
+    temp = rt_hw_interrupt_disable();
+
+    rt_list_for_each(node, &(mutex->parent.suspend_thread))
+    {
+        thread = rt_list_entry(node, struct rt_thread, tlist);
+        thread->pending_mutex = RT_NULL;
+    }
+
+    if (mutex->owner != RT_NULL)
+    {
+        _rt_mutex_drop_owner(mutex);
+        mutex->owner = RT_NULL;
+    }
+
+    rt_hw_interrupt_enable(temp);
+}
+
 /**
  * This function will initialize a mutex and put it under control of resource
  * management.
@@ -556,6 +740,8 @@ rt_err_t rt_mutex_init(rt_mutex_t mutex, const char *name, rt_uint8_t flag)
     mutex->owner = RT_NULL;
     mutex->original_priority = 0xFF;
     mutex->hold  = 0;
+    mutex->ceiling_priority = 0;
+    rt_list_init(&(mutex->taken_list));
 
     /* set flag */
     mutex->parent.parent.flag = flag;
@@ -579,6 +765,9 @@ rt_err_t rt_mutex_detach(rt_mutex_t mutex)
     RT_ASSERT(rt_object_get_type(&mutex->parent.parent) == RT_Object_Class_Mutex);
     RT_ASSERT(rt_object_is_systemobject(&mutex->parent.parent));
 
+    /* restore the priority of owner */
+    _rt_mutex_clear(mutex);
+
     /* wakeup all suspended threads */
     rt_ipc_list_resume_all(&(mutex->parent.suspend_thread));
 
@@ -588,6 +777,32 @@ rt_err_t rt_mutex_detach(rt_mutex_t mutex)
     return RT_EOK;
 }
 
+/**
+ * This function will initialize a priority ceiling mutex. The thread taking
+ * this mutex is raised to the ceiling priority immediately, and the owner
+ * does not inherit priority from the threads waiting for it.
+ *
+ * @param mutex the mutex object
+ * @param name the name of mutex
+ * @param flag the flag of mutex, RT_IPC_FLAG_FIFO or RT_IPC_FLAG_PRIO
+ * @param ceiling the ceiling priority, which shall be the highest priority
+ *        of the threads taking this mutex
+ *
+ * @return the operation status, RT_EOK on successful
+ */
+rt_err_t rt_mutex_init_ceiling(rt_mutex_t   mutex,
+                               const char  *name,
+                               rt_uint8_t   flag,
+                               rt_uint8_t   ceiling)
+{
+    RT_ASSERT(ceiling < RT_THREAD_PRIORITY_MAX);
+
+    rt_mutex_init(mutex, name, flag | RT_IPC_FLAG_CEILING);
+    mutex->ceiling_priority = ceiling;
+
+    return RT_EOK;
+}
+
 #ifdef RT_USING_HEAP
 /**
  * This function will create a mutex from system resource
@@ -617,6 +832,8 @@ rt_mutex_t rt_mutex_create(const char *name, rt_uint8_t flag)
     mutex->owner              = RT_NULL;
     mutex->original_priority  = 0xFF;
     mutex->hold               = 0;
+    mutex->ceiling_priority   = 0;
+    rt_list_init(&(mutex->taken_list));
 
     /* set flag */
     mutex->parent.parent.flag = flag;
@@ -624,6 +841,31 @@ rt_mutex_t rt_mutex_create(const char *name, rt_uint8_t flag)
     return mutex;
 }
 
+/**
+ * This function will create a priority ceiling mutex from system resource
+ *
+ * @param name the name of mutex
+ * @param flag the flag of mutex, RT_IPC_FLAG_FIFO or RT_IPC_FLAG_PRIO
+ * @param ceiling the ceiling priority, which shall be the highest priority
+ *        of the threads taking this mutex
+ *
+ * @return the created mutex, RT_NULL on error happen
+ *
+ * @see rt_mutex_init_ceiling
+ */
+rt_mutex_t rt_mutex_create_ceiling(const char *name, rt_uint8_t flag, rt_uint8_t ceiling)
+{
+    struct rt_mutex *mutex;
+
+    RT_ASSERT(ceiling < RT_THREAD_PRIORITY_MAX);
+
+    mutex = rt_mutex_create(name, flag | RT_IPC_FLAG_CEILING);
+    if (mutex != RT_NULL)
+        mutex->ceiling_priority = ceiling;
+
+    return mutex;
+}
+
 /**
  * This function will delete a mutex object and release the memory
  *
@@ -642,6 +884,9 @@ rt_err_t rt_mutex_delete(rt_mutex_t mutex)
     RT_ASSERT(rt_object_get_type(&mutex->parent.parent) == RT_Object_Class_Mutex);
     RT_ASSERT(rt_object_is_systemobject(&mutex->parent.parent) == RT_FALSE);
 
+    /* restore the priority of owner */
+    _rt_mutex_clear(mutex);
+
     /* wakeup all suspended threads */
     rt_ipc_list_resume_all(&(mutex->parent.suspend_thread));
 
@@ -703,6 +948,18 @@ rt_err_t rt_mutex_take(rt_mutex_t mutex, rt_int32_t time)
     }
     else
     {
+        /* the thread shall not be higher than the ceiling of mutex */
+        if ((mutex->parent.parent.flag & RT_IPC_FLAG_CEILING) &&
+            _rt_mutex_original_priority(thread) < mutex->ceiling_priority)
+        {
+            thread->error = -RT_EINVAL;
+
+            /* enable interrupt */
+            rt_hw_interrupt_enable(temp);
+
+            return -RT_EINVAL;
+        }
+
         /* The value of mutex is 1 in initial status. Therefore, if the
          * value is great than 0, it indicates the mutex is avaible.
          */
@@ -713,7 +970,8 @@ rt_err_t rt_mutex_take(rt_mutex_t mutex, rt_int32_t time)
 
             /* set mutex owner and original priority */
             mutex->owner             = thread;
-            mutex->original_priority = thread->current_priority;
+            mutex->original_priority = _rt_mutex_original_priority(thread);
+            rt_list_insert_before(&(thread->taken_mutex_list), &(mutex->taken_list));
             if(mutex->hold < RT_MUTEX_HOLD_MAX)
             {
                 mutex->hold ++;
@@ -723,6 +981,15 @@ rt_err_t rt_mutex_take(rt_mutex_t mutex, rt_int32_t time)
                 rt_hw_interrupt_enable(temp); /* enable interrupt */
                 return -RT_EFULL; /* value overflowed */
             }
+
+            /* raise the owner to the ceiling immediately */
+            if ((mutex->parent.parent.flag & RT_IPC_FLAG_CEILING) &&
+                mutex->ceiling_priority < thread->current_priority)
+            {
+                rt_thread_control(thread,
+                                  RT_THREAD_CTRL_CHANGE_PRIORITY,
+                                  &(mutex->ceiling_priority));
+            }
         }
         else
         {
@@ -743,19 +1010,16 @@ rt_err_t rt_mutex_take(rt_mutex_t mutex, rt_int32_t time)
                 RT_DEBUG_LOG(RT_DEBUG_IPC, ("mutex_take: suspend thread: %s\n",
                                             thread->name));
 
-                /* change the owner thread priority of mutex */
-                if (thread->current_priority < mutex->owner->current_priority)
-                {
-                    /* change the owner thread priority */
-                    rt_thread_control(mutex->owner,
-                                      RT_THREAD_CTRL_CHANGE_PRIORITY,
-                                      &thread->current_priority);
-                }
-
                 /* suspend current thread */
                 rt_ipc_list_suspend(&(mutex->parent.suspend_thread),
                                     thread,
-                                    mutex->parent.parent.flag);
+                                    mutex->parent.parent.flag & RT_IPC_FLAG_PRIO);
+                thread->pending_mutex = mutex;
+
+                /* the owner and the owners it waits for inherit the priority,
+                 * the owner of ceiling mutex is already at the ceiling */
+                if (!(mutex->parent.parent.flag & RT_IPC_FLAG_CEILING))
+                    _rt_mutex_update_owner(mutex->owner);
 
                 /* has waiting time, start thread timer */
                 if (time > 0)
@@ -779,6 +1043,19 @@ rt_err_t rt_mutex_take(rt_mutex_t mutex, rt_int32_t time)
 
                 if (thread->error != RT_EOK)
                 {
+                    /* disable interrupt */
+                    temp = rt_hw_interrupt_disable();
+
+                    /* waiting is timeout, the owner does not inherit from this thread anymore */
+                    if (thread->pending_mutex != RT_NULL)
+                    {
+                        thread->pending_mutex = RT_NULL;
+                        _rt_mutex_update_owner(mutex->owner);
+                    }
+
+                    /* enable interrupt */
+                    rt_hw_interrupt_enable(temp);
+
                     /* return error */
                     return thread->error;
                 }
@@ -851,13 +1128,8 @@ rt_err_t rt_mutex_release(rt_mutex_t mutex)
     /* if no hold */
     if (mutex->hold == 0)
     {
-        /* change the owner thread to original priority */
-        if (mutex->original_priority != mutex->owner->current_priority)
-        {
-            rt_thread_control(mutex->owner,
-                              RT_THREAD_CTRL_CHANGE_PRIORITY,
-                              &(mutex->original_priority));
-        }
+        /* change the owner thread to the priority inherited from its remaining mutexes */
+        _rt_mutex_drop_owner(mutex);
 
         /* wakeup suspended thread */
         if (!rt_list_isempty(&mutex->parent.suspend_thread))
@@ -872,7 +1144,9 @@ rt_err_t rt_mutex_release(rt_mutex_t mutex)
 
             /* set new owner and priority */
             mutex->owner             = thread;
-            mutex->original_priority = thread->current_priority;
+            mutex->original_priority = _rt_mutex_original_priority(thread);
+            rt_list_insert_before(&(thread->taken_mutex_list), &(mutex->taken_list));
+            thread->pending_mutex    = RT_NULL;
             if(mutex->hold < RT_MUTEX_HOLD_MAX)
             {
                 mutex->hold ++;
@@ -886,6 +1160,9 @@ rt_err_t rt_mutex_release(rt_mutex_t mutex)
             /* resume thread */
             rt_ipc_list_resume(&(mutex->parent.suspend_thread));
 
+            /* the new owner inherits the priority of remaining waiting threads */
+            _rt_mutex_update_owner(thread);
+
             need_schedule = RT_TRUE;
         }
         else
@@ -1765,88 +2042,374 @@ rt_err_t rt_mb_recv(rt_mailbox_t mb, rt_ubase_t *value, rt_int32_t timeout)
 }
 
 /**
- * This function can get or set some extra attributions of a mailbox object.
+ * This function will send a batch of mails to mailbox object. The mails are
+ * copied in as many as the free entries allow under one critical section, and
+ * one suspended receiver is waked up for each new mail before a single
+ * re-schedule. If the mailbox becomes full, current thread will be suspended
+ * until there are free entries again or timeout.
  *
  * @param mb the mailbox object
- * @param cmd the execution command
- * @param arg the execution argument
+ * @param values the mails to be sent
+ * @param count the number of mails
+ * @param timeout the waiting time
  *
- * @return the error code
+ * @return the number of mails sent. When not all of the mails are sent, the
+ *         errno of current thread is set to the code rt_mb_send_wait returns
+ *         in the same case: -RT_EFULL if the mailbox is full and no waiting
+ *         time is left, -RT_ETIMEOUT if the thread times out while waiting,
+ *         or -RT_ERROR if the mailbox is detached or deleted while waiting.
  */
-rt_err_t rt_mb_control(rt_mailbox_t mb, int cmd, void *arg)
+rt_size_t rt_mb_send_batch(rt_mailbox_t      mb,
+                           const rt_ubase_t *values,
+                           rt_size_t         count,
+                           rt_int32_t        timeout)
 {
-    rt_ubase_t level;
+    struct rt_thread *thread;
+    register rt_ubase_t temp;
+    rt_uint32_t tick_delta;
+    rt_size_t sent, length, index;
+    rt_bool_t need_schedule;
 
     /* parameter check */
     RT_ASSERT(mb != RT_NULL);
     RT_ASSERT(rt_object_get_type(&mb->parent.parent) == RT_Object_Class_MailBox);
+    RT_ASSERT(values != RT_NULL);
 
-    if (cmd == RT_IPC_CMD_RESET)
-    {
-        /* disable interrupt */
-        level = rt_hw_interrupt_disable();
-
-        /* resume all waiting thread */
-        rt_ipc_list_resume_all(&(mb->parent.suspend_thread));
-        /* also resume all mailbox private suspended thread */
-        rt_ipc_list_resume_all(&(mb->suspend_sender_thread));
+    if (count == 0)
+        return 0;
 
-        /* re-init mailbox */
-        mb->entry      = 0;
-        mb->in_offset  = 0;
-        mb->out_offset = 0;
+    /* initialize delta tick */
+    tick_delta = 0;
+    /* get current thread */
+    thread = rt_thread_self();
+    sent = 0;
+    need_schedule = RT_FALSE;
 
-        /* enable interrupt */
-        rt_hw_interrupt_enable(level);
+    RT_OBJECT_HOOK_CALL(rt_object_put_hook, (&(mb->parent.parent)));
 
-        rt_schedule();
+    /* disable interrupt */
+    temp = rt_hw_interrupt_disable();
 
-        return RT_EOK;
-    }
+    while (1)
+    {
+        /* fill the free entries */
+        length = mb->size - mb->entry;
+        if (length > count - sent)
+            length = count - sent;
 
-    return -RT_ERROR;
-}
-#endif /* end of RT_USING_MAILBOX */
+        for (index = 0; index < length; index ++)
+        {
+            mb->msg_pool[mb->in_offset] = values[sent + index];
+            ++ mb->in_offset;
+            if (mb->in_offset >= mb->size)
+                mb->in_offset = 0;
+        }
+        mb->entry += length;
+        sent += length;
 
-#ifdef RT_USING_MESSAGEQUEUE
-struct rt_mq_message
-{
-    struct rt_mq_message *next;
-};
+        /* resume one suspended thread for each new mail */
+        for (index = 0; index < length; index ++)
+        {
+            if (rt_list_isempty(&mb->parent.suspend_thread))
+                break;
 
-/**
- * This function will initialize a message queue and put it under control of
- * resource management.
- *
- * @param mq the message object
- * @param name the name of message queue
- * @param msgpool the beginning address of buffer to save messages
- * @param msg_size the maximum size of message
- * @param pool_size the size of buffer to save messages
- * @param flag the flag of message queue
- *
- * @return the operation status, RT_EOK on successful
- */
-rt_err_t rt_mq_init(rt_mq_t     mq,
-                    const char *name,
-                    void       *msgpool,
-                    rt_size_t   msg_size,
-                    rt_size_t   pool_size,
-                    rt_uint8_t  flag)
-{
-    struct rt_mq_message *head;
-    register rt_base_t temp;
+            rt_ipc_list_resume(&(mb->parent.suspend_thread));
+            need_schedule = RT_TRUE;
+        }
 
-    /* parameter check */
-    RT_ASSERT(mq != RT_NULL);
+        if (sent == count || timeout == 0)
+            break;
 
-    /* initialize object */
-    rt_object_init(&(mq->parent.parent), RT_Object_Class_MessageQueue, name);
+        /* mailbox is full */
+        thread->error = RT_EOK;
 
-    /* set parent flag */
-    mq->parent.parent.flag = flag;
+        RT_DEBUG_IN_THREAD_CONTEXT;
+        /* suspend current thread */
+        rt_ipc_list_suspend(&(mb->suspend_sender_thread),
+                            thread,
+                            mb->parent.parent.flag);
 
-    /* initialize ipc object */
+        /* has waiting time, start thread timer */
+        if (timeout > 0)
+        {
+            /* get the start tick of timer */
+            tick_delta = rt_tick_get();
+
+            RT_DEBUG_LOG(RT_DEBUG_IPC, ("mb_send_batch: start timer of thread:%s\n",
+                                        thread->name));
+
+            /* reset the timeout of thread timer and start it */
+            rt_timer_control(&(thread->thread_timer),
+                             RT_TIMER_CTRL_SET_TIME,
+                             &timeout);
+            rt_timer_start(&(thread->thread_timer));
+        }
+
+        /* enable interrupt */
+        rt_hw_interrupt_enable(temp);
+
+        /* re-schedule, the resumed receivers run here as well */
+        rt_schedule();
+        need_schedule = RT_FALSE;
+
+        /* resume from suspend state, the error of thread is the errno */
+        if (thread->error != RT_EOK)
+        {
+            return sent;
+        }
+
+        /* disable interrupt */
+        temp = rt_hw_interrupt_disable();
+
+        /* if it's not waiting forever and then re-calculate timeout tick */
+        if (timeout > 0)
+        {
+            tick_delta = rt_tick_get() - tick_delta;
+            timeout -= tick_delta;
+            if (timeout < 0)
+                timeout = 0;
+        }
+    }
+
+    /* enable interrupt */
+    rt_hw_interrupt_enable(temp);
+
+    if (sent < count)
+        rt_set_errno(-RT_EFULL);
+
+    if (need_schedule == RT_TRUE)
+        rt_schedule();
+
+    return sent;
+}
+
+/**
+ * This function will receive a batch of mails from mailbox object. If there
+ * is no mail in mailbox object, the thread shall wait for a specified time,
+ * otherwise it takes the mails available at most count under one critical
+ * section, and wakes up one suspended sender for each free entry before a
+ * single re-schedule.
+ *
+ * @param mb the mailbox object
+ * @param values the received mails will be saved in
+ * @param count the maximum number of mails to be received
+ * @param timeout the waiting time
+ *
+ * @return the number of mails received, 0 on timeout and the error code is
+ *         set to the errno of current thread
+ */
+rt_size_t rt_mb_recv_batch(rt_mailbox_t mb,
+                           rt_ubase_t  *values,
+                           rt_size_t    count,
+                           rt_int32_t   timeout)
+{
+    struct rt_thread *thread;
+    register rt_ubase_t temp;
+    rt_uint32_t tick_delta;
+    rt_size_t length, index;
+    rt_bool_t need_schedule;
+
+    /* parameter check */
+    RT_ASSERT(mb != RT_NULL);
+    RT_ASSERT(rt_object_get_type(&mb->parent.parent) == RT_Object_Class_MailBox);
+    RT_ASSERT(values != RT_NULL);
+
+    if (count == 0)
+        return 0;
+
+    /* initialize delta tick */
+    tick_delta = 0;
+    /* get current thread */
+    thread = rt_thread_self();
+    need_schedule = RT_FALSE;
+
+    RT_OBJECT_HOOK_CALL(rt_object_trytake_hook, (&(mb->parent.parent)));
+
+    /* disable interrupt */
+    temp = rt_hw_interrupt_disable();
+
+    /* mailbox is empty */
+    while (mb->entry == 0)
+    {
+        /* reset error number in thread */
+        thread->error = RT_EOK;
+
+        /* no waiting, return timeout */
+        if (timeout == 0)
+        {
+            /* enable interrupt */
+            rt_hw_interrupt_enable(temp);
+
+            rt_set_errno(-RT_ETIMEOUT);
+
+            return 0;
+        }
+
+        RT_DEBUG_IN_THREAD_CONTEXT;
+        /* suspend current thread */
+        rt_ipc_list_suspend(&(mb->parent.suspend_thread),
+                            thread,
+                            mb->parent.parent.flag);
+
+        /* has waiting time, start thread timer */
+        if (timeout > 0)
+        {
+            /* get the start tick of timer */
+            tick_delta = rt_tick_get();
+
+            RT_DEBUG_LOG(RT_DEBUG_IPC, ("mb_recv_batch: start timer of thread:%s\n",
+                                        thread->name));
+
+            /* reset the timeout of thread timer and start it */
+            rt_timer_control(&(thread->thread_timer),
+                             RT_TIMER_CTRL_SET_TIME,
+                             &timeout);
+            rt_timer_start(&(thread->thread_timer));
+        }
+
+        /* enable interrupt */
+        rt_hw_interrupt_enable(temp);
+
+        /* re-schedule */
+        rt_schedule();
+
+        /* resume from suspend state */
+        if (thread->error != RT_EOK)
+        {
+            return 0;
+        }
+
+        /* disable interrupt */
+        temp = rt_hw_interrupt_disable();
+
+        /* if it's not waiting forever and then re-calculate timeout tick */
+        if (timeout > 0)
+        {
+            tick_delta = rt_tick_get() - tick_delta;
+            timeout -= tick_delta;
+            if (timeout < 0)
+                timeout = 0;
+        }
+    }
+
+    /* take the mails available */
+    length = mb->entry;
+    if (length > count)
+        length = count;
+
+    for (index = 0; index < length; index ++)
+    {
+        values[index] = mb->msg_pool[mb->out_offset];
+        ++ mb->out_offset;
+        if (mb->out_offset >= mb->size)
+            mb->out_offset = 0;
+    }
+    mb->entry -= length;
+
+    /* resume one suspended sender for each free entry */
+    for (index = 0; index < length; index ++)
+    {
+        if (rt_list_isempty(&(mb->suspend_sender_thread)))
+            break;
+
+        rt_ipc_list_resume(&(mb->suspend_sender_thread));
+        need_schedule = RT_TRUE;
+    }
+
+    /* enable interrupt */
+    rt_hw_interrupt_enable(temp);
+
+    RT_OBJECT_HOOK_CALL(rt_object_take_hook, (&(mb->parent.parent)));
+
+    if (need_schedule == RT_TRUE)
+        rt_schedule();
+
+    return length;
+}
+
+/**
+ * This function can get or set some extra attributions of a mailbox object.
+ *
+ * @param mb the mailbox object
+ * @param cmd the execution command
+ * @param arg the execution argument
+ *
+ * @return the error code
+ */
+rt_err_t rt_mb_control(rt_mailbox_t mb, int cmd, void *arg)
+{
+    rt_ubase_t level;
+
+    /* parameter check */
+    RT_ASSERT(mb != RT_NULL);
+    RT_ASSERT(rt_object_get_type(&mb->parent.parent) == RT_Object_Class_MailBox);
+
+    if (cmd == RT_IPC_CMD_RESET)
+    {
+        /* disable interrupt */
+        level = rt_hw_interrupt_disable();
+
+        /* resume all waiting thread */
+        rt_ipc_list_resume_all(&(mb->parent.suspend_thread));
+        /* also resume all mailbox private suspended thread */
+        rt_ipc_list_resume_all(&(mb->suspend_sender_thread));
+
+        /* re-init mailbox */
+        mb->entry      = 0;
+        mb->in_offset  = 0;
+        mb->out_offset = 0;
+
+        /* enable interrupt */
+        rt_hw_interrupt_enable(level);
+
+        rt_schedule();
+
+        return RT_EOK;
+    }
+
+    return -RT_ERROR;
+}
+#endif /* end of RT_USING_MAILBOX */
+
+#ifdef RT_USING_MESSAGEQUEUE
+struct rt_mq_message
+{
+    struct rt_mq_message *next;
+};
+
+/**
+ * This function will initialize a message queue and put it under control of
+ * resource management.
+ *
+ * @param mq the message object
+ * @param name the name of message queue
+ * @param msgpool the beginning address of buffer to save messages
+ * @param msg_size the maximum size of message
+ * @param pool_size the size of buffer to save messages
+ * @param flag the flag of message queue
+ *
+ * @return the operation status, RT_EOK on successful
+ */
+rt_err_t rt_mq_init(rt_mq_t     mq,
+                    const char *name,
+                    void       *msgpool,
+                    rt_size_t   msg_size,
+                    rt_size_t   pool_size,
+                    rt_uint8_t  flag)
+{
+    struct rt_mq_message *head;
+    register rt_base_t temp;
+
+    /* parameter check */
+    RT_ASSERT(mq != RT_NULL);
+
+    /* initialize object */
+    rt_object_init(&(mq->parent.parent), RT_Object_Class_MessageQueue, name);
+
+    /* set parent flag */
+    mq->parent.parent.flag = flag;
+
+    /* initialize ipc object */
     rt_ipc_object_init(&(mq->parent));
 
     /* set message pool */
@@ -2444,6 +3007,357 @@ rt_err_t rt_mq_recv(rt_mq_t    mq,
     return RT_EOK;
 }
 
+/**
+ * This function will send a batch of messages to message queue object. The
+ * free messages are taken as many as possible at once, filled outside of the
+ * critical section, and then linked to the queue at once, and one suspended
+ * receiver is waked up for each new message before a single re-schedule. If
+ * the message queue becomes full, current thread will be suspended until
+ * there are free messages again or timeout.
+ *
+ * @param mq the message queue object
+ * @param buffer the messages, which are stored one after another
+ * @param size the size of each message
+ * @param count the number of messages
+ * @param timeout the waiting time
+ *
+ * @return the number of messages sent. When not all of the messages are sent, the
+ *         errno of current thread is set to the code rt_mq_send_wait returns
+ *         in the same case: -RT_EFULL if the message queue is full and no waiting
+ *         time is left, -RT_ETIMEOUT if the thread times out while waiting,
+ *         or -RT_ERROR if the message queue is detached or deleted while waiting.
+ */
+rt_size_t rt_mq_send_batch(rt_mq_t     mq,
+                           const void *buffer,
+                           rt_size_t   size,
+                           rt_size_t   count,
+                           rt_int32_t  timeout)
+{
+    register rt_ubase_t temp;
+    struct rt_mq_message *msg, *first, *last;
+    rt_uint32_t tick_delta;
+    struct rt_thread *thread;
+    rt_size_t sent, length, index;
+    rt_bool_t need_schedule;
+
+    /* parameter check */
+    RT_ASSERT(mq != RT_NULL);
+    RT_ASSERT(rt_object_get_type(&mq->parent.parent) == RT_Object_Class_MessageQueue);
+    RT_ASSERT(buffer != RT_NULL);
+    RT_ASSERT(size != 0);
+
+    /* greater than one message size */
+    if (size > mq->msg_size)
+    {
+        rt_set_errno(-RT_ERROR);
+
+        return 0;
+    }
+
+    if (count == 0)
+        return 0;
+
+    /* initialize delta tick */
+    tick_delta = 0;
+    /* get current thread */
+    thread = rt_thread_self();
+    sent = 0;
+    need_schedule = RT_FALSE;
+
+    RT_OBJECT_HOOK_CALL(rt_object_put_hook, (&(mq->parent.parent)));
+
+    /* disable interrupt */
+    temp = rt_hw_interrupt_disable();
+
+    while (1)
+    {
+        /* take free messages as many as possible */
+        first = last = RT_NULL;
+        length = 0;
+        while (length < count - sent && mq->msg_queue_free != RT_NULL)
+        {
+            msg = (struct rt_mq_message *)mq->msg_queue_free;
+            mq->msg_queue_free = msg->next;
+
+            msg->next = RT_NULL;
+            if (last != RT_NULL)
+                last->next = msg;
+            else
+                first = msg;
+            last = msg;
+            length ++;
+        }
+
+        if (length > 0)
+        {
+            /* enable interrupt */
+            rt_hw_interrupt_enable(temp);
+
+            /* copy buffer */
+            for (msg = first, index = sent; msg != RT_NULL; msg = msg->next, index ++)
+            {
+                rt_memcpy(msg + 1, (const rt_uint8_t *)buffer + index * size, size);
+            }
+
+            /* disable interrupt */
+            temp = rt_hw_interrupt_disable();
+
+            /* link messages to message queue */
+            if (mq->msg_queue_tail != RT_NULL)
+                ((struct rt_mq_message *)mq->msg_queue_tail)->next = first;
+            mq->msg_queue_tail = last;
+            if (mq->msg_queue_head == RT_NULL)
+                mq->msg_queue_head = first;
+
+            mq->entry += length;
+            sent += length;
+
+            /* resume one suspended thread for each new message */
+            for (index = 0; index < length; index ++)
+            {
+                if (rt_list_isempty(&mq->parent.suspend_thread))
+                    break;
+
+                rt_ipc_list_resume(&(mq->parent.suspend_thread));
+                need_schedule = RT_TRUE;
+            }
+        }
+
+        if (sent == count || timeout == 0)
+            break;
+
+        /* the free messages may be taken by others when interrupt enabled */
+        if (mq->msg_queue_free != RT_NULL)
+            continue;
+
+        /* message queue is full */
+        thread->error = RT_EOK;
+
+        RT_DEBUG_IN_THREAD_CONTEXT;
+        /* suspend current thread */
+        rt_ipc_list_suspend(&(mq->suspend_sender_thread),
+                            thread,
+                            mq->parent.parent.flag);
+
+        /* has waiting time, start thread timer */
+        if (timeout > 0)
+        {
+            /* get the start tick of timer */
+            tick_delta = rt_tick_get();
+
+            RT_DEBUG_LOG(RT_DEBUG_IPC, ("mq_send_batch: start timer of thread:%s\n",
+                                        thread->name));
+
+            /* reset the timeout of thread timer and start it */
+            rt_timer_control(&(thread->thread_timer),
+                             RT_TIMER_CTRL_SET_TIME,
+                             &timeout);
+            rt_timer_start(&(thread->thread_timer));
+        }
+
+        /* enable interrupt */
+        rt_hw_interrupt_enable(temp);
+
+        /* re-schedule, the resumed receivers run here as well */
+        rt_schedule();
+        need_schedule = RT_FALSE;
+
+        /* resume from suspend state, the error of thread is the errno */
+        if (thread->error != RT_EOK)
+        {
+            return sent;
+        }
+
+        /* disable interrupt */
+        temp = rt_hw_interrupt_disable();
+
+        /* if it's not waiting forever and then re-calculate timeout tick */
+        if (timeout > 0)
+        {
+            tick_delta = rt_tick_get() - tick_delta;
+            timeout -= tick_delta;
+            if (timeout < 0)
+                timeout = 0;
+        }
+    }
+
+    /* enable interrupt */
+    rt_hw_interrupt_enable(temp);
+
+    if (sent < count)
+        rt_set_errno(-RT_EFULL);
+
+    if (need_schedule == RT_TRUE)
+        rt_schedule();
+
+    return sent;
+}
+
+/**
+ * This function will receive a batch of messages from message queue object.
+ * If there is no message in message queue object, the thread shall wait for a
+ * specified time, otherwise it takes the messages available at most count at
+ * once, and wakes up one suspended sender for each free message before a
+ * single re-schedule.
+ *
+ * @param mq the message queue object
+ * @param buffer the received messages will be saved in one after another
+ * @param size the size of each message in buffer
+ * @param count the maximum number of messages to be received
+ * @param timeout the waiting time
+ *
+ * @return the number of messages received, 0 on timeout and the error code is
+ *         set to the errno of current thread
+ */
+rt_size_t rt_mq_recv_batch(rt_mq_t    mq,
+                           void      *buffer,
+                           rt_size_t  size,
+                           rt_size_t  count,
+                           rt_int32_t timeout)
+{
+    struct rt_thread *thread;
+    register rt_ubase_t temp;
+    struct rt_mq_message *msg, *first, *last;
+    rt_uint32_t tick_delta;
+    rt_size_t length, index;
+    rt_bool_t need_schedule;
+
+    /* parameter check */
+    RT_ASSERT(mq != RT_NULL);
+    RT_ASSERT(rt_object_get_type(&mq->parent.parent) == RT_Object_Class_MessageQueue);
+    RT_ASSERT(buffer != RT_NULL);
+    RT_ASSERT(size != 0);
+
+    if (count == 0)
+        return 0;
+
+    /* initialize delta tick */
+    tick_delta = 0;
+    /* get current thread */
+    thread = rt_thread_self();
+    need_schedule = RT_FALSE;
+    RT_OBJECT_HOOK_CALL(rt_object_trytake_hook, (&(mq->parent.parent)));
+
+    /* disable interrupt */
+    temp = rt_hw_interrupt_disable();
+
+    /* message queue is empty */
+    while (mq->entry == 0)
+    {
+        RT_DEBUG_IN_THREAD_CONTEXT;
+
+        /* reset error number in thread */
+        thread->error = RT_EOK;
+
+        /* no waiting, return timeout */
+        if (timeout == 0)
+        {
+            /* enable interrupt */
+            rt_hw_interrupt_enable(temp);
+
+            rt_set_errno(-RT_ETIMEOUT);
+
+            return 0;
+        }
+
+        /* suspend current thread */
+        rt_ipc_list_suspend(&(mq->parent.suspend_thread),
+                            thread,
+                            mq->parent.parent.flag);
+
+        /* has waiting time, start thread timer */
+        if (timeout > 0)
+        {
+            /* get the start tick of timer */
+            tick_delta = rt_tick_get();
+
+            RT_DEBUG_LOG(RT_DEBUG_IPC, ("set thread:%s to timer list\n",
+                                        thread->name));
+
+            /* reset the timeout of thread timer and start it */
+            rt_timer_control(&(thread->thread_timer),
+                             RT_TIMER_CTRL_SET_TIME,
+                             &timeout);
+            rt_timer_start(&(thread->thread_timer));
+        }
+
+        /* enable interrupt */
+        rt_hw_interrupt_enable(temp);
+
+        /* re-schedule */
+        rt_schedule();
+
+        /* recv message */
+        if (thread->error != RT_EOK)
+        {
+            return 0;
+        }
+
+        /* disable interrupt */
+        temp = rt_hw_interrupt_disable();
+
+        /* if it's not waiting forever and then re-calculate timeout tick */
+        if (timeout > 0)
+        {
+            tick_delta = rt_tick_get() - tick_delta;
+            timeout -= tick_delta;
+            if (timeout < 0)
+                timeout = 0;
+        }
+    }
+
+    /* detach the messages available from queue head */
+    first = last = (struct rt_mq_message *)mq->msg_queue_head;
+    for (length = 1; length < count && length < mq->entry; length ++)
+        last = last->next;
+
+    /* move message queue head */
+    mq->msg_queue_head = last->next;
+    /* reach queue tail, set to NULL */
+    if (mq->msg_queue_tail == last)
+        mq->msg_queue_tail = RT_NULL;
+    last->next = RT_NULL;
+
+    /* decrease message entry */
+    mq->entry -= length;
+
+    /* enable interrupt */
+    rt_hw_interrupt_enable(temp);
+
+    /* copy message */
+    for (msg = first, index = 0; msg != RT_NULL; msg = msg->next, index ++)
+    {
+        rt_memcpy((rt_uint8_t *)buffer + index * size, msg + 1,
+                  size > mq->msg_size ? mq->msg_size : size);
+    }
+
+    /* disable interrupt */
+    temp = rt_hw_interrupt_disable();
+    /* put messages to free list */
+    last->next = (struct rt_mq_message *)mq->msg_queue_free;
+    mq->msg_queue_free = first;
+
+    /* resume one suspended sender for each free message */
+    for (index = 0; index < length; index ++)
+    {
+        if (rt_list_isempty(&(mq->suspend_sender_thread)))
+            break;
+
+        rt_ipc_list_resume(&(mq->suspend_sender_thread));
+        need_schedule = RT_TRUE;
+    }
+
+    /* enable interrupt */
+    rt_hw_interrupt_enable(temp);
+
+    RT_OBJECT_HOOK_CALL(rt_object_take_hook, (&(mq->parent.parent)));
+
+    if (need_schedule == RT_TRUE)
+        rt_schedule();
+
+    return length;
+}
+
 /**
  * This function can get or set some extra attributions of a message queue
  * object.
@@ -42,6 +42,28 @@ void rt_interrupt_leave_sethook(void (*hook)(void))
 {
     rt_interrupt_leave_hook = hook;
 }
+
+/**
+ * This function will get the hook function invoked when the system enters an
+ * interrupt, so it can be chained and restored.
+ *
+ * @return the hook function
+ */
+void (*rt_interrupt_enter_gethook(void))(void)
+{
+    return rt_interrupt_enter_hook;
+}
+
+/**
+ * This function will get the hook function invoked when the system exits an
+ * interrupt, so it can be chained and restored.
+ *
+ * @return the hook function
+ */
+void (*rt_interrupt_leave_gethook(void))(void)
+{
+    return rt_interrupt_leave_hook;
+}
 #endif
 
 /* #define IRQ_DEBUG */
@@ -52,9 +74,13 @@ void rt_interrupt_leave_sethook(void (*hook)(void))
 
 /**@{*/
 /*
- * Anotation：中断嵌套的层数。
+ * Anotation：中断嵌套的层数，SMP下每个CPU各自记录。
  * */
+#ifdef RT_USING_SMP
+#define rt_interrupt_nest rt_cpu_self()->irq_nest
+#else
 volatile rt_uint8_t rt_interrupt_nest;
+#endif /*RT_USING_SMP*/
 
 /**
  * This function will be invoked by BSP, when enter interrupt service routine
@@ -74,6 +100,9 @@ void rt_interrupt_enter(void)
 
     level = rt_hw_interrupt_disable();
     rt_interrupt_nest ++;
+#ifdef RT_USING_IRQ_LATENCY
+    rt_irqlat_isr_enter();
+#endif
     RT_OBJECT_HOOK_CALL(rt_interrupt_enter_hook,());
     rt_hw_interrupt_enable(level);
 }
@@ -0,0 +1,362 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2021-09-30     RT-Thread    the first version
+ *
+ * Anotation：关中断区间和中断进入延迟的测量。打开 RT_USING_IRQ_LATENCY 后，rthw.h 把
+ * rt_hw_interrupt_disable/enable 替换成带调用位置（函数名和行号）的包装函数，用 CPU
+ * 周期计数器测量最外层关中断区间的长度，记录最长的前 N 个调用位置和按 2 的幂分桶的
+ * 直方图；rt_interrupt_enter 通过 BSP 提供的 rt_hw_irq_latency_get 记录中断进入延迟。
+ * 无节拍空闲模式在关中断状态下睡眠，睡眠的时间不计入关中断区间。
+ * 统计结果用 irqlat 命令查看，可以设置预算并统计超出预算的次数。
+ */
+
+#include <rthw.h>
+#include <rtthread.h>
+
+#ifdef RT_USING_IRQ_LATENCY
+
+#ifdef RT_USING_SMP
+#error "RT_USING_IRQ_LATENCY does not support RT_USING_SMP"
+#endif
+
+#define IRQLAT_HIST_NR          32              /* the buckets of power of 2 cycles */
+
+struct irqlat_site
+{
+    const char *func;
+    int line;
+    rt_uint32_t max;
+};
+
+struct irqlat_stat
+{
+    rt_uint32_t count;
+    rt_uint32_t max;
+    rt_uint32_t over;                           /* the number of measurements over budget */
+    rt_uint32_t hist[IRQLAT_HIST_NR];
+};
+
+static struct irqlat_stat _irqoff;
+static struct irqlat_stat _isr;
+
+/* the longest interrupt disabled sections by call site */
+static struct irqlat_site _top[RT_IRQ_LATENCY_TOP_NR];
+static rt_uint32_t _top_min;
+
+static rt_uint32_t _budget = RT_IRQ_LATENCY_BUDGET;
+
+/* the current interrupt disabled section */
+static rt_uint32_t _nest;
+static rt_uint32_t _start;
+static rt_uint32_t _elapsed;                    /* the cycles before the cpu sleeps */
+static const char *_site_func;
+static int _site_line;
+
+rt_inline int _irqlat_bucket(rt_uint32_t cycles)
+{
+    int bucket = 0;
+
+#if defined(__GNUC__)
+    if (cycles > 1)
+        bucket = 31 - __builtin_clz(cycles);
+#else
+    while (cycles > 1)
+    {
+        cycles >>= 1;
+        bucket ++;
+    }
+#endif
+
+    return bucket;
+}
+
+static void _irqlat_account(struct irqlat_stat *stat, rt_uint32_t cycles)
+{
+    stat->count ++;
+    if (cycles > stat->max)
+        stat->max = cycles;
+    if (_budget != 0 && cycles > _budget)
+        stat->over ++;
+    stat->hist[_irqlat_bucket(cycles)] ++;
+}
+
+/*
+ * update the longest sections, the shortest one is replaced when the table
+ * is full.
+ */
+static void _irqlat_top_update(const char *func, int line, rt_uint32_t cycles)
+{
+    struct irqlat_site *site = RT_NULL;
+    int index, shortest = 0;
+
+    if (cycles <= _top_min)
+        return;
+
+    for (index = 0; index < RT_IRQ_LATENCY_TOP_NR; index ++)
+    {
+        if (_top[index].func == func && _top[index].line == line)
+        {
+            site = &_top[index];
+            break;
+        }
+
+        if (_top[index].max < _top[shortest].max)
+            shortest = index;
+    }
+
+    if (site == RT_NULL)
+    {
+        site = &_top[shortest];
+        site->func = func;
+        site->line = line;
+        site->max  = 0;
+    }
+
+    if (cycles > site->max)
+        site->max = cycles;
+
+    /* the threshold to enter the table, 0 if it is not full */
+    _top_min = RT_UINT32_MAX;
+    for (index = 0; index < RT_IRQ_LATENCY_TOP_NR; index ++)
+    {
+        if (_top[index].func == RT_NULL)
+        {
+            _top_min = 0;
+            break;
+        }
+
+        if (_top[index].max < _top_min)
+            _top_min = _top[index].max;
+    }
+}
+
+/**
+ * This function will disable the interrupt and start to measure the section
+ * if it is the outermost one. It replaces rt_hw_interrupt_disable() by the
+ * macro in rthw.h.
+ *
+ * @param func the function of call site
+ * @param line the line of call site
+ *
+ * @return the interrupt level of rt_hw_interrupt_disable()
+ */
+rt_base_t rt_irqlat_disable(const char *func, int line)
+{
+    rt_base_t level;
+
+    /* the real one, the name in parentheses is not expanded by the macro */
+    level = (rt_hw_interrupt_disable)();
+
+    if (_nest ++ == 0)
+    {
+        _site_func = func;
+        _site_line = line;
+        _start     = rt_hw_cycle_get();
+    }
+
+    return level;
+}
+
+/**
+ * This function will finish the measurement if it is the outermost section,
+ * and enable the interrupt. It replaces rt_hw_interrupt_enable() by the macro
+ * in rthw.h.
+ *
+ * @param level the interrupt level of rt_irqlat_disable()
+ */
+void rt_irqlat_enable(rt_base_t level)
+{
+    rt_uint32_t cycles;
+
+    if (_nest > 0 && -- _nest == 0)
+    {
+        cycles = rt_hw_cycle_get() - _start;
+
+        _irqlat_account(&_irqoff, cycles);
+        _irqlat_top_update(_site_func, _site_line, cycles);
+    }
+
+    (rt_hw_interrupt_enable)(level);
+}
+
+/**
+ * This function will get the latency of current interrupt, the cycles from
+ * the request of interrupt to the entry of its service routine. It shall be
+ * provided by BSP.
+ *
+ * @return the cycles of latency, RT_UINT32_MAX if it is unknown
+ */
+RT_WEAK rt_uint32_t rt_hw_irq_latency_get(void)
+{
+    return RT_UINT32_MAX;
+}
+
+/**
+ * This function will record the entry latency of current interrupt, it is
+ * invoked by rt_interrupt_enter() with interrupt disabled.
+ */
+void rt_irqlat_isr_enter(void)
+{
+    rt_uint32_t cycles;
+
+    cycles = rt_hw_irq_latency_get();
+    if (cycles != RT_UINT32_MAX)
+        _irqlat_account(&_isr, cycles);
+}
+
+/**
+ * This function will pause the measurement of current interrupt disabled
+ * section before the cpu sleeps with interrupt disabled, such as the tickless
+ * idle. The interrupt is serviced as soon as the cpu wakes up and enables it,
+ * so the sleep is not a latency.
+ */
+void rt_irqlat_sleep_enter(void)
+{
+    if (_nest > 0)
+        _elapsed = rt_hw_cycle_get() - _start;
+}
+
+/**
+ * This function will resume the measurement of current interrupt disabled
+ * section after the cpu wakes up, the cycles of sleep are excluded.
+ */
+void rt_irqlat_sleep_exit(void)
+{
+    if (_nest > 0)
+        _start = rt_hw_cycle_get() - _elapsed;
+}
+
+/**
+ * This function will clear the measurements. It is invoked when the scheduler
+ * starts, because the interrupt disabled at startup is enabled by the first
+ * thread without rt_hw_interrupt_enable().
+ */
+void rt_irqlat_reset(void)
+{
+    register rt_base_t level;
+
+    level = rt_hw_interrupt_disable();
+
+    rt_memset(&_irqoff, 0, sizeof(_irqoff));
+    rt_memset(&_isr, 0, sizeof(_isr));
+    rt_memset(_top, 0, sizeof(_top));
+    _top_min = 0;
+
+    /* the current section is not measured */
+    _nest = 0;
+
+    rt_hw_interrupt_enable(level);
+}
+
+#ifdef RT_USING_FINSH
+#include <finsh.h>
+
+static void _irqlat_show_stat(const char *name, struct irqlat_stat *stat)
+{
+    rt_kprintf("%s: %d, max %d cycles", name, stat->count, stat->max);
+    if (_budget != 0)
+        rt_kprintf(", %d over budget", stat->over);
+    rt_kprintf("\n");
+}
+
+static void _irqlat_show(void)
+{
+    struct irqlat_stat irqoff, isr;
+    struct irqlat_site top[RT_IRQ_LATENCY_TOP_NR], site;
+    register rt_base_t level;
+    int index, next, first, last;
+
+    /* take a snapshot, the output is not measured */
+    level = rt_hw_interrupt_disable();
+    irqoff = _irqoff;
+    isr    = _isr;
+    rt_memcpy(top, _top, sizeof(top));
+    rt_hw_interrupt_enable(level);
+
+    if (_budget != 0)
+        rt_kprintf("budget: %d cycles\n", _budget);
+    _irqlat_show_stat("interrupt disabled", &irqoff);
+    _irqlat_show_stat("interrupt latency", &isr);
+
+    /* the longest sections first */
+    for (index = 0; index < RT_IRQ_LATENCY_TOP_NR; index ++)
+    {
+        for (next = index + 1; next < RT_IRQ_LATENCY_TOP_NR; next ++)
+        {
+            if (top[next].max > top[index].max)
+            {
+                site       = top[index];
+                top[index] = top[next];
+                top[next]  = site;
+            }
+        }
+    }
+
+    rt_kprintf("\nsite                                     line   max cycles\n");
+    rt_kprintf("---------------------------------------- ------ ----------\n");
+    for (index = 0; index < RT_IRQ_LATENCY_TOP_NR && top[index].func != RT_NULL; index ++)
+    {
+        rt_kprintf("%-40.40s %6d %10d\n", top[index].func, top[index].line, top[index].max);
+    }
+
+    /* the range of non-empty buckets */
+    first = IRQLAT_HIST_NR;
+    last  = -1;
+    for (index = 0; index < IRQLAT_HIST_NR; index ++)
+    {
+        if (irqoff.hist[index] != 0 || isr.hist[index] != 0)
+        {
+            if (first == IRQLAT_HIST_NR)
+                first = index;
+            last = index;
+        }
+    }
+
+    rt_kprintf("\ncycles                      disabled    latency\n");
+    rt_kprintf("------------------------- ---------- ----------\n");
+    for (index = first; index <= last; index ++)
+    {
+        rt_kprintf("[%10u, %10u) %10d %10d\n", index == 0 ? 0 : 1u << index,
+                   index == 31 ? RT_UINT32_MAX : 1u << (index + 1),
+                   irqoff.hist[index], isr.hist[index]);
+    }
+}
+
+static int irqlat(int argc, char **argv)
+{
+    const char *ptr;
+
+    if (argc == 1)
+    {
+        _irqlat_show();
+    }
+    else if (argc == 2 && rt_strcmp(argv[1], "reset") == 0)
+    {
+        rt_irqlat_reset();
+    }
+    else if (argc == 3 && rt_strcmp(argv[1], "budget") == 0)
+    {
+        _budget = 0;
+        for (ptr = argv[2]; *ptr >= '0' && *ptr <= '9'; ptr ++)
+            _budget = _budget * 10 + (*ptr - '0');
+    }
+    else
+    {
+        rt_kprintf("Usage: irqlat [reset|budget <cycles>]\n");
+        rt_kprintf("  show the interrupt disabled sections and the interrupt latency,\n");
+        rt_kprintf("  the measurements over budget are counted, budget 0 for none.\n");
+
+        return -RT_EINVAL;
+    }
+
+    return 0;
+}
+MSH_CMD_EXPORT(irqlat, interrupt latency and disabled sections);
+#endif /* RT_USING_FINSH */
+
+#endif /* RT_USING_IRQ_LATENCY */
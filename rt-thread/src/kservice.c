@@ -1198,6 +1198,14 @@ void rt_kprintf(const char *fmt, ...)
     static char rt_log_buf[RT_CONSOLEBUF_SIZE];
 
     va_start(args, fmt);
+#if defined(RT_USING_ASYNC_LOG) && defined(RT_ASYNC_LOG_USING_KPRINTF)
+    /* the output is written by the log thread, or here if it is not buffered */
+    if (rt_async_log_vprintf(fmt, args) != -RT_ENOSYS)
+    {
+        va_end(args);
+        return;
+    }
+#endif
     /* the return value of vsnprintf is the number of bytes that would be
      * written to buffer had if the size of the buffer been sufficiently
      * large excluding the terminating null byte. If the output string
@@ -1229,14 +1237,15 @@ void rt_kprintf(const char *fmt, ...)
 #ifdef RT_USING_HEAP
 /**
  * This function allocates a memory block, which address is aligned to the
- * specified alignment size.
+ * specified alignment size. It is the generic version, which wastes up to
+ * align bytes, the heap may provide its own version.
  *
  * @param size the allocated memory block size
  * @param align the alignment size
  *
  * @return the allocated memory block on successful, otherwise returns RT_NULL
  */
-void *rt_malloc_align(rt_size_t size, rt_size_t align)
+RT_WEAK void *rt_malloc_align(rt_size_t size, rt_size_t align)
 {
     void *ptr;
     void *align_ptr;
@@ -1281,7 +1290,7 @@ void *rt_malloc_align(rt_size_t size, rt_size_t align)
  *
  * @param ptr the memory block pointer
  */
-void rt_free_align(void *ptr)
+RT_WEAK void rt_free_align(void *ptr)
 {
     void *real_ptr;
 
@@ -1368,6 +1377,10 @@ void rt_assert_handler(const char *ex_string, const char *func, rt_size_t line)
 
     if (rt_assert_hook == RT_NULL)
     {
+#ifdef RT_USING_ASYNC_LOG
+        /* the log thread never runs again */
+        rt_async_log_sync();
+#endif
         rt_kprintf("(%s) assertion failed at function:%s, line number:%d \n", ex_string, func, line);
         while (dummy == 0);
     }
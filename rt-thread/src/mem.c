@@ -88,6 +88,28 @@ void rt_free_sethook(void (*hook)(void *ptr))
     rt_free_hook = hook;
 }
 
+/**
+ * This function will get the hook function invoked when a memory block is
+ * allocated from heap memory, so it can be chained and restored.
+ *
+ * @return the hook function
+ */
+void (*rt_malloc_gethook(void))(void *ptr, rt_size_t size)
+{
+    return rt_malloc_hook;
+}
+
+/**
+ * This function will get the hook function invoked when a memory block is
+ * released to heap memory, so it can be chained and restored.
+ *
+ * @return the hook function
+ */
+void (*rt_free_gethook(void))(void *ptr)
+{
+    return rt_free_hook;
+}
+
 /**@}*/
 
 #endif
@@ -132,6 +154,9 @@ static struct heap_mem *lfree;   /* pointer to the lowest free block */
 
 static struct rt_semaphore heap_sem;
 static rt_size_t mem_size_aligned;
+#ifdef RT_USING_MEMFRAG
+static rt_uint32_t heap_generation;        /* changed on each update of blocks */
+#endif
 
 #ifdef RT_MEM_STATS
 static rt_size_t used_mem, max_mem;
@@ -193,6 +218,91 @@ static void plug_holes(struct heap_mem *mem)
     }
 }
 
+/*
+ * mark a free block as used, the tail of block is split as a new free block
+ * when it is large enough. It shall be invoked with heap_sem taken.
+ */
+static void _heap_mem_take(struct heap_mem *mem, rt_size_t size)
+{
+    rt_size_t ptr, ptr2;
+    struct heap_mem *mem2;
+
+    ptr = (rt_uint8_t *)mem - heap_ptr;
+
+    if (mem->next - (ptr + SIZEOF_STRUCT_MEM) >=
+        (size + SIZEOF_STRUCT_MEM + MIN_SIZE_ALIGNED))
+    {
+        /* (in addition to the above, we test if another struct heap_mem (SIZEOF_STRUCT_MEM) containing
+         * at least MIN_SIZE_ALIGNED of data also fits in the 'user data space' of 'mem')
+         * -> split large block, create empty remainder,
+         * remainder must be large enough to contain MIN_SIZE_ALIGNED data: if
+         * mem->next - (ptr + (2*SIZEOF_STRUCT_MEM)) == size,
+         * struct heap_mem would fit in but no data between mem2 and mem2->next
+         * @todo we could leave out MIN_SIZE_ALIGNED. We would create an empty
+         *       region that couldn't hold data, but when mem->next gets freed,
+         *       the 2 regions would be combined, resulting in more free memory
+         */
+        ptr2 = ptr + SIZEOF_STRUCT_MEM + size;
+
+        /* create mem2 struct */
+        mem2       = (struct heap_mem *)&heap_ptr[ptr2];
+        mem2->magic = HEAP_MAGIC;
+        mem2->used = 0;
+        mem2->next = mem->next;
+        mem2->prev = ptr;
+#ifdef RT_USING_MEMTRACE
+        rt_mem_setname(mem2, "    ");
+#endif
+
+        /* and insert it between mem and mem->next */
+        mem->next = ptr2;
+        mem->used = 1;
+
+        if (mem2->next != mem_size_aligned + SIZEOF_STRUCT_MEM)
+        {
+            ((struct heap_mem *)&heap_ptr[mem2->next])->prev = ptr2;
+        }
+#ifdef RT_MEM_STATS
+        used_mem += (size + SIZEOF_STRUCT_MEM);
+        if (max_mem < used_mem)
+            max_mem = used_mem;
+#endif
+    }
+    else
+    {
+        /* (a mem2 struct does no fit into the user data space of mem and mem->next will always
+         * be used at this point: if not we have 2 unused structs in a row, plug_holes should have
+         * take care of this).
+         * -> near fit or excact fit: do not split, no mem2 creation
+         * also can't move mem->next directly behind mem, since mem->next
+         * will always be used at this point!
+         */
+        mem->used = 1;
+#ifdef RT_MEM_STATS
+        used_mem += mem->next - ((rt_uint8_t *)mem - heap_ptr);
+        if (max_mem < used_mem)
+            max_mem = used_mem;
+#endif
+    }
+    /* set memory block magic */
+    mem->magic = HEAP_MAGIC;
+#ifdef RT_USING_MEMTRACE
+    if (rt_thread_self())
+        rt_mem_setname(mem, rt_thread_self()->name);
+    else
+        rt_mem_setname(mem, "NONE");
+#endif
+
+    if (mem == lfree)
+    {
+        /* Find next free block after mem and update lowest free pointer */
+        while (lfree->used && lfree != heap_end)
+            lfree = (struct heap_mem *)&heap_ptr[lfree->next];
+
+        RT_ASSERT(((lfree == heap_end) || (!lfree->used)));
+    }
+}
+
 /**
  * @ingroup SystemInit
  *
@@ -271,8 +381,8 @@ void rt_system_heap_init(void *begin_addr, void *end_addr)
  */
 void *rt_malloc(rt_size_t size)
 {
-    rt_size_t ptr, ptr2;
-    struct heap_mem *mem, *mem2;
+    rt_size_t ptr;
+    struct heap_mem *mem;
 
     if (size == 0)
         return RT_NULL;
@@ -301,6 +411,9 @@ void *rt_malloc(rt_size_t size)
 
     /* take memory semaphore */
     rt_sem_take(&heap_sem, RT_WAITING_FOREVER);
+#ifdef RT_USING_MEMFRAG
+    heap_generation ++;
+#endif
 
     for (ptr = (rt_uint8_t *)lfree - heap_ptr;
          ptr < mem_size_aligned - size;
@@ -313,78 +426,7 @@ void *rt_malloc(rt_size_t size)
             /* mem is not used and at least perfect fit is possible:
              * mem->next - (ptr + SIZEOF_STRUCT_MEM) gives us the 'user data size' of mem */
 
-            if (mem->next - (ptr + SIZEOF_STRUCT_MEM) >=
-                (size + SIZEOF_STRUCT_MEM + MIN_SIZE_ALIGNED))
-            {
-                /* (in addition to the above, we test if another struct heap_mem (SIZEOF_STRUCT_MEM) containing
-                 * at least MIN_SIZE_ALIGNED of data also fits in the 'user data space' of 'mem')
-                 * -> split large block, create empty remainder,
-                 * remainder must be large enough to contain MIN_SIZE_ALIGNED data: if
-                 * mem->next - (ptr + (2*SIZEOF_STRUCT_MEM)) == size,
-                 * struct heap_mem would fit in but no data between mem2 and mem2->next
-                 * @todo we could leave out MIN_SIZE_ALIGNED. We would create an empty
-                 *       region that couldn't hold data, but when mem->next gets freed,
-                 *       the 2 regions would be combined, resulting in more free memory
-                 */
-                ptr2 = ptr + SIZEOF_STRUCT_MEM + size;
-
-                /* create mem2 struct */
-                mem2       = (struct heap_mem *)&heap_ptr[ptr2];
-                mem2->magic = HEAP_MAGIC;
-                mem2->used = 0;
-                mem2->next = mem->next;
-                mem2->prev = ptr;
-#ifdef RT_USING_MEMTRACE
-                rt_mem_setname(mem2, "    ");
-#endif
-
-                /* and insert it between mem and mem->next */
-                mem->next = ptr2;
-                mem->used = 1;
-
-                if (mem2->next != mem_size_aligned + SIZEOF_STRUCT_MEM)
-                {
-                    ((struct heap_mem *)&heap_ptr[mem2->next])->prev = ptr2;
-                }
-#ifdef RT_MEM_STATS
-                used_mem += (size + SIZEOF_STRUCT_MEM);
-                if (max_mem < used_mem)
-                    max_mem = used_mem;
-#endif
-            }
-            else
-            {
-                /* (a mem2 struct does no fit into the user data space of mem and mem->next will always
-                 * be used at this point: if not we have 2 unused structs in a row, plug_holes should have
-                 * take care of this).
-                 * -> near fit or excact fit: do not split, no mem2 creation
-                 * also can't move mem->next directly behind mem, since mem->next
-                 * will always be used at this point!
-                 */
-                mem->used = 1;
-#ifdef RT_MEM_STATS
-                used_mem += mem->next - ((rt_uint8_t *)mem - heap_ptr);
-                if (max_mem < used_mem)
-                    max_mem = used_mem;
-#endif
-            }
-            /* set memory block magic */
-            mem->magic = HEAP_MAGIC;
-#ifdef RT_USING_MEMTRACE
-            if (rt_thread_self())
-                rt_mem_setname(mem, rt_thread_self()->name);
-            else
-                rt_mem_setname(mem, "NONE");
-#endif
-
-            if (mem == lfree)
-            {
-                /* Find next free block after mem and update lowest free pointer */
-                while (lfree->used && lfree != heap_end)
-                    lfree = (struct heap_mem *)&heap_ptr[lfree->next];
-
-                RT_ASSERT(((lfree == heap_end) || (!lfree->used)));
-            }
+            _heap_mem_take(mem, size);
 
             rt_sem_release(&heap_sem);
             RT_ASSERT((rt_ubase_t)mem + SIZEOF_STRUCT_MEM + size <= (rt_ubase_t)heap_end);
@@ -409,6 +451,115 @@ void *rt_malloc(rt_size_t size)
     return RT_NULL;
 }
 
+/**
+ * This function will allocate a block of memory whose address is aligned to
+ * the specified alignment. The leading slack before the aligned address is
+ * split as a free block, and the memory block can be released by rt_free.
+ *
+ * @param size the minimum size of the requested block in bytes
+ * @param align the alignment, which shall be a power of 2
+ *
+ * @return pointer to allocated memory or NULL if no free memory was found.
+ */
+void *rt_malloc_align(rt_size_t size, rt_size_t align)
+{
+    rt_size_t ptr, ptr2;
+    rt_ubase_t data;
+    struct heap_mem *mem, *mem2;
+
+    RT_ASSERT((align & (align - 1)) == 0);
+
+    if (align <= RT_ALIGN_SIZE)
+        return rt_malloc(size);
+
+    if (size == 0)
+        return RT_NULL;
+
+    RT_DEBUG_NOT_IN_INTERRUPT;
+
+    size = RT_ALIGN(size, RT_ALIGN_SIZE);
+    if (size > mem_size_aligned)
+        return RT_NULL;
+
+    /* every data block must be at least MIN_SIZE_ALIGNED long */
+    if (size < MIN_SIZE_ALIGNED)
+        size = MIN_SIZE_ALIGNED;
+
+    /* take memory semaphore */
+    rt_sem_take(&heap_sem, RT_WAITING_FOREVER);
+#ifdef RT_USING_MEMFRAG
+    heap_generation ++;
+#endif
+
+    for (ptr = (rt_uint8_t *)lfree - heap_ptr;
+         ptr < mem_size_aligned - size;
+         ptr = ((struct heap_mem *)&heap_ptr[ptr])->next)
+    {
+        mem = (struct heap_mem *)&heap_ptr[ptr];
+        if (mem->used)
+            continue;
+
+        /* the leading slack shall be none or large enough for a free block */
+        data = RT_ALIGN((rt_ubase_t)mem + SIZEOF_STRUCT_MEM, align);
+        while (data - SIZEOF_STRUCT_MEM != (rt_ubase_t)mem &&
+               data - SIZEOF_STRUCT_MEM - (rt_ubase_t)mem < SIZEOF_STRUCT_MEM + MIN_SIZE_ALIGNED)
+            data += align;
+
+        if (data + size > (rt_ubase_t)&heap_ptr[mem->next])
+            continue;
+
+        ptr2 = data - SIZEOF_STRUCT_MEM - (rt_ubase_t)heap_ptr;
+        if (ptr2 != ptr)
+        {
+            /* split the leading slack, which is left in free state */
+            mem2        = (struct heap_mem *)&heap_ptr[ptr2];
+            mem2->magic = HEAP_MAGIC;
+            mem2->used  = 0;
+            mem2->next  = mem->next;
+            mem2->prev  = ptr;
+#ifdef RT_USING_MEMTRACE
+            rt_mem_setname(mem2, "    ");
+#endif
+
+            mem->next = ptr2;
+            if (mem2->next != mem_size_aligned + SIZEOF_STRUCT_MEM)
+            {
+                ((struct heap_mem *)&heap_ptr[mem2->next])->prev = ptr2;
+            }
+
+            mem = mem2;
+        }
+
+        _heap_mem_take(mem, size);
+
+        rt_sem_release(&heap_sem);
+        RT_ASSERT((rt_ubase_t)mem + SIZEOF_STRUCT_MEM + size <= (rt_ubase_t)heap_end);
+        RT_ASSERT((data & (align - 1)) == 0);
+
+        RT_DEBUG_LOG(RT_DEBUG_MEM,
+                     ("allocate aligned memory at 0x%x, size: %d\n",
+                      data, (rt_ubase_t)(mem->next - ((rt_uint8_t *)mem - heap_ptr))));
+
+        RT_OBJECT_HOOK_CALL(rt_malloc_hook, ((void *)data, size));
+
+        return (void *)data;
+    }
+
+    rt_sem_release(&heap_sem);
+
+    return RT_NULL;
+}
+
+/**
+ * This function will release the memory block allocated by rt_malloc_align.
+ *
+ * @param ptr the address of memory which will be released
+ */
+void rt_free_align(void *ptr)
+{
+    rt_free(ptr);
+}
+
 /**
  * This function will change the previously allocated memory block.
  *
@@ -445,6 +596,9 @@ void *rt_realloc(void *rmem, rt_size_t newsize)
         return rt_malloc(newsize);
 
     rt_sem_take(&heap_sem, RT_WAITING_FOREVER);
+#ifdef RT_USING_MEMFRAG
+    heap_generation ++;
+#endif
 
     if ((rt_uint8_t *)rmem < (rt_uint8_t *)heap_ptr ||
         (rt_uint8_t *)rmem >= (rt_uint8_t *)heap_end)
@@ -580,6 +734,9 @@ void rt_free(void *rmem)
 
     /* protect the heap from concurrent access */
     rt_sem_take(&heap_sem, RT_WAITING_FOREVER);
+#ifdef RT_USING_MEMFRAG
+    heap_generation ++;
+#endif
 
     /* ... which has to be in a used state ... */
     if (!mem->used || mem->magic != HEAP_MAGIC)
@@ -611,6 +768,66 @@ void rt_free(void *rmem)
     rt_sem_release(&heap_sem);
 }
 
+#ifdef RT_USING_MEMFRAG
+/**
+ * This function will walk the blocks of system heap for the fragmentation
+ * analyzer. At most count blocks are visited in one step, and the lock of
+ * heap is never waited for.
+ *
+ * @param walk the walk of heap, its cursor is 0 at the beginning
+ * @param count the maximum number of blocks visited
+ *
+ * @return RT_EOK if the walk is finished, -RT_EBUSY if there are blocks left
+ *         or the heap is locked, -RT_EINTR if the heap has been changed and
+ *         the walk restarts.
+ */
+rt_err_t rt_memory_walk(struct rt_mem_walk *walk, rt_size_t count)
+{
+    struct heap_mem *mem;
+
+    if (rt_sem_trytake(&heap_sem) != RT_EOK)
+        return -RT_EBUSY;
+
+    if (walk->cursor == 0)
+    {
+        walk->start  = (rt_ubase_t)heap_ptr;
+        walk->size   = mem_size_aligned;
+        walk->cursor = (rt_ubase_t)heap_ptr;
+        walk->generation = heap_generation;
+    }
+    else if (walk->generation != heap_generation)
+    {
+        walk->cursor = 0;
+        rt_sem_release(&heap_sem);
+
+        return -RT_EINTR;
+    }
+
+    for (mem = (struct heap_mem *)walk->cursor; mem != heap_end && count > 0; count --)
+    {
+        if (!mem->used)
+        {
+            walk->free_block(walk, (rt_uint8_t *)mem + SIZEOF_STRUCT_MEM,
+                             mem->next - ((rt_uint8_t *)mem - heap_ptr) - SIZEOF_STRUCT_MEM);
+        }
+
+        mem = (struct heap_mem *)&heap_ptr[mem->next];
+    }
+    walk->cursor = (rt_ubase_t)mem;
+
+    rt_sem_release(&heap_sem);
+
+    if (mem == heap_end)
+    {
+        walk->cursor = 0;
+
+        return RT_EOK;
+    }
+
+    return -RT_EBUSY;
+}
+#endif
+
 #ifdef RT_MEM_STATS
 void rt_memory_info(rt_uint32_t *total,
                     rt_uint32_t *used,
@@ -0,0 +1,390 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2021-09-24     RT-Thread    the first version
+ *
+ * Anotation：堆内存碎片分析。空闲线程每次只遍历少量内存块，并且不等待堆的锁，
+ * 遍历期间堆被修改则重新开始；每个区域遍历完成后更新最大空闲块、空闲块大小分布、
+ * 外部碎片率以及空闲内存分布图。
+ */
+
+#include <rthw.h>
+#include <rtthread.h>
+
+#ifdef RT_USING_MEMFRAG
+
+/* the first bucket of histogram holds the free blocks less than 32 bytes */
+#define MEMFRAG_HIST_SHIFT          5
+
+struct memfrag_region
+{
+    char                    name[RT_NAME_MAX];
+    struct rt_memheap      *heap;           /* RT_NULL for the system heap */
+    struct rt_memfrag_info  info;           /* the report of last finished walk */
+};
+
+static struct memfrag_region _region_table[RT_MEMFRAG_REGION_NR];
+static int _region_nr;
+
+/* the walk in progress */
+static struct rt_mem_walk _walk;
+static struct rt_memfrag_info _walk_info;
+static rt_size_t _walk_map[RT_MEMFRAG_MAP_WIDTH];   /* free bytes in each slice */
+static int _walk_region = -1;
+static rt_tick_t _walk_tick;
+
+static void _memfrag_free_block(struct rt_mem_walk *walk, void *addr, rt_size_t size)
+{
+    rt_size_t slice, offset, end, index, len;
+    int bucket;
+
+    _walk_info.total_free += size;
+    _walk_info.free_blocks ++;
+    if (size > _walk_info.largest_free)
+        _walk_info.largest_free = size;
+
+    for (bucket = 0; bucket < RT_MEMFRAG_HIST_NR - 1; bucket ++)
+    {
+        if ((size >> (MEMFRAG_HIST_SHIFT + bucket)) == 0)
+            break;
+    }
+    _walk_info.histogram[bucket] ++;
+
+    /* account the free bytes to the slices overlapped with the block */
+    slice  = (walk->size + RT_MEMFRAG_MAP_WIDTH - 1) / RT_MEMFRAG_MAP_WIDTH;
+    offset = (rt_ubase_t)addr - walk->start;
+    end    = offset + size;
+    if (slice == 0 || end > walk->size)
+        return;
+
+    for (index = offset / slice; offset < end; index ++)
+    {
+        len = (index + 1) * slice;
+        if (len > end)
+            len = end;
+
+        _walk_map[index] += len - offset;
+        offset = len;
+    }
+}
+
+static void _memfrag_walk_reset(void)
+{
+    rt_memset(&_walk_info, 0, sizeof(_walk_info));
+    rt_memset(_walk_map, 0, sizeof(_walk_map));
+    _walk.cursor = 0;
+    _walk.free_block = _memfrag_free_block;
+}
+
+static void _memfrag_walk_finish(struct memfrag_region *region)
+{
+    register rt_base_t level;
+    rt_size_t slice, len, index;
+
+    _walk_info.start = _walk.start;
+    _walk_info.size  = _walk.size;
+    _walk_info.tick  = rt_tick_get();
+
+    if (_walk_info.total_free != 0)
+    {
+        _walk_info.fragmentation = 1000 - (rt_uint16_t)
+                                   ((rt_uint64_t)_walk_info.largest_free * 1000 / _walk_info.total_free);
+    }
+
+    slice = (_walk.size + RT_MEMFRAG_MAP_WIDTH - 1) / RT_MEMFRAG_MAP_WIDTH;
+    for (index = 0; index < RT_MEMFRAG_MAP_WIDTH; index ++)
+    {
+        len = 0;
+        if (index * slice < _walk.size)
+            len = _walk.size - index * slice > slice ? slice : _walk.size - index * slice;
+
+        _walk_info.map[index] = len ? (rt_uint8_t)((rt_uint64_t)_walk_map[index] * 100 / len) : 0;
+    }
+
+    level = rt_hw_interrupt_disable();
+
+    /* keep the minimum since the region is found */
+    _walk_info.largest_free_min = _walk_info.largest_free;
+    if (region->info.tick != 0 && region->info.largest_free_min < _walk_info.largest_free)
+        _walk_info.largest_free_min = region->info.largest_free_min;
+
+    region->info = _walk_info;
+
+    rt_hw_interrupt_enable(level);
+}
+
+#ifdef RT_USING_MEMHEAP
+static rt_bool_t _memfrag_heap_exist(struct rt_memheap *heap)
+{
+    register rt_base_t level;
+    struct rt_object_information *information;
+    struct rt_list_node *node;
+
+    information = rt_object_get_information(RT_Object_Class_MemHeap);
+    RT_ASSERT(information != RT_NULL);
+
+    level = rt_hw_interrupt_disable();
+    for (node = information->object_list.next; node != &(information->object_list); node = node->next)
+    {
+        if (rt_list_entry(node, struct rt_object, list) == &(heap->parent))
+        {
+            rt_hw_interrupt_enable(level);
+
+            return RT_TRUE;
+        }
+    }
+    rt_hw_interrupt_enable(level);
+
+    return RT_FALSE;
+}
+#endif
+
+/*
+ * drop the regions of detached memheap, and add the new memheap objects.
+ */
+static void _memfrag_region_update(void)
+{
+    register rt_base_t level;
+
+    level = rt_hw_interrupt_disable();
+
+#if defined(RT_USING_HEAP) && !defined(RT_USING_MEMHEAP_AS_HEAP)
+    if (_region_nr == 0)
+    {
+        rt_strncpy(_region_table[0].name, "heap", RT_NAME_MAX);
+        _region_table[0].heap = RT_NULL;
+        _region_nr = 1;
+    }
+#endif
+
+#ifdef RT_USING_MEMHEAP
+    {
+        struct rt_object_information *information;
+        struct rt_list_node *node;
+        struct rt_memheap *heap;
+        int index;
+
+        for (index = 0; index < _region_nr; )
+        {
+            if (_region_table[index].heap != RT_NULL && !_memfrag_heap_exist(_region_table[index].heap))
+            {
+                _region_nr --;
+                _region_table[index] = _region_table[_region_nr];
+                continue;
+            }
+            index ++;
+        }
+
+        information = rt_object_get_information(RT_Object_Class_MemHeap);
+        RT_ASSERT(information != RT_NULL);
+
+        for (node = information->object_list.next; node != &(information->object_list); node = node->next)
+        {
+            heap = (struct rt_memheap *)rt_list_entry(node, struct rt_object, list);
+            for (index = 0; index < _region_nr; index ++)
+            {
+                if (_region_table[index].heap == heap)
+                    break;
+            }
+
+            if (index == _region_nr && _region_nr < RT_MEMFRAG_REGION_NR)
+            {
+                rt_strncpy(_region_table[index].name, heap->parent.name, RT_NAME_MAX);
+                _region_table[index].heap = heap;
+                rt_memset(&(_region_table[index].info), 0, sizeof(struct rt_memfrag_info));
+                _region_nr ++;
+            }
+        }
+    }
+#endif
+
+    rt_hw_interrupt_enable(level);
+}
+
+/**
+ * This function will walk a few blocks of heap regions, it is invoked by the
+ * idle thread. The regions are walked one by one every RT_MEMFRAG_PERIOD
+ * ticks, and the report of a region is updated when its walk is finished.
+ */
+void rt_memfrag_step(void)
+{
+    struct memfrag_region *region;
+    rt_err_t result;
+
+    if (_walk_region < 0)
+    {
+        /* wait for the next period */
+        if (_walk_tick != 0 && rt_tick_get() - _walk_tick < RT_MEMFRAG_PERIOD)
+            return;
+
+        _memfrag_region_update();
+        _memfrag_walk_reset();
+        _walk_region = 0;
+    }
+
+    if (_walk_region >= _region_nr)
+    {
+        _walk_region = -1;
+        _walk_tick = rt_tick_get();
+
+        return;
+    }
+
+    region = &_region_table[_walk_region];
+
+    /*
+     * the idle thread is not preempted while it holds the lock of heap, or the
+     * threads waiting for the lock are blocked by the lowest priority thread.
+     */
+    rt_enter_critical();
+#ifdef RT_USING_MEMHEAP
+    if (region->heap != RT_NULL)
+    {
+        if (_memfrag_heap_exist(region->heap))
+            result = rt_memheap_walk(region->heap, &_walk, RT_MEMFRAG_SCAN_STEP);
+        else
+            result = -RT_ERROR;
+    }
+    else
+#endif
+    {
+#if defined(RT_USING_HEAP) && !defined(RT_USING_MEMHEAP_AS_HEAP)
+        result = rt_memory_walk(&_walk, RT_MEMFRAG_SCAN_STEP);
+#else
+        result = -RT_ERROR;
+#endif
+    }
+    rt_exit_critical();
+
+    switch (result)
+    {
+    case RT_EOK:
+        _memfrag_walk_finish(region);
+        _memfrag_walk_reset();
+        _walk_region ++;
+        break;
+
+    case -RT_EINTR:
+        /* the heap is changed, the blocks walked are dropped */
+        _memfrag_walk_reset();
+        break;
+
+    case -RT_EBUSY:
+        break;
+
+    default:
+        /* the memheap is detached, skip it */
+        _memfrag_walk_reset();
+        _walk_region ++;
+        break;
+    }
+}
+
+/**
+ * This function will get the fragmentation report of a heap region.
+ *
+ * @param name the name of memheap object, or "heap" for the system heap
+ * @param info the buffer to store the report
+ *
+ * @return RT_EOK on success, -RT_ERROR if the region is not found, -RT_EEMPTY
+ *         if the first walk of region is not finished.
+ */
+rt_err_t rt_memfrag_get(const char *name, struct rt_memfrag_info *info)
+{
+    register rt_base_t level;
+    int index;
+
+    RT_ASSERT(name != RT_NULL);
+    RT_ASSERT(info != RT_NULL);
+
+    level = rt_hw_interrupt_disable();
+    for (index = 0; index < _region_nr; index ++)
+    {
+        if (rt_strncmp(_region_table[index].name, name, RT_NAME_MAX) == 0)
+        {
+            *info = _region_table[index].info;
+            rt_hw_interrupt_enable(level);
+
+            return info->tick != 0 ? RT_EOK : -RT_EEMPTY;
+        }
+    }
+    rt_hw_interrupt_enable(level);
+
+    return -RT_ERROR;
+}
+
+#ifdef RT_USING_FINSH
+#include <finsh.h>
+
+static long memfrag(void)
+{
+    register rt_base_t level;
+    struct rt_memfrag_info info;
+    char name[RT_NAME_MAX];
+    int region, index;
+
+    for (region = 0; region < RT_MEMFRAG_REGION_NR; region ++)
+    {
+        level = rt_hw_interrupt_disable();
+        if (region >= _region_nr)
+        {
+            rt_hw_interrupt_enable(level);
+            break;
+        }
+        rt_memcpy(name, _region_table[region].name, RT_NAME_MAX);
+        info = _region_table[region].info;
+        rt_hw_interrupt_enable(level);
+
+        rt_kprintf("%-*.*s 0x%08x - 0x%08x", RT_NAME_MAX, RT_NAME_MAX, name,
+                   info.start, info.start + info.size);
+        if (info.tick == 0)
+        {
+            rt_kprintf(" (not walked yet)\n");
+            continue;
+        }
+        rt_kprintf(", walked %d ticks ago\n", rt_tick_get() - info.tick);
+
+        rt_kprintf("free: %d bytes in %d blocks, largest: %d, minimum largest: %d\n",
+                   info.total_free, info.free_blocks, info.largest_free, info.largest_free_min);
+        rt_kprintf("fragmentation: %d.%d%%\n", info.fragmentation / 10, info.fragmentation % 10);
+
+        rt_kprintf("histogram:");
+        for (index = 0; index < RT_MEMFRAG_HIST_NR; index ++)
+        {
+            if (info.histogram[index] == 0)
+                continue;
+
+            if (index == 0)
+                rt_kprintf(" <%d:%d", 1 << MEMFRAG_HIST_SHIFT, info.histogram[index]);
+            else if (index == RT_MEMFRAG_HIST_NR - 1)
+                rt_kprintf(" >=%d:%d", 1 << (MEMFRAG_HIST_SHIFT + index - 1), info.histogram[index]);
+            else
+                rt_kprintf(" %d:%d", 1 << (MEMFRAG_HIST_SHIFT + index - 1), info.histogram[index]);
+        }
+        rt_kprintf("\n");
+
+        /* '#' for used slice, '.' for free slice, digit for tens of free percent */
+        rt_kprintf("map: [");
+        for (index = 0; index < RT_MEMFRAG_MAP_WIDTH; index ++)
+        {
+            if (info.map[index] == 0)
+                rt_kprintf("#");
+            else if (info.map[index] >= 100)
+                rt_kprintf(".");
+            else
+                rt_kprintf("%d", info.map[index] / 10);
+        }
+        rt_kprintf("]\n\n");
+    }
+
+    return 0;
+}
+FINSH_FUNCTION_EXPORT(memfrag, show heap fragmentation report);
+MSH_CMD_EXPORT(memfrag, show heap fragmentation report);
+#endif /* RT_USING_FINSH */
+
+#endif /* RT_USING_MEMFRAG */
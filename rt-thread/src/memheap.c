@@ -38,6 +38,145 @@
 #define RT_MEMHEAP_SIZE         RT_ALIGN(sizeof(struct rt_memheap_item), RT_ALIGN_SIZE)
 #define MEMITEM_SIZE(item)      ((rt_ubase_t)item->next - (rt_ubase_t)item - RT_MEMHEAP_SIZE)
 
+static void *_rt_memheap_alloc(struct rt_memheap *heap, rt_size_t size);
+
+#ifdef RT_USING_MEMHEAP_CACHE
+#define RT_MEMHEAP_CACHE_MAGIC      0x1ea0cace
+#define RT_MEMHEAP_CACHE_ITEM_SIZE  RT_ALIGN(sizeof(struct rt_memheap_cache_item), RT_ALIGN_SIZE)
+
+/*
+ * The header of an object in size class cache. Its magic lies on the place of
+ * next_free field in the header of a memheap block, which is always RT_NULL
+ * when the block is used, so that the magic tells a cached object from a block.
+ */
+struct rt_memheap_cache_item
+{
+    rt_uint32_t              magic;
+    struct rt_memheap_cache *cache;
+};
+
+static const rt_uint16_t _cache_size[RT_MEMHEAP_CACHE_CLASS_NR] = {16, 32, 48, 64, 96, 128};
+
+/*
+ * get the size class cache of an object, RT_NULL for a memheap block.
+ */
+rt_inline struct rt_memheap_cache *_rt_memheap_cache_get(void *ptr)
+{
+    struct rt_memheap_cache_item *item;
+
+    item = (struct rt_memheap_cache_item *)((rt_uint8_t *)ptr - RT_MEMHEAP_CACHE_ITEM_SIZE);
+    if (item->magic != RT_MEMHEAP_CACHE_MAGIC)
+        return RT_NULL;
+
+    return item->cache;
+}
+
+static void _rt_memheap_cache_init(struct rt_memheap *heap)
+{
+    int index;
+
+    for (index = 0; index < RT_MEMHEAP_CACHE_CLASS_NR; index ++)
+    {
+        heap->cache[index].heap      = heap;
+        heap->cache[index].free_list = RT_NULL;
+        heap->cache[index].size      = _cache_size[index];
+        heap->cache[index].total     = 0;
+        heap->cache[index].free      = 0;
+        heap->cache[index].hit       = 0;
+        heap->cache[index].miss      = 0;
+    }
+}
+
+/*
+ * allocate an object from the size class cache, the free list is accessed
+ * with interrupt disabled only, and a new page is carved from memheap when
+ * the free list is empty.
+ */
+static void *_rt_memheap_cache_alloc(struct rt_memheap *heap, rt_size_t size)
+{
+    int index;
+    register rt_base_t level;
+    struct rt_memheap_cache *cache;
+    struct rt_memheap_cache_item *item;
+    rt_uint8_t *page;
+    rt_size_t page_size, stride, count, i;
+    void *object;
+
+    for (index = 0; index < RT_MEMHEAP_CACHE_CLASS_NR; index ++)
+    {
+        if (size <= heap->cache[index].size)
+            break;
+    }
+    if (index == RT_MEMHEAP_CACHE_CLASS_NR)
+        return RT_NULL;
+    cache = &(heap->cache[index]);
+
+    level = rt_hw_interrupt_disable();
+    object = cache->free_list;
+    if (object != RT_NULL)
+    {
+        cache->free_list = *(void **)object;
+        cache->free --;
+        cache->hit ++;
+        rt_hw_interrupt_enable(level);
+
+        return object;
+    }
+    rt_hw_interrupt_enable(level);
+
+    /* carve a new page into objects */
+    stride = RT_MEMHEAP_CACHE_ITEM_SIZE + cache->size;
+    page_size = RT_MEMHEAP_CACHE_PAGE_SIZE < stride ? stride : RT_MEMHEAP_CACHE_PAGE_SIZE;
+    page = (rt_uint8_t *)_rt_memheap_alloc(heap, page_size);
+    if (page == RT_NULL)
+        return RT_NULL;
+
+    count = page_size / stride;
+    for (i = 0; i < count; i ++)
+    {
+        item = (struct rt_memheap_cache_item *)(page + i * stride);
+        item->magic = RT_MEMHEAP_CACHE_MAGIC;
+        item->cache = cache;
+
+        /* link the objects except the first one */
+        if (i > 1)
+            *(void **)(page + (i - 1) * stride + RT_MEMHEAP_CACHE_ITEM_SIZE) =
+                page + i * stride + RT_MEMHEAP_CACHE_ITEM_SIZE;
+    }
+    object = page + RT_MEMHEAP_CACHE_ITEM_SIZE;
+
+    level = rt_hw_interrupt_disable();
+    if (count > 1)
+    {
+        *(void **)(page + (count - 1) * stride + RT_MEMHEAP_CACHE_ITEM_SIZE) = cache->free_list;
+        cache->free_list = page + stride + RT_MEMHEAP_CACHE_ITEM_SIZE;
+    }
+    cache->total += count;
+    cache->free  += count - 1;
+    cache->miss ++;
+    rt_hw_interrupt_enable(level);
+
+    RT_DEBUG_LOG(RT_DEBUG_MEMHEAP, ("carve page[0x%08x] into %d objects of size %d\n",
+                                    page, count, cache->size));
+
+    return object;
+}
+
+/*
+ * put an object back to the free list of size class cache.
+ */
+static void _rt_memheap_cache_free(struct rt_memheap_cache *cache, void *ptr)
+{
+    register rt_base_t level;
+
+    level = rt_hw_interrupt_disable();
+    *(void **)ptr = cache->free_list;
+    cache->free_list = ptr;
+    cache->free ++;
+    rt_hw_interrupt_enable(level);
+}
+#endif
+
 /*
  * The initialized memory pool will be:
  * +-----------------------------------+--------------------------+
@@ -68,6 +207,8 @@ rt_err_t rt_memheap_init(struct rt_memheap *memheap,
     memheap->pool_size      = RT_ALIGN_DOWN(size, RT_ALIGN_SIZE);
     memheap->available_size = memheap->pool_size - (2 * RT_MEMHEAP_SIZE);
     memheap->max_used_size  = memheap->pool_size - memheap->available_size;
+    memheap->max_free_size  = memheap->available_size;
+    memheap->attr           = 0;
 
     /* initialize the free list header */
     item            = &(memheap->free_header);
@@ -117,6 +258,13 @@ rt_err_t rt_memheap_init(struct rt_memheap *memheap,
 
     /* initialize semaphore lock */
     rt_sem_init(&(memheap->lock), name, 1, RT_IPC_FLAG_FIFO);
+#ifdef RT_USING_MEMFRAG
+    memheap->generation = 0;
+#endif
+
+#ifdef RT_USING_MEMHEAP_CACHE
+    _rt_memheap_cache_init(memheap);
+#endif
 
     RT_DEBUG_LOG(RT_DEBUG_MEMHEAP,
                  ("memory heap: start addr 0x%08x, size %d, free list header 0x%08x\n",
@@ -125,6 +273,26 @@ rt_err_t rt_memheap_init(struct rt_memheap *memheap,
     return RT_EOK;
 }
 
+/**
+ * This function will set the attributes of a memory heap, which are used by
+ * rt_malloc_ex to select the memory heaps.
+ *
+ * @param heap the memory heap object
+ * @param attr the attributes, RT_MEMHEAP_ATTR_FAST, RT_MEMHEAP_ATTR_DMA
+ *             and RT_MEMHEAP_ATTR_LARGE
+ *
+ * @return RT_EOK
+ */
+rt_err_t rt_memheap_set_attr(struct rt_memheap *heap, rt_uint32_t attr)
+{
+    RT_ASSERT(heap);
+    RT_ASSERT(rt_object_get_type(&heap->parent) == RT_Object_Class_MemHeap);
+
+    heap->attr = attr;
+
+    return RT_EOK;
+}
+
 rt_err_t rt_memheap_detach(struct rt_memheap *heap)
 {
     RT_ASSERT(heap);
@@ -138,15 +306,181 @@ rt_err_t rt_memheap_detach(struct rt_memheap *heap)
     return RT_EOK;
 }
 
-void *rt_memheap_alloc(struct rt_memheap *heap, rt_size_t size)
+#ifdef RT_USING_MEMFRAG
+/**
+ * This function will walk the blocks of a memory heap for the fragmentation
+ * analyzer. At most count blocks are visited in one step, and the lock of
+ * heap is never waited for.
+ *
+ * @param heap the memory heap object
+ * @param walk the walk of heap, its cursor is 0 at the beginning
+ * @param count the maximum number of blocks visited
+ *
+ * @return RT_EOK if the walk is finished, -RT_EBUSY if there are blocks left
+ *         or the heap is locked, -RT_EINTR if the heap has been changed and
+ *         the walk restarts.
+ */
+rt_err_t rt_memheap_walk(struct rt_memheap *heap, struct rt_mem_walk *walk, rt_size_t count)
+{
+    struct rt_memheap_item *item, *tail;
+
+    RT_ASSERT(heap);
+    RT_ASSERT(rt_object_get_type(&heap->parent) == RT_Object_Class_MemHeap);
+
+    if (rt_sem_trytake(&(heap->lock)) != RT_EOK)
+        return -RT_EBUSY;
+
+    if (walk->cursor == 0)
+    {
+        walk->start  = (rt_ubase_t)heap->start_addr;
+        walk->size   = heap->pool_size;
+        walk->cursor = (rt_ubase_t)heap->block_list;
+        walk->generation = heap->generation;
+    }
+    else if (walk->generation != heap->generation)
+    {
+        walk->cursor = 0;
+        rt_sem_release(&(heap->lock));
+
+        return -RT_EINTR;
+    }
+
+    /* the tailer block is the previous one of the first block */
+    tail = heap->block_list->prev;
+    for (item = (struct rt_memheap_item *)walk->cursor; item != tail && count > 0; count --)
+    {
+        if (!RT_MEMHEAP_IS_USED(item))
+            walk->free_block(walk, (rt_uint8_t *)item + RT_MEMHEAP_SIZE, MEMITEM_SIZE(item));
+
+        item = item->next;
+    }
+    walk->cursor = (rt_ubase_t)item;
+
+    rt_sem_release(&(heap->lock));
+
+    if (item == tail)
+    {
+        walk->cursor = 0;
+
+        return RT_EOK;
+    }
+
+    return -RT_EBUSY;
+}
+#endif
+
+/*
+ * mark a free block as used, the tail of block is split as a new free block
+ * when it is large enough. It shall be invoked with the lock of heap taken.
+ */
+static void _rt_memheap_take(struct rt_memheap *heap,
+                             struct rt_memheap_item *header_ptr,
+                             rt_size_t size)
 {
-    rt_err_t result;
     rt_uint32_t free_size;
-    struct rt_memheap_item *header_ptr;
 
+    free_size = MEMITEM_SIZE(header_ptr);
+
+    /* determine if the block needs to be split. */
+    if (free_size >= (size + RT_MEMHEAP_SIZE + RT_MEMHEAP_MINIALLOC))
+    {
+        struct rt_memheap_item *new_ptr;
+
+        /* split the block. */
+        new_ptr = (struct rt_memheap_item *)
+                  (((rt_uint8_t *)header_ptr) + size + RT_MEMHEAP_SIZE);
+
+        RT_DEBUG_LOG(RT_DEBUG_MEMHEAP,
+                     ("split: block[0x%08x] nextm[0x%08x] prevm[0x%08x] to new[0x%08x]\n",
+                      header_ptr,
+                      header_ptr->next,
+                      header_ptr->prev,
+                      new_ptr));
+
+        /* mark the new block as a memory block and freed. */
+        new_ptr->magic = RT_MEMHEAP_MAGIC;
+
+        /* put the pool pointer into the new block. */
+        new_ptr->pool_ptr = heap;
+
+        /* break down the block list */
+        new_ptr->prev          = header_ptr;
+        new_ptr->next          = header_ptr->next;
+        header_ptr->next->prev = new_ptr;
+        header_ptr->next       = new_ptr;
+
+        /* remove header ptr from free list */
+        header_ptr->next_free->prev_free = header_ptr->prev_free;
+        header_ptr->prev_free->next_free = header_ptr->next_free;
+        header_ptr->next_free = RT_NULL;
+        header_ptr->prev_free = RT_NULL;
+
+        /* insert new_ptr to free list */
+        new_ptr->next_free = heap->free_list->next_free;
+        new_ptr->prev_free = heap->free_list;
+        heap->free_list->next_free->prev_free = new_ptr;
+        heap->free_list->next_free            = new_ptr;
+        RT_DEBUG_LOG(RT_DEBUG_MEMHEAP, ("new ptr: next_free 0x%08x, prev_free 0x%08x\n",
+                                        new_ptr->next_free,
+                                        new_ptr->prev_free));
+
+        /* decrement the available byte count.  */
+        heap->available_size = heap->available_size -
+                               size -
+                               RT_MEMHEAP_SIZE;
+        if (heap->pool_size - heap->available_size > heap->max_used_size)
+            heap->max_used_size = heap->pool_size - heap->available_size;
+    }
+    else
+    {
+        /* decrement the entire free size from the available bytes count. */
+        heap->available_size = heap->available_size - free_size;
+        if (heap->pool_size - heap->available_size > heap->max_used_size)
+            heap->max_used_size = heap->pool_size - heap->available_size;
+
+        /* remove header_ptr from free list */
+        RT_DEBUG_LOG(RT_DEBUG_MEMHEAP,
+                     ("one block: block[0x%08x], next_free 0x%08x, prev_free 0x%08x\n",
+                      header_ptr,
+                      header_ptr->next_free,
+                      header_ptr->prev_free));
+
+        header_ptr->next_free->prev_free = header_ptr->prev_free;
+        header_ptr->prev_free->next_free = header_ptr->next_free;
+        header_ptr->next_free = RT_NULL;
+        header_ptr->prev_free = RT_NULL;
+    }
+
+    /* Mark the allocated block as not available. */
+    header_ptr->magic |= RT_MEMHEAP_USED;
+}
+
+void *rt_memheap_alloc(struct rt_memheap *heap, rt_size_t size)
+{
     RT_ASSERT(heap != RT_NULL);
     RT_ASSERT(rt_object_get_type(&heap->parent) == RT_Object_Class_MemHeap);
 
+#ifdef RT_USING_MEMHEAP_CACHE
+    if (size != 0 && size <= _cache_size[RT_MEMHEAP_CACHE_CLASS_NR - 1])
+    {
+        void *ptr;
+
+        /* fall to memheap when the cache can't carve a new page */
+        ptr = _rt_memheap_cache_alloc(heap, size);
+        if (ptr != RT_NULL)
+            return ptr;
+    }
+#endif
+
+    return _rt_memheap_alloc(heap, size);
+}
+
+static void *_rt_memheap_alloc(struct rt_memheap *heap, rt_size_t size)
+{
+    rt_err_t result;
+    rt_uint32_t free_size, largest;
+    struct rt_memheap_item *header_ptr;
+
     /* align allocated size */
     size = RT_ALIGN(size, RT_ALIGN_SIZE);
     if (size < RT_MEMHEAP_MINIALLOC)
@@ -155,10 +489,12 @@ void *rt_memheap_alloc(struct rt_memheap *heap, rt_size_t size)
     RT_DEBUG_LOG(RT_DEBUG_MEMHEAP, ("allocate %d on heap:%8.*s",
                                     size, RT_NAME_MAX, heap->parent.name));
 
-    if (size < heap->available_size)
+    /* fail fast when no free block is large enough */
+    if (size < heap->available_size && size <= heap->max_free_size)
     {
         /* search on free list */
         free_size = 0;
+        largest   = 0;
 
         /* lock memheap */
         result = rt_sem_take(&(heap->lock), RT_WAITING_FOREVER);
@@ -168,6 +504,9 @@ void *rt_memheap_alloc(struct rt_memheap *heap, rt_size_t size)
 
             return RT_NULL;
         }
+#ifdef RT_USING_MEMFRAG
+        heap->generation ++;
+#endif
 
         /* get the first free memory block */
         header_ptr = heap->free_list->next_free;
@@ -177,6 +516,9 @@ void *rt_memheap_alloc(struct rt_memheap *heap, rt_size_t size)
             free_size = MEMITEM_SIZE(header_ptr);
             if (free_size < size)
             {
+                if (free_size > largest)
+                    largest = free_size;
+
                 /* move to next free memory block */
                 header_ptr = header_ptr->next_free;
             }
@@ -187,78 +529,7 @@ void *rt_memheap_alloc(struct rt_memheap *heap, rt_size_t size)
         {
             /* a block that satisfies the request has been found. */
 
-            /* determine if the block needs to be split. */
-            if (free_size >= (size + RT_MEMHEAP_SIZE + RT_MEMHEAP_MINIALLOC))
-            {
-                struct rt_memheap_item *new_ptr;
-
-                /* split the block. */
-                new_ptr = (struct rt_memheap_item *)
-                          (((rt_uint8_t *)header_ptr) + size + RT_MEMHEAP_SIZE);
-
-                RT_DEBUG_LOG(RT_DEBUG_MEMHEAP,
-                             ("split: block[0x%08x] nextm[0x%08x] prevm[0x%08x] to new[0x%08x]\n",
-                              header_ptr,
-                              header_ptr->next,
-                              header_ptr->prev,
-                              new_ptr));
-
-                /* mark the new block as a memory block and freed. */
-                new_ptr->magic = RT_MEMHEAP_MAGIC;
-
-                /* put the pool pointer into the new block. */
-                new_ptr->pool_ptr = heap;
-
-                /* break down the block list */
-                new_ptr->prev          = header_ptr;
-                new_ptr->next          = header_ptr->next;
-                header_ptr->next->prev = new_ptr;
-                header_ptr->next       = new_ptr;
-
-                /* remove header ptr from free list */
-                header_ptr->next_free->prev_free = header_ptr->prev_free;
-                header_ptr->prev_free->next_free = header_ptr->next_free;
-                header_ptr->next_free = RT_NULL;
-                header_ptr->prev_free = RT_NULL;
-
-                /* insert new_ptr to free list */
-                new_ptr->next_free = heap->free_list->next_free;
-                new_ptr->prev_free = heap->free_list;
-                heap->free_list->next_free->prev_free = new_ptr;
-                heap->free_list->next_free            = new_ptr;
-                RT_DEBUG_LOG(RT_DEBUG_MEMHEAP, ("new ptr: next_free 0x%08x, prev_free 0x%08x\n",
-                                                new_ptr->next_free,
-                                                new_ptr->prev_free));
-
-                /* decrement the available byte count.  */
-                heap->available_size = heap->available_size -
-                                       size -
-                                       RT_MEMHEAP_SIZE;
-                if (heap->pool_size - heap->available_size > heap->max_used_size)
-                    heap->max_used_size = heap->pool_size - heap->available_size;
-            }
-            else
-            {
-                /* decrement the entire free size from the available bytes count. */
-                heap->available_size = heap->available_size - free_size;
-                if (heap->pool_size - heap->available_size > heap->max_used_size)
-                    heap->max_used_size = heap->pool_size - heap->available_size;
-
-                /* remove header_ptr from free list */
-                RT_DEBUG_LOG(RT_DEBUG_MEMHEAP,
-                             ("one block: block[0x%08x], next_free 0x%08x, prev_free 0x%08x\n",
-                              header_ptr,
-                              header_ptr->next_free,
-                              header_ptr->prev_free));
-
-                header_ptr->next_free->prev_free = header_ptr->prev_free;
-                header_ptr->prev_free->next_free = header_ptr->next_free;
-                header_ptr->next_free = RT_NULL;
-                header_ptr->prev_free = RT_NULL;
-            }
-
-            /* Mark the allocated block as not available. */
-            header_ptr->magic |= RT_MEMHEAP_USED;
+            _rt_memheap_take(heap, header_ptr, size);
 
             /* release lock */
             rt_sem_release(&(heap->lock));
@@ -273,6 +544,9 @@ void *rt_memheap_alloc(struct rt_memheap *heap, rt_size_t size)
             return (void *)((rt_uint8_t *)header_ptr + RT_MEMHEAP_SIZE);
         }
 
+        /* the whole free list is searched, the largest free block is exact now */
+        heap->max_free_size = largest;
+
         /* release lock */
         rt_sem_release(&(heap->lock));
     }
@@ -283,6 +557,115 @@ void *rt_memheap_alloc(struct rt_memheap *heap, rt_size_t size)
     return RT_NULL;
 }
 
+/**
+ * This function will allocate a block of memory from memory heap, whose
+ * address is aligned to the specified alignment. The leading slack before
+ * the aligned address is split as a free block, and the memory block can be
+ * released by rt_memheap_free.
+ *
+ * @param heap the memory heap object
+ * @param size the size of memory block
+ * @param align the alignment, which shall be a power of 2
+ *
+ * @return the allocated memory block, RT_NULL on failure
+ */
+void *rt_memheap_alloc_align(struct rt_memheap *heap, rt_size_t size, rt_size_t align)
+{
+    rt_err_t result;
+    rt_uint32_t largest;
+    rt_ubase_t data, lead;
+    struct rt_memheap_item *header_ptr, *new_ptr;
+
+    RT_ASSERT(heap != RT_NULL);
+    RT_ASSERT(rt_object_get_type(&heap->parent) == RT_Object_Class_MemHeap);
+    RT_ASSERT((align & (align - 1)) == 0);
+
+    if (align <= RT_ALIGN_SIZE)
+        return _rt_memheap_alloc(heap, size);
+
+    /* align allocated size */
+    size = RT_ALIGN(size, RT_ALIGN_SIZE);
+    if (size < RT_MEMHEAP_MINIALLOC)
+        size = RT_MEMHEAP_MINIALLOC;
+
+    /* fail fast when no free block is large enough */
+    if (size >= heap->available_size || size > heap->max_free_size)
+        return RT_NULL;
+
+    /* lock memheap */
+    result = rt_sem_take(&(heap->lock), RT_WAITING_FOREVER);
+    if (result != RT_EOK)
+    {
+        rt_set_errno(result);
+
+        return RT_NULL;
+    }
+#ifdef RT_USING_MEMFRAG
+    heap->generation ++;
+#endif
+
+    largest = 0;
+    for (header_ptr  = heap->free_list->next_free;
+         header_ptr != heap->free_list;
+         header_ptr  = header_ptr->next_free)
+    {
+        if (MEMITEM_SIZE(header_ptr) > largest)
+            largest = MEMITEM_SIZE(header_ptr);
+
+        /* the leading slack shall be none or large enough for a free block */
+        data = RT_ALIGN((rt_ubase_t)header_ptr + RT_MEMHEAP_SIZE, align);
+        lead = data - RT_MEMHEAP_SIZE - (rt_ubase_t)header_ptr;
+        while (lead != 0 && lead < RT_MEMHEAP_SIZE + RT_MEMHEAP_MINIALLOC)
+        {
+            data += align;
+            lead += align;
+        }
+
+        if (data + size > (rt_ubase_t)header_ptr->next)
+            continue;
+
+        if (lead != 0)
+        {
+            /* split the leading slack, which is left in free list */
+            new_ptr = (struct rt_memheap_item *)(data - RT_MEMHEAP_SIZE);
+            new_ptr->magic    = RT_MEMHEAP_MAGIC;
+            new_ptr->pool_ptr = heap;
+
+            new_ptr->prev          = header_ptr;
+            new_ptr->next          = header_ptr->next;
+            header_ptr->next->prev = new_ptr;
+            header_ptr->next       = new_ptr;
+
+            new_ptr->next_free = heap->free_list->next_free;
+            new_ptr->prev_free = heap->free_list;
+            heap->free_list->next_free->prev_free = new_ptr;
+            heap->free_list->next_free            = new_ptr;
+
+            heap->available_size = heap->available_size - RT_MEMHEAP_SIZE;
+            header_ptr = new_ptr;
+        }
+
+        _rt_memheap_take(heap, header_ptr, size);
+
+        /* release lock */
+        rt_sem_release(&(heap->lock));
+
+        RT_DEBUG_LOG(RT_DEBUG_MEMHEAP,
+                     ("alloc aligned mem: memory[0x%08x], heap[0x%08x], size: %d\n",
+                      data, header_ptr, size));
+
+        return (void *)data;
+    }
+
+    /* the whole free list is searched, the largest free block is exact now */
+    heap->max_free_size = largest;
+
+    /* release lock */
+    rt_sem_release(&(heap->lock));
+
+    return RT_NULL;
+}
+
 void *rt_memheap_realloc(struct rt_memheap *heap, void *ptr, rt_size_t newsize)
 {
     rt_err_t result;
@@ -309,6 +692,29 @@ void *rt_memheap_realloc(struct rt_memheap *heap, void *ptr, rt_size_t newsize)
         return rt_memheap_alloc(heap, newsize);
     }
 
+#ifdef RT_USING_MEMHEAP_CACHE
+    {
+        struct rt_memheap_cache *cache;
+        void *object;
+
+        cache = _rt_memheap_cache_get(ptr);
+        if (cache != RT_NULL)
+        {
+            if (newsize <= cache->size)
+                return ptr;
+
+            object = rt_memheap_alloc(heap, newsize);
+            if (object != RT_NULL)
+            {
+                rt_memcpy(object, ptr, cache->size);
+                rt_memheap_free(ptr);
+            }
+
+            return object;
+        }
+    }
+#endif
+
     /* get memory block header and get the size of memory block */
     header_ptr = (struct rt_memheap_item *)
                  ((rt_uint8_t *)ptr - RT_MEMHEAP_SIZE);
@@ -326,6 +732,9 @@ void *rt_memheap_realloc(struct rt_memheap *heap, void *ptr, rt_size_t newsize)
             rt_set_errno(result);
             return RT_NULL;
         }
+#ifdef RT_USING_MEMFRAG
+        heap->generation ++;
+#endif
 
         next_ptr = header_ptr->next;
 
@@ -430,6 +839,9 @@ void *rt_memheap_realloc(struct rt_memheap *heap, void *ptr, rt_size_t newsize)
 
         return RT_NULL;
     }
+#ifdef RT_USING_MEMFRAG
+    heap->generation ++;
+#endif
 
     /* split the block. */
     new_ptr = (struct rt_memheap_item *)
@@ -485,6 +897,8 @@ void *rt_memheap_realloc(struct rt_memheap *heap, void *ptr, rt_size_t newsize)
 
     /* increment the available byte count.  */
     heap->available_size = heap->available_size + MEMITEM_SIZE(new_ptr);
+    if (MEMITEM_SIZE(new_ptr) > heap->max_free_size)
+        heap->max_free_size = MEMITEM_SIZE(new_ptr);
 
     /* release lock */
     rt_sem_release(&(heap->lock));
@@ -503,6 +917,23 @@ void rt_memheap_free(void *ptr)
     /* NULL check */
     if (ptr == RT_NULL) return;
 
+#ifdef RT_USING_MEMHEAP_CACHE
+    {
+        struct rt_memheap_cache *cache;
+
+        cache = _rt_memheap_cache_get(ptr);
+        if (cache != RT_NULL)
+        {
+            RT_DEBUG_LOG(RT_DEBUG_MEMHEAP, ("free object: memory[0x%08x] to cache of size %d\n",
+                                            ptr, cache->size));
+
+            _rt_memheap_cache_free(cache, ptr);
+
+            return;
+        }
+    }
+#endif
+
     /* set initial status as OK */
     insert_header = 1;
     new_ptr       = RT_NULL;
@@ -532,6 +963,9 @@ void rt_memheap_free(void *ptr)
 
         return ;
     }
+#ifdef RT_USING_MEMFRAG
+    heap->generation ++;
+#endif
 
     /* Mark the memory as available. */
     header_ptr->magic &= ~RT_MEMHEAP_USED;
@@ -578,6 +1012,9 @@ void rt_memheap_free(void *ptr)
         new_ptr->prev_free->next_free = new_ptr->next_free;
     }
 
+    if (MEMITEM_SIZE(header_ptr) > heap->max_free_size)
+        heap->max_free_size = MEMITEM_SIZE(header_ptr);
+
     if (insert_header)
     {
         /* no left merge, insert to free list */
@@ -602,6 +1039,63 @@ void rt_memheap_free(void *ptr)
  * */
 static struct rt_memheap _heap;
 
+#ifdef RT_USING_HOOK
+static void (*rt_malloc_hook)(void *ptr, rt_size_t size);
+static void (*rt_free_hook)(void *ptr);
+
+/**
+ * @addtogroup Hook
+ */
+
+/**@{*/
+
+/**
+ * This function will set a hook function, which will be invoked when a memory
+ * block is allocated from heap memory.
+ *
+ * @param hook the hook function
+ */
+void rt_malloc_sethook(void (*hook)(void *ptr, rt_size_t size))
+{
+    rt_malloc_hook = hook;
+}
+
+/**
+ * This function will set a hook function, which will be invoked when a memory
+ * block is released to heap memory.
+ *
+ * @param hook the hook function
+ */
+void rt_free_sethook(void (*hook)(void *ptr))
+{
+    rt_free_hook = hook;
+}
+
+/**
+ * This function will get the hook function invoked when a memory block is
+ * allocated from heap memory, so it can be chained and restored.
+ *
+ * @return the hook function
+ */
+void (*rt_malloc_gethook(void))(void *ptr, rt_size_t size)
+{
+    return rt_malloc_hook;
+}
+
+/**
+ * This function will get the hook function invoked when a memory block is
+ * released to heap memory, so it can be chained and restored.
+ *
+ * @return the hook function
+ */
+void (*rt_free_gethook(void))(void *ptr)
+{
+    return rt_free_hook;
+}
+
+/**@}*/
+#endif
+
 void rt_system_heap_init(void *begin_addr, void *end_addr)
 {
     /* initialize a default heap in the system
@@ -653,14 +1147,132 @@ void *rt_malloc(rt_size_t size)
         }
     }
 
+    if (ptr != RT_NULL)
+        RT_OBJECT_HOOK_CALL(rt_malloc_hook, (ptr, size));
+
     return ptr;
 }
 
+/**
+ * This function will allocate a block of memory from the memory heaps, which
+ * have all of the attributes in flags. The memory heaps whose largest free
+ * block is not large enough are skipped without searching.
+ *
+ * @param size the size of memory block
+ * @param flags the attributes of memory heap, RT_MEMHEAP_ATTR_FAST,
+ *              RT_MEMHEAP_ATTR_DMA and RT_MEMHEAP_ATTR_LARGE
+ *
+ * @return the allocated memory block, RT_NULL on failure
+ *
+ * Anotation：按属性（CCM、可DMA、外部SDRAM等）直接到对应的内存堆分配。
+ */
+void *rt_malloc_ex(rt_size_t size, rt_uint32_t flags)
+{
+    void *ptr;
+    struct rt_object *object;
+    struct rt_list_node *node;
+    struct rt_memheap *heap;
+    struct rt_object_information *information;
+
+    if (flags == 0)
+        return rt_malloc(size);
+
+    ptr = RT_NULL;
+    information = rt_object_get_information(RT_Object_Class_MemHeap);
+    RT_ASSERT(information != RT_NULL);
+    for (node  = information->object_list.next;
+         node != &(information->object_list);
+         node  = node->next)
+    {
+        object = rt_list_entry(node, struct rt_object, list);
+        heap   = (struct rt_memheap *)object;
+
+        RT_ASSERT(heap);
+        RT_ASSERT(rt_object_get_type(&heap->parent) == RT_Object_Class_MemHeap);
+
+        if ((heap->attr & flags) != flags)
+            continue;
+
+        ptr = rt_memheap_alloc(heap, size);
+        if (ptr != RT_NULL)
+            break;
+    }
+
+    if (ptr != RT_NULL)
+        RT_OBJECT_HOOK_CALL(rt_malloc_hook, (ptr, size));
+
+    return ptr;
+}
+
+/**
+ * This function will allocate a block of memory whose address is aligned to
+ * the specified alignment, from the system heap first and then the other
+ * memory heaps.
+ *
+ * @param size the size of memory block
+ * @param align the alignment, which shall be a power of 2
+ *
+ * @return the allocated memory block, RT_NULL on failure
+ */
+void *rt_malloc_align(rt_size_t size, rt_size_t align)
+{
+    void *ptr;
+    struct rt_object *object;
+    struct rt_list_node *node;
+    struct rt_memheap *heap;
+    struct rt_object_information *information;
+
+    if (size == 0)
+        return RT_NULL;
+
+    ptr = rt_memheap_alloc_align(&_heap, size, align);
+    if (ptr == RT_NULL)
+    {
+        /* try to allocate on other memory heap */
+        information = rt_object_get_information(RT_Object_Class_MemHeap);
+        RT_ASSERT(information != RT_NULL);
+        for (node  = information->object_list.next;
+             node != &(information->object_list);
+             node  = node->next)
+        {
+            object = rt_list_entry(node, struct rt_object, list);
+            heap   = (struct rt_memheap *)object;
+
+            if (heap == &_heap)
+                continue;
+
+            ptr = rt_memheap_alloc_align(heap, size, align);
+            if (ptr != RT_NULL)
+                break;
+        }
+    }
+
+    if (ptr != RT_NULL)
+        RT_OBJECT_HOOK_CALL(rt_malloc_hook, (ptr, size));
+
+    return ptr;
+}
+
+/**
+ * This function will release the memory block allocated by rt_malloc_align.
+ *
+ * @param ptr the memory block
+ */
+void rt_free_align(void *ptr)
+{
+    rt_free(ptr);
+}
+
 /*
  * Anotation：系统所有的动态内存回收都从这个函数实现，从而内核所有的内存分配由内存堆实现
  * */
 void rt_free(void *rmem)
 {
+    if (rmem == RT_NULL)
+        return;
+
+    RT_OBJECT_HOOK_CALL(rt_free_hook, (rmem));
+
     rt_memheap_free(rmem);
 }
 
@@ -670,7 +1282,12 @@ void rt_free(void *rmem)
 void *rt_realloc(void *rmem, rt_size_t newsize)
 {
     void *new_ptr;
+    rt_size_t oldsize;
+    struct rt_memheap *heap;
     struct rt_memheap_item *header_ptr;
+#ifdef RT_USING_MEMHEAP_CACHE
+    struct rt_memheap_cache *cache;
+#endif
 
     if (rmem == RT_NULL)
         return rt_malloc(newsize);
@@ -685,17 +1302,34 @@ void *rt_realloc(void *rmem, rt_size_t newsize)
     header_ptr = (struct rt_memheap_item *)
                  ((rt_uint8_t *)rmem - RT_MEMHEAP_SIZE);
 
-    new_ptr = rt_memheap_realloc(header_ptr->pool_ptr, rmem, newsize);
-    if (new_ptr == RT_NULL && newsize != 0)
+#ifdef RT_USING_MEMHEAP_CACHE
+    cache = _rt_memheap_cache_get(rmem);
+    if (cache != RT_NULL)
+    {
+        heap    = cache->heap;
+        oldsize = cache->size;
+    }
+    else
+#endif
+    {
+        heap    = header_ptr->pool_ptr;
+        oldsize = MEMITEM_SIZE(header_ptr);
+    }
+
+    new_ptr = rt_memheap_realloc(heap, rmem, newsize);
+    if (new_ptr != RT_NULL)
+    {
+        /* the old block is released and the new one is allocated */
+        RT_OBJECT_HOOK_CALL(rt_free_hook, (rmem));
+        RT_OBJECT_HOOK_CALL(rt_malloc_hook, (new_ptr, newsize));
+    }
+    else if (newsize != 0)
     {
         /* allocate memory block from other memheap */
         new_ptr = rt_malloc(newsize);
         if (new_ptr != RT_NULL && rmem != RT_NULL)
         {
-            rt_size_t oldsize;
-
-            /* get the size of old memory block */
-            oldsize = MEMITEM_SIZE(header_ptr);
+            /* copy the data of old memory block */
             if (newsize > oldsize)
                 rt_memcpy(new_ptr, rmem, oldsize);
             else
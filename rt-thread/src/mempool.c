@@ -58,6 +58,229 @@ void rt_mp_free_sethook(void (*hook)(struct rt_mempool *mp, void *block))
 /**@}*/
 #endif
 
+#define MP_BLOCK_STRIDE(mp)         ((mp)->block_size + sizeof(rt_uint8_t *))
+
+#ifdef RT_USING_MEMPOOL_LOCKFREE
+#if !defined(__GNUC__)
+#error "RT_USING_MEMPOOL_LOCKFREE requires the atomic builtins of GNU C"
+#endif
+
+/*
+ * The head of free list is a block index (plus one, 0 for the empty list) in
+ * the high half and a tag in the low half. The tag is increased on each update
+ * of head, so that a stale head can not be swapped in after the first block
+ * was taken and released again (ABA problem).
+ */
+#define MP_TAG_BITS                 (sizeof(rt_ubase_t) * 4)
+#define MP_TAG_MASK                 (((rt_ubase_t)1 << MP_TAG_BITS) - 1)
+#define MP_INDEX_MAX                (((rt_ubase_t)1 << (sizeof(rt_ubase_t) * 8 - MP_TAG_BITS)) - 1)
+
+rt_inline rt_ubase_t _mp_head_make(struct rt_mempool *mp, rt_uint8_t *block, rt_ubase_t tag)
+{
+    rt_ubase_t index = 0;
+
+    if (block != RT_NULL)
+        index = (block - (rt_uint8_t *)mp->start_address) / MP_BLOCK_STRIDE(mp) + 1;
+
+    return (index << MP_TAG_BITS) | (tag & MP_TAG_MASK);
+}
+
+rt_inline rt_uint8_t *_mp_head_block(struct rt_mempool *mp, rt_ubase_t head)
+{
+    rt_ubase_t index = head >> MP_TAG_BITS;
+
+    if (index == 0)
+        return RT_NULL;
+
+    return (rt_uint8_t *)mp->start_address + (index - 1) * MP_BLOCK_STRIDE(mp);
+}
+
+/*
+ * take the first block from free list, the caller has reserved one block by
+ * decreasing the free block counter, so the list is never empty here.
+ */
+static rt_uint8_t *_mp_block_pop(struct rt_mempool *mp)
+{
+    rt_ubase_t head, next;
+    rt_uint8_t *block;
+
+    head = __atomic_load_n(&mp->block_head, __ATOMIC_ACQUIRE);
+    do
+    {
+        block = _mp_head_block(mp, head);
+        RT_ASSERT(block != RT_NULL);
+
+        /* the block may be taken by others, then the swap fails and retries */
+        next = _mp_head_make(mp, *(rt_uint8_t **)block, head + 1);
+    }
+    while (!__atomic_compare_exchange_n(&mp->block_head, &head, next, 1,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+
+    return block;
+}
+
+/*
+ * take at most count blocks, returns the number of blocks taken.
+ */
+static rt_size_t _mp_block_take(struct rt_mempool *mp, rt_uint8_t **blocks, rt_size_t count)
+{
+    rt_size_t free, used, max_used, index;
+
+    /* reserve the blocks */
+    free = __atomic_load_n(&mp->block_free_count, __ATOMIC_RELAXED);
+    do
+    {
+        if (free == 0)
+            return 0;
+
+        if (count > free)
+            count = free;
+    }
+    while (!__atomic_compare_exchange_n(&mp->block_free_count, &free, free - count, 1,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED));
+
+    /* update the high watermark */
+    used = mp->block_total_count - (free - count);
+    max_used = __atomic_load_n(&mp->block_max_used, __ATOMIC_RELAXED);
+    while (used > max_used &&
+           !__atomic_compare_exchange_n(&mp->block_max_used, &max_used, used, 1,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+    for (index = 0; index < count; index ++)
+        blocks[index] = _mp_block_pop(mp);
+
+    return count;
+}
+
+/*
+ * put a chain of blocks, which are linked from first to last, into free list.
+ */
+static void _mp_block_give(struct rt_mempool *mp, rt_uint8_t *first, rt_uint8_t *last, rt_size_t count)
+{
+    rt_ubase_t head, next;
+
+    head = __atomic_load_n(&mp->block_head, __ATOMIC_RELAXED);
+    do
+    {
+        *(rt_uint8_t **)last = _mp_head_block(mp, head);
+        next = _mp_head_make(mp, first, head + 1);
+    }
+    while (!__atomic_compare_exchange_n(&mp->block_head, &head, next, 1,
+                                        __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+
+    /* the blocks are available to others only after they are in free list */
+    __atomic_add_fetch(&mp->block_free_count, count, __ATOMIC_SEQ_CST);
+}
+#else
+static rt_size_t _mp_block_take(struct rt_mempool *mp, rt_uint8_t **blocks, rt_size_t count)
+{
+    register rt_base_t level;
+    rt_size_t index;
+
+    /* disable interrupt */
+    level = rt_hw_interrupt_disable();
+
+    if (count > mp->block_free_count)
+        count = mp->block_free_count;
+
+    for (index = 0; index < count; index ++)
+    {
+        /* get block from block list */
+        blocks[index] = mp->block_list;
+        RT_ASSERT(blocks[index] != RT_NULL);
+
+        /* Setup the next free node. */
+        mp->block_list = *(rt_uint8_t **)blocks[index];
+    }
+
+    mp->block_free_count -= count;
+
+    /* update the high watermark */
+    if (mp->block_total_count - mp->block_free_count > mp->block_max_used)
+        mp->block_max_used = mp->block_total_count - mp->block_free_count;
+
+    /* enable interrupt */
+    rt_hw_interrupt_enable(level);
+
+    return count;
+}
+
+static void _mp_block_give(struct rt_mempool *mp, rt_uint8_t *first, rt_uint8_t *last, rt_size_t count)
+{
+    register rt_base_t level;
+
+    /* disable interrupt */
+    level = rt_hw_interrupt_disable();
+
+    /* link the blocks into the block list */
+    *(rt_uint8_t **)last = mp->block_list;
+    mp->block_list = first;
+
+    /* increase the free block count */
+    mp->block_free_count += count;
+
+    /* enable interrupt */
+    rt_hw_interrupt_enable(level);
+}
+#endif /* RT_USING_MEMPOOL_LOCKFREE */
+
+/*
+ * insert a thread into the suspend list in priority order, the threads with
+ * the same priority are in FIFO order.
+ */
+rt_inline void _mp_suspend_list_insert(struct rt_mempool *mp, struct rt_thread *thread)
+{
+    struct rt_list_node *n;
+
+    for (n = mp->suspend_thread.next; n != &(mp->suspend_thread); n = n->next)
+    {
+        if (thread->current_priority < rt_list_entry(n, struct rt_thread, tlist)->current_priority)
+            break;
+    }
+
+    rt_list_insert_before(n, &(thread->tlist));
+}
+
+/*
+ * release a chain of blocks and wake up a suspended thread for each block.
+ */
+static void _mp_block_release(struct rt_mempool *mp, rt_uint8_t *first, rt_uint8_t *last, rt_size_t count)
+{
+    register rt_base_t level;
+    struct rt_thread *thread;
+
+    _mp_block_give(mp, first, last, count);
+
+    /* pairs with the barrier in allocation after the thread is suspended */
+    rt_hw_dmb();
+    if (rt_list_isempty(&(mp->suspend_thread)))
+        return;
+
+    /* disable interrupt */
+    level = rt_hw_interrupt_disable();
+
+    while (count > 0 && !rt_list_isempty(&(mp->suspend_thread)))
+    {
+        /* get the suspended thread */
+        thread = rt_list_entry(mp->suspend_thread.next,
+                               struct rt_thread,
+                               tlist);
+
+        /* set error */
+        thread->error = RT_EOK;
+
+        /* resume thread */
+        rt_thread_resume(thread);
+        count --;
+    }
+
+    /* enable interrupt */
+    rt_hw_interrupt_enable(level);
+
+    /* do a schedule */
+    rt_schedule();
+}
+
 /**
  * @addtogroup MM
  */
@@ -122,7 +345,13 @@ rt_err_t rt_mp_init(struct rt_mempool *mp,
     *(rt_uint8_t **)(block_ptr + (offset - 1) * (block_size + sizeof(rt_uint8_t *))) =
         RT_NULL;
 
+#ifdef RT_USING_MEMPOOL_LOCKFREE
+    RT_ASSERT(mp->block_total_count <= MP_INDEX_MAX);
+    mp->block_head = _mp_head_make(mp, block_ptr, 0);
+#else
     mp->block_list = block_ptr;
+#endif
+    mp->block_max_used = 0;
 
     return RT_EOK;
 }
@@ -240,7 +469,13 @@ rt_mp_t rt_mp_create(const char *name,
     *(rt_uint8_t **)(block_ptr + (offset - 1) * (block_size + sizeof(rt_uint8_t *)))
         = RT_NULL;
 
+#ifdef RT_USING_MEMPOOL_LOCKFREE
+    RT_ASSERT(mp->block_total_count <= MP_INDEX_MAX);
+    mp->block_head = _mp_head_make(mp, block_ptr, 0);
+#else
     mp->block_list = block_ptr;
+#endif
+    mp->block_max_used = 0;
 
     return mp;
 }
@@ -298,52 +533,56 @@ rt_err_t rt_mp_delete(rt_mp_t mp)
 }
 #endif
 
-/**
- * This function will allocate a block from memory pool
- *
- * @param mp the memory pool object
- * @param time the waiting time
- *
- * @return the allocated memory block or RT_NULL on allocated failed
- *
- * Anotation：使用内存池的内存分配内存
- */
-void *rt_mp_alloc(rt_mp_t mp, rt_int32_t time)
+static rt_size_t _mp_alloc(rt_mp_t mp, void **blocks, rt_size_t count, rt_int32_t time)
 {
     rt_uint8_t *block_ptr;
     register rt_base_t level;
     struct rt_thread *thread;
     rt_uint32_t before_sleep = 0;
+    rt_size_t index, taken;
 
     /* parameter check */
     RT_ASSERT(mp != RT_NULL);
+    RT_ASSERT(blocks != RT_NULL && count > 0);
 
     /* get current thread */
     thread = rt_thread_self();
 
-    /* disable interrupt */
-    level = rt_hw_interrupt_disable();
-
-    while (mp->block_free_count == 0)
+    while ((taken = _mp_block_take(mp, (rt_uint8_t **)blocks, count)) == 0)
     {
         /* memory block is unavailable. */
         if (time == 0)
         {
-            /* enable interrupt */
-            rt_hw_interrupt_enable(level);
-
             rt_set_errno(-RT_ETIMEOUT);
 
-            return RT_NULL;
+            return 0;
         }
 
         RT_DEBUG_NOT_IN_INTERRUPT;
 
+        /* disable interrupt */
+        level = rt_hw_interrupt_disable();
+
         thread->error = RT_EOK;
 
         /* need suspend thread */
         rt_thread_suspend(thread);
-        rt_list_insert_after(&(mp->suspend_thread), &(thread->tlist));
+        _mp_suspend_list_insert(mp, thread);
+
+        /*
+         * a block released before the thread is on the suspend list wakes
+         * up nobody, check the free block counter again.
+         */
+        rt_hw_dmb();
+        if (mp->block_free_count > 0)
+        {
+            rt_thread_resume(thread);
+
+            /* enable interrupt */
+            rt_hw_interrupt_enable(level);
+
+            continue;
+        }
 
         if (time > 0)
         {
@@ -364,7 +603,7 @@ void *rt_mp_alloc(rt_mp_t mp, rt_int32_t time)
         rt_schedule();
 
         if (thread->error != RT_EOK)
-            return RT_NULL;
+            return 0;
 
         if (time > 0)
         {
@@ -372,30 +611,60 @@ void *rt_mp_alloc(rt_mp_t mp, rt_int32_t time)
             if (time < 0)
                 time = 0;
         }
-        /* disable interrupt */
-        level = rt_hw_interrupt_disable();
     }
 
-    /* memory block is available. decrease the free block counter */
-    mp->block_free_count--;
+    for (index = 0; index < taken; index ++)
+    {
+        block_ptr = (rt_uint8_t *)blocks[index];
 
-    /* get block from block list */
-    block_ptr = mp->block_list;
-    RT_ASSERT(block_ptr != RT_NULL);
+        /* point to memory pool */
+        *(rt_uint8_t **)block_ptr = (rt_uint8_t *)mp;
+        blocks[index] = block_ptr + sizeof(rt_uint8_t *);
 
-    /* Setup the next free node. */
-    mp->block_list = *(rt_uint8_t **)block_ptr;
+        RT_OBJECT_HOOK_CALL(rt_mp_alloc_hook, (mp, blocks[index]));
+    }
 
-    /* point to memory pool */
-    *(rt_uint8_t **)block_ptr = (rt_uint8_t *)mp;
+    return taken;
+}
 
-    /* enable interrupt */
-    rt_hw_interrupt_enable(level);
+/**
+ * This function will allocate a block from memory pool
+ *
+ * @param mp the memory pool object
+ * @param time the waiting time
+ *
+ * @return the allocated memory block or RT_NULL on allocated failed
+ *
+ * Anotation：使用内存池的内存分配内存
+ */
+void *rt_mp_alloc(rt_mp_t mp, rt_int32_t time)
+{
+    void *block;
 
-    RT_OBJECT_HOOK_CALL(rt_mp_alloc_hook,
-                        (mp, (rt_uint8_t *)(block_ptr + sizeof(rt_uint8_t *))));
+    if (_mp_alloc(mp, &block, 1, time) == 0)
+        return RT_NULL;
 
-    return (rt_uint8_t *)(block_ptr + sizeof(rt_uint8_t *));
+    return block;
+}
+
+/**
+ * This function will allocate blocks from memory pool. If no block is
+ * available, the thread waits until at least one block is released, then
+ * takes as many blocks as possible.
+ *
+ * @param mp the memory pool object
+ * @param blocks the array to store the allocated blocks
+ * @param count the maximum number of blocks to allocate
+ * @param time the waiting time
+ *
+ * @return the number of allocated blocks, 0 on allocated failed
+ */
+rt_size_t rt_mp_alloc_batch(rt_mp_t mp, void **blocks, rt_size_t count, rt_int32_t time)
+{
+    if (count == 0)
+        return 0;
+
+    return _mp_alloc(mp, blocks, count, time);
 }
 
 /**
@@ -409,8 +678,6 @@ void rt_mp_free(void *block)
 {
     rt_uint8_t **block_ptr;
     struct rt_mempool *mp;
-    struct rt_thread *thread;
-    register rt_base_t level;
 
     /* parameter check */
     if (block == RT_NULL) return;
@@ -421,40 +688,56 @@ void rt_mp_free(void *block)
 
     RT_OBJECT_HOOK_CALL(rt_mp_free_hook, (mp, block));
 
-    /* disable interrupt */
-    level = rt_hw_interrupt_disable();
+    _mp_block_release(mp, (rt_uint8_t *)block_ptr, (rt_uint8_t *)block_ptr, 1);
+}
 
-    /* increase the free block count */
-    mp->block_free_count ++;
+/**
+ * This function will release memory blocks. The blocks of the same memory
+ * pool next to each other in the array are linked and released at once.
+ *
+ * @param blocks the array of memory blocks to be released
+ * @param count the number of blocks
+ */
+void rt_mp_free_batch(void **blocks, rt_size_t count)
+{
+    rt_uint8_t *first, *last, *block_ptr;
+    struct rt_mempool *mp, *block_mp;
+    rt_size_t index, chain;
 
-    /* link the block into the block list */
-    *block_ptr = mp->block_list;
-    mp->block_list = (rt_uint8_t *)block_ptr;
+    RT_ASSERT(count == 0 || blocks != RT_NULL);
 
-    if (!rt_list_isempty(&(mp->suspend_thread)))
+    mp = RT_NULL;
+    first = last = RT_NULL;
+    chain = 0;
+    for (index = 0; index < count; index ++)
     {
-        /* get the suspended thread */
-        thread = rt_list_entry(mp->suspend_thread.next,
-                               struct rt_thread,
-                               tlist);
+        if (blocks[index] == RT_NULL)
+            continue;
 
-        /* set error */
-        thread->error = RT_EOK;
+        block_ptr = (rt_uint8_t *)blocks[index] - sizeof(rt_uint8_t *);
+        block_mp  = (struct rt_mempool *)*(rt_uint8_t **)block_ptr;
 
-        /* resume thread */
-        rt_thread_resume(thread);
+        RT_OBJECT_HOOK_CALL(rt_mp_free_hook, (block_mp, blocks[index]));
 
-        /* enable interrupt */
-        rt_hw_interrupt_enable(level);
+        if (block_mp == mp)
+        {
+            /* link the block after the chain */
+            *(rt_uint8_t **)last = block_ptr;
+            last = block_ptr;
+            chain ++;
+            continue;
+        }
 
-        /* do a schedule */
-        rt_schedule();
+        if (chain > 0)
+            _mp_block_release(mp, first, last, chain);
 
-        return;
+        mp = block_mp;
+        first = last = block_ptr;
+        chain = 1;
     }
 
-    /* enable interrupt */
-    rt_hw_interrupt_enable(level);
+    if (chain > 0)
+        _mp_block_release(mp, first, last, chain);
 }
 
 /**@}*/
@@ -0,0 +1,397 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2021-09-22     RT-Thread    the first version
+ *
+ * Anotation：通过 rt_malloc_sethook/rt_free_sethook 统计每个线程的堆内存使用，
+ * 适用于所有的堆算法。每个分配的内存块记录在以地址为键的哈希表中，释放时据此找到
+ * 所属线程和大小；线程的当前使用量、峰值和分配次数记录在以线程为键的哈希表中。
+ */
+
+#include <rthw.h>
+#include <rtthread.h>
+
+#if defined (RT_USING_HEAP) && defined (RT_USING_MEMSTAT)
+
+#ifndef RT_USING_HOOK
+#error "RT_USING_MEMSTAT requires RT_USING_HOOK"
+#endif
+
+/* the last entry of thread table is for the allocations without thread */
+#define MEMSTAT_OTHER               RT_MEMSTAT_THREAD_NR
+/* keep the load of record table low so that the probing is short */
+#define MEMSTAT_RECORD_LIMIT        (RT_MEMSTAT_RECORD_NR * 3 / 4)
+/* the entry of a dropped thread, it is reused but not the end of probing */
+#define MEMSTAT_DROPPED             ((rt_thread_t)-1)
+
+struct memstat_thread
+{
+    rt_thread_t thread;
+    char        name[RT_NAME_MAX];
+
+    rt_uint32_t live;                       /* bytes allocated and not released */
+    rt_uint32_t peak;                       /* maximum of live bytes */
+    rt_uint32_t alloc_count;
+    rt_uint32_t free_count;
+    rt_uint32_t last_count;                 /* alloc count when memstat shows last time */
+};
+
+struct memstat_record
+{
+    void       *ptr;
+    rt_uint32_t size;
+    rt_uint16_t owner;                      /* index in the thread table */
+};
+
+static struct memstat_thread _thread_table[RT_MEMSTAT_THREAD_NR + 1];
+static struct memstat_record _record_table[RT_MEMSTAT_RECORD_NR];
+static rt_uint32_t _record_count;
+static rt_uint32_t _untracked_count;
+static rt_tick_t _last_tick;
+
+/* the hooks set before memstat, they are chained */
+static void (*_memstat_prev_malloc_hook)(void *ptr, rt_size_t size);
+static void (*_memstat_prev_free_hook)(void *ptr);
+
+rt_inline rt_uint32_t _memstat_hash(void *key, rt_uint32_t size)
+{
+    return (rt_uint32_t)(((rt_ubase_t)key >> 2) * 2654435761u) % size;
+}
+
+/*
+ * find or add the entry of a thread, the table is probed linearly.
+ */
+static int _memstat_thread_get(rt_thread_t thread)
+{
+    rt_uint32_t index, count;
+    int dropped = -1;
+
+    if (thread == RT_NULL)
+        return MEMSTAT_OTHER;
+
+    index = _memstat_hash(thread, RT_MEMSTAT_THREAD_NR);
+    for (count = 0; count < RT_MEMSTAT_THREAD_NR; count ++)
+    {
+        if (_thread_table[index].thread == thread)
+            return index;
+
+        if (_thread_table[index].thread == MEMSTAT_DROPPED && dropped < 0)
+            dropped = index;
+
+        if (_thread_table[index].thread == RT_NULL)
+            break;
+
+        index = (index + 1) % RT_MEMSTAT_THREAD_NR;
+    }
+
+    /* the entry of a dropped thread is reused firstly */
+    if (dropped >= 0)
+        index = dropped;
+    else if (count == RT_MEMSTAT_THREAD_NR)
+        return MEMSTAT_OTHER;
+
+    _thread_table[index].thread = thread;
+    rt_strncpy(_thread_table[index].name, thread->name, RT_NAME_MAX);
+
+    return index;
+}
+
+/*
+ * find the entry of a thread without adding it, -1 if it is not found.
+ */
+static int _memstat_thread_find(rt_thread_t thread)
+{
+    rt_uint32_t index, count;
+
+    index = _memstat_hash(thread, RT_MEMSTAT_THREAD_NR);
+    for (count = 0; count < RT_MEMSTAT_THREAD_NR; count ++)
+    {
+        if (_thread_table[index].thread == thread)
+            return index;
+
+        if (_thread_table[index].thread == RT_NULL)
+            break;
+
+        index = (index + 1) % RT_MEMSTAT_THREAD_NR;
+    }
+
+    return -1;
+}
+
+static int _memstat_record_find(void *ptr)
+{
+    rt_uint32_t index;
+
+    index = _memstat_hash(ptr, RT_MEMSTAT_RECORD_NR);
+    while (_record_table[index].ptr != RT_NULL)
+    {
+        if (_record_table[index].ptr == ptr)
+            return index;
+
+        index = (index + 1) % RT_MEMSTAT_RECORD_NR;
+    }
+
+    return -1;
+}
+
+/*
+ * remove a record and shift the following records back, so that no
+ * tombstone is left in the table.
+ */
+static void _memstat_record_remove(rt_uint32_t index)
+{
+    rt_uint32_t next, home;
+
+    while (1)
+    {
+        _record_table[index].ptr = RT_NULL;
+
+        next = index;
+        while (1)
+        {
+            next = (next + 1) % RT_MEMSTAT_RECORD_NR;
+            if (_record_table[next].ptr == RT_NULL)
+                return;
+
+            /* move the record if its home is not in (index, next] */
+            home = _memstat_hash(_record_table[next].ptr, RT_MEMSTAT_RECORD_NR);
+            if (index <= next ? (home <= index || home > next) : (home <= index && home > next))
+                break;
+        }
+
+        _record_table[index] = _record_table[next];
+        index = next;
+    }
+}
+
+static void _memstat_malloc_hook(void *ptr, rt_size_t size)
+{
+    register rt_base_t level;
+    struct memstat_thread *stat;
+    rt_uint32_t index;
+    int owner;
+
+    level = rt_hw_interrupt_disable();
+
+    owner = _memstat_thread_get(rt_interrupt_get_nest() ? RT_NULL : rt_thread_self());
+    stat = &_thread_table[owner];
+    stat->alloc_count ++;
+
+    if (_record_count >= MEMSTAT_RECORD_LIMIT)
+    {
+        /* no room to record, the size is not accounted */
+        _untracked_count ++;
+        rt_hw_interrupt_enable(level);
+
+        if (_memstat_prev_malloc_hook != RT_NULL)
+            _memstat_prev_malloc_hook(ptr, size);
+
+        return;
+    }
+
+    index = _memstat_hash(ptr, RT_MEMSTAT_RECORD_NR);
+    while (_record_table[index].ptr != RT_NULL)
+        index = (index + 1) % RT_MEMSTAT_RECORD_NR;
+
+    _record_table[index].ptr   = ptr;
+    _record_table[index].size  = size;
+    _record_table[index].owner = owner;
+    _record_count ++;
+
+    stat->live += size;
+    if (stat->live > stat->peak)
+        stat->peak = stat->live;
+
+    rt_hw_interrupt_enable(level);
+
+    if (_memstat_prev_malloc_hook != RT_NULL)
+        _memstat_prev_malloc_hook(ptr, size);
+}
+
+static void _memstat_free_hook(void *ptr)
+{
+    register rt_base_t level;
+    struct memstat_thread *stat;
+    int index;
+
+    level = rt_hw_interrupt_disable();
+
+    index = _memstat_record_find(ptr);
+    if (index >= 0)
+    {
+        /* the block is accounted to the thread which allocated it */
+        stat = &_thread_table[_record_table[index].owner];
+        stat->live -= _record_table[index].size;
+        stat->free_count ++;
+
+        _memstat_record_remove(index);
+        _record_count --;
+    }
+
+    rt_hw_interrupt_enable(level);
+
+    if (_memstat_prev_free_hook != RT_NULL)
+        _memstat_prev_free_hook(ptr);
+}
+
+/**
+ * This function will drop the statistics of a thread when it is deleted or
+ * detached, so a thread created later at the same address starts from zero.
+ * The blocks it has not released are accounted to the allocations without
+ * thread.
+ *
+ * @param thread the thread
+ */
+void rt_memstat_thread_drop(rt_thread_t thread)
+{
+    register rt_base_t level;
+    struct memstat_thread *stat, *other;
+    rt_uint32_t index;
+    int owner;
+
+    level = rt_hw_interrupt_disable();
+
+    owner = _memstat_thread_find(thread);
+    if (owner >= 0)
+    {
+        stat  = &_thread_table[owner];
+        other = &_thread_table[MEMSTAT_OTHER];
+
+        for (index = 0; index < RT_MEMSTAT_RECORD_NR; index ++)
+        {
+            if (_record_table[index].ptr != RT_NULL && _record_table[index].owner == owner)
+                _record_table[index].owner = MEMSTAT_OTHER;
+        }
+
+        other->live += stat->live;
+        if (other->live > other->peak)
+            other->peak = other->live;
+
+        rt_memset(stat, 0, sizeof(*stat));
+        stat->thread = MEMSTAT_DROPPED;
+    }
+
+    rt_hw_interrupt_enable(level);
+}
+
+/**
+ * This function will initialize the allocation statistics of threads, and
+ * set the malloc and free hooks of heap. The hooks set before are invoked
+ * after memstat.
+ *
+ * @return RT_EOK
+ */
+int rt_memstat_init(void)
+{
+    rt_memset(_thread_table, 0, sizeof(_thread_table));
+    rt_memset(_record_table, 0, sizeof(_record_table));
+    rt_strncpy(_thread_table[MEMSTAT_OTHER].name, "(other)", RT_NAME_MAX);
+    _record_count    = 0;
+    _untracked_count = 0;
+    _last_tick       = rt_tick_get();
+
+    _memstat_prev_malloc_hook = rt_malloc_gethook();
+    _memstat_prev_free_hook   = rt_free_gethook();
+    rt_malloc_sethook(_memstat_malloc_hook);
+    rt_free_sethook(_memstat_free_hook);
+
+    return RT_EOK;
+}
+INIT_PREV_EXPORT(rt_memstat_init);
+
+/**
+ * This function will get the allocation statistics of a thread.
+ *
+ * @param thread the thread, RT_NULL for the allocations without thread
+ * @param live the bytes allocated and not released
+ * @param peak the maximum of live bytes
+ * @param count the number of allocations
+ *
+ * @return RT_EOK on success, -RT_ERROR if the thread has never allocated
+ */
+rt_err_t rt_memstat_get(rt_thread_t thread,
+                        rt_uint32_t *live,
+                        rt_uint32_t *peak,
+                        rt_uint32_t *count)
+{
+    register rt_base_t level;
+    int index;
+
+    level = rt_hw_interrupt_disable();
+
+    index = MEMSTAT_OTHER;
+    if (thread != RT_NULL)
+        index = _memstat_thread_find(thread);
+
+    if (index < 0)
+    {
+        rt_hw_interrupt_enable(level);
+
+        return -RT_ERROR;
+    }
+
+    if (live != RT_NULL)
+        *live = _thread_table[index].live;
+    if (peak != RT_NULL)
+        *peak = _thread_table[index].peak;
+    if (count != RT_NULL)
+        *count = _thread_table[index].alloc_count;
+
+    rt_hw_interrupt_enable(level);
+
+    return RT_EOK;
+}
+
+#ifdef RT_USING_FINSH
+#include <finsh.h>
+
+static long memstat(void)
+{
+    register rt_base_t level;
+    struct memstat_thread stat;
+    rt_uint32_t index, rate;
+    rt_tick_t now, elapsed;
+
+    now = rt_tick_get();
+    elapsed = now - _last_tick;
+    _last_tick = now;
+
+    rt_kprintf("%-*.s live     peak     allocs   frees    rate/s\n", RT_NAME_MAX, "thread");
+    for (index = 0; index < RT_NAME_MAX; index ++)
+        rt_kprintf("-");
+    rt_kprintf(" -------- -------- -------- -------- ------\n");
+    for (index = 0; index <= RT_MEMSTAT_THREAD_NR; index ++)
+    {
+        level = rt_hw_interrupt_disable();
+        stat = _thread_table[index];
+        _thread_table[index].last_count = stat.alloc_count;
+        rt_hw_interrupt_enable(level);
+
+        if (stat.alloc_count == 0)
+            continue;
+
+        /* allocations per second since the last time */
+        rate = 0;
+        if (elapsed != 0)
+            rate = (rt_uint32_t)((rt_uint64_t)(stat.alloc_count - stat.last_count) *
+                                 RT_TICK_PER_SECOND / elapsed);
+
+        rt_kprintf("%-*.*s %-8d %-8d %-8d %-8d %d\n",
+                   RT_NAME_MAX, RT_NAME_MAX, stat.name,
+                   stat.live, stat.peak, stat.alloc_count, stat.free_count, rate);
+    }
+
+    rt_kprintf("records: %d/%d, untracked allocations: %d\n",
+               _record_count, RT_MEMSTAT_RECORD_NR, _untracked_count);
+
+    return 0;
+}
+FINSH_FUNCTION_EXPORT(memstat, show heap allocation statistics of threads);
+MSH_CMD_EXPORT(memstat, show heap allocation statistics of threads);
+#endif /* RT_USING_FINSH */
+
+#endif /* RT_USING_HEAP && RT_USING_MEMSTAT */
@@ -53,6 +53,12 @@ enum rt_object_info_type
 #endif
 #ifdef RT_USING_DEVICE
     RT_Object_Info_Device,                             /**< The object is a 驱动 */
+#endif
+#ifdef RT_USING_RINGQUEUE
+    RT_Object_Info_RingQueue,                          /**< The object is a 环形队列. */
+#endif
+#ifdef RT_USING_ARENA
+    RT_Object_Info_Arena,                              /**< The object is a 内存区域. */
 #endif
     RT_Object_Info_Timer,                              /**< The object is a 定时器. */
     RT_Object_Info_Unknown,                            /**< The object is unknown.  使用枚举变量定义的特性对其动态计数*/
@@ -108,6 +114,14 @@ static struct rt_object_information rt_object_container[RT_Object_Info_Unknown]
 #ifdef RT_USING_DEVICE
     /* initialize object container - device */
     {RT_Object_Class_Device, _OBJ_CONTAINER_LIST_INIT(RT_Object_Info_Device), sizeof(struct rt_device)},
+#endif
+#ifdef RT_USING_RINGQUEUE
+    /* initialize object container - ring queue */
+    {RT_Object_Class_RingQueue, _OBJ_CONTAINER_LIST_INIT(RT_Object_Info_RingQueue), sizeof(struct rt_ringqueue)},
+#endif
+#ifdef RT_USING_ARENA
+    /* initialize object container - arena */
+    {RT_Object_Class_Arena, _OBJ_CONTAINER_LIST_INIT(RT_Object_Info_Arena), sizeof(struct rt_arena)},
 #endif
     /* initialize object container - timer */
     {RT_Object_Class_Timer, _OBJ_CONTAINER_LIST_INIT(RT_Object_Info_Timer), sizeof(struct rt_timer)},
@@ -213,6 +227,50 @@ void rt_object_put_sethook(void (*hook)(struct rt_object *object))
     rt_object_put_hook = hook;
 }
 
+/**
+ * This function will get the hook function invoked when object attaches to
+ * kernel object system, so it can be chained and restored.
+ *
+ * @return the hook function
+ */
+void (*rt_object_attach_gethook(void))(struct rt_object *object)
+{
+    return rt_object_attach_hook;
+}
+
+/**
+ * This function will get the hook function invoked when object is taken from
+ * kernel object system, so it can be chained and restored.
+ *
+ * @return the hook function
+ */
+void (*rt_object_trytake_gethook(void))(struct rt_object *object)
+{
+    return rt_object_trytake_hook;
+}
+
+/**
+ * This function will get the hook function invoked when object have been
+ * taken from kernel object system, so it can be chained and restored.
+ *
+ * @return the hook function
+ */
+void (*rt_object_take_gethook(void))(struct rt_object *object)
+{
+    return rt_object_take_hook;
+}
+
+/**
+ * This function will get the hook function invoked when object is put to
+ * kernel object system, so it can be chained and restored.
+ *
+ * @return the hook function
+ */
+void (*rt_object_put_gethook(void))(struct rt_object *object)
+{
+    return rt_object_put_hook;
+}
+
 /**@}*/
 #endif
 
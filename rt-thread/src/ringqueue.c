@@ -0,0 +1,529 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2021-09-10     RT-Thread    the first version
+ *
+ * Anotation：单生产者单消费者的无锁环形队列。生产者只写 head，消费者只写 tail，
+ * 生产者（可以是中断）放入元素不需要关中断，只有唤醒等待的消费者线程时才进入临界区。
+ */
+
+#include <rthw.h>
+#include <rtthread.h>
+
+#ifdef RT_USING_RINGQUEUE
+
+/*
+ * wake up the consumer thread waiting for elements.
+ */
+static void _rt_ringqueue_wakeup(rt_ringqueue_t rq)
+{
+    struct rt_thread *thread;
+    register rt_base_t level;
+
+    /* disable interrupt */
+    level = rt_hw_interrupt_disable();
+
+    thread = rq->reader;
+    if (thread != RT_NULL &&
+        (thread->stat & RT_THREAD_STAT_MASK) == RT_THREAD_SUSPEND)
+    {
+        rq->reader = RT_NULL;
+        rt_thread_resume(thread);
+
+        /* enable interrupt */
+        rt_hw_interrupt_enable(level);
+
+        rt_schedule();
+
+        return;
+    }
+
+    /* enable interrupt */
+    rt_hw_interrupt_enable(level);
+}
+
+/*
+ * make the put elements visible to consumer by the new put index.
+ */
+rt_inline void _rt_ringqueue_publish(rt_ringqueue_t rq, rt_uint32_t head)
+{
+    /* the elements are written before the index */
+    rt_hw_dmb();
+    rq->head = head;
+
+    /* the index is written before checking the waiting consumer */
+    rt_hw_dmb();
+    if (rq->reader != RT_NULL)
+        _rt_ringqueue_wakeup(rq);
+}
+
+/*
+ * wait until there are elements in the ring queue.
+ *
+ * @return the number of elements, 0 on timeout or the ring queue is detached
+ */
+static rt_uint32_t _rt_ringqueue_wait(rt_ringqueue_t rq, rt_int32_t timeout)
+{
+    rt_uint32_t count;
+    rt_uint32_t tick_delta;
+    struct rt_thread *thread;
+    register rt_base_t level;
+
+    tick_delta = 0;
+
+    while ((count = rq->head - rq->tail) == 0)
+    {
+        /* no waiting, return with timeout */
+        if (timeout == 0)
+            return 0;
+
+        RT_DEBUG_IN_THREAD_CONTEXT;
+
+        thread = rt_thread_self();
+
+        /* disable interrupt */
+        level = rt_hw_interrupt_disable();
+
+        /* publish the waiting consumer, then check the put index again */
+        rq->reader = thread;
+        rt_hw_dmb();
+        if (rq->head != rq->tail)
+        {
+            rq->reader = RT_NULL;
+
+            /* enable interrupt */
+            rt_hw_interrupt_enable(level);
+            continue;
+        }
+
+        /* reset thread error number */
+        thread->error = RT_EOK;
+
+        /* suspend current thread */
+        rt_thread_suspend(thread);
+
+        /* has waiting time, start thread timer */
+        if (timeout > 0)
+        {
+            /* get the start tick of timer */
+            tick_delta = rt_tick_get();
+
+            RT_DEBUG_LOG(RT_DEBUG_IPC, ("set thread:%s to timer list\n",
+                                        thread->name));
+
+            /* reset the timeout of thread timer and start it */
+            rt_timer_control(&(thread->thread_timer),
+                             RT_TIMER_CTRL_SET_TIME,
+                             &timeout);
+            rt_timer_start(&(thread->thread_timer));
+        }
+
+        /* enable interrupt */
+        rt_hw_interrupt_enable(level);
+
+        /* do schedule */
+        rt_schedule();
+
+        /* the ring queue is detached */
+        if (thread->error == -RT_ERROR)
+            return 0;
+
+        /* disable interrupt */
+        level = rt_hw_interrupt_disable();
+        rq->reader = RT_NULL;
+        /* enable interrupt */
+        rt_hw_interrupt_enable(level);
+
+        if (thread->error != RT_EOK)
+        {
+            /* timeout, check the elements for the last time */
+            timeout = 0;
+        }
+        else if (timeout > 0)
+        {
+            /* if it's not waiting forever, then re-calculate timeout tick */
+            tick_delta = rt_tick_get() - tick_delta;
+            timeout -= tick_delta;
+            if (timeout < 0)
+                timeout = 0;
+        }
+    }
+
+    /* the elements are read after the index */
+    rt_hw_dmb();
+
+    return count;
+}
+
+/*
+ * wake up the waiting consumer with error before the ring queue is detached.
+ */
+static void _rt_ringqueue_clear(rt_ringqueue_t rq)
+{
+    struct rt_thread *thread;
+    register rt_base_t level;
+
+    /* disable interrupt */
+    level = rt_hw_interrupt_disable();
+
+    thread = rq->reader;
+    if (thread != RT_NULL &&
+        (thread->stat & RT_THREAD_STAT_MASK) == RT_THREAD_SUSPEND)
+    {
+        /* set error code to RT_ERROR */
+        thread->error = -RT_ERROR;
+        rt_thread_resume(thread);
+    }
+    rq->reader = RT_NULL;
+
+    /* enable interrupt */
+    rt_hw_interrupt_enable(level);
+}
+
+/**
+ * @addtogroup IPC
+ */
+
+/**@{*/
+
+/**
+ * This function will initialize a ring queue object. The ring queue has one
+ * producer which may be an interrupt service routine, and one consumer thread.
+ *
+ * @param rq the ring queue object
+ * @param name the name of ring queue
+ * @param pool the buffer of elements, its size is elem_size * size
+ * @param elem_size the size of each element
+ * @param size the number of elements, which shall be a power of 2
+ *
+ * @return RT_EOK
+ */
+rt_err_t rt_ringqueue_init(rt_ringqueue_t rq,
+                           const char    *name,
+                           void          *pool,
+                           rt_size_t      elem_size,
+                           rt_size_t      size)
+{
+    /* parameter check */
+    RT_ASSERT(rq != RT_NULL);
+    RT_ASSERT(pool != RT_NULL);
+    RT_ASSERT(elem_size > 0);
+    RT_ASSERT(size > 0 && (size & (size - 1)) == 0);
+
+    /* initialize object */
+    rt_object_init(&(rq->parent), RT_Object_Class_RingQueue, name);
+
+    rq->pool      = (rt_uint8_t *)pool;
+    rq->elem_size = elem_size;
+    rq->size      = size;
+    rq->reader    = RT_NULL;
+    rq->head      = 0;
+    rq->tail      = 0;
+
+    return RT_EOK;
+}
+
+/**
+ * This function will detach a ring queue object from resource management.
+ *
+ * @param rq the ring queue object
+ *
+ * @return RT_EOK
+ */
+rt_err_t rt_ringqueue_detach(rt_ringqueue_t rq)
+{
+    /* parameter check */
+    RT_ASSERT(rq != RT_NULL);
+    RT_ASSERT(rt_object_get_type(&rq->parent) == RT_Object_Class_RingQueue);
+    RT_ASSERT(rt_object_is_systemobject(&rq->parent));
+
+    /* wake up the waiting consumer */
+    _rt_ringqueue_clear(rq);
+
+    /* detach ring queue object */
+    rt_object_detach(&(rq->parent));
+
+    return RT_EOK;
+}
+
+#ifdef RT_USING_HEAP
+/**
+ * This function will create a ring queue object and allocate the buffer of
+ * elements from heap.
+ *
+ * @param name the name of ring queue
+ * @param elem_size the size of each element
+ * @param size the number of elements, which shall be a power of 2
+ *
+ * @return the created ring queue, RT_NULL on error happen
+ */
+rt_ringqueue_t rt_ringqueue_create(const char *name,
+                                   rt_size_t   elem_size,
+                                   rt_size_t   size)
+{
+    struct rt_ringqueue *rq;
+
+    RT_DEBUG_NOT_IN_INTERRUPT;
+
+    /* parameter check */
+    RT_ASSERT(elem_size > 0);
+    RT_ASSERT(size > 0 && (size & (size - 1)) == 0);
+
+    /* allocate object */
+    rq = (rt_ringqueue_t)rt_object_allocate(RT_Object_Class_RingQueue, name);
+    if (rq == RT_NULL)
+        return rq;
+
+    /* allocate the buffer of elements */
+    rq->pool = (rt_uint8_t *)rt_malloc(elem_size * size);
+    if (rq->pool == RT_NULL)
+    {
+        /* no memory, delete ring queue object */
+        rt_object_delete(&(rq->parent));
+
+        return RT_NULL;
+    }
+
+    rq->elem_size = elem_size;
+    rq->size      = size;
+    rq->reader    = RT_NULL;
+    rq->head      = 0;
+    rq->tail      = 0;
+
+    return rq;
+}
+
+/**
+ * This function will delete a ring queue object and release the memory.
+ *
+ * @param rq the ring queue object
+ *
+ * @return RT_EOK
+ */
+rt_err_t rt_ringqueue_delete(rt_ringqueue_t rq)
+{
+    RT_DEBUG_NOT_IN_INTERRUPT;
+
+    /* parameter check */
+    RT_ASSERT(rq != RT_NULL);
+    RT_ASSERT(rt_object_get_type(&rq->parent) == RT_Object_Class_RingQueue);
+    RT_ASSERT(rt_object_is_systemobject(&rq->parent) == RT_FALSE);
+
+    /* wake up the waiting consumer */
+    _rt_ringqueue_clear(rq);
+
+    /* free the buffer of elements */
+    rt_free(rq->pool);
+
+    /* delete ring queue object */
+    rt_object_delete(&(rq->parent));
+
+    return RT_EOK;
+}
+#endif
+
+/**
+ * This function will put elements to the ring queue without lock, it shall
+ * be invoked by the producer only and can be invoked in interrupt.
+ *
+ * @param rq the ring queue object
+ * @param buffer the elements to be put
+ * @param count the number of elements
+ *
+ * @return the number of elements put, which is less than count when the ring
+ *         queue is full
+ */
+rt_size_t rt_ringqueue_put(rt_ringqueue_t rq, const void *buffer, rt_size_t count)
+{
+    rt_uint32_t head, space, index, first;
+
+    /* parameter check */
+    RT_ASSERT(rq != RT_NULL);
+    RT_ASSERT(buffer != RT_NULL || count == 0);
+
+    head  = rq->head;
+    space = rq->size - (head - rq->tail);
+    if (count > space)
+        count = space;
+    if (count == 0)
+        return 0;
+
+    /* copy the elements, which may wrap around the end of buffer */
+    index = head & (rq->size - 1);
+    first = rq->size - index;
+    if (first > count)
+        first = count;
+    rt_memcpy(rq->pool + index * rq->elem_size, buffer, first * rq->elem_size);
+    if (count > first)
+    {
+        rt_memcpy(rq->pool, (const rt_uint8_t *)buffer + first * rq->elem_size,
+                  (count - first) * rq->elem_size);
+    }
+
+    _rt_ringqueue_publish(rq, head + count);
+
+    return count;
+}
+
+/**
+ * This function will get elements from the ring queue, it shall be invoked
+ * by the consumer only.
+ *
+ * @param rq the ring queue object
+ * @param buffer the buffer to save the elements
+ * @param count the maximal number of elements to get
+ * @param timeout the waiting time when the ring queue is empty
+ *
+ * @return the number of elements got, 0 on timeout
+ */
+rt_size_t rt_ringqueue_get(rt_ringqueue_t rq,
+                           void          *buffer,
+                           rt_size_t      count,
+                           rt_int32_t     timeout)
+{
+    rt_uint32_t tail, avail, index, first;
+
+    /* parameter check */
+    RT_ASSERT(rq != RT_NULL);
+    RT_ASSERT(buffer != RT_NULL);
+
+    avail = _rt_ringqueue_wait(rq, timeout);
+    if (count > avail)
+        count = avail;
+    if (count == 0)
+        return 0;
+
+    /* copy the elements, which may wrap around the end of buffer */
+    tail  = rq->tail;
+    index = tail & (rq->size - 1);
+    first = rq->size - index;
+    if (first > count)
+        first = count;
+    rt_memcpy(buffer, rq->pool + index * rq->elem_size, first * rq->elem_size);
+    if (count > first)
+    {
+        rt_memcpy((rt_uint8_t *)buffer + first * rq->elem_size, rq->pool,
+                  (count - first) * rq->elem_size);
+    }
+
+    /* the elements are read out before the slots are freed */
+    rt_hw_dmb();
+    rq->tail = tail + count;
+
+    return count;
+}
+
+/**
+ * This function will reserve the contiguous free slots of the ring queue, so
+ * the producer can fill the elements in place and then commit them.
+ *
+ * @param rq the ring queue object
+ * @param ptr the address of the first reserved slot
+ *
+ * @return the number of contiguous free slots
+ */
+rt_size_t rt_ringqueue_reserve(rt_ringqueue_t rq, void **ptr)
+{
+    rt_uint32_t head, space, index;
+
+    /* parameter check */
+    RT_ASSERT(rq != RT_NULL);
+    RT_ASSERT(ptr != RT_NULL);
+
+    head  = rq->head;
+    space = rq->size - (head - rq->tail);
+    index = head & (rq->size - 1);
+    if (space > rq->size - index)
+        space = rq->size - index;
+
+    *ptr = rq->pool + index * rq->elem_size;
+
+    return space;
+}
+
+/**
+ * This function will commit the elements filled in the reserved slots.
+ *
+ * @param rq the ring queue object
+ * @param count the number of elements, which is not more than the reserved
+ */
+void rt_ringqueue_commit(rt_ringqueue_t rq, rt_size_t count)
+{
+    /* parameter check */
+    RT_ASSERT(rq != RT_NULL);
+    RT_ASSERT(count <= rq->size - (rq->head - rq->tail));
+
+    if (count > 0)
+        _rt_ringqueue_publish(rq, rq->head + count);
+}
+
+/**
+ * This function will peek the contiguous elements of the ring queue, so the
+ * consumer can process the elements in place and then consume them.
+ *
+ * @param rq the ring queue object
+ * @param ptr the address of the first element
+ * @param timeout the waiting time when the ring queue is empty
+ *
+ * @return the number of contiguous elements, 0 on timeout
+ */
+rt_size_t rt_ringqueue_peek(rt_ringqueue_t rq, void **ptr, rt_int32_t timeout)
+{
+    rt_uint32_t avail, index;
+
+    /* parameter check */
+    RT_ASSERT(rq != RT_NULL);
+    RT_ASSERT(ptr != RT_NULL);
+
+    avail = _rt_ringqueue_wait(rq, timeout);
+    if (avail == 0)
+        return 0;
+
+    index = rq->tail & (rq->size - 1);
+    if (avail > rq->size - index)
+        avail = rq->size - index;
+
+    *ptr = rq->pool + index * rq->elem_size;
+
+    return avail;
+}
+
+/**
+ * This function will free the slots of peeked elements.
+ *
+ * @param rq the ring queue object
+ * @param count the number of elements, which is not more than the peeked
+ */
+void rt_ringqueue_consume(rt_ringqueue_t rq, rt_size_t count)
+{
+    /* parameter check */
+    RT_ASSERT(rq != RT_NULL);
+    RT_ASSERT(count <= rq->head - rq->tail);
+
+    /* the elements are processed before the slots are freed */
+    rt_hw_dmb();
+    rq->tail = rq->tail + count;
+}
+
+/**
+ * This function will get the number of elements in the ring queue.
+ *
+ * @param rq the ring queue object
+ *
+ * @return the number of elements
+ */
+rt_size_t rt_ringqueue_count(rt_ringqueue_t rq)
+{
+    /* parameter check */
+    RT_ASSERT(rq != RT_NULL);
+
+    return rq->head - rq->tail;
+}
+
+/**@}*/
+
+#endif /* RT_USING_RINGQUEUE */
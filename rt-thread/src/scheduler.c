@@ -42,10 +42,12 @@ rt_uint8_t rt_thread_ready_table[32];
 #endif
 
 
+#ifndef RT_USING_SMP
 extern volatile rt_uint8_t rt_interrupt_nest;
 static rt_int16_t rt_scheduler_lock_nest;
 struct rt_thread *rt_current_thread = RT_NULL;
 rt_uint8_t rt_current_priority;
+#endif /*RT_USING_SMP*/
 
 
 rt_list_t rt_thread_defunct;
@@ -73,6 +75,17 @@ rt_scheduler_sethook(void (*hook)(struct rt_thread *from, struct rt_thread *to))
     rt_scheduler_hook = hook;
 }
 
+/**
+ * This function will get the hook function invoked when thread switch
+ * happens, so it can be chained and restored.
+ *
+ * @return the hook function
+ */
+void (*rt_scheduler_gethook(void))(struct rt_thread *from, struct rt_thread *to)
+{
+    return rt_scheduler_hook;
+}
+
 /**@}*/
 #endif
 
@@ -121,6 +134,276 @@ static void _rt_scheduler_stack_check(struct rt_thread *thread)
 }
 #endif
 
+#ifdef RT_USING_THREAD_RUNTIME
+/* the cpu cycles of all threads in the current and the last window */
+static rt_tick_t   rt_runtime_index;
+static rt_uint64_t rt_runtime_window;
+static rt_uint64_t rt_runtime_last;
+
+/*
+ * move the window of cpu usage statistics to the current one, the current
+ * window becomes the last one if it is just closed, otherwise the last one
+ * is idle.
+ */
+rt_inline void _rt_scheduler_runtime_roll(rt_tick_t index, rt_tick_t *window_index,
+                                          rt_uint64_t *window, rt_uint64_t *last)
+{
+    if (*window_index != index)
+    {
+        *last = (index - *window_index == 1) ? *window : 0;
+        *window = 0;
+        *window_index = index;
+    }
+}
+
+/*
+ * add the cpu cycles to a window, the cycles of a window older than the last
+ * one are dropped.
+ */
+rt_inline void _rt_scheduler_runtime_add(rt_tick_t index, rt_tick_t *window_index,
+                                         rt_uint64_t *window, rt_uint64_t *last,
+                                         rt_uint64_t cycles)
+{
+    if (index - *window_index < RT_TICK_MAX / 2)
+    {
+        _rt_scheduler_runtime_roll(index, window_index, window, last);
+        *window += cycles;
+    }
+    else if (*window_index - index == 1)
+    {
+        *last += cycles;
+    }
+}
+
+/*
+ * charge the cpu cycles used since the last charge to the thread and to the
+ * windows, so the windows are rolled over without walking the threads. The
+ * running thread is charged on each tick, so the cycles are shared by the
+ * windows by ticks only when no tick is handled for a while, such as in the
+ * tickless sleep of idle thread.
+ */
+rt_inline void _rt_scheduler_runtime_charge(struct rt_thread *thread, rt_uint32_t now)
+{
+    rt_uint64_t used, part;
+    rt_tick_t tick, ticks, index, boundary;
+
+    used  = (rt_uint32_t)(now - thread->runtime_start);
+    tick  = rt_tick_get();
+    ticks = tick - thread->runtime_tick;
+    index = tick / RT_THREAD_RUNTIME_WINDOW;
+
+    thread->runtime += used;
+
+    boundary = index * RT_THREAD_RUNTIME_WINDOW;
+    if (ticks > tick - boundary)
+    {
+        /* the part in the last window, the windows before it are dropped */
+        part = tick - boundary + RT_THREAD_RUNTIME_WINDOW < ticks ?
+               RT_THREAD_RUNTIME_WINDOW : ticks - (tick - boundary);
+        part = used * part / ticks;
+        _rt_scheduler_runtime_add(index - 1, &rt_runtime_index, &rt_runtime_window,
+                                  &rt_runtime_last, part);
+        _rt_scheduler_runtime_add(index - 1, &thread->runtime_index, &thread->runtime_window,
+                                  &thread->runtime_last, part);
+
+        /* the part in the current window */
+        used = used * (tick - boundary) / ticks;
+    }
+
+    _rt_scheduler_runtime_add(index, &rt_runtime_index, &rt_runtime_window,
+                              &rt_runtime_last, used);
+    _rt_scheduler_runtime_add(index, &thread->runtime_index, &thread->runtime_window,
+                              &thread->runtime_last, used);
+
+    thread->runtime_start = now;
+    thread->runtime_tick  = tick;
+}
+
+/*
+ * account the cpu cycles when thread switch happens, from_thread is RT_NULL
+ * when the scheduler starts.
+ *
+ * Anotation：线程切换时把CPU周期计入切出的线程，并记录切入线程的起始周期
+ */
+static void _rt_scheduler_runtime_switch(struct rt_thread *from_thread,
+                                         struct rt_thread *to_thread)
+{
+    rt_uint32_t now;
+
+    now = rt_hw_cycle_get();
+    if (from_thread != RT_NULL)
+        _rt_scheduler_runtime_charge(from_thread, now);
+
+    to_thread->runtime_start = now;
+    to_thread->runtime_tick  = rt_tick_get();
+}
+
+/**
+ * This function will charge the cpu cycles to the running thread of current
+ * cpu, it is invoked by rt_tick_increase before the tick is increased, so a
+ * thread running for a long time is charged to each window it runs in.
+ */
+void rt_scheduler_runtime_tick(void)
+{
+    rt_base_t level;
+    struct rt_thread *thread;
+
+    level = rt_hw_interrupt_disable();
+
+    thread = rt_thread_self();
+    if (thread != RT_NULL)
+        _rt_scheduler_runtime_charge(thread, rt_hw_cycle_get());
+
+    rt_hw_interrupt_enable(level);
+}
+
+/**
+ * This function will charge the thread until now if it is running, and get
+ * its cpu usage in the last window of RT_THREAD_RUNTIME_WINDOW ticks.
+ *
+ * @param thread the thread
+ *
+ * @return the cpu usage in 0.01%, the share of the cycles of all cpus
+ *
+ * @note the cycles are charged when the thread is switched out and on each
+ * tick, and the cycles used by the interrupts are charged to the interrupted
+ * thread.
+ */
+rt_uint32_t rt_scheduler_runtime_update(struct rt_thread *thread)
+{
+    rt_base_t level;
+    rt_tick_t index;
+    rt_uint64_t last, total;
+#ifdef RT_USING_SMP
+    int cpu;
+#endif
+
+    level = rt_hw_interrupt_disable();
+
+#ifdef RT_USING_SMP
+    for (cpu = 0; cpu < RT_CPUS_NR; cpu ++)
+    {
+        if (rt_cpu_index(cpu)->current_thread == thread)
+            _rt_scheduler_runtime_charge(thread, rt_hw_cycle_get());
+    }
+#else
+    if (thread == rt_current_thread)
+        _rt_scheduler_runtime_charge(thread, rt_hw_cycle_get());
+#endif
+
+    index = rt_tick_get() / RT_THREAD_RUNTIME_WINDOW;
+    _rt_scheduler_runtime_roll(index, &rt_runtime_index, &rt_runtime_window, &rt_runtime_last);
+    _rt_scheduler_runtime_roll(index, &thread->runtime_index, &thread->runtime_window, &thread->runtime_last);
+    last  = thread->runtime_last;
+    total = rt_runtime_last;
+
+    rt_hw_interrupt_enable(level);
+
+    if (total == 0)
+        return 0;
+    if (last >= total)
+        return 10000;
+
+    return (rt_uint32_t)(last * 10000 / total);
+}
+#endif
+
+#ifdef RT_USING_SMP
+/*
+ * get the highest priority thread in the global ready queue and the ready
+ * queue of local cpu.
+ *
+ * Anotation：从全局就绪队列和本CPU的就绪队列中找出优先级最高的线程
+ */
+static struct rt_thread* _get_highest_priority_thread(rt_ubase_t *highest_prio)
+{
+    register struct rt_thread *highest_priority_thread;
+    register rt_ubase_t highest_ready_priority, local_highest_ready_priority;
+    struct rt_cpu* pcpu = rt_cpu_self();
+
+#if RT_THREAD_PRIORITY_MAX > 32
+    register rt_ubase_t number;
+
+    number = __rt_ffs(rt_thread_ready_priority_group) - 1;
+    highest_ready_priority = (number << 3) + __rt_ffs(rt_thread_ready_table[number]) - 1;
+    number = __rt_ffs(pcpu->priority_group) - 1;
+    local_highest_ready_priority = (number << 3) + __rt_ffs(pcpu->ready_table[number]) - 1;
+#else
+    highest_ready_priority = __rt_ffs(rt_thread_ready_priority_group) - 1;
+    local_highest_ready_priority = __rt_ffs(pcpu->priority_group) - 1;
+#endif
+
+    /* get highest ready priority thread */
+    if (highest_ready_priority < local_highest_ready_priority)
+    {
+        *highest_prio = highest_ready_priority;
+        highest_priority_thread = rt_list_entry(rt_thread_priority_table[highest_ready_priority].next,
+                                  struct rt_thread,
+                                  tlist);
+    }
+    else
+    {
+        *highest_prio = local_highest_ready_priority;
+        highest_priority_thread = rt_list_entry(pcpu->priority_table[local_highest_ready_priority].next,
+                                  struct rt_thread,
+                                  tlist);
+    }
+
+    return highest_priority_thread;
+}
+
+/*
+ * pick the next thread of local cpu, the current thread is put back to the
+ * ready queue if it is preempted, yielded or not allowed on this cpu.
+ * It returns the current thread if no switch is needed.
+ */
+static struct rt_thread *_scheduler_pick_thread(struct rt_cpu *pcpu, int cpu_id,
+                                                rt_ubase_t *highest_prio)
+{
+    struct rt_thread *to_thread;
+    struct rt_thread *current_thread = pcpu->current_thread;
+
+    if (rt_thread_ready_priority_group == 0 && pcpu->priority_group == 0)
+    {
+        /* only the current thread is ready for this cpu */
+        current_thread->stat &= ~RT_THREAD_STAT_YIELD_MASK;
+        *highest_prio = current_thread->current_priority;
+        return current_thread;
+    }
+
+    to_thread = _get_highest_priority_thread(highest_prio);
+
+    current_thread->oncpu = RT_CPU_DETACHED;
+    if ((current_thread->stat & RT_THREAD_STAT_MASK) == RT_THREAD_RUNNING)
+    {
+        if (current_thread->bind_cpu != RT_CPUS_NR &&
+            current_thread->bind_cpu != cpu_id)
+        {
+            /* the thread is bound to another cpu, migrate it */
+            rt_schedule_insert_thread(current_thread);
+        }
+        else if (current_thread->current_priority < *highest_prio)
+        {
+            to_thread = current_thread;
+        }
+        else if (current_thread->current_priority == *highest_prio &&
+                 (current_thread->stat & RT_THREAD_STAT_YIELD_MASK) == 0)
+        {
+            to_thread = current_thread;
+        }
+        else
+        {
+            rt_schedule_insert_thread(current_thread);
+        }
+        current_thread->stat &= ~RT_THREAD_STAT_YIELD_MASK;
+    }
+
+    to_thread->oncpu = cpu_id;
+
+    return to_thread;
+}
+#endif /*RT_USING_SMP*/
+
 /**
  * @ingroup SystemInit
  * This function will initialize the system scheduler
@@ -128,9 +411,14 @@ static void _rt_scheduler_stack_check(struct rt_thread *thread)
  */
 void rt_system_scheduler_init(void)
 {
+#ifdef RT_USING_SMP
+    int cpu;
+#endif /*RT_USING_SMP*/
     register rt_base_t offset;
 
+#ifndef RT_USING_SMP
     rt_scheduler_lock_nest = 0;
+#endif /*RT_USING_SMP*/
 
     RT_DEBUG_LOG(RT_DEBUG_SCHEDULER, ("start scheduler: max priority 0x%02x\n",
                                       RT_THREAD_PRIORITY_MAX));
@@ -143,8 +431,28 @@ void rt_system_scheduler_init(void)
         rt_list_init(&rt_thread_priority_table[offset]);
     }
 
+#ifdef RT_USING_SMP
+    for (cpu = 0; cpu < RT_CPUS_NR; cpu++)
+    {
+        struct rt_cpu *pcpu =  rt_cpu_index(cpu);
+        for (offset = 0; offset < RT_THREAD_PRIORITY_MAX; offset ++)
+        {
+            rt_list_init(&pcpu->priority_table[offset]);
+        }
+
+        pcpu->irq_switch_flag = 0;
+        pcpu->current_priority = RT_THREAD_PRIORITY_MAX - 1;
+        pcpu->current_thread = RT_NULL;
+        pcpu->priority_group = 0;
+
+#if RT_THREAD_PRIORITY_MAX > 32
+        rt_memset(pcpu->ready_table, 0, sizeof(pcpu->ready_table));
+#endif
+    }
+#else
     rt_current_priority = RT_THREAD_PRIORITY_MAX - 1;
     rt_current_thread = RT_NULL;
+#endif /*RT_USING_SMP*/
 
     /* initialize ready priority group */
     rt_thread_ready_priority_group = 0;
@@ -156,6 +464,11 @@ void rt_system_scheduler_init(void)
 
     /* initialize thread defunct */
     rt_list_init(&rt_thread_defunct);
+
+#ifdef RT_USING_THREAD_RUNTIME
+    /* open the first window of cpu usage statistics */
+    rt_runtime_index = rt_tick_get() / RT_THREAD_RUNTIME_WINDOW;
+#endif
 }
 
 /**
@@ -167,6 +480,23 @@ void rt_system_scheduler_init(void)
  */
 void rt_system_scheduler_start(void)
 {
+#ifdef RT_USING_SMP
+    register struct rt_thread *to_thread;
+    rt_ubase_t highest_ready_priority;
+
+    to_thread = _get_highest_priority_thread(&highest_ready_priority);
+    to_thread->oncpu = rt_hw_cpu_id();
+
+    rt_schedule_remove_thread(to_thread);
+    to_thread->stat = RT_THREAD_RUNNING;
+
+#ifdef RT_USING_THREAD_RUNTIME
+    _rt_scheduler_runtime_switch(RT_NULL, to_thread);
+#endif
+
+    /* switch to new thread, the cpus lock is released in the switch */
+    rt_hw_context_switch_to((rt_ubase_t)&to_thread->sp, to_thread);
+#else
     /*
      * to_thread 为指向下一要调度线程的指针。
      * highest_ready_priority 表示这个当前线程的最高优先级，下次调用将启动优先级最高的线程。
@@ -195,10 +525,20 @@ void rt_system_scheduler_start(void)
      * */
     rt_current_thread = to_thread;
 
+#ifdef RT_USING_THREAD_RUNTIME
+    _rt_scheduler_runtime_switch(RT_NULL, to_thread);
+#endif
+
+#ifdef RT_USING_IRQ_LATENCY
+    /* the interrupt disabled at startup is enabled by the first thread */
+    rt_irqlat_reset();
+#endif
+
     /* switch to new thread
      * rt_hw_context_switch_to 这个线程转换与硬件有关，由于不同的芯片和不同的芯片架构其底层的指令不同，所以其实现也不同。
      * */
     rt_hw_context_switch_to((rt_uint32_t)&to_thread->sp);
+#endif /*RT_USING_SMP*/
 
     /* never come back */
 }
@@ -209,6 +549,153 @@ void rt_system_scheduler_start(void)
 
 /**@{*/
 
+#ifdef RT_USING_SMP
+/**
+ * This function will handle IPI interrupt and do a scheduling in system.
+ *
+ * @param vector, the number of IPI interrupt for system scheduling
+ * @param param, use RT_NULL
+ *
+ * @note this function should be invoke or register as ISR in BSP.
+ */
+void rt_scheduler_ipi_handler(int vector, void *param)
+{
+    rt_schedule();
+}
+
+/**
+ * This function will perform one schedule. It will select one thread
+ * with the highest priority level in the global ready queue or the ready
+ * queue of local cpu, then switch to it.
+ *
+ * Anotation：SMP下的调度，在中断中只设置切换标志，由中断退出时的 rt_scheduler_do_irq_switch 完成切换
+ */
+void rt_schedule(void)
+{
+    rt_base_t level;
+    struct rt_thread *to_thread;
+    struct rt_thread *current_thread;
+    struct rt_cpu    *pcpu;
+    int cpu_id;
+
+    /* disable interrupt */
+    level  = rt_hw_interrupt_disable();
+
+    cpu_id = rt_hw_cpu_id();
+    pcpu   = rt_cpu_index(cpu_id);
+    current_thread = pcpu->current_thread;
+
+    /* whether do switch in interrupt */
+    if (pcpu->irq_nest)
+    {
+        pcpu->irq_switch_flag = 1;
+        rt_hw_interrupt_enable(level);
+        return;
+    }
+
+    /* the scheduler is locked only by the cpus lock of this function */
+    if (current_thread->scheduler_lock_nest == 1)
+    {
+        rt_ubase_t highest_ready_priority;
+
+        to_thread = _scheduler_pick_thread(pcpu, cpu_id, &highest_ready_priority);
+        if (to_thread != current_thread)
+        {
+            /* if the destination thread is not the same as current thread */
+            pcpu->current_priority = (rt_uint8_t)highest_ready_priority;
+
+            RT_OBJECT_HOOK_CALL(rt_scheduler_hook, (current_thread, to_thread));
+#ifdef RT_USING_THREAD_RUNTIME
+            _rt_scheduler_runtime_switch(current_thread, to_thread);
+#endif
+
+            rt_schedule_remove_thread(to_thread);
+            to_thread->stat = RT_THREAD_RUNNING | (to_thread->stat & ~RT_THREAD_STAT_MASK);
+
+            /* switch to new thread */
+            RT_DEBUG_LOG(RT_DEBUG_SCHEDULER,
+                         ("[%d]switch to priority#%d "
+                          "thread:%.*s(sp:0x%08x), "
+                          "from thread:%.*s(sp: 0x%08x)\n",
+                          pcpu->irq_nest, highest_ready_priority,
+                          RT_NAME_MAX, to_thread->name, to_thread->sp,
+                          RT_NAME_MAX, current_thread->name, current_thread->sp));
+
+#ifdef RT_USING_OVERFLOW_CHECK
+            _rt_scheduler_stack_check(to_thread);
+#endif
+
+            rt_hw_context_switch((rt_ubase_t)&current_thread->sp,
+                                 (rt_ubase_t)&to_thread->sp, to_thread);
+        }
+    }
+
+    /* enable interrupt */
+    rt_hw_interrupt_enable(level);
+}
+
+/**
+ * This function checks if a scheduling is needed after IRQ context. If yes,
+ * it will select one thread with the highest priority level, and then switch
+ * to it.
+ *
+ * @param context the context of the interrupted thread
+ */
+void rt_scheduler_do_irq_switch(void *context)
+{
+    int cpu_id;
+    rt_base_t level;
+    struct rt_cpu* pcpu;
+    struct rt_thread *to_thread;
+    struct rt_thread *current_thread;
+
+    level = rt_hw_interrupt_disable();
+
+    cpu_id = rt_hw_cpu_id();
+    pcpu   = rt_cpu_index(cpu_id);
+    current_thread = pcpu->current_thread;
+
+    if (pcpu->irq_switch_flag == 0)
+    {
+        rt_hw_interrupt_enable(level);
+        return;
+    }
+
+    if (current_thread->scheduler_lock_nest == 1 && pcpu->irq_nest == 0)
+    {
+        rt_ubase_t highest_ready_priority;
+
+        /* clear irq switch flag */
+        pcpu->irq_switch_flag = 0;
+
+        to_thread = _scheduler_pick_thread(pcpu, cpu_id, &highest_ready_priority);
+        if (to_thread != current_thread)
+        {
+            pcpu->current_priority = (rt_uint8_t)highest_ready_priority;
+
+            RT_OBJECT_HOOK_CALL(rt_scheduler_hook, (current_thread, to_thread));
+#ifdef RT_USING_THREAD_RUNTIME
+            _rt_scheduler_runtime_switch(current_thread, to_thread);
+#endif
+
+            rt_schedule_remove_thread(to_thread);
+            to_thread->stat = RT_THREAD_RUNNING | (to_thread->stat & ~RT_THREAD_STAT_MASK);
+
+#ifdef RT_USING_OVERFLOW_CHECK
+            _rt_scheduler_stack_check(to_thread);
+#endif
+            RT_DEBUG_LOG(RT_DEBUG_SCHEDULER, ("switch in interrupt\n"));
+
+            current_thread->cpus_lock_nest--;
+            current_thread->scheduler_lock_nest--;
+
+            rt_hw_context_switch_interrupt(context, (rt_ubase_t)&current_thread->sp,
+                                           (rt_ubase_t)&to_thread->sp, to_thread);
+        }
+    }
+    rt_hw_interrupt_enable(level);
+}
+#else
 /**
  * This function will perform one schedule. It will select one thread
  * with the highest priority level, then switch to it.
@@ -255,6 +742,9 @@ void rt_schedule(void)
             rt_current_thread   = to_thread;
 
             RT_OBJECT_HOOK_CALL(rt_scheduler_hook, (from_thread, to_thread));
+#ifdef RT_USING_THREAD_RUNTIME
+            _rt_scheduler_runtime_switch(from_thread, to_thread);
+#endif
 
             /* switch to new thread */
             RT_DEBUG_LOG(RT_DEBUG_SCHEDULER,
@@ -294,6 +784,7 @@ void rt_schedule(void)
     /* enable interrupt */
     rt_hw_interrupt_enable(level);
 }
+#endif /*RT_USING_SMP*/
 
 /*
  * This function will insert a thread to system ready queue. The state of
@@ -304,6 +795,133 @@ void rt_schedule(void)
  *
  * Anotation：插入一个线程
  */
+#ifdef RT_USING_SMP
+void rt_schedule_insert_thread(struct rt_thread *thread)
+{
+    int cpu_id;
+    int bind_cpu;
+    rt_uint32_t cpu_mask;
+    register rt_base_t level;
+
+    RT_ASSERT(thread != RT_NULL);
+
+    /* disable interrupt */
+    level = rt_hw_interrupt_disable();
+
+    /* it should be RUNNING thread */
+    if (thread->oncpu != RT_CPU_DETACHED)
+    {
+        thread->stat = RT_THREAD_RUNNING | (thread->stat & ~RT_THREAD_STAT_MASK);
+        goto __exit;
+    }
+
+    /* READY thread, insert to ready queue */
+    thread->stat = RT_THREAD_READY | (thread->stat & ~RT_THREAD_STAT_MASK);
+
+    cpu_id   = rt_hw_cpu_id();
+    bind_cpu = thread->bind_cpu ;
+
+    /* insert thread to ready list */
+    if (bind_cpu == RT_CPUS_NR)
+    {
+#if RT_THREAD_PRIORITY_MAX > 32
+        rt_thread_ready_table[thread->number] |= thread->high_mask;
+#endif
+        rt_thread_ready_priority_group |= thread->number_mask;
+
+        rt_list_insert_before(&(rt_thread_priority_table[thread->current_priority]),
+                              &(thread->tlist));
+
+        /* let the other cpus check whether to run it */
+        cpu_mask = RT_CPU_MASK ^ (1 << cpu_id);
+        rt_hw_ipi_send(RT_SCHEDULE_IPI, cpu_mask);
+    }
+    else
+    {
+        struct rt_cpu *pcpu = rt_cpu_index(bind_cpu);
+
+#if RT_THREAD_PRIORITY_MAX > 32
+        pcpu->ready_table[thread->number] |= thread->high_mask;
+#endif
+        pcpu->priority_group |= thread->number_mask;
+
+        rt_list_insert_before(&(pcpu->priority_table[thread->current_priority]),
+                              &(thread->tlist));
+
+        if (cpu_id != bind_cpu)
+        {
+            cpu_mask = 1 << bind_cpu;
+            rt_hw_ipi_send(RT_SCHEDULE_IPI, cpu_mask);
+        }
+    }
+
+    RT_DEBUG_LOG(RT_DEBUG_SCHEDULER, ("insert thread[%.*s], the priority: %d\n",
+                                      RT_NAME_MAX, thread->name, thread->current_priority));
+
+__exit:
+    /* enable interrupt */
+    rt_hw_interrupt_enable(level);
+}
+
+/*
+ * This function will remove a thread from system ready queue.
+ *
+ * @param thread the thread to be removed
+ *
+ * @note Please do not invoke this function in user application.
+ */
+void rt_schedule_remove_thread(struct rt_thread *thread)
+{
+    register rt_base_t level;
+
+    RT_ASSERT(thread != RT_NULL);
+
+    /* disable interrupt */
+    level = rt_hw_interrupt_disable();
+
+    RT_DEBUG_LOG(RT_DEBUG_SCHEDULER, ("remove thread[%.*s], the priority: %d\n",
+                                      RT_NAME_MAX, thread->name,
+                                      thread->current_priority));
+
+    /* remove thread from ready list */
+    rt_list_remove(&(thread->tlist));
+    if (thread->bind_cpu == RT_CPUS_NR)
+    {
+        if (rt_list_isempty(&(rt_thread_priority_table[thread->current_priority])))
+        {
+#if RT_THREAD_PRIORITY_MAX > 32
+            rt_thread_ready_table[thread->number] &= ~thread->high_mask;
+            if (rt_thread_ready_table[thread->number] == 0)
+            {
+                rt_thread_ready_priority_group &= ~thread->number_mask;
+            }
+#else
+            rt_thread_ready_priority_group &= ~thread->number_mask;
+#endif
+        }
+    }
+    else
+    {
+        struct rt_cpu *pcpu = rt_cpu_index(thread->bind_cpu);
+
+        if (rt_list_isempty(&(pcpu->priority_table[thread->current_priority])))
+        {
+#if RT_THREAD_PRIORITY_MAX > 32
+            pcpu->ready_table[thread->number] &= ~thread->high_mask;
+            if (pcpu->ready_table[thread->number] == 0)
+            {
+                pcpu->priority_group &= ~thread->number_mask;
+            }
+#else
+            pcpu->priority_group &= ~thread->number_mask;
+#endif
+        }
+    }
+
+    /* enable interrupt */
+    rt_hw_interrupt_enable(level);
+}
+#else
 void rt_schedule_insert_thread(struct rt_thread *thread)
 {
     register rt_base_t temp;
@@ -393,12 +1011,52 @@ void rt_schedule_remove_thread(struct rt_thread *thread)
     /* enable interrupt */
     rt_hw_interrupt_enable(temp);
 }
+#endif /*RT_USING_SMP*/
 
 /**
  * This function will lock the thread scheduler.
  *
  * Anotation：对调度器进行锁定。
  */
+#ifdef RT_USING_SMP
+void rt_enter_critical(void)
+{
+    register rt_base_t level;
+    struct rt_thread *current_thread;
+
+    /* disable interrupt */
+    level = rt_hw_local_irq_disable();
+
+    current_thread = rt_cpu_self()->current_thread;
+    if (!current_thread)
+    {
+        rt_hw_local_irq_enable(level);
+        return;
+    }
+
+    /*
+     * the maximal number of nest is RT_UINT16_MAX, which is big
+     * enough and does not check here
+     */
+    {
+        register rt_uint16_t lock_nest = current_thread->cpus_lock_nest;
+        current_thread->cpus_lock_nest++;
+        if (lock_nest == 0)
+        {
+            current_thread->scheduler_lock_nest ++;
+            rt_hw_spin_lock(&_cpus_lock);
+        }
+    }
+    /* critical for local cpu */
+    current_thread->critical_lock_nest ++;
+
+    /* lock scheduler for local cpu */
+    current_thread->scheduler_lock_nest ++;
+
+    /* enable interrupt */
+    rt_hw_local_irq_enable(level);
+}
+#else
 void rt_enter_critical(void)
 {
     register rt_base_t level;
@@ -415,11 +1073,54 @@ void rt_enter_critical(void)
     /* enable interrupt */
     rt_hw_interrupt_enable(level);
 }
+#endif /*RT_USING_SMP*/
 
 /**
  * This function will unlock the thread scheduler.
  * Anotation：对调度器进行解锁
  */
+#ifdef RT_USING_SMP
+void rt_exit_critical(void)
+{
+    register rt_base_t level;
+    struct rt_thread *current_thread;
+
+    /* disable interrupt */
+    level = rt_hw_local_irq_disable();
+
+    current_thread = rt_cpu_self()->current_thread;
+    if (!current_thread)
+    {
+        rt_hw_local_irq_enable(level);
+        return;
+    }
+
+    current_thread->scheduler_lock_nest --;
+
+    current_thread->critical_lock_nest --;
+
+    current_thread->cpus_lock_nest--;
+    if (current_thread->cpus_lock_nest == 0)
+    {
+        current_thread->scheduler_lock_nest --;
+        rt_hw_spin_unlock(&_cpus_lock);
+    }
+
+    if (current_thread->scheduler_lock_nest <= 0)
+    {
+        current_thread->scheduler_lock_nest = 0;
+        /* enable interrupt */
+        rt_hw_local_irq_enable(level);
+
+        rt_schedule();
+    }
+    else
+    {
+        /* enable interrupt */
+        rt_hw_local_irq_enable(level);
+    }
+}
+#else
 void rt_exit_critical(void)
 {
     register rt_base_t level;
@@ -446,6 +1147,7 @@ void rt_exit_critical(void)
         rt_hw_interrupt_enable(level);
     }
 }
+#endif /*RT_USING_SMP*/
 
 /**
  * Get the scheduler lock level
@@ -457,7 +1159,13 @@ void rt_exit_critical(void)
  */
 rt_uint16_t rt_critical_level(void)
 {
+#ifdef RT_USING_SMP
+    struct rt_thread *current_thread = rt_cpu_self()->current_thread;
+
+    return current_thread->critical_lock_nest;
+#else
     return rt_scheduler_lock_nest;
+#endif /*RT_USING_SMP*/
 }
 /**@}*/
 
@@ -95,6 +95,28 @@ void rt_free_sethook(void (*hook)(void *ptr))
     rt_free_hook = hook;
 }
 
+/**
+ * This function will get the hook function invoked when a memory block is
+ * allocated from heap memory, so it can be chained and restored.
+ *
+ * @return the hook function
+ */
+void (*rt_malloc_gethook(void))(void *ptr, rt_size_t size)
+{
+    return rt_malloc_hook;
+}
+
+/**
+ * This function will get the hook function invoked when a memory block is
+ * released to heap memory, so it can be chained and restored.
+ *
+ * @return the hook function
+ */
+void (*rt_free_gethook(void))(void *ptr)
+{
+    return rt_free_hook;
+}
+
 /**@}*/
 
 #endif
@@ -178,6 +200,8 @@ typedef struct slab_zone
 
     rt_int32_t  z_zoneindex;    /* zone index */
     slab_chunk  *z_freechunk;   /* free chunk list */
+
+    rt_tick_t   z_freetick;     /* the tick when zone becomes totally free */
 } slab_zone;
 
 #define ZALLOC_SLAB_MAGIC       0x51ab51ab
@@ -185,7 +209,11 @@ typedef struct slab_zone
 #define ZALLOC_MIN_ZONE_SIZE    (32 * 1024)     /* minimum zone size */
 #define ZALLOC_MAX_ZONE_SIZE    (128 * 1024)    /* maximum zone size */
 #define NZONES                  72              /* number of zones */
+#ifdef RT_SLAB_ZONE_RELEASE_THRESH
+#define ZONE_RELEASE_THRESH     RT_SLAB_ZONE_RELEASE_THRESH
+#else
 #define ZONE_RELEASE_THRESH     2               /* threshold number of zones */
+#endif
 
 static slab_zone *zone_array[NZONES];   /* linked list of zones NFree > 0 */
 static slab_zone *zone_free;            /* whole zones that have become free */
@@ -195,6 +223,19 @@ static int zone_size;
 static int zone_limit;
 static int zone_page_cnt;
 
+#ifdef RT_MEM_STATS
+/* statistics of each zone class */
+struct slab_zone_stat
+{
+    rt_uint32_t hit;            /* allocations from the zones of class */
+    rt_uint32_t miss;           /* allocations which need a new zone */
+    rt_uint16_t zones;          /* zones owned by class */
+    rt_uint16_t chunk;          /* chunk size */
+    rt_uint16_t nmax;           /* chunks in a zone */
+};
+static struct slab_zone_stat zone_stat[NZONES];
+#endif
+
 /*
  * Misc constants.  Note that allocations that are exact multiples of
  * RT_MM_PAGE_SIZE, or exceed the zone limit, fall through to the kmem module.
@@ -230,6 +271,9 @@ struct rt_page_head
 };
 static struct rt_page_head *rt_page_list;
 static struct rt_semaphore heap_sem;
+#ifdef RT_USING_MEMFRAG
+static rt_uint32_t heap_generation;        /* changed on each update of blocks */
+#endif
 
 void *rt_page_alloc(rt_size_t npages)
 {
@@ -241,6 +285,9 @@ void *rt_page_alloc(rt_size_t npages)
 
     /* lock heap */
     rt_sem_take(&heap_sem, RT_WAITING_FOREVER);
+#ifdef RT_USING_MEMFRAG
+    heap_generation ++;
+#endif
     for (prev = &rt_page_list; (b = *prev) != RT_NULL; prev = &(b->next))
     {
         if (b->page > npages)
@@ -280,6 +327,9 @@ void rt_page_free(void *addr, rt_size_t npages)
 
     /* lock heap */
     rt_sem_take(&heap_sem, RT_WAITING_FOREVER);
+#ifdef RT_USING_MEMFRAG
+    heap_generation ++;
+#endif
 
     for (prev = &rt_page_list; (b = *prev) != RT_NULL; prev = &(b->next))
     {
@@ -493,6 +543,10 @@ void *rt_malloc(rt_size_t size)
         size = RT_ALIGN(size, RT_MM_PAGE_SIZE);
 
         chunk = rt_page_alloc(size >> RT_MM_PAGE_BITS);
+
+        /* the free zones may be reclaimed */
+        if (chunk == RT_NULL && rt_slab_reclaim(0) > 0)
+            chunk = rt_page_alloc(size >> RT_MM_PAGE_BITS);
         if (chunk == RT_NULL)
             return RT_NULL;
 
@@ -538,6 +592,10 @@ void *rt_malloc(rt_size_t size)
     {
         RT_ASSERT(z->z_nfree > 0);
 
+#ifdef RT_MEM_STATS
+        zone_stat[zi].hit ++;
+#endif
+
         /* Remove us from the zone_array[] when we become empty */
         if (--z->z_nfree == 0)
         {
@@ -585,6 +643,10 @@ void *rt_malloc(rt_size_t size)
     {
         rt_int32_t off;
 
+#ifdef RT_MEM_STATS
+        zone_stat[zi].miss ++;
+#endif
+
         if ((z = zone_free) != RT_NULL)
         {
             /* remove zone from free zone list */
@@ -598,6 +660,10 @@ void *rt_malloc(rt_size_t size)
 
             /* allocate a zone from page */
             z = rt_page_alloc(zone_size / RT_MM_PAGE_SIZE);
+
+            /* the free zones of other classes may be reclaimed */
+            if (z == RT_NULL && rt_slab_reclaim(0) > 0)
+                z = rt_page_alloc(zone_size / RT_MM_PAGE_SIZE);
             if (z == RT_NULL)
             {
                 chunk = RT_NULL;
@@ -649,6 +715,12 @@ void *rt_malloc(rt_size_t size)
         z->z_next = zone_array[zi];
         zone_array[zi] = z;
 
+#ifdef RT_MEM_STATS
+        zone_stat[zi].zones ++;
+        zone_stat[zi].chunk = size;
+        zone_stat[zi].nmax  = z->z_nmax;
+#endif
+
 #ifdef RT_MEM_STATS
         used_mem += z->z_chunksize;
         if (used_mem > max_mem)
@@ -840,6 +912,9 @@ void rt_free(void *ptr)
         zone_array[z->z_zoneindex] = z;
     }
 
+    if (z->z_nfree == z->z_nmax)
+        z->z_freetick = rt_tick_get();
+
     /*
      * If the zone becomes totally free, and there are other zones we
      * can allocate from, move this zone to the FreeZones list.  Since
@@ -862,6 +937,10 @@ void rt_free(void *ptr)
         /* reset zone */
         z->z_magic = -1;
 
+#ifdef RT_MEM_STATS
+        zone_stat[z->z_zoneindex].zones --;
+#endif
+
         /* insert to free zone list */
         z->z_next = zone_free;
         zone_free = z;
@@ -898,6 +977,199 @@ void rt_free(void *ptr)
     rt_sem_release(&heap_sem);
 }
 
+/*
+ * take a zone which is totally free for age ticks at least, the heap is locked.
+ */
+static slab_zone *_slab_zone_reclaim_get(rt_tick_t age)
+{
+    slab_zone *z, **pz;
+    rt_tick_t now;
+    int zi;
+
+    now = rt_tick_get();
+
+    /* the zones cached in free zone list firstly */
+    for (pz = &zone_free; (z = *pz) != RT_NULL; pz = &(z->z_next))
+    {
+        if (now - z->z_freetick >= age)
+        {
+            *pz = z->z_next;
+            -- zone_free_cnt;
+
+            return z;
+        }
+    }
+
+    /* the last zone of a class is kept in zone array even it is free */
+    for (zi = 0; zi < NZONES; zi ++)
+    {
+        for (pz = &zone_array[zi]; (z = *pz) != RT_NULL; pz = &(z->z_next))
+        {
+            if (z->z_nfree == z->z_nmax && now - z->z_freetick >= age)
+            {
+                *pz = z->z_next;
+                z->z_magic = -1;
+#ifdef RT_MEM_STATS
+                zone_stat[zi].zones --;
+#endif
+
+                return z;
+            }
+        }
+    }
+
+    return RT_NULL;
+}
+
+static rt_size_t _slab_reclaim(rt_tick_t age, rt_bool_t nowait)
+{
+    slab_zone *z;
+    struct memusage *kup;
+    rt_size_t count = 0;
+    int i;
+
+    while (1)
+    {
+        /* lock heap */
+        if (nowait)
+        {
+            if (rt_sem_trytake(&heap_sem) != RT_EOK)
+                break;
+        }
+        else
+        {
+            rt_sem_take(&heap_sem, RT_WAITING_FOREVER);
+        }
+
+        z = _slab_zone_reclaim_get(age);
+        if (z == RT_NULL)
+        {
+            rt_sem_release(&heap_sem);
+            break;
+        }
+
+        /* set message usage */
+        for (i = 0, kup = btokup(z); i < zone_page_cnt; i ++)
+        {
+            kup->type = PAGE_TYPE_FREE;
+            kup->size = 0;
+            kup ++;
+        }
+
+        /* unlock heap */
+        rt_sem_release(&heap_sem);
+
+        RT_DEBUG_LOG(RT_DEBUG_SLAB, ("reclaim zone 0x%x\n", (rt_ubase_t)z));
+
+        /* release pages */
+        rt_page_free(z, zone_size / RT_MM_PAGE_SIZE);
+        count ++;
+
+        /* only one zone is released in a step of idle thread */
+        if (nowait)
+            break;
+    }
+
+    return count;
+}
+
+/**
+ * This function will release the slab zones, which have been totally free
+ * for age ticks at least, to the page allocator.
+ *
+ * @param age the ticks a zone keeps totally free, 0 for all of free zones
+ *
+ * @return the number of released zones
+ */
+rt_size_t rt_slab_reclaim(rt_tick_t age)
+{
+    RT_DEBUG_NOT_IN_INTERRUPT;
+
+    return _slab_reclaim(age, RT_FALSE);
+}
+
+#ifdef RT_USING_SLAB_RECLAIM
+/**
+ * This function will release a zone which has been totally free for
+ * RT_SLAB_RECLAIM_AGE ticks. It is invoked by the idle thread at most once
+ * in a tick, and never waits for the lock of heap.
+ */
+void rt_slab_reclaim_idle(void)
+{
+    static rt_tick_t last_tick;
+    rt_tick_t now;
+
+    now = rt_tick_get();
+    if (now == last_tick)
+        return;
+    last_tick = now;
+
+    /*
+     * the idle thread is not preempted while it holds the lock of heap, and
+     * the lock is available again when the pages are released.
+     */
+    rt_enter_critical();
+    _slab_reclaim(RT_SLAB_RECLAIM_AGE, RT_TRUE);
+    rt_exit_critical();
+}
+#endif
+
+#ifdef RT_USING_MEMFRAG
+/**
+ * This function will walk the blocks of system heap for the fragmentation
+ * analyzer. At most count blocks are visited in one step, and the lock of
+ * heap is never waited for.
+ *
+ * @param walk the walk of heap, its cursor is 0 at the beginning
+ * @param count the maximum number of blocks visited
+ *
+ * @return RT_EOK if the walk is finished, -RT_EBUSY if there are blocks left
+ *         or the heap is locked, -RT_EINTR if the heap has been changed and
+ *         the walk restarts.
+ */
+rt_err_t rt_memory_walk(struct rt_mem_walk *walk, rt_size_t count)
+{
+    struct rt_page_head *b;
+
+    if (rt_sem_trytake(&heap_sem) != RT_EOK)
+        return -RT_EBUSY;
+
+    if (walk->cursor == 0)
+    {
+        walk->start  = heap_start;
+        walk->size   = heap_end - heap_start;
+        walk->cursor = (rt_ubase_t)rt_page_list;
+        walk->generation = heap_generation;
+    }
+    else if (walk->generation != heap_generation)
+    {
+        walk->cursor = 0;
+        rt_sem_release(&heap_sem);
+
+        return -RT_EINTR;
+    }
+
+    /* only the free pages are walked, the zones are counted as used */
+    for (b = (struct rt_page_head *)walk->cursor; b != RT_NULL && count > 0; count --)
+    {
+        walk->free_block(walk, b, b->page * RT_MM_PAGE_SIZE);
+        b = b->next;
+    }
+    walk->cursor = (rt_ubase_t)b;
+
+    rt_sem_release(&heap_sem);
+
+    if (b == RT_NULL)
+    {
+        walk->cursor = 0;
+
+        return RT_EOK;
+    }
+
+    return -RT_EBUSY;
+}
+#endif
+
 #ifdef RT_MEM_STATS
 void rt_memory_info(rt_uint32_t *total,
                     rt_uint32_t *used,
@@ -923,6 +1195,47 @@ void list_mem(void)
     rt_kprintf("maximum allocated memory: %d\n", max_mem);
 }
 FINSH_FUNCTION_EXPORT(list_mem, list memory usage information)
+
+long list_slab(void)
+{
+    struct slab_zone_stat stat;
+    slab_zone *z;
+    rt_size_t nfree, pinned;
+    int zi;
+
+    rt_kprintf("class chunk zones hit        miss     free chunk used chunk\n");
+    rt_kprintf("----- ----- ----- ---------- -------- ---------- ----------\n");
+
+    pinned = 0;
+    for (zi = 0; zi < NZONES; zi ++)
+    {
+        /* lock heap */
+        rt_sem_take(&heap_sem, RT_WAITING_FOREVER);
+
+        stat = zone_stat[zi];
+
+        /* the zones with free chunk are in zone array */
+        nfree = 0;
+        for (z = zone_array[zi]; z != RT_NULL; z = z->z_next)
+            nfree += z->z_nfree;
+
+        rt_sem_release(&heap_sem);
+
+        if (stat.hit == 0 && stat.miss == 0)
+            continue;
+
+        pinned += nfree * stat.chunk;
+        rt_kprintf("%-5d %-5d %-5d %-10d %-8d %-10d %d\n", zi, stat.chunk, stat.zones,
+                   stat.hit, stat.miss, nfree, stat.zones * stat.nmax - nfree);
+    }
+
+    rt_kprintf("zone size: %d, cached free zones: %d, free chunk memory: %d\n",
+               zone_size, zone_free_cnt, pinned);
+
+    return 0;
+}
+FINSH_FUNCTION_EXPORT(list_slab, list slab zone classes);
+MSH_CMD_EXPORT(list_slab, list slab zone classes);
 #endif
 #endif
 
@@ -81,6 +81,28 @@ void rt_thread_resume_sethook(void (*hook)(rt_thread_t thread))
     rt_thread_resume_hook = hook;
 }
 
+/**
+ * This function will get the hook function invoked when the system suspends a
+ * thread, so it can be chained and restored.
+ *
+ * @return the hook function
+ */
+void (*rt_thread_suspend_gethook(void))(rt_thread_t thread)
+{
+    return rt_thread_suspend_hook;
+}
+
+/**
+ * This function will get the hook function invoked when the system resumes a
+ * thread, so it can be chained and restored.
+ *
+ * @return the hook function
+ */
+void (*rt_thread_resume_gethook(void))(rt_thread_t thread)
+{
+    return rt_thread_resume_hook;
+}
+
 /**
  * @ingroup Hook
  * This function sets a hook function when a thread is initialized.
@@ -107,6 +129,11 @@ static void _thread_cleanup_execute(rt_thread_t thread)
     if (thread->cleanup != RT_NULL)
         thread->cleanup(thread);
 
+#if defined(RT_USING_HEAP) && defined(RT_USING_MEMSTAT)
+    /* the statistics are not inherited by a thread reusing this one */
+    rt_memstat_thread_drop(thread);
+#endif
+
     rt_hw_interrupt_enable(level);
 }
 
@@ -119,7 +146,7 @@ void rt_thread_exit(void)
     register rt_base_t level;
 
     /* get current thread */
-    thread = rt_current_thread;
+    thread = rt_thread_self();
 
     /* disable interrupt */
     level = rt_hw_interrupt_disable();
@@ -213,6 +240,38 @@ static rt_err_t _rt_thread_init(struct rt_thread *thread,
     thread->cleanup   = 0;
     thread->user_data = 0;
 
+#ifdef RT_USING_MUTEX
+    /* no mutex is taken or waited */
+    rt_list_init(&(thread->taken_mutex_list));
+    thread->pending_mutex = RT_NULL;
+#endif
+
+#ifdef RT_USING_SMP
+    /* not bind on any cpu */
+    thread->bind_cpu = RT_CPUS_NR;
+    thread->oncpu = RT_CPU_DETACHED;
+
+    /* lock init */
+    thread->scheduler_lock_nest = 0;
+    thread->cpus_lock_nest = 0;
+    thread->critical_lock_nest = 0;
+#endif /*RT_USING_SMP*/
+
+#ifdef RT_USING_THREAD_RUNTIME
+    /* cpu usage statistics init */
+    thread->runtime        = 0;
+    thread->runtime_start  = 0;
+    thread->runtime_tick   = 0;
+    thread->runtime_index  = 0;
+    thread->runtime_window = 0;
+    thread->runtime_last   = 0;
+#endif
+
+#ifdef RT_USING_ARENA
+    /* no default arena */
+    thread->arena = RT_NULL;
+#endif
+
     /* initialize thread timer */
     rt_timer_init(&(thread->thread_timer),
                   thread->name,
@@ -284,7 +343,17 @@ rt_err_t rt_thread_init(struct rt_thread *thread,
  */
 rt_thread_t rt_thread_self(void)
 {
+#ifdef RT_USING_SMP
+    rt_base_t lock;
+    rt_thread_t self;
+
+    lock = rt_hw_local_irq_disable();
+    self = rt_cpu_self()->current_thread;
+    rt_hw_local_irq_enable(lock);
+    return self;
+#else
     return rt_current_thread;
+#endif /*RT_USING_SMP*/
 }
 
 /**
@@ -500,6 +569,24 @@ rt_err_t rt_thread_delete(rt_thread_t thread)
  *
  * Anotation：线程仲裁，就是优先运行优先级高的线程。
  */
+#ifdef RT_USING_SMP
+rt_err_t rt_thread_yield(void)
+{
+    struct rt_thread *thread;
+    rt_base_t lock;
+
+    thread = rt_thread_self();
+    lock = rt_hw_interrupt_disable();
+
+    /* the running thread is put back to the tail of ready queue by scheduler */
+    thread->remaining_tick = thread->init_tick;
+    thread->stat |= RT_THREAD_STAT_YIELD;
+    rt_schedule();
+    rt_hw_interrupt_enable(lock);
+
+    return RT_EOK;
+}
+#else
 rt_err_t rt_thread_yield(void)
 {
     register rt_base_t level;
@@ -535,6 +622,7 @@ rt_err_t rt_thread_yield(void)
 
     return RT_EOK;
 }
+#endif /*RT_USING_SMP*/
 
 /**
  * This function will let current thread sleep for some ticks.
@@ -553,7 +641,7 @@ rt_err_t rt_thread_sleep(rt_tick_t tick)
     /* disable interrupt */
     temp = rt_hw_interrupt_disable();
     /* set to current thread */
-    thread = rt_current_thread;
+    thread = rt_thread_self();
     RT_ASSERT(thread != RT_NULL);
     RT_ASSERT(rt_object_get_type((rt_object_t)thread) == RT_Object_Class_Thread);
 
@@ -737,6 +825,47 @@ rt_err_t rt_thread_control(rt_thread_t thread, int cmd, void *arg)
     case RT_THREAD_CTRL_STARTUP:
         return rt_thread_startup(thread);
 
+#ifdef RT_USING_SMP
+    case RT_THREAD_CTRL_BIND_CPU:
+    {
+        rt_uint8_t cpu;
+
+        /* RT_CPUS_NR means the thread may run on any cpu */
+        cpu = (rt_uint8_t)(rt_ubase_t)arg;
+        if (cpu > RT_CPUS_NR)
+            cpu = RT_CPUS_NR;
+
+        /* disable interrupt */
+        temp = rt_hw_interrupt_disable();
+
+        if ((thread->stat & RT_THREAD_STAT_MASK) == RT_THREAD_READY)
+        {
+            /* move the thread to the ready queue of new cpu */
+            rt_schedule_remove_thread(thread);
+            thread->bind_cpu = cpu;
+            rt_schedule_insert_thread(thread);
+        }
+        else
+        {
+            thread->bind_cpu = cpu;
+
+            /* the running thread is migrated by the scheduler of its cpu */
+            if ((thread->stat & RT_THREAD_STAT_MASK) == RT_THREAD_RUNNING &&
+                cpu != RT_CPUS_NR && thread->oncpu != cpu)
+            {
+                if (thread->oncpu == rt_hw_cpu_id())
+                    rt_schedule();
+                else
+                    rt_hw_ipi_send(RT_SCHEDULE_IPI, 1 << thread->oncpu);
+            }
+        }
+
+        /* enable interrupt */
+        rt_hw_interrupt_enable(temp);
+        break;
+    }
+#endif /*RT_USING_SMP*/
+
     case RT_THREAD_CTRL_CLOSE:
 
         if (rt_object_is_systemobject((rt_object_t)thread) == RT_TRUE)
@@ -771,6 +900,7 @@ rt_err_t rt_thread_control(rt_thread_t thread, int cmd, void *arg)
  */
 rt_err_t rt_thread_suspend(rt_thread_t thread)
 {
+    register rt_base_t stat;
     register rt_base_t temp;
 
     /* thread check */
@@ -779,7 +909,8 @@ rt_err_t rt_thread_suspend(rt_thread_t thread)
 
     RT_DEBUG_LOG(RT_DEBUG_THREAD, ("thread suspend:  %s\n", thread->name));
 
-    if ((thread->stat & RT_THREAD_STAT_MASK) != RT_THREAD_READY)
+    stat = thread->stat & RT_THREAD_STAT_MASK;
+    if ((stat != RT_THREAD_READY) && (stat != RT_THREAD_RUNNING))
     {
         RT_DEBUG_LOG(RT_DEBUG_THREAD, ("thread suspend: thread disorder, 0x%2x\n",
                                        thread->stat));
@@ -794,6 +925,14 @@ rt_err_t rt_thread_suspend(rt_thread_t thread)
     rt_schedule_remove_thread(thread);
     thread->stat = RT_THREAD_SUSPEND | (thread->stat & ~RT_THREAD_STAT_MASK);
 
+#ifdef RT_USING_SMP
+    /* the thread is running on other cpu, let it switch out */
+    if (stat == RT_THREAD_RUNNING && thread->oncpu != rt_hw_cpu_id())
+    {
+        rt_hw_ipi_send(RT_SCHEDULE_IPI, 1 << thread->oncpu);
+    }
+#endif /*RT_USING_SMP*/
+
     /* stop thread timer anyway */
     rt_timer_stop(&(thread->thread_timer));
 
@@ -856,19 +995,34 @@ rt_err_t rt_thread_resume(rt_thread_t thread)
  *
  * @param parameter the parameter of thread timeout function
  *
+ * @note the timeout function may be invoked with interrupt enabled or, on
+ *       SMP, without the cpus lock, so the suspend list of IPC object is
+ *       locked here, and the thread may have been resumed just before.
+ *
  * Anotation：线程时间片用完之后调用此函数进行下一个线程的调度。
  */
 void rt_thread_timeout(void *parameter)
 {
     struct rt_thread *thread;
+    register rt_base_t temp;
 
     thread = (struct rt_thread *)parameter;
 
     /* thread check */
     RT_ASSERT(thread != RT_NULL);
-    RT_ASSERT((thread->stat & RT_THREAD_STAT_MASK) == RT_THREAD_SUSPEND);
     RT_ASSERT(rt_object_get_type((rt_object_t)thread) == RT_Object_Class_Thread);
 
+    /* disable interrupt, it is the cpus lock on SMP */
+    temp = rt_hw_interrupt_disable();
+
+    /* the thread is resumed by IPC after the timer is taken off the list */
+    if ((thread->stat & RT_THREAD_STAT_MASK) != RT_THREAD_SUSPEND)
+    {
+        rt_hw_interrupt_enable(temp);
+
+        return;
+    }
+
     /* set error number */
     thread->error = -RT_ETIMEOUT;
 
@@ -878,6 +1032,9 @@ void rt_thread_timeout(void *parameter)
     /* insert to schedule ready list */
     rt_schedule_insert_thread(thread);
 
+    /* enable interrupt */
+    rt_hw_interrupt_enable(temp);
+
     /* do schedule */
     rt_schedule();
 }
@@ -898,4 +1055,49 @@ rt_thread_t rt_thread_find(char *name)
     return (rt_thread_t)rt_object_find(name, RT_Object_Class_Thread);
 }
 
+#ifdef RT_USING_THREAD_RUNTIME
+/**
+ * This function will get the total cpu cycles used by the thread.
+ *
+ * @param thread the thread
+ *
+ * @return the cpu cycles used by the thread since it is created
+ */
+rt_uint64_t rt_thread_runtime_get(rt_thread_t thread)
+{
+    rt_base_t level;
+    rt_uint64_t runtime;
+
+    /* thread check */
+    RT_ASSERT(thread != RT_NULL);
+    RT_ASSERT(rt_object_get_type((rt_object_t)thread) == RT_Object_Class_Thread);
+
+    /* the running thread is charged until now */
+    rt_scheduler_runtime_update(thread);
+
+    level = rt_hw_interrupt_disable();
+    runtime = thread->runtime;
+    rt_hw_interrupt_enable(level);
+
+    return runtime;
+}
+
+/**
+ * This function will get the cpu usage of the thread in the last window of
+ * RT_THREAD_RUNTIME_WINDOW ticks.
+ *
+ * @param thread the thread
+ *
+ * @return the cpu usage in 0.01%, from 0 to 10000
+ */
+rt_uint32_t rt_thread_cpu_usage_get(rt_thread_t thread)
+{
+    /* thread check */
+    RT_ASSERT(thread != RT_NULL);
+    RT_ASSERT(rt_object_get_type((rt_object_t)thread) == RT_Object_Class_Thread);
+
+    return rt_scheduler_runtime_update(thread);
+}
+#endif
+
 /**@}*/
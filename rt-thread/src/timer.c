@@ -21,11 +21,75 @@
 #include <rtthread.h>
 #include <rthw.h>
 
+#ifdef RT_TIMER_USING_WHEEL
+#ifndef RT_TIMER_WHEEL_BITS
+#define RT_TIMER_WHEEL_BITS             4
+#endif
+
+#define RT_TIMER_WHEEL_SIZE             (1UL << RT_TIMER_WHEEL_BITS)
+#define RT_TIMER_WHEEL_MASK             (RT_TIMER_WHEEL_SIZE - 1)
+/* the levels of wheel cover the whole 32bit tick */
+#define RT_TIMER_WHEEL_LEVEL            ((32 + RT_TIMER_WHEEL_BITS - 1) / RT_TIMER_WHEEL_BITS)
+
+/*
+ * hierarchical timing wheel
+ *
+ * The timers which timeout in the next RT_TIMER_WHEEL_SIZE ticks are hashed
+ * into the slots of level 0 by their timeout tick, the farther timers are
+ * hashed into the higher levels and cascaded to the lower levels when the
+ * lower level wraps around. So the start, stop and expire of a timer are
+ * constant time operations.
+ *
+ * Anotation：分层时间轮，定时器按照超时时刻散列到对应层的槽中，启动、停止和超时处理都是常数时间。
+ */
+struct rt_timer_wheel
+{
+    rt_tick_t tick;                                     /* the tick which the wheel has run to */
+    rt_list_t slot[RT_TIMER_WHEEL_LEVEL][RT_TIMER_WHEEL_SIZE];
+};
+
+/* hard timer wheel */
+static struct rt_timer_wheel rt_timer_wheel;
+#else
 /* hard timer list
  *
  * Anotation：内核硬件定时器的管理数组链表
  * */
 static rt_list_t rt_timer_list[RT_TIMER_SKIP_LIST_LEVEL];
+#endif
+
+#ifdef RT_USING_SMP
+/* the lock of timer lists, it shall be taken after the cpus lock if both are needed
+ *
+ * Anotation：SMP下定时器链表使用独立的自旋锁，不再占用全局的cpus锁
+ * */
+static struct rt_spinlock _timer_lock;
+
+/*
+ * the timer lock does not disable preemption, because its release shall not
+ * schedule: the thread timer is started by IPC in the middle of suspending
+ * the thread, and a switch there leaves the thread half suspended.
+ * Preemption is impossible anyway with the local interrupt disabled.
+ */
+rt_inline rt_base_t _timer_lock_irqsave(void)
+{
+    rt_base_t level;
+
+    level = rt_hw_local_irq_disable();
+    rt_hw_spin_lock(&(_timer_lock.lock));
+
+    return level;
+}
+
+rt_inline void _timer_unlock_irqrestore(rt_base_t level)
+{
+    rt_hw_spin_unlock(&(_timer_lock.lock));
+    rt_hw_local_irq_enable(level);
+}
+#else
+#define _timer_lock_irqsave()               rt_hw_interrupt_disable()
+#define _timer_unlock_irqrestore(level)     rt_hw_interrupt_enable(level)
+#endif
 
 #ifdef RT_USING_TIMER_SOFT
 
@@ -44,11 +108,16 @@ static rt_list_t rt_timer_list[RT_TIMER_SKIP_LIST_LEVEL];
  * Anotation：软件定时器状态
  * */
 static rt_uint8_t soft_timer_status = RT_SOFT_TIMER_IDLE;
+#ifdef RT_TIMER_USING_WHEEL
+/* soft timer wheel */
+static struct rt_timer_wheel rt_soft_timer_wheel;
+#else
 /* soft timer list
  *
  * Anotation：内核硬件定时器的管理数组链表
  * */
 static rt_list_t rt_soft_timer_list[RT_TIMER_SKIP_LIST_LEVEL];
+#endif
 /*
  * Anotation：定时器线程以及对应分配的栈空间
  * */
@@ -94,6 +163,28 @@ void rt_timer_exit_sethook(void (*hook)(struct rt_timer *timer))
     rt_timer_exit_hook = hook;
 }
 
+/**
+ * This function will get the hook function invoked when enter timer timeout
+ * callback function, so it can be chained and restored.
+ *
+ * @return the hook function
+ */
+void (*rt_timer_enter_gethook(void))(struct rt_timer *timer)
+{
+    return rt_timer_enter_hook;
+}
+
+/**
+ * This function will get the hook function invoked when exit timer timeout
+ * callback function, so it can be chained and restored.
+ *
+ * @return the hook function
+ */
+void (*rt_timer_exit_gethook(void))(struct rt_timer *timer)
+{
+    return rt_timer_exit_hook;
+}
+
 /**@}*/
 #endif
 
@@ -119,6 +210,7 @@ static void _rt_timer_init(rt_timer_t timer,
 
     timer->timeout_tick = 0;
     timer->init_tick    = time;
+    timer->overrun      = 0;
 
     /* initialize timer list */
     for (i = 0; i < RT_TIMER_SKIP_LIST_LEVEL; i++)
@@ -127,6 +219,7 @@ static void _rt_timer_init(rt_timer_t timer,
     }
 }
 
+#ifndef RT_TIMER_USING_WHEEL
 /* the fist timer always in the last row
  * Anotation：转到下一个定时器
  * */
@@ -137,7 +230,7 @@ static rt_tick_t rt_timer_list_next_timeout(rt_list_t timer_list[])
     rt_tick_t timeout_tick = RT_TICK_MAX;
 
     /* disable interrupt */
-    level = rt_hw_interrupt_disable();
+    level = _timer_lock_irqsave();
 
     // 高下标对应高优先级
     if (!rt_list_isempty(&timer_list[RT_TIMER_SKIP_LIST_LEVEL - 1]))
@@ -151,10 +244,11 @@ static rt_tick_t rt_timer_list_next_timeout(rt_list_t timer_list[])
     }
 
     /* enable interrupt */
-    rt_hw_interrupt_enable(level);
+    _timer_unlock_irqrestore(level);
 
     return timeout_tick;
 }
+#endif
 
 /*
  * Anotation：移除定时器
@@ -169,6 +263,202 @@ rt_inline void _rt_timer_remove(rt_timer_t timer)
     }
 }
 
+#ifdef RT_TIMER_USING_WHEEL
+static void _rt_timer_wheel_init(struct rt_timer_wheel *wheel)
+{
+    int lvl, idx;
+
+    wheel->tick = rt_tick_get();
+    for (lvl = 0; lvl < RT_TIMER_WHEEL_LEVEL; lvl++)
+    {
+        for (idx = 0; idx < RT_TIMER_WHEEL_SIZE; idx++)
+        {
+            rt_list_init(&(wheel->slot[lvl][idx]));
+        }
+    }
+}
+
+/*
+ * hash the timer into the slot by expires tick, must be invoked with
+ * interrupt disabled.
+ */
+static void _rt_timer_wheel_insert(struct rt_timer_wheel *wheel,
+                                   rt_timer_t             timer,
+                                   rt_tick_t              expires)
+{
+    int lvl;
+    rt_tick_t delta;
+
+    delta = expires - wheel->tick;
+    for (lvl = 0; lvl < RT_TIMER_WHEEL_LEVEL - 1; lvl++)
+    {
+        if (delta < (1UL << (RT_TIMER_WHEEL_BITS * (lvl + 1))))
+            break;
+    }
+
+    /* the timers with the same timeout tick are called by the insert order */
+    rt_list_insert_before(&(wheel->slot[lvl][(expires >> (RT_TIMER_WHEEL_BITS * lvl)) & RT_TIMER_WHEEL_MASK]),
+                          &(timer->row[RT_TIMER_SKIP_LIST_LEVEL - 1]));
+}
+
+/* re-hash the timers of a higher level slot into the lower levels */
+static void _rt_timer_wheel_cascade(struct rt_timer_wheel *wheel, int lvl, int idx)
+{
+    struct rt_timer *t;
+    rt_list_t list;
+
+    rt_list_init(&list);
+    rt_list_splice(&list, &(wheel->slot[lvl][idx]));
+
+    while (!rt_list_isempty(&list))
+    {
+        t = rt_list_entry(list.next, struct rt_timer, row[RT_TIMER_SKIP_LIST_LEVEL - 1]);
+        rt_list_remove(&(t->row[RT_TIMER_SKIP_LIST_LEVEL - 1]));
+
+        _rt_timer_wheel_insert(wheel, t, t->timeout_tick);
+    }
+}
+
+/*
+ * the number of the empty levels from level 0, the timers in the higher
+ * levels are cascaded to level 0 no earlier than the next wraparound of the
+ * first non-empty level.
+ */
+static int _rt_timer_wheel_empty_levels(struct rt_timer_wheel *wheel)
+{
+    int lvl, idx;
+
+    for (lvl = 0; lvl < RT_TIMER_WHEEL_LEVEL; lvl++)
+    {
+        for (idx = 0; idx < RT_TIMER_WHEEL_SIZE; idx++)
+        {
+            if (!rt_list_isempty(&(wheel->slot[lvl][idx])))
+                return lvl;
+        }
+    }
+
+    return RT_TIMER_WHEEL_LEVEL;
+}
+
+/*
+ * bring the wheel to the current tick if it is empty, so the wheel which has
+ * been idle for a long time is not run tick by tick, must be invoked with
+ * interrupt disabled.
+ */
+static void _rt_timer_wheel_sync(struct rt_timer_wheel *wheel, rt_tick_t current_tick)
+{
+    if (wheel->tick != current_tick &&
+        _rt_timer_wheel_empty_levels(wheel) == RT_TIMER_WHEEL_LEVEL)
+    {
+        wheel->tick = current_tick;
+    }
+}
+
+/*
+ * run the wheel to the current tick and move the timeout timers to the
+ * expired list, must be invoked with interrupt disabled.
+ *
+ * The ticks in which nothing expires or cascades are skipped, so the time
+ * is bounded by the levels and slots of wheel rather than the ticks behind,
+ * such as after the tickless sleep or a sleeping soft timer thread.
+ */
+static void _rt_timer_wheel_run(struct rt_timer_wheel *wheel,
+                                rt_tick_t              current_tick,
+                                rt_list_t             *expired)
+{
+    int lvl;
+    rt_tick_t span, skip;
+
+    while (current_tick != wheel->tick &&
+           (current_tick - wheel->tick) < RT_TICK_MAX / 2)
+    {
+        if (current_tick - wheel->tick > 1)
+        {
+            lvl = _rt_timer_wheel_empty_levels(wheel);
+            if (lvl == RT_TIMER_WHEEL_LEVEL)
+            {
+                /* nothing is in the wheel */
+                wheel->tick = current_tick;
+                break;
+            }
+
+            if (lvl > 0)
+            {
+                /* nothing happens before the next wraparound of level lvl - 1 */
+                span = 1UL << (RT_TIMER_WHEEL_BITS * lvl);
+                skip = (wheel->tick | (span - 1)) - wheel->tick;
+                if (current_tick - wheel->tick <= skip)
+                {
+                    wheel->tick = current_tick;
+                    break;
+                }
+                wheel->tick += skip;
+            }
+        }
+
+        wheel->tick ++;
+
+        /* cascade the higher levels when the lower level wraps around */
+        for (lvl = 1; lvl < RT_TIMER_WHEEL_LEVEL; lvl++)
+        {
+            if ((wheel->tick >> (RT_TIMER_WHEEL_BITS * (lvl - 1))) & RT_TIMER_WHEEL_MASK)
+                break;
+
+            _rt_timer_wheel_cascade(wheel, lvl,
+                                    (wheel->tick >> (RT_TIMER_WHEEL_BITS * lvl)) & RT_TIMER_WHEEL_MASK);
+        }
+
+        rt_list_splice(expired, &(wheel->slot[0][wheel->tick & RT_TIMER_WHEEL_MASK]));
+    }
+}
+
+/*
+ * The first non-empty slot after the current position of each level holds
+ * the nearest timers of this level, so the next timeout tick is the minimum
+ * of them.
+ */
+static rt_tick_t rt_timer_wheel_next_timeout(struct rt_timer_wheel *wheel)
+{
+    struct rt_timer *timer;
+    register rt_base_t level;
+    rt_tick_t timeout_tick = RT_TICK_MAX;
+    rt_bool_t found = RT_FALSE;
+    rt_list_t *slot, *node;
+    int lvl, idx, cur;
+
+    /* disable interrupt */
+    level = _timer_lock_irqsave();
+
+    for (lvl = 0; lvl < RT_TIMER_WHEEL_LEVEL; lvl++)
+    {
+        cur = (wheel->tick >> (RT_TIMER_WHEEL_BITS * lvl)) & RT_TIMER_WHEEL_MASK;
+        for (idx = 1; idx <= RT_TIMER_WHEEL_SIZE; idx++)
+        {
+            slot = &(wheel->slot[lvl][(cur + idx) & RT_TIMER_WHEEL_MASK]);
+            if (rt_list_isempty(slot))
+                continue;
+
+            rt_list_for_each(node, slot)
+            {
+                timer = rt_list_entry(node, struct rt_timer, row[RT_TIMER_SKIP_LIST_LEVEL - 1]);
+                if (found == RT_FALSE ||
+                    (timer->timeout_tick - timeout_tick) >= RT_TICK_MAX / 2)
+                {
+                    timeout_tick = timer->timeout_tick;
+                    found = RT_TRUE;
+                }
+            }
+            break;
+        }
+    }
+
+    /* enable interrupt */
+    _timer_unlock_irqrestore(level);
+
+    return timeout_tick;
+}
+#endif
+
 #if RT_DEBUG_TIMER
 static int rt_timer_count_height(struct rt_timer *timer)
 {
@@ -256,14 +546,14 @@ rt_err_t rt_timer_detach(rt_timer_t timer)
     RT_ASSERT(rt_object_is_systemobject(&timer->parent));
 
     /* disable interrupt */
-    level = rt_hw_interrupt_disable();
+    level = _timer_lock_irqsave();
 
     _rt_timer_remove(timer);
     /* stop timer */
     timer->parent.flag &= ~RT_TIMER_FLAG_ACTIVATED;
 
     /* enable interrupt */
-    rt_hw_interrupt_enable(level);
+    _timer_unlock_irqrestore(level);
 
     rt_object_detach((rt_object_t)timer);
 
@@ -328,7 +618,7 @@ rt_err_t rt_timer_delete(rt_timer_t timer)
     RT_ASSERT(rt_object_is_systemobject(&timer->parent) == RT_FALSE);
 
     /* disable interrupt */
-    level = rt_hw_interrupt_disable();
+    level = _timer_lock_irqsave();
     /*
      * Anotation：调用定时器部分的移除函数，带有下划线开头的函数表示是对象的成员函数。
     */
@@ -340,7 +630,7 @@ rt_err_t rt_timer_delete(rt_timer_t timer)
     timer->parent.flag &= ~RT_TIMER_FLAG_ACTIVATED;
 
     /* enable interrupt */
-    rt_hw_interrupt_enable(level);
+    _timer_unlock_irqrestore(level);
 
     rt_object_delete((rt_object_t)timer);
 
@@ -348,44 +638,47 @@ rt_err_t rt_timer_delete(rt_timer_t timer)
 }
 #endif
 
-/**
- * This function will start the timer
- *
- * @param timer the timer to be started
- *
- * @return the operation status, RT_EOK on OK, -RT_ERROR on error
- *
- * Anotation：启动定时器，内核的软件和硬件定时器都开始运行。
+/*
+ * insert the timer to the timer list by its timeout tick, must be invoked
+ * with interrupt disabled.
  */
-rt_err_t rt_timer_start(rt_timer_t timer)
+static void _rt_timer_insert(rt_timer_t timer)
 {
+#ifdef RT_TIMER_USING_WHEEL
+    struct rt_timer_wheel *wheel;
+    rt_tick_t expires;
+#else
     unsigned int row_lvl;
     rt_list_t *timer_list;
-    register rt_base_t level;
     rt_list_t *row_head[RT_TIMER_SKIP_LIST_LEVEL];
     unsigned int tst_nr;
     static unsigned int random_nr;
+#endif
 
-    /* timer check */
-    RT_ASSERT(timer != RT_NULL);
-    RT_ASSERT(rt_object_get_type(&timer->parent) == RT_Object_Class_Timer);
-
-    /* stop timer firstly */
-    level = rt_hw_interrupt_disable();
-    /* remove timer from list */
-    _rt_timer_remove(timer);
-    /* change status of timer */
-    timer->parent.flag &= ~RT_TIMER_FLAG_ACTIVATED;
+#ifdef RT_TIMER_USING_WHEEL
+#ifdef RT_USING_TIMER_SOFT
+    if (timer->parent.flag & RT_TIMER_FLAG_SOFT_TIMER)
+    {
+        /* insert timer to soft timer wheel */
+        wheel = &rt_soft_timer_wheel;
+    }
+    else
+#endif
+    {
+        /* insert timer to system timer wheel */
+        wheel = &rt_timer_wheel;
+    }
 
-    RT_OBJECT_HOOK_CALL(rt_object_take_hook, (&(timer->parent)));
+    /* the idle wheel may be far behind, it is synchronized before hashing */
+    _rt_timer_wheel_sync(wheel, rt_tick_get());
 
-    /*
-     * get timeout tick,
-     * the max timeout tick shall not great than RT_TICK_MAX/2
-     */
-    RT_ASSERT(timer->init_tick < RT_TICK_MAX / 2);
-    timer->timeout_tick = rt_tick_get() + timer->init_tick;
+    /* the slot of the wheel tick has been checked, use the next one */
+    expires = timer->timeout_tick;
+    if ((expires - wheel->tick - 1) >= RT_TICK_MAX / 2)
+        expires = wheel->tick + 1;
 
+    _rt_timer_wheel_insert(wheel, timer, expires);
+#else
 #ifdef RT_USING_TIMER_SOFT
     if (timer->parent.flag & RT_TIMER_FLAG_SOFT_TIMER)
     {
@@ -449,11 +742,91 @@ rt_err_t rt_timer_start(rt_timer_t timer)
          * bits. */
         tst_nr >>= (RT_TIMER_SKIP_LIST_MASK + 1) >> 1;
     }
+#endif
+}
+
+/*
+ * re-arm the anchored periodic timer from its previous timeout tick, so the
+ * latency of timeout function does not drift the phase of timer. The missed
+ * periods are skipped or called one by one, and counted as overrun. It must
+ * be invoked with interrupt disabled.
+ */
+static void _rt_timer_rearm(rt_timer_t timer, rt_tick_t current_tick)
+{
+    rt_tick_t period, missed;
+
+    period = timer->init_tick > 0 ? timer->init_tick : 1;
+
+    if (timer->parent.flag & RT_TIMER_FLAG_CATCH_UP)
+    {
+        timer->timeout_tick += period;
+        /* the next period is already late */
+        if ((current_tick - timer->timeout_tick) < RT_TICK_MAX / 2)
+            timer->overrun ++;
+    }
+    else
+    {
+        /* skip to the first period after current tick */
+        missed = (current_tick - timer->timeout_tick) / period;
+        timer->timeout_tick += (missed + 1) * period;
+        timer->overrun += missed;
+    }
 
+    _rt_timer_insert(timer);
     timer->parent.flag |= RT_TIMER_FLAG_ACTIVATED;
+}
+
+/*
+ * start the timer from current tick, must be invoked with the timer list locked.
+ */
+static void _rt_timer_start(rt_timer_t timer)
+{
+    /* remove timer from list */
+    _rt_timer_remove(timer);
+    /* change status of timer */
+    timer->parent.flag &= ~RT_TIMER_FLAG_ACTIVATED;
+
+    RT_OBJECT_HOOK_CALL(rt_object_take_hook, (&(timer->parent)));
+
+    /*
+     * get timeout tick,
+     * the max timeout tick shall not great than RT_TICK_MAX/2
+     */
+    RT_ASSERT(timer->init_tick < RT_TICK_MAX / 2);
+    timer->timeout_tick = rt_tick_get() + timer->init_tick;
+
+    /* the overrun is counted from the start of timer */
+    timer->overrun = 0;
+
+    _rt_timer_insert(timer);
+
+    timer->parent.flag |= RT_TIMER_FLAG_ACTIVATED;
+}
+
+/**
+ * This function will start the timer
+ *
+ * @param timer the timer to be started
+ *
+ * @return the operation status, RT_EOK on OK, -RT_ERROR on error
+ *
+ * Anotation：启动定时器，内核的软件和硬件定时器都开始运行。
+ */
+rt_err_t rt_timer_start(rt_timer_t timer)
+{
+    register rt_base_t level;
+
+    /* timer check */
+    RT_ASSERT(timer != RT_NULL);
+    RT_ASSERT(rt_object_get_type(&timer->parent) == RT_Object_Class_Timer);
+
+    /* disable interrupt */
+    level = _timer_lock_irqsave();
+
+    _rt_timer_start(timer);
 
     /* enable interrupt */
-    rt_hw_interrupt_enable(level);
+    _timer_unlock_irqrestore(level);
 
 #ifdef RT_USING_TIMER_SOFT
     if (timer->parent.flag & RT_TIMER_FLAG_SOFT_TIMER)
@@ -495,14 +868,14 @@ rt_err_t rt_timer_stop(rt_timer_t timer)
     RT_OBJECT_HOOK_CALL(rt_object_put_hook, (&(timer->parent)));
 
     /* disable interrupt */
-    level = rt_hw_interrupt_disable();
+    level = _timer_lock_irqsave();
 
     _rt_timer_remove(timer);
     /* change status */
     timer->parent.flag &= ~RT_TIMER_FLAG_ACTIVATED;
 
     /* enable interrupt */
-    rt_hw_interrupt_enable(level);
+    _timer_unlock_irqrestore(level);
 
     return RT_EOK;
 }
@@ -526,7 +899,7 @@ rt_err_t rt_timer_control(rt_timer_t timer, int cmd, void *arg)
     RT_ASSERT(timer != RT_NULL);
     RT_ASSERT(rt_object_get_type(&timer->parent) == RT_Object_Class_Timer);
 
-    level = rt_hw_interrupt_disable();
+    level = _timer_lock_irqsave();
     switch (cmd)
     {
     case RT_TIMER_CTRL_GET_TIME:
@@ -545,6 +918,10 @@ rt_err_t rt_timer_control(rt_timer_t timer, int cmd, void *arg)
         timer->parent.flag |= RT_TIMER_FLAG_PERIODIC;
         break;
 
+    case RT_TIMER_CTRL_GET_OVERRUN:
+        *(rt_uint32_t *)arg = timer->overrun;
+        break;
+
     case RT_TIMER_CTRL_GET_STATE:
         if(timer->parent.flag & RT_TIMER_FLAG_ACTIVATED)
         {
@@ -561,11 +938,212 @@ rt_err_t rt_timer_control(rt_timer_t timer, int cmd, void *arg)
     default:
         break;
     }
-    rt_hw_interrupt_enable(level);
+    _timer_unlock_irqrestore(level);
 
     return RT_EOK;
 }
 
+#ifdef RT_TIMER_USING_IRQOFF_STAT
+/* the longest interrupt disabled time of timer check in last tick and all ticks */
+static rt_uint32_t rt_timer_irqoff_last;
+static rt_uint32_t rt_timer_irqoff_max;
+
+rt_inline void _rt_timer_irqoff_update(rt_uint32_t irqoff)
+{
+    rt_timer_irqoff_last = irqoff;
+    if (irqoff > rt_timer_irqoff_max)
+        rt_timer_irqoff_max = irqoff;
+}
+
+/**
+ * This function will get the longest interrupt disabled time of timer check.
+ *
+ * @param last the longest time in the last timer check, in cpu cycles
+ * @param max the longest time since system startup, in cpu cycles
+ *
+ * Anotation：获取定时器检查中最长的关中断时间
+ */
+void rt_timer_irqoff_get(rt_uint32_t *last, rt_uint32_t *max)
+{
+    if (last != RT_NULL)
+        *last = rt_timer_irqoff_last;
+    if (max != RT_NULL)
+        *max = rt_timer_irqoff_max;
+}
+#endif
+
+#ifdef RT_TIMER_DEFER_CALLBACK
+#ifndef RT_TIMER_USING_WHEEL
+/*
+ * cut the timeout timers off the timer list and splice them to the expired
+ * list by the bottom row, must be invoked with interrupt disabled.
+ *
+ * The last timeout timer of each row is found by the skip list search, and
+ * then the timeout prefix of each row is cut off at once, so the time does
+ * not grow with the number of timeout timers. The cut upper rows are closed
+ * to rings, so removing a timer from them later leaves the timer list alone.
+ */
+static void _rt_timer_list_expire(rt_list_t timer_list[], rt_tick_t current_tick,
+                                  rt_list_t *expired)
+{
+    unsigned int row_lvl;
+    rt_list_t *row_head[RT_TIMER_SKIP_LIST_LEVEL];
+    rt_list_t *first, *last;
+
+    row_head[0] = &timer_list[0];
+    for (row_lvl = 0; row_lvl < RT_TIMER_SKIP_LIST_LEVEL; row_lvl++)
+    {
+        for (; row_head[row_lvl] != timer_list[row_lvl].prev;
+             row_head[row_lvl]  = row_head[row_lvl]->next)
+        {
+            struct rt_timer *t;
+            rt_list_t *p = row_head[row_lvl]->next;
+
+            t = rt_list_entry(p, struct rt_timer, row[row_lvl]);
+            if ((current_tick - t->timeout_tick) >= RT_TICK_MAX / 2)
+                break;
+        }
+        if (row_lvl != RT_TIMER_SKIP_LIST_LEVEL - 1)
+            row_head[row_lvl + 1] = row_head[row_lvl] + 1;
+    }
+
+    for (row_lvl = 0; row_lvl < RT_TIMER_SKIP_LIST_LEVEL; row_lvl++)
+    {
+        /* nothing is timeout in this row */
+        last = row_head[row_lvl];
+        if (last == &timer_list[row_lvl])
+            continue;
+
+        first = timer_list[row_lvl].next;
+        timer_list[row_lvl].next = last->next;
+        last->next->prev = &timer_list[row_lvl];
+
+        if (row_lvl == RT_TIMER_SKIP_LIST_LEVEL - 1)
+        {
+            /* the expired list is empty, the bottom row is spliced to it */
+            expired->next = first;
+            first->prev   = expired;
+            expired->prev = last;
+            last->next    = expired;
+        }
+        else
+        {
+            first->prev = last;
+            last->next  = first;
+        }
+    }
+}
+#endif
+
+/**
+ * This function will check timer list, if a timeout event happens, the
+ * corresponding timeout function will be invoked.
+ *
+ * The timeout timers are taken off the timer list with interrupt disabled,
+ * and then their timeout functions are invoked with interrupt enabled at
+ * the tail of timer interrupt, so a slow timeout function does not block
+ * the other interrupts.
+ *
+ * @note this function shall be invoked in operating system timer interrupt.
+ *
+ * Anotation：对定时器进行更新，超时的定时器在关中断下摘出，超时函数在开中断下执行
+ */
+void rt_timer_check(void)
+{
+    struct rt_timer *t;
+    rt_tick_t current_tick;
+    register rt_base_t level;
+    rt_list_t list;
+    rt_list_t expired;
+#ifdef RT_TIMER_USING_IRQOFF_STAT
+    rt_uint32_t irqoff_start, irqoff, irqoff_max = 0;
+#endif
+
+    rt_list_init(&list);
+    rt_list_init(&expired);
+
+    RT_DEBUG_LOG(RT_DEBUG_TIMER, ("timer check enter\n"));
+
+    current_tick = rt_tick_get();
+
+    /* disable interrupt */
+    level = _timer_lock_irqsave();
+#ifdef RT_TIMER_USING_IRQOFF_STAT
+    irqoff_start = rt_hw_cycle_get();
+#endif
+
+    /* take the timeout timers off the timer list */
+#ifdef RT_TIMER_USING_WHEEL
+    _rt_timer_wheel_run(&rt_timer_wheel, current_tick, &expired);
+#else
+    _rt_timer_list_expire(rt_timer_list, current_tick, &expired);
+#endif
+
+    while (!rt_list_isempty(&expired))
+    {
+        t = rt_list_entry(expired.next,
+                          struct rt_timer, row[RT_TIMER_SKIP_LIST_LEVEL - 1]);
+
+        /* the upper rows are taken off the cut rings as well */
+        _rt_timer_remove(t);
+        if (!(t->parent.flag & RT_TIMER_FLAG_PERIODIC))
+        {
+            t->parent.flag &= ~RT_TIMER_FLAG_ACTIVATED;
+        }
+        /* add timer to temporary list  */
+        rt_list_insert_after(&list, &(t->row[RT_TIMER_SKIP_LIST_LEVEL - 1]));
+
+#ifdef RT_TIMER_USING_IRQOFF_STAT
+        irqoff = rt_hw_cycle_get() - irqoff_start;
+        if (irqoff > irqoff_max)
+            irqoff_max = irqoff;
+#endif
+        /* enable interrupt */
+        _timer_unlock_irqrestore(level);
+
+        RT_OBJECT_HOOK_CALL(rt_timer_enter_hook, (t));
+
+        /* call timeout function */
+        t->timeout_func(t->parameter);
+
+        RT_OBJECT_HOOK_CALL(rt_timer_exit_hook, (t));
+
+        /* disable interrupt */
+        level = _timer_lock_irqsave();
+#ifdef RT_TIMER_USING_IRQOFF_STAT
+        irqoff_start = rt_hw_cycle_get();
+#endif
+
+        /* Check whether the timer object is stopped, detached or started again */
+        if (rt_list_isempty(&list))
+        {
+            continue;
+        }
+        rt_list_remove(&(t->row[RT_TIMER_SKIP_LIST_LEVEL - 1]));
+        if ((t->parent.flag & RT_TIMER_FLAG_PERIODIC) &&
+            (t->parent.flag & RT_TIMER_FLAG_ACTIVATED))
+        {
+            /* start it */
+            t->parent.flag &= ~RT_TIMER_FLAG_ACTIVATED;
+            if (t->parent.flag & RT_TIMER_FLAG_ANCHORED)
+                _rt_timer_rearm(t, rt_tick_get());
+            else
+                _rt_timer_start(t);
+        }
+    }
+
+#ifdef RT_TIMER_USING_IRQOFF_STAT
+    irqoff = rt_hw_cycle_get() - irqoff_start;
+    if (irqoff > irqoff_max)
+        irqoff_max = irqoff;
+    _rt_timer_irqoff_update(irqoff_max);
+#endif
+    /* enable interrupt */
+    _timer_unlock_irqrestore(level);
+
+    RT_DEBUG_LOG(RT_DEBUG_TIMER, ("timer check leave\n"));
+}
+#else
 /**
  * This function will check timer list, if a timeout event happens, the
  * corresponding timeout function will be invoked.
@@ -580,6 +1158,13 @@ void rt_timer_check(void)
     rt_tick_t current_tick;
     register rt_base_t level;
     rt_list_t list;
+    rt_list_t *timer_head;
+#ifdef RT_TIMER_USING_WHEEL
+    rt_list_t expired;
+#endif
+#ifdef RT_TIMER_USING_IRQOFF_STAT
+    rt_uint32_t irqoff_start;
+#endif
 
     rt_list_init(&list);
 
@@ -588,12 +1173,23 @@ void rt_timer_check(void)
     current_tick = rt_tick_get();
 
     /* disable interrupt */
-    level = rt_hw_interrupt_disable();
+    level = _timer_lock_irqsave();
+#ifdef RT_TIMER_USING_IRQOFF_STAT
+    irqoff_start = rt_hw_cycle_get();
+#endif
 
+#ifdef RT_TIMER_USING_WHEEL
+    /* move the timers of the passed ticks to the expired list */
+    rt_list_init(&expired);
+    _rt_timer_wheel_run(&rt_timer_wheel, current_tick, &expired);
+    timer_head = &expired;
+#else
+    timer_head = &rt_timer_list[RT_TIMER_SKIP_LIST_LEVEL - 1];
+#endif
 
-    while (!rt_list_isempty(&rt_timer_list[RT_TIMER_SKIP_LIST_LEVEL - 1]))
+    while (!rt_list_isempty(timer_head))
     {
-        t = rt_list_entry(rt_timer_list[RT_TIMER_SKIP_LIST_LEVEL - 1].next,
+        t = rt_list_entry(timer_head->next,
                           struct rt_timer, row[RT_TIMER_SKIP_LIST_LEVEL - 1]);
 
         /*
@@ -612,8 +1208,15 @@ void rt_timer_check(void)
             }
             /* add timer to temporary list  */
             rt_list_insert_after(&list, &(t->row[RT_TIMER_SKIP_LIST_LEVEL - 1]));
+#ifdef RT_USING_SMP
+            /* the timeout function may take the cpus lock, release the timer lists */
+            rt_hw_spin_unlock(&_timer_lock.lock);
+#endif
             /* call timeout function */
             t->timeout_func(t->parameter);
+#ifdef RT_USING_SMP
+            rt_hw_spin_lock(&_timer_lock.lock);
+#endif
 
             /* re-get tick */
             current_tick = rt_tick_get();
@@ -632,17 +1235,24 @@ void rt_timer_check(void)
             {
                 /* start it */
                 t->parent.flag &= ~RT_TIMER_FLAG_ACTIVATED;
-                rt_timer_start(t);
+                if (t->parent.flag & RT_TIMER_FLAG_ANCHORED)
+                    _rt_timer_rearm(t, current_tick);
+                else
+                    _rt_timer_start(t);
             }
         }
         else break;
     }
 
+#ifdef RT_TIMER_USING_IRQOFF_STAT
+    _rt_timer_irqoff_update(rt_hw_cycle_get() - irqoff_start);
+#endif
     /* enable interrupt */
-    rt_hw_interrupt_enable(level);
+    _timer_unlock_irqrestore(level);
 
     RT_DEBUG_LOG(RT_DEBUG_TIMER, ("timer check leave\n"));
 }
+#endif
 
 /**
  * This function will return the next timeout tick in the system.
@@ -653,7 +1263,11 @@ void rt_timer_check(void)
  */
 rt_tick_t rt_timer_next_timeout_tick(void)
 {
+#ifdef RT_TIMER_USING_WHEEL
+    return rt_timer_wheel_next_timeout(&rt_timer_wheel);
+#else
     return rt_timer_list_next_timeout(rt_timer_list);
+#endif
 }
 
 #ifdef RT_USING_TIMER_SOFT
@@ -669,17 +1283,30 @@ void rt_soft_timer_check(void)
     struct rt_timer *t;
     register rt_base_t level;
     rt_list_t list;
+    rt_list_t *timer_head;
+#ifdef RT_TIMER_USING_WHEEL
+    rt_list_t expired;
+#endif
 
     rt_list_init(&list);
 
     RT_DEBUG_LOG(RT_DEBUG_TIMER, ("software timer check enter\n"));
 
     /* disable interrupt */
-    level = rt_hw_interrupt_disable();
+    level = _timer_lock_irqsave();
+
+#ifdef RT_TIMER_USING_WHEEL
+    /* move the timers of the passed ticks to the expired list */
+    rt_list_init(&expired);
+    _rt_timer_wheel_run(&rt_soft_timer_wheel, rt_tick_get(), &expired);
+    timer_head = &expired;
+#else
+    timer_head = &rt_soft_timer_list[RT_TIMER_SKIP_LIST_LEVEL - 1];
+#endif
 
-    while (!rt_list_isempty(&rt_soft_timer_list[RT_TIMER_SKIP_LIST_LEVEL - 1]))
+    while (!rt_list_isempty(timer_head))
     {
-        t = rt_list_entry(rt_soft_timer_list[RT_TIMER_SKIP_LIST_LEVEL - 1].next,
+        t = rt_list_entry(timer_head->next,
                             struct rt_timer, row[RT_TIMER_SKIP_LIST_LEVEL - 1]);
 
         current_tick = rt_tick_get();
@@ -703,7 +1330,7 @@ void rt_soft_timer_check(void)
 
             soft_timer_status = RT_SOFT_TIMER_BUSY;
             /* enable interrupt */
-            rt_hw_interrupt_enable(level);
+            _timer_unlock_irqrestore(level);
 
             /* call timeout function */
             t->timeout_func(t->parameter);
@@ -712,7 +1339,7 @@ void rt_soft_timer_check(void)
             RT_DEBUG_LOG(RT_DEBUG_TIMER, ("current tick: %d\n", current_tick));
 
             /* disable interrupt */
-            level = rt_hw_interrupt_disable();
+            level = _timer_lock_irqsave();
 
             soft_timer_status = RT_SOFT_TIMER_IDLE;
             /* Check whether the timer object is detached or started again */
@@ -726,13 +1353,16 @@ void rt_soft_timer_check(void)
             {
                 /* start it */
                 t->parent.flag &= ~RT_TIMER_FLAG_ACTIVATED;
-                rt_timer_start(t);
+                if (t->parent.flag & RT_TIMER_FLAG_ANCHORED)
+                    _rt_timer_rearm(t, rt_tick_get());
+                else
+                    _rt_timer_start(t);
             }
         }
         else break; /* not check anymore */
     }
     /* enable interrupt */
-    rt_hw_interrupt_enable(level);
+    _timer_unlock_irqrestore(level);
 
     RT_DEBUG_LOG(RT_DEBUG_TIMER, ("software timer check leave\n"));
 }
@@ -748,7 +1378,11 @@ static void rt_thread_timer_entry(void *parameter)
     while (1)
     {
         /* get the next timeout tick */
+#ifdef RT_TIMER_USING_WHEEL
+        next_timeout = rt_timer_wheel_next_timeout(&rt_soft_timer_wheel);
+#else
         next_timeout = rt_timer_list_next_timeout(rt_soft_timer_list);
+#endif
         if (next_timeout == RT_TICK_MAX)
         {
             /* no software timer exist, suspend self. */
@@ -785,12 +1419,19 @@ static void rt_thread_timer_entry(void *parameter)
  */
 void rt_system_timer_init(void)
 {
+#ifdef RT_USING_SMP
+    rt_spin_lock_init(&_timer_lock);
+#endif
+#ifdef RT_TIMER_USING_WHEEL
+    _rt_timer_wheel_init(&rt_timer_wheel);
+#else
     int i;
 
     for (i = 0; i < sizeof(rt_timer_list) / sizeof(rt_timer_list[0]); i++)
     {
         rt_list_init(rt_timer_list + i);
     }
+#endif
 }
 
 /**
@@ -803,6 +1444,9 @@ void rt_system_timer_init(void)
 void rt_system_timer_thread_init(void)
 {
 #ifdef RT_USING_TIMER_SOFT
+#ifdef RT_TIMER_USING_WHEEL
+    _rt_timer_wheel_init(&rt_soft_timer_wheel);
+#else
     int i;
 
     for (i = 0;
@@ -811,6 +1455,7 @@ void rt_system_timer_thread_init(void)
     {
         rt_list_init(rt_soft_timer_list + i);
     }
+#endif
 
     /* start software timer thread */
     rt_thread_init(&timer_thread,
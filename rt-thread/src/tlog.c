@@ -0,0 +1,311 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2021-09-29     RT-Thread    the first version
+ *
+ * Anotation：延迟格式化的二进制跟踪日志。LOG_x 不再在目标板上格式化字符串，只把格式
+ * 字符串的地址（编译时确定，作为格式 ID）、时间戳和原始参数写入内存中的环形缓冲区，
+ * 缓冲区满时覆盖最早的记录。缓冲区可以用 tlog dump 命令或调试器导出，由主机上的
+ * tools/tlog_decode.py 对照 ELF 文件还原成文本。
+ */
+
+#include <rthw.h>
+#include <rtthread.h>
+
+#ifdef RT_USING_TLOG
+
+#if !defined(__GNUC__)
+#error "RT_USING_TLOG requires the atomic builtins of GNU C"
+#endif
+
+#if (RT_TLOG_BUF_SIZE & (RT_TLOG_BUF_SIZE - 1)) != 0
+#error "RT_TLOG_BUF_SIZE shall be a power of 2"
+#endif
+
+#define TLOG_MAGIC              0x474f4c54      /* "TLOG" */
+#define TLOG_RECORD_MARK        0xa5
+#define TLOG_ARG_MAX            16              /* the words of arguments in a record */
+#define TLOG_BUF_WORDS          (RT_TLOG_BUF_SIZE / sizeof(rt_uint32_t))
+
+#define TLOG_FLAG_CYCLE         0x01            /* the timestamp is cpu cycle, otherwise tick */
+#define TLOG_FLAG_STOP          0x02            /* the records are not written */
+
+/*
+ * A record is a header word, the address of format string, the timestamp and
+ * the arguments. The header word is the mark in the highest byte, the level
+ * and the words of arguments.
+ */
+#define TLOG_RECORD_HDR(level, count) \
+    (((rt_uint32_t)TLOG_RECORD_MARK << 24) | ((rt_uint32_t)(level) << 16) | (count))
+
+/*
+ * the trace log buffer, the layout is known by the decoder.
+ */
+struct tlog_buffer
+{
+    rt_uint32_t magic;
+    rt_uint32_t flag;
+    rt_uint32_t size;                           /* the size of buffer in words */
+    rt_uint32_t tail;                           /* the free-running write position in words */
+    rt_uint32_t buf[TLOG_BUF_WORDS];
+};
+
+struct tlog_buffer rt_tlog;
+
+rt_inline rt_uint32_t _tlog_stamp(void)
+{
+#ifdef RT_TLOG_USING_HW_CYCLE
+    return rt_hw_cycle_get();
+#else
+    return rt_tick_get();
+#endif
+}
+
+/*
+ * put a value of words into arguments.
+ */
+rt_inline rt_size_t _tlog_put(rt_uint32_t *args, rt_size_t count, rt_uint64_t value, rt_size_t words)
+{
+    if (count + words > TLOG_ARG_MAX)
+        return count;
+
+    args[count ++] = (rt_uint32_t)value;
+    if (words > 1)
+        args[count ++] = (rt_uint32_t)(value >> 32);
+
+    return count;
+}
+
+/*
+ * fetch the arguments by the conversions of format, the value is copied
+ * without formatting.
+ *
+ * @return the words of arguments
+ */
+static rt_size_t _tlog_args(const char *fmt, va_list ap, rt_uint32_t *args)
+{
+    rt_size_t count = 0;
+    int qualifier;
+
+    for (; *fmt; fmt ++)
+    {
+        if (*fmt != '%')
+            continue;
+
+        fmt ++;
+        if (*fmt == '%')
+            continue;
+
+        /* flags */
+        while (*fmt == '-' || *fmt == '+' || *fmt == ' ' || *fmt == '#' || *fmt == '0')
+            fmt ++;
+
+        /* field width and precision */
+        if (*fmt == '*')
+        {
+            count = _tlog_put(args, count, (rt_uint32_t)va_arg(ap, int), 1);
+            fmt ++;
+        }
+        while (*fmt >= '0' && *fmt <= '9')
+            fmt ++;
+        if (*fmt == '.')
+        {
+            fmt ++;
+            if (*fmt == '*')
+            {
+                count = _tlog_put(args, count, (rt_uint32_t)va_arg(ap, int), 1);
+                fmt ++;
+            }
+            while (*fmt >= '0' && *fmt <= '9')
+                fmt ++;
+        }
+
+        /* length modifier */
+        qualifier = 0;
+        while (*fmt == 'h' || *fmt == 'l' || *fmt == 'z')
+        {
+            qualifier = (qualifier == 'l' && *fmt == 'l') ? 'L' : *fmt;
+            fmt ++;
+        }
+
+        switch (*fmt)
+        {
+        case 'd':
+        case 'i':
+        case 'u':
+        case 'o':
+        case 'x':
+        case 'X':
+        case 'c':
+            if (qualifier == 'L')
+                count = _tlog_put(args, count, va_arg(ap, rt_uint64_t), 2);
+            else if (qualifier == 'l')
+                count = _tlog_put(args, count, (unsigned long)va_arg(ap, long),
+                                  sizeof(long) / sizeof(rt_uint32_t));
+            else if (qualifier == 'z')
+                count = _tlog_put(args, count, va_arg(ap, rt_size_t),
+                                  sizeof(rt_size_t) / sizeof(rt_uint32_t));
+            else
+                count = _tlog_put(args, count, (rt_uint32_t)va_arg(ap, int), 1);
+            break;
+
+        case 's':
+        case 'p':
+            /* the string is decoded by address, it shall be a constant in the image */
+            count = _tlog_put(args, count, (rt_ubase_t)va_arg(ap, void *),
+                              sizeof(void *) / sizeof(rt_uint32_t));
+            break;
+
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+        {
+            union
+            {
+                double d;
+                rt_uint64_t u;
+            } value;
+
+            value.d = va_arg(ap, double);
+            count = _tlog_put(args, count, value.u, 2);
+            break;
+        }
+
+        default:
+            /* the unknown conversion, the rest can't be fetched */
+            return count;
+        }
+    }
+
+    return count;
+}
+
+/**
+ * This function will initialize the header of trace log buffer, which is
+ * used by the decoder.
+ *
+ * @return RT_EOK
+ */
+int rt_tlog_init(void)
+{
+    rt_tlog.magic = TLOG_MAGIC;
+    rt_tlog.size  = TLOG_BUF_WORDS;
+#ifdef RT_TLOG_USING_HW_CYCLE
+    rt_tlog.flag |= TLOG_FLAG_CYCLE;
+#endif
+
+    return RT_EOK;
+}
+INIT_PREV_EXPORT(rt_tlog_init);
+
+/**
+ * This function will write a record of trace log. The format is not
+ * formatted, its address and the arguments are written, and decoded by
+ * tools/tlog_decode.py against the ELF file. It can be invoked in interrupt.
+ *
+ * @param level the level of log
+ * @param fmt the format, it shall be a string literal
+ */
+void rt_tlog_write(rt_uint8_t level, const char *fmt, ...)
+{
+    rt_uint32_t args[TLOG_ARG_MAX];
+    rt_uint32_t pos, stamp;
+    rt_size_t count, index;
+    va_list ap;
+
+    if (rt_tlog.flag & TLOG_FLAG_STOP)
+        return;
+
+    stamp = _tlog_stamp();
+
+    va_start(ap, fmt);
+    count = _tlog_args(fmt, ap, args);
+    va_end(ap);
+
+    /* the oldest records are overwritten */
+    pos = __atomic_fetch_add(&rt_tlog.tail, count + 3, __ATOMIC_RELAXED);
+
+    /* the header is cleared first and written at last, so that the decoder skips a half record */
+    __atomic_store_n(&rt_tlog.buf[pos % TLOG_BUF_WORDS], 0, __ATOMIC_RELAXED);
+    rt_tlog.buf[(pos + 1) % TLOG_BUF_WORDS] = (rt_uint32_t)(rt_ubase_t)fmt;
+    rt_tlog.buf[(pos + 2) % TLOG_BUF_WORDS] = stamp;
+    for (index = 0; index < count; index ++)
+    {
+        rt_tlog.buf[(pos + 3 + index) % TLOG_BUF_WORDS] = args[index];
+    }
+
+    __atomic_store_n(&rt_tlog.buf[pos % TLOG_BUF_WORDS], TLOG_RECORD_HDR(level, count),
+                     __ATOMIC_RELEASE);
+}
+
+/**
+ * This function will clear the records of trace log.
+ */
+void rt_tlog_clear(void)
+{
+    register rt_base_t level;
+
+    level = rt_hw_interrupt_disable();
+
+    rt_memset(rt_tlog.buf, 0, sizeof(rt_tlog.buf));
+    rt_tlog.tail = 0;
+
+    rt_hw_interrupt_enable(level);
+}
+
+#ifdef RT_USING_FINSH
+#include <finsh.h>
+
+/*
+ * print the trace log buffer in hex words, which is decoded by
+ * tools/tlog_decode.py from the captured console output.
+ */
+static void _tlog_dump(void)
+{
+    rt_uint32_t *word = (rt_uint32_t *)&rt_tlog;
+    rt_size_t index, total;
+
+    /* stop the writing, so that the records are not overwritten during dump */
+    rt_tlog.flag |= TLOG_FLAG_STOP;
+
+    total = sizeof(rt_tlog) / sizeof(rt_uint32_t);
+    rt_kprintf("tlog begin %d\n", total);
+    for (index = 0; index < total; index ++)
+    {
+        rt_kprintf("%08x%c", word[index], (index % 8 == 7 || index == total - 1) ? '\n' : ' ');
+    }
+    rt_kprintf("tlog end\n");
+
+    rt_tlog.flag &= ~TLOG_FLAG_STOP;
+}
+
+static int tlog(int argc, char **argv)
+{
+    if (argc == 2 && rt_strcmp(argv[1], "dump") == 0)
+    {
+        _tlog_dump();
+    }
+    else if (argc == 2 && rt_strcmp(argv[1], "clear") == 0)
+    {
+        rt_tlog_clear();
+    }
+    else
+    {
+        rt_kprintf("records: %d words of %d\n",
+                   rt_tlog.tail < TLOG_BUF_WORDS ? rt_tlog.tail : TLOG_BUF_WORDS, TLOG_BUF_WORDS);
+        rt_kprintf("usage: tlog [dump|clear]\n");
+    }
+
+    return 0;
+}
+MSH_CMD_EXPORT(tlog, dump or clear the trace log);
+#endif /* RT_USING_FINSH */
+
+#endif /* RT_USING_TLOG */
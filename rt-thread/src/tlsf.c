@@ -0,0 +1,699 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2021-09-18     RT-Thread    the first version
+ *
+ * Anotation：TLSF（两级分离适配）堆算法。空闲块按大小分入两级位图索引的空闲链表，
+ * 申请和释放都只需查找位图和常数次链表操作，执行时间与碎片程度无关。
+ */
+
+#include <rthw.h>
+#include <rtthread.h>
+
+#if defined (RT_USING_HEAP) && defined (RT_USING_TLSF)
+
+#ifdef RT_USING_HOOK
+static void (*rt_malloc_hook)(void *ptr, rt_size_t size);
+static void (*rt_free_hook)(void *ptr);
+
+/**
+ * @addtogroup Hook
+ */
+
+/**@{*/
+
+/**
+ * This function will set a hook function, which will be invoked when a memory
+ * block is allocated from heap memory.
+ *
+ * @param hook the hook function
+ */
+void rt_malloc_sethook(void (*hook)(void *ptr, rt_size_t size))
+{
+    rt_malloc_hook = hook;
+}
+
+/**
+ * This function will set a hook function, which will be invoked when a memory
+ * block is released to heap memory.
+ *
+ * @param hook the hook function
+ */
+void rt_free_sethook(void (*hook)(void *ptr))
+{
+    rt_free_hook = hook;
+}
+
+/**
+ * This function will get the hook function invoked when a memory block is
+ * allocated from heap memory, so it can be chained and restored.
+ *
+ * @return the hook function
+ */
+void (*rt_malloc_gethook(void))(void *ptr, rt_size_t size)
+{
+    return rt_malloc_hook;
+}
+
+/**
+ * This function will get the hook function invoked when a memory block is
+ * released to heap memory, so it can be chained and restored.
+ *
+ * @return the hook function
+ */
+void (*rt_free_gethook(void))(void *ptr)
+{
+    return rt_free_hook;
+}
+
+/**@}*/
+
+#endif
+
+/*
+ * The second level divides each power of two range into 16 lists. The sizes
+ * below the small block size are all mapped to the first level 0, which is
+ * divided linearly.
+ */
+#define TLSF_SL_INDEX_COUNT_LOG2    4
+#define TLSF_SL_INDEX_COUNT         (1 << TLSF_SL_INDEX_COUNT_LOG2)
+#define TLSF_FL_INDEX_SHIFT         (TLSF_SL_INDEX_COUNT_LOG2 + 2)
+#define TLSF_SMALL_BLOCK_SIZE       (1 << TLSF_FL_INDEX_SHIFT)
+#ifdef ARCH_CPU_64BIT
+#define TLSF_FL_INDEX_MAX           32
+#else
+#define TLSF_FL_INDEX_MAX           30
+#endif
+#define TLSF_FL_INDEX_COUNT         (TLSF_FL_INDEX_MAX - TLSF_FL_INDEX_SHIFT + 1)
+
+/* the lowest bit of size is the free flag, the sizes are always aligned */
+#define TLSF_BLOCK_FREE             0x01
+
+struct tlsf_block
+{
+    struct tlsf_block *prev_phys;   /* the previous physical block */
+    rt_size_t size;                 /* size of data and the free flag */
+
+    /* only valid for a free block, which are in the data area */
+    struct tlsf_block *next_free;
+    struct tlsf_block *prev_free;
+};
+
+#define TLSF_BLOCK_HEADER_SIZE      RT_ALIGN(2 * sizeof(void *), RT_ALIGN_SIZE)
+#define TLSF_BLOCK_SIZE_MIN         RT_ALIGN(2 * sizeof(void *), RT_ALIGN_SIZE)
+#define TLSF_BLOCK_SIZE_MAX         (((rt_size_t)1 << TLSF_FL_INDEX_MAX) - 1)
+
+#define TLSF_BLOCK_SIZE(block)      ((block)->size & ~(rt_size_t)TLSF_BLOCK_FREE)
+#define TLSF_BLOCK_IS_FREE(block)   ((block)->size & TLSF_BLOCK_FREE)
+#define TLSF_BLOCK_TO_PTR(block)    ((void *)((rt_uint8_t *)(block) + TLSF_BLOCK_HEADER_SIZE))
+#define TLSF_PTR_TO_BLOCK(ptr)      ((struct tlsf_block *)((rt_uint8_t *)(ptr) - TLSF_BLOCK_HEADER_SIZE))
+#define TLSF_BLOCK_NEXT(block)      ((struct tlsf_block *)((rt_uint8_t *)TLSF_BLOCK_TO_PTR(block) + \
+                                                          TLSF_BLOCK_SIZE(block)))
+
+/* the bitmaps and heads of free lists */
+static rt_uint32_t fl_bitmap;
+static rt_uint32_t sl_bitmap[TLSF_FL_INDEX_COUNT];
+static struct tlsf_block *free_blocks[TLSF_FL_INDEX_COUNT][TLSF_SL_INDEX_COUNT];
+
+static rt_uint8_t *heap_ptr;
+static struct tlsf_block *heap_end;
+static struct rt_semaphore heap_sem;
+static rt_size_t mem_size_aligned;
+static rt_size_t used_mem, max_mem;
+#ifdef RT_USING_MEMFRAG
+static rt_uint32_t heap_generation;        /* changed on each update of blocks */
+#endif
+
+/*
+ * find the index of the most significant bit set, -1 for 0.
+ */
+rt_inline int _tlsf_fls(rt_size_t word)
+{
+    int bit = 0;
+
+    if (word == 0)
+        return -1;
+
+#if defined(__GNUC__) || defined(__clang__)
+    bit = (int)(sizeof(rt_size_t) * 8 - 1) - __builtin_clzl((unsigned long)word);
+#else
+#ifdef ARCH_CPU_64BIT
+    if (word & 0xffffffff00000000ul) { word >>= 32; bit += 32; }
+#endif
+    if (word & 0xffff0000) { word >>= 16; bit += 16; }
+    if (word & 0xff00) { word >>= 8; bit += 8; }
+    if (word & 0xf0) { word >>= 4; bit += 4; }
+    if (word & 0xc) { word >>= 2; bit += 2; }
+    if (word & 0x2) { bit += 1; }
+#endif
+
+    return bit;
+}
+
+/*
+ * map a block size to the indexes of free list.
+ */
+rt_inline void _tlsf_mapping(rt_size_t size, int *fl, int *sl)
+{
+    int bit;
+
+    if (size < TLSF_SMALL_BLOCK_SIZE)
+    {
+        *fl = 0;
+        *sl = (int)size / (TLSF_SMALL_BLOCK_SIZE / TLSF_SL_INDEX_COUNT);
+    }
+    else
+    {
+        bit = _tlsf_fls(size);
+        *sl = (int)(size >> (bit - TLSF_SL_INDEX_COUNT_LOG2)) ^ TLSF_SL_INDEX_COUNT;
+        *fl = bit - (TLSF_FL_INDEX_SHIFT - 1);
+    }
+}
+
+/*
+ * find a free block which is large enough for the size, the size is rounded
+ * up to the next list so that any block in the list fits.
+ */
+static struct tlsf_block *_tlsf_search(rt_size_t size)
+{
+    int fl, sl;
+    rt_uint32_t bitmap;
+    rt_size_t round;
+
+    round = size;
+    if (round >= TLSF_SMALL_BLOCK_SIZE)
+        round += ((rt_size_t)1 << (_tlsf_fls(round) - TLSF_SL_INDEX_COUNT_LOG2)) - 1;
+
+    _tlsf_mapping(round, &fl, &sl);
+    if (fl < TLSF_FL_INDEX_COUNT)
+    {
+        bitmap = sl_bitmap[fl] & (~0U << sl);
+        if (bitmap == 0 && fl + 1 < TLSF_FL_INDEX_COUNT)
+        {
+            /* no block in this first level, go to the larger ones */
+            bitmap = fl_bitmap & (~0U << (fl + 1));
+            if (bitmap != 0)
+            {
+                fl = __rt_ffs((int)bitmap) - 1;
+                bitmap = sl_bitmap[fl];
+            }
+        }
+
+        if (bitmap != 0)
+        {
+            sl = __rt_ffs((int)bitmap) - 1;
+
+            return free_blocks[fl][sl];
+        }
+    }
+
+    /* the last chance, the first block in the list of size may fit */
+    _tlsf_mapping(size, &fl, &sl);
+    if (fl < TLSF_FL_INDEX_COUNT && free_blocks[fl][sl] != RT_NULL &&
+        TLSF_BLOCK_SIZE(free_blocks[fl][sl]) >= size)
+        return free_blocks[fl][sl];
+
+    return RT_NULL;
+}
+
+static void _tlsf_insert(struct tlsf_block *block)
+{
+    int fl, sl;
+
+    _tlsf_mapping(TLSF_BLOCK_SIZE(block), &fl, &sl);
+
+    block->prev_free = RT_NULL;
+    block->next_free = free_blocks[fl][sl];
+    if (block->next_free != RT_NULL)
+        block->next_free->prev_free = block;
+    free_blocks[fl][sl] = block;
+
+    fl_bitmap |= 1U << fl;
+    sl_bitmap[fl] |= 1U << sl;
+}
+
+static void _tlsf_remove(struct tlsf_block *block)
+{
+    int fl, sl;
+
+    _tlsf_mapping(TLSF_BLOCK_SIZE(block), &fl, &sl);
+
+    if (block->next_free != RT_NULL)
+        block->next_free->prev_free = block->prev_free;
+    if (block->prev_free != RT_NULL)
+    {
+        block->prev_free->next_free = block->next_free;
+    }
+    else
+    {
+        free_blocks[fl][sl] = block->next_free;
+        if (block->next_free == RT_NULL)
+        {
+            /* the list is empty now */
+            sl_bitmap[fl] &= ~(1U << sl);
+            if (sl_bitmap[fl] == 0)
+                fl_bitmap &= ~(1U << fl);
+        }
+    }
+}
+
+/*
+ * split the tail of a block into a new free block if it is large enough, and
+ * merge the tail with the next block if the next block is free.
+ */
+static void _tlsf_trim(struct tlsf_block *block, rt_size_t size)
+{
+    struct tlsf_block *remain, *next;
+    rt_size_t remain_size;
+
+    if (TLSF_BLOCK_SIZE(block) < size + TLSF_BLOCK_HEADER_SIZE + TLSF_BLOCK_SIZE_MIN)
+        return;
+
+    remain_size = TLSF_BLOCK_SIZE(block) - size - TLSF_BLOCK_HEADER_SIZE;
+    block->size = size | (block->size & TLSF_BLOCK_FREE);
+
+    remain = TLSF_BLOCK_NEXT(block);
+    remain->prev_phys = block;
+    remain->size = remain_size | TLSF_BLOCK_FREE;
+
+    next = TLSF_BLOCK_NEXT(remain);
+    if (TLSF_BLOCK_IS_FREE(next))
+    {
+        _tlsf_remove(next);
+        remain->size += TLSF_BLOCK_HEADER_SIZE + TLSF_BLOCK_SIZE(next);
+        next = TLSF_BLOCK_NEXT(remain);
+    }
+    next->prev_phys = remain;
+
+    _tlsf_insert(remain);
+}
+
+/**
+ * @ingroup SystemInit
+ *
+ * This function will initialize system heap memory.
+ *
+ * @param begin_addr the beginning address of system heap memory.
+ * @param end_addr the end address of system heap memory.
+ */
+void rt_system_heap_init(void *begin_addr, void *end_addr)
+{
+    struct tlsf_block *block;
+    rt_ubase_t begin_align = RT_ALIGN((rt_ubase_t)begin_addr, RT_ALIGN_SIZE);
+    rt_ubase_t end_align   = RT_ALIGN_DOWN((rt_ubase_t)end_addr, RT_ALIGN_SIZE);
+
+    RT_DEBUG_NOT_IN_INTERRUPT;
+
+    /* the heap holds one free block and the end block at least */
+    if ((end_align > (2 * TLSF_BLOCK_HEADER_SIZE + TLSF_BLOCK_SIZE_MIN)) &&
+        ((end_align - 2 * TLSF_BLOCK_HEADER_SIZE - TLSF_BLOCK_SIZE_MIN) >= begin_align))
+    {
+        /* calculate the aligned memory size */
+        mem_size_aligned = end_align - begin_align - 2 * TLSF_BLOCK_HEADER_SIZE;
+        if (mem_size_aligned > TLSF_BLOCK_SIZE_MAX)
+            mem_size_aligned = RT_ALIGN_DOWN(TLSF_BLOCK_SIZE_MAX, RT_ALIGN_SIZE);
+    }
+    else
+    {
+        rt_kprintf("mem init, error begin address 0x%x, and end address 0x%x\n",
+                   (rt_ubase_t)begin_addr, (rt_ubase_t)end_addr);
+
+        return;
+    }
+
+    heap_ptr = (rt_uint8_t *)begin_align;
+
+    RT_DEBUG_LOG(RT_DEBUG_MEM, ("mem init, heap begin address 0x%x, size %d\n",
+                                (rt_ubase_t)heap_ptr, mem_size_aligned));
+
+    /* the whole heap is one free block */
+    block = (struct tlsf_block *)heap_ptr;
+    block->prev_phys = RT_NULL;
+    block->size = mem_size_aligned | TLSF_BLOCK_FREE;
+
+    /* the end block is used and empty, which stops the merging */
+    heap_end = TLSF_BLOCK_NEXT(block);
+    heap_end->prev_phys = block;
+    heap_end->size = 0;
+
+    _tlsf_insert(block);
+
+    rt_sem_init(&heap_sem, "heap", 1, RT_IPC_FLAG_FIFO);
+}
+
+/**
+ * @addtogroup MM
+ */
+
+/**@{*/
+
+/**
+ * Allocate a block of memory with a minimum of 'size' bytes.
+ *
+ * @param size is the minimum size of the requested block in bytes.
+ *
+ * @return pointer to allocated memory or NULL if no free memory was found.
+ */
+void *rt_malloc(rt_size_t size)
+{
+    struct tlsf_block *block, *next;
+
+    if (size == 0)
+        return RT_NULL;
+
+    RT_DEBUG_NOT_IN_INTERRUPT;
+
+    if (size > mem_size_aligned)
+    {
+        RT_DEBUG_LOG(RT_DEBUG_MEM, ("no memory\n"));
+
+        return RT_NULL;
+    }
+
+    /* alignment size */
+    size = RT_ALIGN(size, RT_ALIGN_SIZE);
+    if (size < TLSF_BLOCK_SIZE_MIN)
+        size = TLSF_BLOCK_SIZE_MIN;
+
+    /* take memory semaphore */
+    rt_sem_take(&heap_sem, RT_WAITING_FOREVER);
+#ifdef RT_USING_MEMFRAG
+    heap_generation ++;
+#endif
+
+    block = _tlsf_search(size);
+    if (block == RT_NULL)
+    {
+        rt_sem_release(&heap_sem);
+
+        RT_DEBUG_LOG(RT_DEBUG_MEM, ("no memory\n"));
+
+        return RT_NULL;
+    }
+
+    _tlsf_remove(block);
+    _tlsf_trim(block, size);
+
+    /* mark the block as used */
+    block->size &= ~(rt_size_t)TLSF_BLOCK_FREE;
+    next = TLSF_BLOCK_NEXT(block);
+    next->prev_phys = block;
+
+    used_mem += TLSF_BLOCK_SIZE(block) + TLSF_BLOCK_HEADER_SIZE;
+    if (max_mem < used_mem)
+        max_mem = used_mem;
+
+    rt_sem_release(&heap_sem);
+
+    RT_ASSERT((rt_ubase_t)TLSF_BLOCK_TO_PTR(block) % RT_ALIGN_SIZE == 0);
+
+    RT_DEBUG_LOG(RT_DEBUG_MEM,
+                 ("allocate memory at 0x%x, size: %d\n",
+                  (rt_ubase_t)TLSF_BLOCK_TO_PTR(block), TLSF_BLOCK_SIZE(block)));
+
+    RT_OBJECT_HOOK_CALL(rt_malloc_hook, (TLSF_BLOCK_TO_PTR(block), size));
+
+    return TLSF_BLOCK_TO_PTR(block);
+}
+
+/**
+ * This function will change the previously allocated memory block.
+ *
+ * @param rmem pointer to memory allocated by rt_malloc
+ * @param newsize the required new size
+ *
+ * @return the changed memory block address
+ */
+void *rt_realloc(void *rmem, rt_size_t newsize)
+{
+    struct tlsf_block *block, *next;
+    rt_size_t size;
+    void *nmem;
+
+    RT_DEBUG_NOT_IN_INTERRUPT;
+
+    if (newsize > mem_size_aligned)
+    {
+        RT_DEBUG_LOG(RT_DEBUG_MEM, ("realloc: out of memory\n"));
+
+        return RT_NULL;
+    }
+    else if (newsize == 0)
+    {
+        rt_free(rmem);
+        return RT_NULL;
+    }
+
+    /* allocate a new memory block */
+    if (rmem == RT_NULL)
+        return rt_malloc(newsize);
+
+    if ((rt_uint8_t *)rmem < heap_ptr || (rt_uint8_t *)rmem >= (rt_uint8_t *)heap_end)
+    {
+        /* illegal memory */
+        return rmem;
+    }
+
+    /* alignment size */
+    newsize = RT_ALIGN(newsize, RT_ALIGN_SIZE);
+    if (newsize < TLSF_BLOCK_SIZE_MIN)
+        newsize = TLSF_BLOCK_SIZE_MIN;
+
+    rt_sem_take(&heap_sem, RT_WAITING_FOREVER);
+#ifdef RT_USING_MEMFRAG
+    heap_generation ++;
+#endif
+
+    block = TLSF_PTR_TO_BLOCK(rmem);
+    RT_ASSERT(!TLSF_BLOCK_IS_FREE(block));
+
+    size = TLSF_BLOCK_SIZE(block);
+    next = TLSF_BLOCK_NEXT(block);
+
+    /* absorb the next free block when growing in place is possible */
+    if (newsize > size && TLSF_BLOCK_IS_FREE(next) &&
+        size + TLSF_BLOCK_HEADER_SIZE + TLSF_BLOCK_SIZE(next) >= newsize)
+    {
+        _tlsf_remove(next);
+        block->size += TLSF_BLOCK_HEADER_SIZE + TLSF_BLOCK_SIZE(next);
+        TLSF_BLOCK_NEXT(block)->prev_phys = block;
+    }
+
+    if (TLSF_BLOCK_SIZE(block) >= newsize)
+    {
+        /* shrink or grow in place */
+        _tlsf_trim(block, newsize);
+
+        used_mem = used_mem - size + TLSF_BLOCK_SIZE(block);
+        if (max_mem < used_mem)
+            max_mem = used_mem;
+
+        rt_sem_release(&heap_sem);
+
+        /* the old block is released and the new one is allocated */
+        RT_OBJECT_HOOK_CALL(rt_free_hook, (rmem));
+        RT_OBJECT_HOOK_CALL(rt_malloc_hook, (rmem, newsize));
+
+        return rmem;
+    }
+    rt_sem_release(&heap_sem);
+
+    /* expand memory */
+    nmem = rt_malloc(newsize);
+    if (nmem != RT_NULL) /* check memory */
+    {
+        rt_memcpy(nmem, rmem, size);
+        rt_free(rmem);
+    }
+
+    return nmem;
+}
+
+/**
+ * This function will contiguously allocate enough space for count objects
+ * that are size bytes of memory each and returns a pointer to the allocated
+ * memory.
+ *
+ * The allocated memory is filled with bytes of value zero.
+ *
+ * @param count number of objects to allocate
+ * @param size size of the objects to allocate
+ *
+ * @return pointer to allocated memory / NULL pointer if there is an error
+ */
+void *rt_calloc(rt_size_t count, rt_size_t size)
+{
+    void *p;
+
+    /* allocate 'count' objects of size 'size' */
+    p = rt_malloc(count * size);
+
+    /* zero the memory */
+    if (p)
+        rt_memset(p, 0, count * size);
+
+    return p;
+}
+
+/**
+ * This function will release the previously allocated memory block by
+ * rt_malloc. The released memory block is taken back to system heap.
+ *
+ * @param rmem the address of memory which will be released
+ */
+void rt_free(void *rmem)
+{
+    struct tlsf_block *block, *prev, *next;
+
+    if (rmem == RT_NULL)
+        return;
+
+    RT_DEBUG_NOT_IN_INTERRUPT;
+
+    RT_ASSERT((((rt_ubase_t)rmem) & (RT_ALIGN_SIZE - 1)) == 0);
+    RT_ASSERT((rt_uint8_t *)rmem >= heap_ptr &&
+              (rt_uint8_t *)rmem < (rt_uint8_t *)heap_end);
+
+    RT_OBJECT_HOOK_CALL(rt_free_hook, (rmem));
+
+    if ((rt_uint8_t *)rmem < heap_ptr || (rt_uint8_t *)rmem >= (rt_uint8_t *)heap_end)
+    {
+        RT_DEBUG_LOG(RT_DEBUG_MEM, ("illegal memory\n"));
+
+        return;
+    }
+
+    block = TLSF_PTR_TO_BLOCK(rmem);
+
+    RT_DEBUG_LOG(RT_DEBUG_MEM,
+                 ("release memory 0x%x, size: %d\n",
+                  (rt_ubase_t)rmem, TLSF_BLOCK_SIZE(block)));
+
+    /* protect the heap from concurrent access */
+    rt_sem_take(&heap_sem, RT_WAITING_FOREVER);
+#ifdef RT_USING_MEMFRAG
+    heap_generation ++;
+#endif
+
+    if (TLSF_BLOCK_IS_FREE(block))
+    {
+        rt_kprintf("to free a bad data block:\n");
+        rt_kprintf("mem: 0x%08x, size: %d\n", rmem, TLSF_BLOCK_SIZE(block));
+    }
+    RT_ASSERT(!TLSF_BLOCK_IS_FREE(block));
+
+    used_mem -= TLSF_BLOCK_SIZE(block) + TLSF_BLOCK_HEADER_SIZE;
+    block->size |= TLSF_BLOCK_FREE;
+
+    /* merge with the previous block */
+    prev = block->prev_phys;
+    if (prev != RT_NULL && TLSF_BLOCK_IS_FREE(prev))
+    {
+        _tlsf_remove(prev);
+        prev->size += TLSF_BLOCK_HEADER_SIZE + TLSF_BLOCK_SIZE(block);
+        block = prev;
+    }
+
+    /* merge with the next block */
+    next = TLSF_BLOCK_NEXT(block);
+    if (TLSF_BLOCK_IS_FREE(next))
+    {
+        _tlsf_remove(next);
+        block->size += TLSF_BLOCK_HEADER_SIZE + TLSF_BLOCK_SIZE(next);
+        next = TLSF_BLOCK_NEXT(block);
+    }
+    next->prev_phys = block;
+
+    _tlsf_insert(block);
+
+    rt_sem_release(&heap_sem);
+}
+
+#ifdef RT_USING_MEMFRAG
+/**
+ * This function will walk the blocks of system heap for the fragmentation
+ * analyzer. At most count blocks are visited in one step, and the lock of
+ * heap is never waited for.
+ *
+ * @param walk the walk of heap, its cursor is 0 at the beginning
+ * @param count the maximum number of blocks visited
+ *
+ * @return RT_EOK if the walk is finished, -RT_EBUSY if there are blocks left
+ *         or the heap is locked, -RT_EINTR if the heap has been changed and
+ *         the walk restarts.
+ */
+rt_err_t rt_memory_walk(struct rt_mem_walk *walk, rt_size_t count)
+{
+    struct tlsf_block *block;
+
+    if (rt_sem_trytake(&heap_sem) != RT_EOK)
+        return -RT_EBUSY;
+
+    if (walk->cursor == 0)
+    {
+        walk->start  = (rt_ubase_t)heap_ptr;
+        walk->size   = mem_size_aligned;
+        walk->cursor = (rt_ubase_t)heap_ptr;
+        walk->generation = heap_generation;
+    }
+    else if (walk->generation != heap_generation)
+    {
+        walk->cursor = 0;
+        rt_sem_release(&heap_sem);
+
+        return -RT_EINTR;
+    }
+
+    for (block = (struct tlsf_block *)walk->cursor; block != heap_end && count > 0; count --)
+    {
+        if (TLSF_BLOCK_IS_FREE(block))
+            walk->free_block(walk, TLSF_BLOCK_TO_PTR(block), TLSF_BLOCK_SIZE(block));
+
+        block = TLSF_BLOCK_NEXT(block);
+    }
+    walk->cursor = (rt_ubase_t)block;
+
+    rt_sem_release(&heap_sem);
+
+    if (block == heap_end)
+    {
+        walk->cursor = 0;
+
+        return RT_EOK;
+    }
+
+    return -RT_EBUSY;
+}
+#endif
+
+void rt_memory_info(rt_uint32_t *total,
+                    rt_uint32_t *used,
+                    rt_uint32_t *max_used)
+{
+    if (total != RT_NULL)
+        *total = mem_size_aligned;
+    if (used  != RT_NULL)
+        *used = used_mem;
+    if (max_used != RT_NULL)
+        *max_used = max_mem;
+}
+
+#ifdef RT_USING_FINSH
+#include <finsh.h>
+
+void list_mem(void)
+{
+    rt_kprintf("total memory: %d\n", mem_size_aligned);
+    rt_kprintf("used memory : %d\n", used_mem);
+    rt_kprintf("maximum allocated memory: %d\n", max_mem);
+}
+FINSH_FUNCTION_EXPORT(list_mem, list memory usage information)
+#endif /* end of RT_USING_FINSH */
+
+/**@}*/
+
+#endif /* end of RT_USING_HEAP && RT_USING_TLSF */
@@ -0,0 +1,221 @@
+#!/usr/bin/env python
+#
+# Copyright (c) 2006-2021, RT-Thread Development Team
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+# Change Logs:
+# Date           Author       Notes
+# 2021-09-29     RT-Thread    the first version
+#
+# Decode the deferred-format trace log (RT_USING_TLOG) against the ELF file.
+#
+# The trace log buffer is the variable rt_tlog, it can be captured by
+#   - the console output of "tlog dump" command, or
+#   - the debugger, such as "dump binary value tlog.bin rt_tlog" in gdb.
+#
+# usage: tlog_decode.py rtthread.elf tlog.txt [--hz 168000000] [--color]
+
+from __future__ import print_function
+
+import re
+import struct
+import argparse
+
+TLOG_MAGIC       = 0x474f4c54
+TLOG_RECORD_MARK = 0xa5
+TLOG_FLAG_CYCLE  = 0x01
+
+SHF_ALLOC        = 0x2
+SHT_NOBITS       = 8
+
+LEVEL_COLOR = {0: 31, 1: 33, 2: 32, 3: 0}
+
+CONVERSION = re.compile(r'%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d*))?(hh|h|ll|l|z)?([diouxXcspfFeEgG%])')
+
+class Elf(object):
+    '''the loaded sections of ELF file, to read the format strings'''
+
+    def __init__(self, name):
+        data = open(name, 'rb').read()
+        if data[:4] != b'\x7fELF':
+            raise ValueError('%s is not an ELF file' % name)
+
+        self.word_size = 8 if data[4] == 2 or data[4:5] == b'\x02' else 4
+        endian = '<' if data[5] == 1 or data[5:6] == b'\x01' else '>'
+        self.endian = endian
+
+        if self.word_size == 4:
+            shoff, = struct.unpack_from(endian + 'I', data, 0x20)
+            shentsize, shnum = struct.unpack_from(endian + 'HH', data, 0x2e)
+            fmt = endian + 'IIIIIIIIII'
+        else:
+            shoff, = struct.unpack_from(endian + 'Q', data, 0x28)
+            shentsize, shnum = struct.unpack_from(endian + 'HH', data, 0x3a)
+            fmt = endian + 'IIQQQQIIQQ'
+
+        self.sections = []
+        for index in range(shnum):
+            _, sh_type, sh_flags, sh_addr, sh_offset, sh_size = \
+                struct.unpack_from(fmt, data, shoff + index * shentsize)[:6]
+            if (sh_flags & SHF_ALLOC) and sh_type != SHT_NOBITS and sh_size:
+                self.sections.append((sh_addr, sh_addr + sh_size, data[sh_offset:sh_offset + sh_size]))
+
+    def string(self, addr):
+        '''the string at address, None if it is not in the image'''
+        for start, end, data in self.sections:
+            if start <= addr < end:
+                offset = addr - start
+                length = data.find(b'\0', offset)
+                if length < 0:
+                    length = len(data)
+                return data[offset:length].decode('utf-8', 'replace')
+        return None
+
+def load_dump(name, endian):
+    '''the words of rt_tlog from the console output or the binary dump'''
+    data = open(name, 'rb').read()
+
+    if b'tlog begin' in data:
+        words = []
+        capture = False
+        for line in data.decode('utf-8', 'replace').splitlines():
+            line = line.strip()
+            if line.startswith('tlog begin'):
+                capture = True
+                words = []
+            elif line.startswith('tlog end'):
+                capture = False
+            elif capture:
+                words.extend(int(word, 16) for word in line.split())
+        return words
+
+    count = len(data) // 4
+    return list(struct.unpack(endian + '%dI' % count, data[:count * 4]))
+
+def fetch(words, count):
+    '''the value of count words, the low word first'''
+    value = 0
+    for index in range(count):
+        value |= words.pop(0) << (32 * index)
+    return value
+
+def signed(value, bits):
+    if value & (1 << (bits - 1)):
+        value -= 1 << bits
+    return value
+
+def format_line(elf, fmt, args):
+    '''format the line like printf, the arguments are the raw words'''
+    result = []
+    last = 0
+    for match in CONVERSION.finditer(fmt):
+        result.append(fmt[last:match.start()])
+        last = match.end()
+
+        flags, width, precision, qualifier, conversion = match.groups()
+        if conversion == '%':
+            result.append('%')
+            continue
+
+        try:
+            if width == '*':
+                width = str(signed(fetch(args, 1), 32))
+            if precision == '*':
+                precision = str(signed(fetch(args, 1), 32))
+        except IndexError:
+            result.append('<?>')
+            continue
+
+        spec = '%' + flags + (width or '') + ('.' + precision if precision is not None else '')
+
+        if qualifier == 'll':
+            words = 2
+        elif qualifier in ('l', 'z') or conversion in 'sp':
+            words = elf.word_size // 4
+        elif conversion in 'fFeEgG':
+            words = 2
+        else:
+            words = 1
+
+        if len(args) < words:
+            result.append('<?>')
+            continue
+        value = fetch(args, words)
+
+        if conversion in 'di':
+            result.append((spec + 'd') % signed(value, 32 * words))
+        elif conversion == 'u':
+            result.append((spec + 'd') % value)
+        elif conversion in 'oxX':
+            result.append((spec + conversion) % value)
+        elif conversion == 'c':
+            result.append((spec + 'c') % chr(value & 0xff))
+        elif conversion == 'p':
+            result.append('0x%0*x' % (elf.word_size * 2, value))
+        elif conversion == 's':
+            string = elf.string(value)
+            if string is None:
+                string = '<str@0x%x>' % value
+            result.append((spec + 's') % string)
+        else:
+            number, = struct.unpack('<d', struct.pack('<Q', value))
+            result.append((spec + conversion) % number)
+
+    result.append(fmt[last:])
+    return ''.join(result)
+
+def decode(elf, words, hz, color):
+    if len(words) < 4 or words[0] != TLOG_MAGIC:
+        raise ValueError('no trace log buffer is found in the dump')
+
+    flag, size, tail = words[1:4]
+    buf = words[4:4 + size]
+    if len(buf) < size:
+        raise ValueError('the dump is truncated')
+
+    unit = 'cycle' if flag & TLOG_FLAG_CYCLE else 'tick'
+    pos = tail - size if tail > size else 0
+    skipped = 0
+
+    while pos + 3 <= tail:
+        header = buf[pos % size]
+        count = header & 0xffff
+        level = (header >> 16) & 0xff
+        fmt = elf.string(buf[(pos + 1) % size]) if (header >> 24) == TLOG_RECORD_MARK else None
+
+        # resync at the next word if the record was overwritten
+        if fmt is None or pos + 3 + count > tail:
+            pos += 1
+            skipped += 1
+            continue
+
+        stamp = buf[(pos + 2) % size]
+        args = [buf[(pos + 3 + index) % size] for index in range(count)]
+        line = format_line(elf, fmt, args)
+        pos += 3 + count
+
+        if hz:
+            stamp = '%.6f' % (float(stamp) / hz)
+        if color:
+            line = '\033[%dm%s\033[0m' % (LEVEL_COLOR.get(level, 0), line)
+        print('[%s] %s' % (stamp, line))
+
+    if skipped:
+        print('(%d words of overwritten records are skipped, timestamp in %s)' % (skipped, unit))
+
+def main():
+    parser = argparse.ArgumentParser(description='decode the trace log of RT-Thread')
+    parser.add_argument('elf', help='the ELF file of firmware')
+    parser.add_argument('dump', help='the console output of "tlog dump", or the binary dump of rt_tlog')
+    parser.add_argument('--hz', type=float, default=0,
+                        help='the frequency of timestamp, print the timestamp in seconds')
+    parser.add_argument('--color', action='store_true', help='color the lines by level')
+    args = parser.parse_args()
+
+    elf = Elf(args.elf)
+    words = load_dump(args.dump, elf.endian)
+    decode(elf, words, args.hz, args.color)
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,288 @@
+#!/usr/bin/env python
+#
+# Copyright (c) 2006-2021, RT-Thread Development Team
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+# Change Logs:
+# Date           Author       Notes
+# 2021-09-30     RT-Thread    the first version
+#
+# Convert the kernel event trace (RT_USING_TRACE) to the Chrome trace JSON,
+# which is opened by https://ui.perfetto.dev or chrome://tracing.
+#
+# The trace buffer is the variable rt_trace, it can be captured by
+#   - the console output of "trace dump" command,
+#   - the binary output of "trace dump <device>" command, or
+#   - the debugger, such as "dump binary value trace.bin rt_trace" in gdb.
+#
+# usage: trace2json.py trace.txt -o trace.json [--hz 168000000]
+#
+# The timeline has a track for each thread, and the tracks of interrupts,
+# timers and heap. The wakeup of a thread is drawn as a flow from the waker
+# to the thread, and the latencies are summarized in the output.
+
+from __future__ import print_function
+
+import sys
+import json
+import struct
+import argparse
+
+TRACE_MAGIC        = 0x45435254
+TRACE_FLAG_CYCLE   = 0x01
+
+TRACE_SWITCH         = 1
+TRACE_IRQ_ENTER      = 2
+TRACE_IRQ_LEAVE      = 3
+TRACE_OBJ_TRYTAKE    = 4
+TRACE_OBJ_TAKE       = 5
+TRACE_OBJ_PUT        = 6
+TRACE_THREAD_SUSPEND = 7
+TRACE_THREAD_RESUME  = 8
+TRACE_TIMER_ENTER    = 9
+TRACE_TIMER_EXIT     = 10
+TRACE_MALLOC         = 11
+TRACE_FREE           = 12
+
+OBJECT_CLASS = {1: 'thread', 2: 'sem', 3: 'mutex', 4: 'event', 5: 'mailbox',
+                6: 'mq', 7: 'memheap', 8: 'mempool', 9: 'device', 10: 'timer',
+                11: 'ringqueue', 12: 'arena'}
+
+TID_IRQ    = 1
+TID_TIMER  = 2
+TID_HEAP   = 3
+TID_THREAD = 100
+
+HEADER_SIZE = 28
+
+def load_dump(name):
+    '''the bytes of rt_trace from the console output or the binary dump'''
+    data = open(name, 'rb').read()
+
+    if b'trace begin' in data:
+        words = []
+        capture = False
+        for line in data.decode('utf-8', 'replace').splitlines():
+            line = line.strip()
+            if line.startswith('trace begin'):
+                capture = True
+                words = []
+            elif line.startswith('trace end'):
+                capture = False
+            elif capture:
+                words.extend(int(word, 16) for word in line.split())
+        # the words are printed by target, so they are in the byte order of host here
+        return struct.pack('<%dI' % len(words), *words), '<'
+
+    magic, = struct.unpack_from('<I', data, 0)
+    return data, '<' if magic == TRACE_MAGIC else '>'
+
+def parse(data, endian):
+    magic, version, event_size, name_size, name_nr, flag, event_nr, tail, rate = \
+        struct.unpack_from(endian + 'IHHHHIIII', data, 0)
+    if magic != TRACE_MAGIC:
+        raise ValueError('no trace buffer is found in the dump')
+    if version != 1:
+        raise ValueError('the version %d of trace buffer is not supported' % version)
+
+    names = {}
+    offset = HEADER_SIZE
+    for index in range(name_nr):
+        obj, cls = struct.unpack_from(endian + 'IB', data, offset)
+        name = data[offset + 8:offset + name_size].split(b'\0')[0].decode('utf-8', 'replace')
+        if obj:
+            names[obj] = (cls, name)
+        offset += name_size
+
+    if len(data) < offset + event_nr * event_size:
+        raise ValueError('the dump is truncated')
+
+    events = []
+    start = tail - event_nr if tail > event_nr else 0
+    for pos in range(start, tail):
+        events.append(struct.unpack_from(endian + 'IBBHII', data, offset + (pos % event_nr) * event_size))
+
+    return flag, rate, names, events, start > 0
+
+class Converter(object):
+
+    def __init__(self, names, rate):
+        self.names = names
+        self.rate = float(rate)
+        self.output = []
+        self.tids = {}
+        self.running = {}           # cpu -> (thread, start)
+        self.irq = {}               # cpu -> [(irq, start)]
+        self.timer = {}             # timer -> start
+        self.wakeup = {}            # thread -> (flow id, time)
+        self.heap = {}              # block -> size
+        self.heap_used = 0
+        self.flow = 0
+        self.stat_run = {}          # thread -> [count, total, max]
+        self.stat_wakeup = {}       # thread -> [count, total, max]
+        self.stat_irq = {}          # irq -> [count, total, max]
+        self.stat_timer = {}        # timer -> [count, total, max]
+
+    def name(self, obj):
+        if obj in self.names:
+            return self.names[obj][1]
+        return '0x%08x' % obj
+
+    def tid(self, thread):
+        if thread not in self.tids:
+            self.tids[thread] = TID_THREAD + len(self.tids)
+        return self.tids[thread]
+
+    def us(self, stamp):
+        return stamp * 1e6 / self.rate
+
+    def emit(self, **event):
+        self.output.append(event)
+
+    def slice(self, name, cpu, tid, start, end, **args):
+        self.emit(name=name, ph='X', pid=cpu, tid=tid, ts=self.us(start),
+                  dur=self.us(end - start), args=args)
+
+    def instant(self, name, cpu, tid, now, **args):
+        self.emit(name=name, ph='i', s='t', pid=cpu, tid=tid, ts=self.us(now), args=args)
+
+    def account(self, stat, key, value):
+        item = stat.setdefault(key, [0, 0, 0])
+        item[0] += 1
+        item[1] += value
+        item[2] = max(item[2], value)
+
+    def context(self, cpu, thread):
+        '''the track of current context, the interrupt or the thread'''
+        if self.irq.get(cpu):
+            return TID_IRQ
+        return self.tid(thread)
+
+    def event(self, now, type, cpu, value, obj, arg):
+        if type == TRACE_SWITCH:
+            if cpu in self.running:
+                thread, start = self.running[cpu]
+                self.slice(self.name(thread), cpu, self.tid(thread), start, now)
+                self.account(self.stat_run, thread, now - start)
+            self.running[cpu] = (arg, now)
+
+            if arg in self.wakeup:
+                flow, start = self.wakeup.pop(arg)
+                self.emit(name='wakeup', cat='wakeup', ph='f', bp='e', id=flow,
+                          pid=cpu, tid=self.tid(arg), ts=self.us(now))
+                self.account(self.stat_wakeup, arg, now - start)
+
+        elif type == TRACE_IRQ_ENTER:
+            self.irq.setdefault(cpu, []).append((value, now))
+
+        elif type == TRACE_IRQ_LEAVE:
+            if self.irq.get(cpu):
+                irq, start = self.irq[cpu].pop()
+                self.slice('irq %d' % irq, cpu, TID_IRQ, start, now)
+                self.account(self.stat_irq, irq, now - start)
+
+        elif type in (TRACE_OBJ_TRYTAKE, TRACE_OBJ_TAKE, TRACE_OBJ_PUT):
+            action = {TRACE_OBJ_TRYTAKE: 'trytake', TRACE_OBJ_TAKE: 'take', TRACE_OBJ_PUT: 'put'}[type]
+            self.instant('%s %s' % (action, self.name(obj)), cpu, self.context(cpu, arg), now,
+                         object=self.name(obj), type=OBJECT_CLASS.get(value & 0x7f, str(value)))
+
+        elif type == TRACE_THREAD_SUSPEND:
+            self.instant('suspend', cpu, self.tid(obj), now, by=self.name(arg))
+
+        elif type == TRACE_THREAD_RESUME:
+            self.flow += 1
+            self.wakeup[obj] = (self.flow, now)
+            self.emit(name='wakeup', cat='wakeup', ph='s', id=self.flow,
+                      pid=cpu, tid=self.context(cpu, arg), ts=self.us(now))
+            self.instant('resume %s' % self.name(obj), cpu, self.context(cpu, arg), now)
+
+        elif type == TRACE_TIMER_ENTER:
+            self.timer[obj] = now
+
+        elif type == TRACE_TIMER_EXIT:
+            if obj in self.timer:
+                start = self.timer.pop(obj)
+                self.slice(self.name(obj), cpu, TID_TIMER, start, now, function='0x%08x' % arg)
+                self.account(self.stat_timer, obj, now - start)
+
+        elif type == TRACE_MALLOC:
+            self.heap[obj] = arg
+            self.heap_used += arg
+            self.emit(name='heap', ph='C', pid=cpu, tid=TID_HEAP, ts=self.us(now),
+                      args={'used': self.heap_used})
+
+        elif type == TRACE_FREE:
+            # the blocks allocated before recording are unknown
+            self.heap_used -= self.heap.pop(obj, 0)
+            self.emit(name='heap', ph='C', pid=cpu, tid=TID_HEAP, ts=self.us(now),
+                      args={'used': self.heap_used})
+
+    def finish(self, now):
+        for cpu, (thread, start) in self.running.items():
+            self.slice(self.name(thread), cpu, self.tid(thread), start, now)
+            self.account(self.stat_run, thread, now - start)
+
+        cpus = set(event['pid'] for event in self.output) or set([0])
+        for cpu in cpus:
+            self.emit(name='process_name', ph='M', pid=cpu, args={'name': 'cpu%d' % cpu})
+            self.emit(name='thread_name', ph='M', pid=cpu, tid=TID_IRQ, args={'name': 'interrupt'})
+            self.emit(name='thread_name', ph='M', pid=cpu, tid=TID_TIMER, args={'name': 'timer'})
+            self.emit(name='thread_name', ph='M', pid=cpu, tid=TID_HEAP, args={'name': 'heap'})
+            for thread, tid in self.tids.items():
+                self.emit(name='thread_name', ph='M', pid=cpu, tid=tid, args={'name': self.name(thread)})
+
+    def summary(self, out):
+        def show(title, stat, name):
+            if not stat:
+                return
+            print('%-16s %8s %12s %12s %12s' % (title, 'count', 'total(us)', 'mean(us)', 'max(us)'), file=out)
+            for key, (count, total, peak) in sorted(stat.items(), key=lambda item: -item[1][2]):
+                print('%-16s %8d %12.1f %12.1f %12.1f' % (name(key), count, self.us(total),
+                      self.us(total) / count, self.us(peak)), file=out)
+            print('', file=out)
+
+        show('thread run', self.stat_run, self.name)
+        show('wakeup latency', self.stat_wakeup, self.name)
+        show('interrupt', self.stat_irq, lambda irq: 'irq %d' % irq)
+        show('timer', self.stat_timer, self.name)
+
+def main():
+    parser = argparse.ArgumentParser(description='convert the kernel event trace of RT-Thread to Chrome trace JSON')
+    parser.add_argument('dump', help='the console output of "trace dump", or the binary dump of rt_trace')
+    parser.add_argument('-o', '--output', default='trace.json', help='the JSON file, trace.json by default')
+    parser.add_argument('--hz', type=float, default=0,
+                        help='the frequency of timestamp, it is required for the cpu cycle timestamp')
+    args = parser.parse_args()
+
+    data, endian = load_dump(args.dump)
+    flag, rate, names, events, wrapped = parse(data, endian)
+
+    if args.hz:
+        rate = args.hz
+    if not rate:
+        parser.error('the timestamp is cpu cycle, the frequency shall be given by --hz')
+
+    converter = Converter(names, rate)
+
+    # the timestamp is unwrapped from 32 bits
+    now = 0
+    last = events[0][0] if events else 0
+    for stamp, type, cpu, value, obj, arg in events:
+        now += (stamp - last) & 0xffffffff
+        last = stamp
+        converter.event(now, type, cpu, value, obj, arg)
+    converter.finish(now)
+
+    with open(args.output, 'w') as output:
+        json.dump({'traceEvents': converter.output, 'displayTimeUnit': 'ns'}, output)
+
+    print('%d events%s, %.1f us, written to %s' % (len(events), ' (the oldest are overwritten)' if wrapped else '',
+          converter.us(now), args.output), file=sys.stderr)
+    if not flag & TRACE_FLAG_CYCLE:
+        print('the timestamp is tick, the latencies are in the resolution of tick', file=sys.stderr)
+    print('', file=sys.stderr)
+    converter.summary(sys.stderr)
+
+if __name__ == '__main__':
+    main()